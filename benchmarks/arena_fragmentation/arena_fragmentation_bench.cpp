@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures allocation from an arena whose superblocks are fragmented into many small holes. A
+// request that fits none of the holes has to skip every fragmented superblock before it is served.
+
+#include <benchmarks/utilities/simulated_memory_resource.hpp>
+
+#include <rmm/cuda_stream_view.hpp>
+#include <rmm/mr/device/arena_memory_resource.hpp>
+#include <rmm/mr/device/detail/arena.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using arena_mr = rmm::mr::arena_memory_resource<rmm::mr::simulated_memory_resource>;
+
+constexpr std::size_t small_size{256};
+constexpr std::size_t superblock_size{rmm::mr::detail::arena::superblock::minimum_size};
+
+/**
+ * @brief Fills `num_superblocks` superblocks with small allocations and frees every other one,
+ * leaving each superblock with `superblock_size / (2 * small_size)` free blocks.
+ *
+ * @return The allocations that are still live.
+ */
+std::vector<void*> fragment(arena_mr& mr, std::size_t num_superblocks)
+{
+  auto const num_blocks = num_superblocks * superblock_size / small_size;
+  std::vector<void*> blocks(num_blocks);
+  for (auto& ptr : blocks) {
+    ptr = mr.allocate(small_size);
+  }
+  std::vector<void*> live;
+  live.reserve(num_blocks / 2);
+  for (std::size_t i = 0; i < num_blocks; ++i) {
+    if (i % 2 == 0) {
+      mr.deallocate(blocks[i], small_size);
+    } else {
+      live.push_back(blocks[i]);
+    }
+  }
+  return live;
+}
+
+void BM_FragmentedArena(benchmark::State& state, std::size_t size)
+{
+  auto const num_superblocks = static_cast<std::size_t>(state.range(0));
+  auto const arena_size      = (num_superblocks + 64) * superblock_size;
+  rmm::mr::simulated_memory_resource upstream{arena_size};
+  arena_mr mr{&upstream, arena_size};
+  auto const live = fragment(mr, num_superblocks);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    void* ptr = mr.allocate(size);
+    benchmark::DoNotOptimize(ptr);
+    mr.deallocate(ptr, size);
+  }
+
+  for (auto* ptr : live) {
+    mr.deallocate(ptr, small_size);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Served from the first hole of the first superblock
+void BM_FragmentedArenaSmall(benchmark::State& state) { BM_FragmentedArena(state, small_size); }
+
+// Fits no hole, so every fragmented superblock is skipped
+void BM_FragmentedArenaLarge(benchmark::State& state) { BM_FragmentedArena(state, 64UL << 10); }
+
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK(BM_FragmentedArenaSmall)
+  ->RangeMultiplier(4)
+  ->Range(4, 256)
+  ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FragmentedArenaLarge)
+  ->RangeMultiplier(4)
+  ->Range(4, 256)
+  ->Unit(benchmark::kMicrosecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures a pipeline in which producer threads allocate blocks and hand them to consumer threads
+// that free them, so that every deallocation happens on a thread other than the allocating one.
+
+#include <benchmarks/utilities/simulated_memory_resource.hpp>
+
+#include <rmm/cuda_stream_view.hpp>
+#include <rmm/mr/device/arena_memory_resource.hpp>
+#include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/pool_memory_resource.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using simulated_mr = rmm::mr::simulated_memory_resource;
+
+constexpr std::size_t memory_size{std::size_t{16} << 30};
+constexpr std::size_t max_size{std::size_t{64} << 10};
+constexpr std::size_t blocks_per_producer{10000};
+
+/**
+ * @brief Runs `num_pairs` producer threads, each allocating `blocks_per_producer` blocks, and
+ * `num_pairs` consumer threads freeing them in the order they were produced.
+ */
+void run_pipeline(rmm::mr::device_memory_resource* mr, std::size_t num_pairs)
+{
+  std::mutex mtx;
+  std::condition_variable blocks_ready;
+  std::deque<std::pair<void*, std::size_t>> blocks;
+
+  auto produce = [&](std::size_t seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<std::size_t> size_distribution(1, max_size);
+    for (std::size_t i = 0; i < blocks_per_producer; ++i) {
+      auto const size = size_distribution(generator);
+      void* ptr       = mr->allocate(size, rmm::cuda_stream_per_thread);
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        blocks.emplace_back(ptr, size);
+      }
+      blocks_ready.notify_one();
+    }
+  };
+  auto consume = [&]() {
+    for (std::size_t i = 0; i < blocks_per_producer; ++i) {
+      std::unique_lock lock(mtx);
+      blocks_ready.wait(lock, [&blocks] { return !blocks.empty(); });
+      auto const [ptr, size] = blocks.front();
+      blocks.pop_front();
+      lock.unlock();
+      mr->deallocate(ptr, size, rmm::cuda_stream_per_thread);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < num_pairs; ++i) {
+    threads.emplace_back(produce, i);
+    threads.emplace_back(consume);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+template <typename MemoryResource>
+void BM_ProducerConsumer(benchmark::State& state)
+{
+  auto const num_pairs = static_cast<std::size_t>(state.range(0));
+  simulated_mr upstream{memory_size};
+  MemoryResource mr{&upstream, memory_size};
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    run_pipeline(&mr, num_pairs);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * num_pairs) *
+                          static_cast<int64_t>(blocks_per_producer));
+}
+
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, rmm::mr::arena_memory_resource<simulated_mr>)
+  ->RangeMultiplier(2)
+  ->Range(1, 8)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, rmm::mr::pool_memory_resource<simulated_mr>)
+  ->RangeMultiplier(2)
+  ->Range(1, 8)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+
+BENCHMARK_MAIN();
@@ -37,6 +37,7 @@
 
 #include <benchmarks/utilities/cxxopts.hpp>
 
+#include <rmm/cuda_stream.hpp>
 #include <rmm/mr/device/arena_memory_resource.hpp>
 #include <rmm/mr/device/binning_memory_resource.hpp>
 #include <rmm/mr/device/cuda_async_memory_resource.hpp>
@@ -44,14 +45,20 @@
 #include <rmm/mr/device/device_memory_resource.hpp>
 #include <rmm/mr/device/owning_wrapper.hpp>
 #include <rmm/mr/device/pool_memory_resource.hpp>
+#include <rmm/mr/device/static_binning_memory_resource.hpp>
+#include <rmm/mr/device/tlsf_memory_resource.hpp>
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <random>
+#include <thread>
+#include <vector>
 
 #define VERBOSE 0
 
@@ -189,6 +196,19 @@ inline auto make_pool()
   return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda());
 }
 
+inline auto make_pool_thread_cache()
+{
+  constexpr std::size_t max_cached_size{64 << 10};
+  rmm::mr::pool_memory_resource_options opts;
+  opts.thread_cache = {max_cached_size};
+  return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda(), opts);
+}
+
+inline auto make_tlsf()
+{
+  return rmm::mr::make_owning_wrapper<rmm::mr::tlsf_memory_resource>(make_cuda());
+}
+
 inline auto make_arena()
 {
   auto free = rmm::detail::available_device_memory().first;
@@ -208,6 +228,20 @@ inline auto make_binning()
   return mr;
 }
 
+inline std::shared_ptr<rmm::mr::device_memory_resource> make_binning_static()
+{
+  // The bins of make_binning, laid out at compile time
+  auto pool = make_pool();
+  using binning_mr = rmm::mr::static_binning_memory_resource<decltype(pool)::element_type,
+                                                             std::size_t{256} << 10U,
+                                                             std::size_t{512} << 10U,
+                                                             std::size_t{1} << 20U,
+                                                             std::size_t{2} << 20U,
+                                                             std::size_t{4} << 20U>;
+  // The deleter keeps the pool alive until the binning resource is destroyed
+  return {new binning_mr{pool.get()}, [pool](binning_mr* mr) { delete mr; }};
+}
+
 using MRFactoryFunc = std::function<std::shared_ptr<rmm::mr::device_memory_resource>()>;
 
 constexpr std::size_t max_usage = 16000;
@@ -228,6 +262,103 @@ static void BM_RandomAllocations(benchmark::State& state, MRFactoryFunc const& f
   }
 }
 
+static void BM_FragmentedAllocations(benchmark::State& state, MRFactoryFunc const& factory)
+{
+  auto mr = factory();
+
+  auto const num_fragments = static_cast<std::size_t>(state.range(0));
+  constexpr std::size_t fragment_size{256};
+
+  // Allocate pairs of small blocks and free the first of each pair, leaving `num_fragments`
+  // non-contiguous free blocks that are too small to satisfy the allocations timed below.
+  std::vector<void*> ptrs(2 * num_fragments);
+  std::for_each(ptrs.begin(), ptrs.end(), [&mr](void*& ptr) { ptr = mr->allocate(fragment_size); });
+  for (std::size_t i = 0; i < ptrs.size(); i += 2) {
+    mr->deallocate(ptrs[i], fragment_size);
+  }
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    void* ptr = mr->allocate(2 * fragment_size);
+    mr->deallocate(ptr, 2 * fragment_size);
+  }
+
+  for (std::size_t i = 1; i < ptrs.size(); i += 2) {
+    mr->deallocate(ptrs[i], fragment_size);
+  }
+}
+
+static void BM_MultithreadedSmallAllocations(benchmark::State& state,
+                                             MRFactoryFunc const& factory)
+{
+  auto mr = factory();
+
+  auto const num_threads = static_cast<std::size_t>(state.range(0));
+  constexpr std::size_t num_operations{10000};  // per thread
+  constexpr std::size_t max_live{16};           // per thread
+  constexpr std::size_t max_size{64 << 10};
+
+  // Each thread repeatedly allocates and frees small blocks on its own default stream, the typical
+  // pattern of host-multithreaded pipelines where contention on the resource lock dominates.
+  auto work = [&mr]() {
+    std::default_random_engine generator;
+    std::uniform_int_distribution<std::size_t> size_distribution(1, max_size);
+    std::vector<allocation> live;
+    live.reserve(max_live);
+    for (std::size_t i = 0; i < num_operations; ++i) {
+      if (live.size() == max_live) {
+        auto const freed = remove_at(live, generator() % max_live);
+        mr->deallocate(freed.ptr, freed.size, rmm::cuda_stream_per_thread);
+      }
+      auto const size = size_distribution(generator);
+      live.emplace_back(mr->allocate(size, rmm::cuda_stream_per_thread), size);
+    }
+    for (auto const& alloc : live) {
+      mr->deallocate(alloc.ptr, alloc.size, rmm::cuda_stream_per_thread);
+    }
+  };
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back(work);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * num_threads *
+                                                    num_operations));
+}
+
+static void BM_DeallocateOnStream(benchmark::State& state)
+{
+  // range(0) is the number of frees covered by one event record; 1 records on every free
+  rmm::mr::pool_memory_resource_options opts;
+  opts.deferred_events = {static_cast<std::size_t>(state.range(0))};
+  auto mr = rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda(), opts);
+  rmm::cuda_stream stream{};
+
+  constexpr std::size_t num_allocations{1000};
+  constexpr std::size_t size{256};
+  std::vector<void*> ptrs(num_allocations);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    state.PauseTiming();
+    std::for_each(ptrs.begin(), ptrs.end(), [&](void*& ptr) { ptr = mr->allocate(size, stream); });
+    state.ResumeTiming();
+    std::for_each(ptrs.begin(), ptrs.end(), [&](void* ptr) { mr->deallocate(ptr, size, stream); });
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * num_allocations));
+}
+
+static void thread_range(benchmark::internal::Benchmark* bench)
+{
+  bench->RangeMultiplier(2)->Range(1, 32)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
 static void num_range(benchmark::internal::Benchmark* bench, int size)
 {
   for (int num_allocations : std::vector<int>{1000, 10000, 100000}) {
@@ -280,9 +411,36 @@ void declare_benchmark(std::string const& name)
   } else if (name == "binning") {
     BENCHMARK_CAPTURE(BM_RandomAllocations, binning_mr, &make_binning)  // NOLINT
       ->Apply(benchmark_range);
+  } else if (name == "binning_static") {
+    BENCHMARK_CAPTURE(BM_RandomAllocations, binning_static_mr, &make_binning_static)  // NOLINT
+      ->Apply(benchmark_range);
   } else if (name == "pool") {
     BENCHMARK_CAPTURE(BM_RandomAllocations, pool_mr, &make_pool)  // NOLINT
       ->Apply(benchmark_range);
+    BENCHMARK_CAPTURE(BM_FragmentedAllocations, pool_mr, &make_pool)  // NOLINT
+      ->RangeMultiplier(10)
+      ->Range(1000, 100000)
+      ->Unit(benchmark::kMicrosecond);
+    BENCHMARK_CAPTURE(BM_MultithreadedSmallAllocations, pool_mr, &make_pool)  // NOLINT
+      ->Apply(thread_range);
+    BENCHMARK(BM_DeallocateOnStream)  // NOLINT
+      ->Arg(1)
+      ->Arg(64)
+      ->Unit(benchmark::kMicrosecond);
+  } else if (name == "pool_thread_cache") {
+    BENCHMARK_CAPTURE(  // NOLINT
+      BM_RandomAllocations, pool_thread_cache_mr, &make_pool_thread_cache)
+      ->Apply(benchmark_range);
+    BENCHMARK_CAPTURE(  // NOLINT
+      BM_MultithreadedSmallAllocations, pool_thread_cache_mr, &make_pool_thread_cache)
+      ->Apply(thread_range);
+  } else if (name == "tlsf") {
+    BENCHMARK_CAPTURE(BM_RandomAllocations, tlsf_mr, &make_tlsf)  // NOLINT
+      ->Apply(benchmark_range);
+    BENCHMARK_CAPTURE(BM_FragmentedAllocations, tlsf_mr, &make_tlsf)  // NOLINT
+      ->RangeMultiplier(10)
+      ->Range(1000, 100000)
+      ->Unit(benchmark::kMicrosecond);
   } else if (name == "arena") {
     BENCHMARK_CAPTURE(BM_RandomAllocations, arena_mr, &make_arena)  // NOLINT
       ->Apply(benchmark_range);
@@ -332,13 +490,17 @@ int main(int argc, char** argv)
     max_size        = args["maxsize"].as<int>();
 
     if (args.count("profile") > 0) {
-      std::map<std::string, MRFactoryFunc> const funcs({{"arena", &make_arena},
-                                                        {"binning", &make_binning},
-                                                        {"cuda", &make_cuda},
+      std::map<std::string, MRFactoryFunc> const funcs(
+        {{"arena", &make_arena},
+         {"binning", &make_binning},
+         {"binning_static", &make_binning_static},
+         {"cuda", &make_cuda},
 #ifdef RMM_CUDA_MALLOC_ASYNC_SUPPORT
-                                                        {"cuda_async", &make_cuda_async},
+         {"cuda_async", &make_cuda_async},
 #endif
-                                                        {"pool", &make_pool}});
+         {"pool", &make_pool},
+         {"pool_thread_cache", &make_pool_thread_cache},
+         {"tlsf", &make_tlsf}});
       auto resource = args["resource"].as<std::string>();
 
       std::cout << "Profiling " << resource << " with " << num_allocations << " allocations of max "
@@ -360,9 +522,17 @@ int main(int argc, char** argv)
         declare_benchmark(mr_name);
       } else {
 #ifdef RMM_CUDA_MALLOC_ASYNC_SUPPORT
-        std::vector<std::string> mrs{"pool", "binning", "arena", "cuda_async", "cuda"};
+        std::vector<std::string> mrs{"pool",
+                                     "pool_thread_cache",
+                                     "tlsf",
+                                     "binning",
+                                     "binning_static",
+                                     "arena",
+                                     "cuda_async",
+                                     "cuda"};
 #else
-        std::vector<std::string> mrs{"pool", "binning", "arena", "cuda"};
+        std::vector<std::string> mrs{
+          "pool", "pool_thread_cache", "tlsf", "binning", "binning_static", "arena", "cuda"};
 #endif
         std::for_each(
           std::cbegin(mrs), std::cend(mrs), [](auto const& mr) { declare_benchmark(mr); });
@@ -39,14 +39,19 @@
 #include <benchmarks/utilities/log_parser.hpp>
 #include <benchmarks/utilities/simulated_memory_resource.hpp>
 
+#include <rmm/cuda_stream_pool.hpp>
 #include <rmm/cuda_stream_view.hpp>
 #include <rmm/detail/error.hpp>
 #include <rmm/mr/device/arena_memory_resource.hpp>
 #include <rmm/mr/device/binning_memory_resource.hpp>
 #include <rmm/mr/device/cuda_memory_resource.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/growth_policy.hpp>
 #include <rmm/mr/device/owning_wrapper.hpp>
 #include <rmm/mr/device/pool_memory_resource.hpp>
+#include <rmm/mr/device/size_class_policy.hpp>
+#include <rmm/mr/device/statistics_resource_adaptor.hpp>
+#include <rmm/mr/device/tlsf_memory_resource.hpp>
 
 #include <thrust/execution_policy.h>
 #include <thrust/iterator/constant_iterator.h>
@@ -57,13 +62,16 @@
 
 #include <spdlog/common.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <numeric>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 /// MR factory functions
 std::shared_ptr<rmm::mr::device_memory_resource> make_cuda(std::size_t = 0)
@@ -76,22 +84,88 @@ std::shared_ptr<rmm::mr::device_memory_resource> make_simulated(std::size_t simu
   return std::make_shared<rmm::mr::simulated_memory_resource>(simulated_size);
 }
 
-inline auto make_pool(std::size_t simulated_size)
+/**
+ * @brief Creates the growth policy named `name` ("default", "fixed", "geometric" or "adaptive").
+ */
+std::shared_ptr<rmm::mr::growth_policy> make_growth_policy(std::string const& name)
+{
+  constexpr std::size_t chunk_size{1U << 30U};      // fixed: 1 GiB per expansion
+  constexpr std::size_t max_chunk_size{1UL << 32U};  // geometric and adaptive: at most 4 GiB
+  constexpr std::size_t min_chunk_size{1U << 26U};   // adaptive: at least 64 MiB
+  constexpr std::size_t window{1024};                // adaptive: the last 1024 allocations
+  if (name == "default") { return std::make_shared<rmm::mr::default_growth_policy>(); }
+  if (name == "fixed") { return std::make_shared<rmm::mr::fixed_chunk_growth_policy>(chunk_size); }
+  if (name == "geometric") {
+    return std::make_shared<rmm::mr::geometric_growth_policy>(2.0, max_chunk_size);
+  }
+  if (name == "adaptive") {
+    return std::make_shared<rmm::mr::adaptive_growth_policy>(
+      window, min_chunk_size, max_chunk_size);
+  }
+  RMM_FAIL("Invalid growth policy: " + name);
+}
+
+/**
+ * @brief Creates a pool. Without a growth policy the pool starts at the simulated size (or half of
+ * the device); with one it starts empty so that every byte is obtained through the policy.
+ *
+ * The upstream is wrapped in a `statistics_resource_adaptor` to count upstream calls and the peak
+ * footprint of the pool.
+ */
+inline auto make_pool(std::size_t simulated_size, std::string const& growth_policy = {})
+{
+  auto upstream = rmm::mr::make_owning_wrapper<rmm::mr::statistics_resource_adaptor>(
+    (simulated_size > 0) ? make_simulated(simulated_size) : make_cuda());
+  auto const maximum = (simulated_size > 0) ? thrust::optional<std::size_t>{simulated_size}
+                                            : thrust::optional<std::size_t>{};
+  if (growth_policy.empty()) {
+    return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(upstream, maximum, maximum);
+  }
+  rmm::mr::pool_memory_resource_options opts;
+  opts.initial_pool_size = 0;
+  opts.maximum_pool_size = maximum;
+  opts.growth            = make_growth_policy(growth_policy);
+  return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(upstream, opts);
+}
+
+using pool_type = decltype(make_pool(0))::element_type;
+
+inline auto make_tlsf(std::size_t simulated_size)
 {
   if (simulated_size > 0) {
-    return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(
+    return rmm::mr::make_owning_wrapper<rmm::mr::tlsf_memory_resource>(
       make_simulated(simulated_size), simulated_size, simulated_size);
   }
-  return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda());
+  return rmm::mr::make_owning_wrapper<rmm::mr::tlsf_memory_resource>(make_cuda());
+}
+
+/**
+ * @brief Creates the arena size-class policy named `name`: "exact" (256-byte alignment only),
+ * "jemalloc" (4 classes per doubling), "fine" (8 classes per doubling) or "exact-small" (256-byte
+ * granularity up to 1 MiB, 4 classes per doubling above).
+ */
+std::shared_ptr<rmm::mr::size_class_policy> make_size_classes(std::string const& name)
+{
+  constexpr std::size_t exact_below{1U << 20U};
+  if (name == "exact") { return std::make_shared<rmm::mr::exact_size_classes>(); }
+  if (name == "jemalloc") { return std::make_shared<rmm::mr::geometric_size_classes>(4); }
+  if (name == "fine") { return std::make_shared<rmm::mr::geometric_size_classes>(8); }
+  if (name == "exact-small") {
+    return std::make_shared<rmm::mr::geometric_size_classes>(4, exact_below);
+  }
+  RMM_FAIL("Invalid size classes: " + name);
 }
 
-inline auto make_arena(std::size_t simulated_size)
+inline auto make_arena(std::size_t simulated_size, std::string const& size_classes = {})
 {
+  rmm::mr::arena_memory_resource_options opts;
+  if (not size_classes.empty()) { opts.size_classes = make_size_classes(size_classes); }
   if (simulated_size > 0) {
+    opts.arena_size = simulated_size;
     return rmm::mr::make_owning_wrapper<rmm::mr::arena_memory_resource>(
-      make_simulated(simulated_size), simulated_size, simulated_size);
+      make_simulated(simulated_size), opts);
   }
-  return rmm::mr::make_owning_wrapper<rmm::mr::arena_memory_resource>(make_cuda());
+  return rmm::mr::make_owning_wrapper<rmm::mr::arena_memory_resource>(make_cuda(), opts);
 }
 
 inline auto make_binning(std::size_t simulated_size)
@@ -106,6 +180,23 @@ inline auto make_binning(std::size_t simulated_size)
   return mr;
 }
 
+/**
+ * @brief Creates a binning resource over a pool whose bins are created and retired adaptively for
+ * the sizes of up to 1 MiB that dominate the log. The bins may hold an eighth of the simulated
+ * size, or 1 GiB on a real device.
+ */
+inline auto make_binning_adaptive(std::size_t simulated_size)
+{
+  constexpr std::size_t default_budget{std::size_t{1} << 30U};
+  constexpr std::size_t budget_divisor{8};
+  rmm::mr::adaptive_binning_options options{};
+  options.memory_budget = (simulated_size > 0) ? simulated_size / budget_divisor : default_budget;
+  return rmm::mr::make_owning_wrapper<rmm::mr::binning_memory_resource>(make_pool(simulated_size),
+                                                                        options);
+}
+
+using binning_type = decltype(make_binning(0))::element_type;
+
 using MRFactoryFunc = std::function<std::shared_ptr<rmm::mr::device_memory_resource>(std::size_t)>;
 
 /**
@@ -115,10 +206,24 @@ using MRFactoryFunc = std::function<std::shared_ptr<rmm::mr::device_memory_resou
 struct allocation {
   allocation() = default;
   void* ptr{};
-  allocation(void* ptr, std::size_t size) : ptr{ptr}, size{size} {}
+  allocation(void* ptr, std::size_t size, rmm::cuda_stream_view stream)
+    : ptr{ptr}, size{size}, stream{stream}
+  {
+  }
   std::size_t size{};
+  rmm::cuda_stream_view stream{};
 };
 
+/**
+ * @brief Returns the replay stream of `event`, whose stream has been remapped by `remap_streams`.
+ */
+inline rmm::cuda_stream_view replay_stream(rmm::detail::event const& event)
+{
+  cudaStream_t stream{};
+  std::memcpy(&stream, &event.stream, sizeof(cudaStream_t));
+  return rmm::cuda_stream_view{stream};
+}
+
 /**
  * @brief Function object for running a replay benchmark with the specified
  * `device_memory_resource`.
@@ -131,13 +236,17 @@ struct replay_benchmark {
   std::size_t simulated_size_;
   std::shared_ptr<rmm::mr::device_memory_resource> mr_{};
   std::vector<std::vector<rmm::detail::event>> const& events_{};
+  std::size_t num_events_{};  // events per iteration, across all threads
 
   // Maps a pointer from the event log to an active allocation
   std::unordered_map<uintptr_t, allocation> allocation_map;
 
   std::condition_variable cv;  // to ensure in-order playback
   std::mutex event_mutex;      // to make event_index and allocation_map thread-safe
-  std::size_t event_index{0};  // playback index
+  std::size_t event_index{0};  // playback index, counted across iterations
+
+  std::size_t num_leaked{0};    // allocations the log never frees
+  std::size_t total_leaked{0};  // bytes the log never frees
 
   /**
    * @brief Construct a `replay_benchmark` from a list of events and
@@ -153,6 +262,10 @@ struct replay_benchmark {
     : factory_{std::move(factory)},
       simulated_size_{simulated_size},
       events_{events},
+      num_events_{std::accumulate(
+        events.begin(), events.end(), std::size_t{0}, [](std::size_t accum, auto const& thread) {
+          return accum + thread.size();
+        })},
       allocation_map{events.size()}
   {
   }
@@ -167,6 +280,7 @@ struct replay_benchmark {
       simulated_size_{other.simulated_size_},
       mr_{std::move(other.mr_)},
       events_{other.events_},
+      num_events_{other.num_events_},
       allocation_map{std::move(other.allocation_map)}
   {
   }
@@ -191,12 +305,57 @@ struct replay_benchmark {
     return allocation{};
   }
 
+  /// Free the allocations the log leaves live at the end of an iteration (NOT thread safe)
+  void free_leaked_allocations(bool count_leaks)
+  {
+    for (auto const& ptr_alloc : allocation_map) {
+      auto const& alloc = ptr_alloc.second;
+      if (count_leaks) {
+        num_leaked++;
+        total_leaked += alloc.size;
+      }
+      mr_->deallocate(alloc.ptr, alloc.size, alloc.stream);
+    }
+    allocation_map.clear();
+  }
+
   /// Create the memory resource shared by all threads before the benchmark runs
   void SetUp(const ::benchmark::State& state)
   {
     if (state.thread_index() == 0) {
       rmm::logger().log(spdlog::level::info, "------ Start of Benchmark -----");
-      mr_ = factory_(simulated_size_);
+      mr_          = factory_(simulated_size_);
+      event_index  = 0;
+      num_leaked   = 0;
+      total_leaked = 0;
+    }
+  }
+
+  /// Report the upstream allocation calls and peak footprint of a pool resource
+  void report_upstream_statistics(::benchmark::State& state) const
+  {
+    auto const* pool = dynamic_cast<pool_type const*>(mr_.get());
+    if (state.thread_index() != 0 || pool == nullptr) { return; }
+    auto const& upstream = pool->wrapped().get_upstream()->wrapped();
+    state.counters["upstream_allocations"] =
+      static_cast<double>(upstream.get_allocations_counter().total);
+    state.counters["peak_footprint_MiB"] =
+      static_cast<double>(upstream.get_bytes_counter().peak) / static_cast<double>(1U << 20U);
+  }
+
+  /// Report the share of allocations served by each bin of a binning resource
+  void report_bin_statistics(::benchmark::State& state) const
+  {
+    auto const* binning = dynamic_cast<binning_type const*>(mr_.get());
+    if (state.thread_index() != 0 || binning == nullptr) { return; }
+    auto const stats                = binning->wrapped().get_bin_statistics();
+    state.counters["bin_hit_rate"]  = stats.hit_rate();
+    state.counters["bins_created"]  = static_cast<double>(stats.bins_created);
+    state.counters["bins_retired"]  = static_cast<double>(stats.bins_retired);
+    for (auto const& bin : stats.bins) {
+      std::cout << (bin.adaptive ? "Adaptive" : "Static") << " bin of " << bin.size
+                << " B: " << bin.allocations << " allocations, hit rate " << bin.hit_rate * 100
+                << "%\n";
     }
   }
 
@@ -205,20 +364,10 @@ struct replay_benchmark {
   {
     if (state.thread_index() == 0) {
       rmm::logger().log(spdlog::level::info, "------ End of Benchmark -----");
-      // clean up any leaked allocations
-      std::size_t total_leaked{0};
-      std::size_t num_leaked{0};
-      for (auto const& ptr_alloc : allocation_map) {
-        auto alloc = ptr_alloc.second;
-        num_leaked++;
-        total_leaked += alloc.size;
-        mr_->deallocate(alloc.ptr, alloc.size);
-      }
       if (num_leaked > 0) {
         std::cout << "LOG shows leak of " << num_leaked << " allocations of " << total_leaked
                   << " total bytes\n";
       }
-      allocation_map.clear();
       mr_.reset();
     }
   }
@@ -230,28 +379,36 @@ struct replay_benchmark {
 
     auto const& my_events = events_.at(state.thread_index());
 
+    std::size_t iteration{0};
     for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
-      std::for_each(my_events.begin(), my_events.end(), [this](auto event) {
-        // ensure correct ordering between threads
+      auto const first = iteration * num_events_;
+      std::for_each(my_events.begin(), my_events.end(), [this, first, iteration](auto event) {
+        // ensure correct ordering between threads, and therefore between streams
         std::unique_lock<std::mutex> lock{event_mutex};
-        if (event_index != event.index) {
-          cv.wait(lock, [&]() { return event_index == event.index; });
+        auto const index = first + event.index;
+        if (event_index != index) {
+          cv.wait(lock, [&]() { return event_index == index; });
         }
 
         // rmm::detail::action::ALLOCATE_FAILURE is ignored.
+        auto const stream = replay_stream(event);
         if (rmm::detail::action::ALLOCATE == event.act) {
-          auto ptr = mr_->allocate(event.size);
-          set_allocation(event.pointer, allocation{ptr, event.size});
+          auto ptr = mr_->allocate(event.size, stream);
+          set_allocation(event.pointer, allocation{ptr, event.size, stream});
         } else if (rmm::detail::action::FREE == event.act) {
           auto alloc = remove_allocation(event.pointer);
-          mr_->deallocate(alloc.ptr, event.size);
+          mr_->deallocate(alloc.ptr, event.size, stream);
         }
 
-        event_index++;
+        // the last event of an iteration returns what the log leaks, so iterations are identical
+        if (++event_index == first + num_events_) { free_leaked_allocations(iteration == 0); }
         cv.notify_all();
       });
+      ++iteration;
     }
 
+    report_upstream_statistics(state);
+    report_bin_statistics(state);
     TearDown(state);
   }
 };
@@ -265,17 +422,7 @@ struct replay_benchmark {
 std::vector<std::vector<rmm::detail::event>> parse_per_thread_events(std::string const& filename)
 {
   using rmm::detail::event;
-  std::vector<event> all_events = rmm::detail::parse_csv(filename);
-
-  RMM_EXPECTS(std::all_of(all_events.begin(),
-                          all_events.end(),
-                          [](auto const& event) {
-                            cudaStream_t custream;
-                            memcpy(&custream, &event.stream, sizeof(cudaStream_t));
-                            auto stream = rmm::cuda_stream_view{custream};
-                            return stream.is_default() or stream.is_per_thread_default();
-                          }),
-              "Non-default streams not currently supported.");
+  std::vector<event> all_events = rmm::detail::parse_log(filename);
 
   // Sort events by thread id
   std::stable_sort(all_events.begin(), all_events.end(), [](auto lhs, auto rhs) {
@@ -316,10 +463,126 @@ std::vector<std::vector<rmm::detail::event>> parse_per_thread_events(std::string
   return per_thread_events;
 }
 
+/**
+ * @brief Prints the internal fragmentation that each arena size-class scheme incurs on a log.
+ *
+ * The events of all threads are replayed in log order without allocating. For each scheme the
+ * report gives the peak of the live bytes after rounding to size classes, and the waste (rounded
+ * less requested bytes) at that peak and summed over all allocations.
+ */
+void report_size_class_waste(std::vector<std::vector<rmm::detail::event>> const& per_thread_events)
+{
+  std::vector<rmm::detail::event> events;
+  for (auto const& thread_events : per_thread_events) {
+    events.insert(events.end(), thread_events.begin(), thread_events.end());
+  }
+  std::sort(events.begin(), events.end(), [](auto const& lhs, auto const& rhs) {
+    return lhs.index < rhs.index;
+  });
+
+  std::cout << "Size classes: peak rounded bytes, waste at peak, waste over all allocations\n";
+  for (auto const* name : {"exact", "jemalloc", "fine", "exact-small"}) {
+    auto const policy = make_size_classes(name);
+    std::size_t live_requested{};
+    std::size_t live_rounded{};
+    std::size_t peak_rounded{};
+    std::size_t waste_at_peak{};
+    std::size_t total_requested{};
+    std::size_t total_rounded{};
+    for (auto const& event : events) {
+      auto const rounded = policy->align(event.size);
+      if (event.act == rmm::detail::action::ALLOCATE) {
+        live_requested += event.size;
+        live_rounded += rounded;
+        total_requested += event.size;
+        total_rounded += rounded;
+        if (live_rounded > peak_rounded) {
+          peak_rounded  = live_rounded;
+          waste_at_peak = live_rounded - live_requested;
+        }
+      } else if (event.act == rmm::detail::action::FREE) {
+        live_requested -= event.size;
+        live_rounded -= rounded;
+      }
+    }
+    auto const percent = [](std::size_t part, std::size_t whole) {
+      return (whole > 0) ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+    };
+    std::cout << "  " << name << ": " << peak_rounded << " B, " << waste_at_peak << " B ("
+              << percent(waste_at_peak, peak_rounded) << "%), "
+              << percent(total_rounded - total_requested, total_rounded) << "%\n";
+  }
+}
+
+/**
+ * @brief Maps the streams of a log to the streams the replay runs on, in place.
+ *
+ * The default and per-thread default streams replay on themselves. Each other logged stream is
+ * assigned its own replay stream, so that allocations and frees keep the stream they were made on
+ * and a free on one stream followed by an allocation on another exercises the cross-stream paths
+ * of stream-ordered resources. Replay streams come from a `cuda_stream_pool`.
+ *
+ * Host-only mode gives up stream semantics. Stream-ordered resources record events on the streams
+ * they are given and must never see a handle that the runtime did not create, so without real
+ * streams every event replays on the default stream. Per-stream free lists, cross-stream reuse and
+ * the event waits it requires are then not exercised; the replay only measures the
+ * single-stream behavior of the resource.
+ *
+ * @param per_thread_events The events of each thread; their `stream` fields are rewritten
+ * @param host_only Whether to replay all streams on the default stream instead of real streams
+ * @return The pool owning the replay streams, which must outlive the replay (null if not needed)
+ */
+std::unique_ptr<rmm::cuda_stream_pool> remap_streams(
+  std::vector<std::vector<rmm::detail::event>>& per_thread_events, bool host_only)
+{
+  auto is_default = [](uintptr_t logged) {
+    cudaStream_t stream{};
+    std::memcpy(&stream, &logged, sizeof(cudaStream_t));
+    auto const view = rmm::cuda_stream_view{stream};
+    return view.is_default() or view.is_per_thread_default();
+  };
+
+  // Number the non-default streams in order of first appearance
+  std::unordered_map<uintptr_t, std::size_t> stream_ids;
+  for (auto const& events : per_thread_events) {
+    for (auto const& event : events) {
+      if (not is_default(event.stream)) { stream_ids.try_emplace(event.stream, stream_ids.size()); }
+    }
+  }
+
+  std::unique_ptr<rmm::cuda_stream_pool> pool{};
+  if (not host_only && not stream_ids.empty()) {
+    pool = std::make_unique<rmm::cuda_stream_pool>(stream_ids.size());
+  }
+  auto replay_value = [&pool](std::size_t stream_id) -> uintptr_t {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (pool) { return reinterpret_cast<uintptr_t>(pool->get_stream(stream_id).value()); }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<uintptr_t>(rmm::cuda_stream_default.value());
+  };
+
+  for (auto& events : per_thread_events) {
+    for (auto& event : events) {
+      if (not is_default(event.stream)) { event.stream = replay_value(stream_ids[event.stream]); }
+    }
+  }
+
+  if (host_only && not stream_ids.empty()) {
+    std::cout << "Host-only streams: replaying the " << stream_ids.size()
+              << " non-default streams of the log on the default stream. Per-stream ordering and "
+                 "cross-stream reuse are not exercised.\n";
+  } else {
+    std::cout << "Replaying " << stream_ids.size() << " non-default streams.\n";
+  }
+  return pool;
+}
+
 void declare_benchmark(std::string const& name,
                        std::size_t simulated_size,
                        std::vector<std::vector<rmm::detail::event>> const& per_thread_events,
-                       std::size_t num_threads)
+                       std::size_t num_threads,
+                       std::string const& growth_policy,
+                       std::string const& size_classes)
 {
   if (name == "cuda") {
     benchmark::RegisterBenchmark("CUDA Resource",
@@ -331,14 +594,27 @@ void declare_benchmark(std::string const& name,
                                  replay_benchmark(&make_binning, simulated_size, per_thread_events))
       ->Unit(benchmark::kMillisecond)
       ->Threads(static_cast<int>(num_threads));
+  } else if (name == "binning-adaptive") {
+    benchmark::RegisterBenchmark(
+      "Adaptive Binning Resource",
+      replay_benchmark(&make_binning_adaptive, simulated_size, per_thread_events))
+      ->Unit(benchmark::kMillisecond)
+      ->Threads(static_cast<int>(num_threads));
   } else if (name == "pool") {
+    auto factory = [growth_policy](std::size_t size) { return make_pool(size, growth_policy); };
     benchmark::RegisterBenchmark("Pool Resource",
-                                 replay_benchmark(&make_pool, simulated_size, per_thread_events))
+                                 replay_benchmark(factory, simulated_size, per_thread_events))
+      ->Unit(benchmark::kMillisecond)
+      ->Threads(static_cast<int>(num_threads));
+  } else if (name == "tlsf") {
+    benchmark::RegisterBenchmark("TLSF Resource",
+                                 replay_benchmark(&make_tlsf, simulated_size, per_thread_events))
       ->Unit(benchmark::kMillisecond)
       ->Threads(static_cast<int>(num_threads));
   } else if (name == "arena") {
+    auto factory = [size_classes](std::size_t size) { return make_arena(size, size_classes); };
     benchmark::RegisterBenchmark("Arena Resource",
-                                 replay_benchmark(&make_arena, simulated_size, per_thread_events))
+                                 replay_benchmark(factory, simulated_size, per_thread_events))
       ->Unit(benchmark::kMillisecond)
       ->Threads(static_cast<int>(num_threads));
   } else {
@@ -360,7 +636,8 @@ int main(int argc, char** argv)
         "RMM Replay Benchmark",
         "Replays and benchmarks allocation activity captured from RMM logging.");
 
-      options.add_options()("f,file", "Name of RMM log file.", cxxopts::value<std::string>());
+      options.add_options()(
+        "f,file", "Name of RMM log file, in CSV or binary format.", cxxopts::value<std::string>());
       options.add_options()("r,resource",
                             "Type of device_memory_resource",
                             cxxopts::value<std::string>()->default_value("pool"));
@@ -369,6 +646,23 @@ int main(int argc, char** argv)
         "Size of simulated GPU memory in GiB. Not supported for the cuda memory "
         "resource.",
         cxxopts::value<float>()->default_value("0"));
+      options.add_options()(
+        "g,growth-policy",
+        "Growth policy of the pool resource: default, fixed, geometric or adaptive. When set, the "
+        "pool starts empty so that all of its memory is obtained through the policy.",
+        cxxopts::value<std::string>());
+      options.add_options()(
+        "size-classes",
+        "Size classes of the arena resource: exact, jemalloc, fine or exact-small.",
+        cxxopts::value<std::string>());
+      options.add_options()("size-class-report",
+                            "Print the internal fragmentation of each arena size-class scheme.",
+                            cxxopts::value<bool>()->default_value("false"));
+      options.add_options()(
+        "host-only-streams",
+        "Replay all streams on the default stream without creating real streams. Gives up "
+        "per-stream ordering and cross-stream reuse.",
+        cxxopts::value<bool>()->default_value("false"));
       options.add_options()("v,verbose",
                             "Enable verbose printing of log events",
                             cxxopts::value<bool>()->default_value("false"));
@@ -422,21 +716,37 @@ int main(int argc, char** argv)
       }
     }
 
+    if (args["size-class-report"].as<bool>()) { report_size_class_waste(per_thread_events); }
+
     auto const num_threads = per_thread_events.size();
 
+    auto const replay_streams =
+      remap_streams(per_thread_events, args["host-only-streams"].as<bool>());
+
     // Uncomment to enable / change default log level
     // rmm::logger().set_level(spdlog::level::trace);
 
+    auto const growth_policy =
+      (args.count("growth-policy") > 0) ? args["growth-policy"].as<std::string>() : std::string{};
+
+    auto const size_classes =
+      (args.count("size-classes") > 0) ? args["size-classes"].as<std::string>() : std::string{};
+
     if (args.count("resource") > 0) {
       std::string mr_name = args["resource"].as<std::string>();
-      declare_benchmark(mr_name, simulated_size, per_thread_events, num_threads);
+      declare_benchmark(
+        mr_name, simulated_size, per_thread_events, num_threads, growth_policy, size_classes);
     } else {
-      std::array<std::string, 4> mrs{"pool", "arena", "binning", "cuda"};
-      std::for_each(std::cbegin(mrs),
-                    std::cend(mrs),
-                    [&simulated_size, &per_thread_events, &num_threads](auto const& mr) {
-                      declare_benchmark(mr, simulated_size, per_thread_events, num_threads);
-                    });
+      std::array<std::string, 6> mrs{
+        "pool", "tlsf", "arena", "binning", "binning-adaptive", "cuda"};
+      std::for_each(
+        std::cbegin(mrs),
+        std::cend(mrs),
+        [&simulated_size, &per_thread_events, &num_threads, &growth_policy, &size_classes](
+          auto const& mr) {
+          declare_benchmark(
+            mr, simulated_size, per_thread_events, num_threads, growth_policy, size_classes);
+        });
     }
 
     ::benchmark::RunSpecifiedBenchmarks();
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Converts RMM allocation logs between the CSV format of `logging_resource_adaptor` and the
+// binary format of `binary_logging_resource_adaptor`. The direction is chosen from the format of
+// the input file.
+
+#include <benchmarks/utilities/cxxopts.hpp>
+#include <benchmarks/utilities/log_parser.hpp>
+
+#include <rmm/mr/device/binary_logging_resource_adaptor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using rmm::detail::action;
+using rmm::detail::event;
+
+rmm::mr::trace_action to_trace_action(action act)
+{
+  switch (act) {
+    case action::ALLOCATE: return rmm::mr::trace_action::allocate;
+    case action::FREE: return rmm::mr::trace_action::free;
+    default: return rmm::mr::trace_action::allocate_failure;
+  }
+}
+
+/**
+ * @brief Writes `events` as a binary trace.
+ *
+ * CSV thread ids are mapped to dense ids in order of first appearance. CSV timestamps are times
+ * of day, so a day is added whenever the time goes backwards to keep the timestamps monotonic.
+ */
+void write_binary(std::vector<event> const& events, std::string const& filename)
+{
+  std::ofstream out{filename, std::ios::binary | std::ios::trunc};
+  RMM_EXPECTS(out.is_open(), "Failed to open output file.");
+
+  rmm::mr::trace_file_header const header{};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+  std::unordered_map<std::size_t, std::uint32_t> thread_ids;
+  std::uint64_t const day = std::chrono::nanoseconds{std::chrono::hours{24}}.count();
+  std::uint64_t offset{};
+  std::uint64_t previous{};
+
+  std::vector<rmm::mr::trace_record> records;
+  records.reserve(events.size());
+  for (auto const& evt : events) {
+    if (evt.timestamp + offset < previous) { offset += day; }
+    previous = evt.timestamp + offset;
+    auto const tid =
+      thread_ids.try_emplace(evt.thread_id, static_cast<std::uint32_t>(thread_ids.size()))
+        .first->second;
+    records.push_back(rmm::mr::trace_record{
+      previous, evt.pointer, evt.size, evt.stream, tid, to_trace_action(evt.act)});
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  out.write(reinterpret_cast<char const*>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(rmm::mr::trace_record)));
+}
+
+/**
+ * @brief Writes the records of `trace` in the CSV format of `logging_resource_adaptor`, reading
+ * them in place in timestamp order.
+ *
+ * Binary timestamps are monotonic clock readings and are written as a time of day modulo 24 hours.
+ */
+void write_csv(rmm::detail::mapped_trace const& trace, std::string const& filename)
+{
+  std::ofstream out{filename, std::ios::trunc};
+  RMM_EXPECTS(out.is_open(), "Failed to open output file.");
+
+  out << "Thread,Time,Action,Pointer,Size,Stream\n";
+  out << std::setfill('0');
+  rmm::detail::for_each_record(trace, [&out](auto const& record) {
+    auto const evt     = rmm::detail::to_event(record, 0);
+    auto const time    = std::chrono::nanoseconds{evt.timestamp} % std::chrono::hours{24};
+    auto const hours   = std::chrono::duration_cast<std::chrono::hours>(time);
+    auto const minutes = std::chrono::duration_cast<std::chrono::minutes>(time - hours);
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(time - hours - minutes);
+    auto const micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(time - hours - minutes - seconds);
+
+    auto const* act_string = [&evt] {
+      switch (evt.act) {
+        case action::ALLOCATE: return "allocate";
+        case action::FREE: return "free";
+        default: return "allocate failure";
+      }
+    }();
+
+    out << std::dec << evt.thread_id << ',' << std::setw(2) << hours.count() << ':'
+        << std::setw(2) << minutes.count() << ':' << std::setw(2) << seconds.count() << '.'
+        << std::setw(6) << micros.count() << ',' << act_string << ",0x" << std::hex
+        << evt.pointer << ',' << std::dec << evt.size << ",0x" << std::hex << evt.stream << '\n';
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  cxxopts::Options options("RMM Trace Converter",
+                           "Converts RMM allocation logs between the CSV and binary formats.");
+  options.add_options()("i,input", "Input log file, CSV or binary", cxxopts::value<std::string>());
+  options.add_options()(
+    "o,output", "Output log file, in the other format", cxxopts::value<std::string>());
+  options.add_options()("h,help", "Print usage");
+
+  auto args = options.parse(argc, argv);
+  if (args.count("help") > 0 or args.count("input") == 0 or args.count("output") == 0) {
+    std::cout << options.help() << std::endl;
+    return (args.count("help") > 0) ? 0 : 1;
+  }
+
+  auto const input  = args["input"].as<std::string>();
+  auto const output = args["output"].as<std::string>();
+  try {
+    if (rmm::detail::is_binary_trace(input)) {
+      write_csv(rmm::detail::mapped_trace{input}, output);
+    } else {
+      write_binary(rmm::detail::parse_csv(input), output);
+    }
+  } catch (std::exception const& e) {
+    std::cerr << "Conversion failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of tracking_resource_adaptor's bookkeeping when many threads allocate and
+// free at once, by comparing the throughput of an arena resource with and without the adaptor,
+// and with the adaptor capturing the stacks of every allocation or of a sample of them.
+
+#include <benchmarks/utilities/simulated_memory_resource.hpp>
+
+#include <rmm/cuda_stream_view.hpp>
+#include <rmm/mr/device/arena_memory_resource.hpp>
+#include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/tracking_resource_adaptor.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using simulated_mr = rmm::mr::simulated_memory_resource;
+using arena_mr     = rmm::mr::arena_memory_resource<simulated_mr>;
+using tracking_mr  = rmm::mr::tracking_resource_adaptor<arena_mr>;
+
+constexpr std::size_t memory_size{std::size_t{16} << 30};
+constexpr std::size_t max_size{std::size_t{64} << 10};
+constexpr std::size_t batch_size{64};
+constexpr std::size_t batches_per_thread{200};
+
+/**
+ * @brief Runs `num_threads` threads that each allocate and then free `batches_per_thread` batches
+ * of `batch_size` blocks.
+ */
+void run_threads(rmm::mr::device_memory_resource* mr, std::size_t num_threads)
+{
+  auto work = [mr](std::size_t seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<std::size_t> size_distribution(1, max_size);
+    std::vector<std::pair<void*, std::size_t>> blocks(batch_size);
+    for (std::size_t batch = 0; batch < batches_per_thread; ++batch) {
+      for (auto& [ptr, size] : blocks) {
+        size = size_distribution(generator);
+        ptr  = mr->allocate(size, rmm::cuda_stream_per_thread);
+      }
+      for (auto const& [ptr, size] : blocks) {
+        mr->deallocate(ptr, size, rmm::cuda_stream_per_thread);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(work, i);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void set_items_processed(benchmark::State& state, std::size_t num_threads)
+{
+  // One item is an allocation together with its deallocation
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * num_threads) *
+                          static_cast<int64_t>(batches_per_thread * batch_size));
+}
+
+void BM_Untracked(benchmark::State& state)
+{
+  auto const num_threads = static_cast<std::size_t>(state.range(0));
+  simulated_mr upstream{memory_size};
+  arena_mr mr{&upstream, memory_size};
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    run_threads(&mr, num_threads);
+  }
+  set_items_processed(state, num_threads);
+}
+
+void BM_Tracked(benchmark::State& state, tracking_mr::stack_sampling sampling)
+{
+  auto const num_threads = static_cast<std::size_t>(state.range(0));
+  simulated_mr upstream{memory_size};
+  arena_mr arena{&upstream, memory_size};
+  tracking_mr mr{&arena, sampling};
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    run_threads(&mr, num_threads);
+  }
+  set_items_processed(state, num_threads);
+}
+
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK(BM_Untracked)
+  ->RangeMultiplier(2)
+  ->Range(1, 16)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Tracked, no_stacks, tracking_mr::stack_sampling{0})
+  ->RangeMultiplier(2)
+  ->Range(1, 16)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Tracked, sampled_stacks, tracking_mr::stack_sampling{0, 1 << 20})
+  ->RangeMultiplier(2)
+  ->Range(1, 16)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Tracked, all_stacks, tracking_mr::stack_sampling{1})
+  ->RangeMultiplier(2)
+  ->Range(1, 16)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+
+BENCHMARK_MAIN();
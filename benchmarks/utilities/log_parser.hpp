@@ -18,11 +18,21 @@
 
 #include <chrono>
 #include <rmm/detail/error.hpp>
+#include <rmm/mr/device/binary_logging_resource_adaptor.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
 
 #include "rapidcsv.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <limits>
 #include <memory>
@@ -30,6 +40,8 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace rmm::detail {
 
@@ -81,6 +93,7 @@ struct event {
   std::size_t thread_id{};  ///< ID of the thread that initiated the event
   uintptr_t stream{};   ///< Numeric representation of the CUDA stream on which the event occurred
   std::size_t index{};  ///< Original ordering index of the event
+  std::uint64_t timestamp{};  ///< Time of the event in nanoseconds
 };
 
 inline std::ostream& operator<<(std::ostream& os, event const& evt)
@@ -108,8 +121,9 @@ inline std::ostream& operator<<(std::ostream& os, event const& evt)
  * is in timestamp order even for multithreaded logs.
  * @note This function can be simplified with C++20 and later.
  *
- * @param str_time The input time in format "HH:MM:SS:us" where us is a 6 digits microseconds part
- * of the current second. (This is the format rmm::mr::logging_resource_adaptor outputs)
+ * @param str_time The input time in format "HH:MM:SS.us" where us is a 6 digits microseconds part
+ * of the current second. (This is the format rmm::mr::logging_resource_adaptor outputs.) A colon
+ * is also accepted before the microseconds.
  * @return std::chrono::time_point<std::chrono::system_clock> Converted time point.
  */
 inline std::chrono::time_point<std::chrono::system_clock> parse_time(std::string const& str_time)
@@ -133,6 +147,33 @@ inline std::chrono::time_point<std::chrono::system_clock> parse_time(std::string
   return timepoint;
 }
 
+/**
+ * @brief Parse a log timestamp into nanoseconds since midnight
+ *
+ * @param str_time The input time in format "HH:MM:SS.us" where us is a 6 digits microseconds part
+ * of the current second. (This is the format rmm::mr::logging_resource_adaptor outputs.) A colon
+ * is also accepted before the microseconds.
+ * @return std::uint64_t The time of day in nanoseconds
+ */
+inline std::uint64_t parse_time_of_day(std::string const& str_time)
+{
+  auto const first  = str_time.find(':');
+  auto const second = str_time.find(':', first + 1);
+  auto const dot    = str_time.find_first_of(".:", second + 1);
+  RMM_EXPECTS(first != std::string::npos and second != std::string::npos and
+                dot != std::string::npos,
+              "Invalid time string.");
+
+  auto field = [&str_time](std::size_t begin, std::size_t end) {
+    return std::stoul(str_time.substr(begin, end - begin));
+  };
+  std::chrono::nanoseconds const time =
+    std::chrono::hours{field(0, first)} + std::chrono::minutes{field(first + 1, second)} +
+    std::chrono::seconds{field(second + 1, dot)} +
+    std::chrono::microseconds{field(dot + 1, str_time.size())};
+  return static_cast<std::uint64_t>(time.count());
+}
+
 /**
  * @brief Parses a RMM log file into a vector of events
  *
@@ -154,11 +195,17 @@ inline std::vector<event> parse_csv(std::string const& filename)
     ptr = std::stoll(str, nullptr, base);
   };
 
-  std::vector<uintptr_t> pointers = csv.GetColumn<uintptr_t>("Pointer", parse_pointer);
-  std::vector<std::size_t> sizes  = csv.GetColumn<std::size_t>("Size");
-  std::vector<uintptr_t> streams  = csv.GetColumn<uintptr_t>("Stream");
+  auto parse_time = [](std::string const& str, std::uint64_t& time) {
+    time = parse_time_of_day(str);
+  };
 
-  auto const size_list = {tids.size(), actions.size(), pointers.size(), streams.size()};
+  std::vector<uintptr_t> pointers  = csv.GetColumn<uintptr_t>("Pointer", parse_pointer);
+  std::vector<std::size_t> sizes   = csv.GetColumn<std::size_t>("Size");
+  std::vector<uintptr_t> streams   = csv.GetColumn<uintptr_t>("Stream", parse_pointer);
+  std::vector<std::uint64_t> times = csv.GetColumn<std::uint64_t>("Time", parse_time);
+
+  auto const size_list = {
+    tids.size(), actions.size(), pointers.size(), streams.size(), times.size()};
 
   RMM_EXPECTS(std::all_of(std::begin(size_list),
                           std::end(size_list),
@@ -177,9 +224,208 @@ inline std::vector<event> parse_csv(std::string const& filename)
     } else if (action == "free") {
       act = action::FREE;
     }
-    events[i] = event{tids[i], act, sizes[i], pointers[i], streams[i], i};
+    events[i]           = event{tids[i], act, sizes[i], pointers[i], streams[i], i};
+    events[i].timestamp = times[i];
+  }
+  return events;
+}
+
+/**
+ * @brief A read-only memory mapping of a binary trace written by
+ * `rmm::mr::binary_logging_resource_adaptor`.
+ *
+ * The records are accessed in place, in file order, without copying or parsing.
+ */
+class mapped_trace {
+ public:
+  /**
+   * @brief Maps the trace file `filename` and validates its header.
+   *
+   * @throws rmm::logic_error if the file cannot be mapped or is not a binary trace of the current
+   * version
+   *
+   * @param filename Name of the trace file
+   */
+  explicit mapped_trace(std::string const& filename)
+  {
+    int const fd = ::open(filename.c_str(), O_RDONLY);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    RMM_EXPECTS(fd >= 0, "Failed to open trace file.");
+    struct stat info {};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+      bytes_ = static_cast<std::size_t>(info.st_size);
+      data_  = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (data_ == MAP_FAILED) { data_ = nullptr; }
+    RMM_EXPECTS(data_ != nullptr, "Failed to map trace file.");
+
+    rmm::mr::trace_file_header header{};
+    if (bytes_ < sizeof(header)) { unmap(); }
+    RMM_EXPECTS(data_ != nullptr, "Trace file is too short.");
+    std::memcpy(&header, data_, sizeof(header));
+    bool const valid = header.magic == rmm::mr::trace_file_header::expected_magic &&
+                       header.version == rmm::mr::trace_file_header::current_version &&
+                       header.record_size == sizeof(rmm::mr::trace_record);
+    if (not valid) { unmap(); }
+    RMM_EXPECTS(valid, "Not a binary trace of the current version.");
+
+    ::madvise(data_, bytes_, MADV_SEQUENTIAL);
+    num_records_ = (bytes_ - sizeof(header)) / sizeof(rmm::mr::trace_record);
+  }
+
+  ~mapped_trace() { unmap(); }
+
+  mapped_trace(mapped_trace const&)            = delete;
+  mapped_trace& operator=(mapped_trace const&) = delete;
+  mapped_trace(mapped_trace&&)                 = delete;
+  mapped_trace& operator=(mapped_trace&&)      = delete;
+
+  /**
+   * @brief The number of records in the trace.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return num_records_; }
+
+  /**
+   * @brief Pointer to the first record.
+   */
+  [[nodiscard]] rmm::mr::trace_record const* begin() const noexcept
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return reinterpret_cast<rmm::mr::trace_record const*>(static_cast<char const*>(data_) +
+                                                          sizeof(rmm::mr::trace_file_header));
+  }
+
+  /**
+   * @brief Pointer past the last record.
+   */
+  [[nodiscard]] rmm::mr::trace_record const* end() const noexcept
+  {
+    return begin() + num_records_;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+
+ private:
+  void unmap() noexcept
+  {
+    if (data_ != nullptr) { ::munmap(data_, bytes_); }
+    data_ = nullptr;
+  }
+
+  void* data_{};
+  std::size_t bytes_{};
+  std::size_t num_records_{};
+};
+
+/**
+ * @brief Whether `filename` starts with the magic number of a binary trace.
+ *
+ * @param filename Name of the file to check
+ * @return true if the file is a binary trace
+ */
+inline bool is_binary_trace(std::string const& filename)
+{
+  std::ifstream file{filename, std::ios::binary};
+  std::array<char, rmm::mr::trace_file_header::expected_magic.size()> magic{};
+  file.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+  return file.good() && magic == rmm::mr::trace_file_header::expected_magic;
+}
+
+/**
+ * @brief Calls `func(record)` on each record of `trace` in timestamp order, reading the records in
+ * place.
+ *
+ * Each thread writes its records in timestamp order, in batches, so the file is a sequence of
+ * sorted runs. The runs are merged with a heap of one entry per run, and records with equal
+ * timestamps are visited in file order.
+ *
+ * @param trace The mapped trace
+ * @param func Callable invoked with each `rmm::mr::trace_record const&`
+ */
+template <typename Func>
+void for_each_record(mapped_trace const& trace, Func&& func)
+{
+  using record = rmm::mr::trace_record;
+  auto by_time = [](record const& lhs, record const& rhs) {
+    return lhs.timestamp_ns < rhs.timestamp_ns;
+  };
+  std::vector<std::pair<record const*, record const*>> runs;  // [first, last) of each sorted run
+  for (auto const* first = trace.begin(); first != trace.end();) {
+    auto const* last = std::is_sorted_until(first, trace.end(), by_time);
+    runs.emplace_back(first, last);
+    first = last;
+  }
+
+  // Orders the heap by the next record of each run, and by run (file) order on equal timestamps
+  auto later = [&runs](std::size_t lhs, std::size_t rhs) {
+    auto const lhs_time = runs[lhs].first->timestamp_ns;
+    auto const rhs_time = runs[rhs].first->timestamp_ns;
+    return (lhs_time != rhs_time) ? lhs_time > rhs_time : lhs > rhs;
+  };
+  std::vector<std::size_t> heap(runs.size());
+  std::iota(heap.begin(), heap.end(), 0);
+  std::make_heap(heap.begin(), heap.end(), later);
+  while (not heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    auto& run = runs[heap.back()];
+    func(*run.first);
+    if (++run.first == run.second) {
+      heap.pop_back();
+    } else {
+      std::push_heap(heap.begin(), heap.end(), later);
+    }
   }
+}
+
+/**
+ * @brief Converts a binary trace record to an event
+ *
+ * @param record The record
+ * @param index The index of the event
+ * @return The event
+ */
+inline event to_event(rmm::mr::trace_record const& record, std::size_t index)
+{
+  auto const act = [&record] {
+    switch (record.action) {
+      case rmm::mr::trace_action::allocate: return action::ALLOCATE;
+      case rmm::mr::trace_action::free: return action::FREE;
+      case rmm::mr::trace_action::allocate_failure: return action::ALLOCATE_FAILURE;
+      default: RMM_FAIL("Invalid action in binary trace.");
+    }
+  }();
+  event evt{record.thread_id, act, record.size, record.pointer, record.stream, index};
+  evt.timestamp = record.timestamp_ns;
+  return evt;
+}
+
+/**
+ * @brief Parses a binary trace into a vector of events
+ *
+ * The trace is memory mapped and its records are converted in timestamp order as they are read,
+ * without an intermediate copy or sort.
+ *
+ * @param filename Name of the binary trace file
+ * @return Vector of events from the contents of the trace, in timestamp order
+ */
+inline std::vector<event> parse_binary(std::string const& filename)
+{
+  mapped_trace const trace{filename};
+  std::vector<event> events;
+  events.reserve(trace.size());
+  for_each_record(trace, [&events](auto const& record) {
+    events.push_back(to_event(record, events.size()));
+  });
   return events;
 }
 
+/**
+ * @brief Parses a RMM log file in either the binary or the CSV format into a vector of events
+ *
+ * @param filename Name of the RMM log file
+ * @return Vector of events from the contents of the log file
+ */
+inline std::vector<event> parse_log(std::string const& filename)
+{
+  return is_binary_trace(filename) ? parse_binary(filename) : parse_csv(filename);
+}
+
 }  // namespace rmm::detail
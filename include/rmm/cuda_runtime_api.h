@@ -78,6 +78,9 @@
 #ifndef cudaErrorInvalidValue
 #  define cudaErrorInvalidValue hipErrorInvalidValue
 #endif
+#ifndef cudaErrorNotReady
+#  define cudaErrorNotReady hipErrorNotReady
+#endif
 #ifndef cudaErrorMemoryAllocation
 #  define cudaErrorMemoryAllocation hipErrorMemoryAllocation
 #endif
@@ -135,6 +138,9 @@
 #ifndef cudaEventRecord
 #  define cudaEventRecord hipEventRecord
 #endif
+#ifndef cudaEventQuery
+#  define cudaEventQuery hipEventQuery
+#endif
 #ifndef cudaEventSynchronize
 #  define cudaEventSynchronize hipEventSynchronize
 #endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/detail/stack_trace.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rmm::detail {
+
+/**
+ * @brief A table of interned stack traces, so that allocations made from the same call site share
+ * one `stack_trace`.
+ *
+ * Capturing only records return addresses; symbols are looked up when a trace is printed. Traces
+ * are kept for the lifetime of the table, as a program has a bounded number of call sites.
+ */
+class stack_table {
+ public:
+  /**
+   * @brief Captures the calling thread's stack.
+   *
+   * @return std::shared_ptr<stack_trace const> The interned trace, equal to any trace captured
+   * earlier from the same call site
+   */
+  std::shared_ptr<stack_trace const> capture()
+  {
+#if defined(RMM_ENABLE_STACK_TRACES)
+    std::array<void*, max_depth> frames{};
+    auto const depth = static_cast<std::size_t>(backtrace(frames.data(), max_depth));
+    auto const hash  = hash_of(frames.data(), depth);
+
+    std::lock_guard lock(mtx_);
+    auto& bucket = stacks_[hash];
+    for (auto const& trace : bucket) {
+      auto const& existing = trace->frames();
+      if (existing.size() == depth && std::equal(existing.begin(), existing.end(), frames.data())) {
+        return trace;
+      }
+    }
+    return bucket.emplace_back(std::make_shared<stack_trace const>(frames.data(), depth));
+#else
+    std::lock_guard lock(mtx_);
+    if (disabled_ == nullptr) { disabled_ = std::make_shared<stack_trace const>(nullptr, 0); }
+    return disabled_;
+#endif  // RMM_ENABLE_STACK_TRACES
+  }
+
+  /**
+   * @briefreturn{The number of distinct stack traces captured}
+   */
+  [[nodiscard]] std::size_t size() const
+  {
+    std::lock_guard lock(mtx_);
+#if defined(RMM_ENABLE_STACK_TRACES)
+    std::size_t count{0};
+    for (auto const& bucket : stacks_) {
+      count += bucket.second.size();
+    }
+    return count;
+#else
+    return disabled_ == nullptr ? 0 : 1;
+#endif  // RMM_ENABLE_STACK_TRACES
+  }
+
+ private:
+  static constexpr int max_depth{64};
+
+  /// FNV-1a over the return addresses.
+  static std::uint64_t hash_of(void* const* frames, std::size_t depth) noexcept
+  {
+    std::uint64_t hash{0xcbf29ce484222325ULL};
+    for (std::size_t i = 0; i < depth; ++i) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      hash = (hash ^ static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(frames[i]))) *
+             0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  mutable std::mutex mtx_;
+#if defined(RMM_ENABLE_STACK_TRACES)
+  // traces by the hash of their return addresses
+  std::unordered_map<std::uint64_t, std::vector<std::shared_ptr<stack_trace const>>> stacks_;
+#else
+  std::shared_ptr<stack_trace const> disabled_;
+#endif  // RMM_ENABLE_STACK_TRACES
+};
+
+}  // namespace rmm::detail
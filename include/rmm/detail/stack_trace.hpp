@@ -45,6 +45,7 @@
 #define RMM_ENABLE_STACK_TRACES
 #endif
 
+#include <cstddef>
 #include <sstream>
 
 #if defined(RMM_ENABLE_STACK_TRACES)
@@ -52,7 +53,6 @@
 #include <dlfcn.h>
 #include <execinfo.h>
 
-#include <cstddef>
 #include <memory>
 #include <vector>
 #endif
@@ -80,6 +80,27 @@ class stack_trace {
 #endif  // RMM_ENABLE_STACK_TRACES
   }
 
+  /**
+   * @brief Construct a stack trace from `depth` return addresses captured earlier by `backtrace`.
+   * Symbols are only looked up when the trace is printed.
+   *
+   * @param frames The return addresses, innermost first
+   * @param depth The number of return addresses
+   */
+  stack_trace([[maybe_unused]] void* const* frames, [[maybe_unused]] std::size_t depth)
+#if defined(RMM_ENABLE_STACK_TRACES)
+    : stack_ptrs(frames, frames + depth)
+#endif  // RMM_ENABLE_STACK_TRACES
+  {
+  }
+
+#if defined(RMM_ENABLE_STACK_TRACES)
+  /**
+   * @briefreturn{The return addresses of the trace, innermost first}
+   */
+  [[nodiscard]] std::vector<void*> const& frames() const noexcept { return stack_ptrs; }
+#endif  // RMM_ENABLE_STACK_TRACES
+
   friend std::ostream& operator<<(std::ostream& os, const stack_trace& trace)
   {
 #if defined(RMM_ENABLE_STACK_TRACES)
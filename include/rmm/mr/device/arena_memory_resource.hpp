@@ -40,16 +40,31 @@
 #include <rmm/detail/logging_assert.hpp>
 #include <rmm/logger.hpp>
 #include <rmm/mr/device/detail/arena.hpp>
+#include <rmm/mr/device/detail/thread_cache.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/memory_snapshot.hpp>
+#include <rmm/mr/device/size_class_policy.hpp>
 
 #include <rmm/cuda_runtime_api.h>
 
+#include <fmt/core.h>
 #include <spdlog/common.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <optional>
 #include <shared_mutex>
+#include <sstream>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace rmm::mr {
 /**
@@ -58,6 +73,46 @@ namespace rmm::mr {
  * @file
  */
 
+/**
+ * @brief Options for constructing an `arena_memory_resource`, also available as
+ * `arena_memory_resource<Upstream>::options`.
+ *
+ * Every field has a default, so callers set only the fields they need.
+ */
+struct arena_memory_resource_options {
+  /// Initial size in bytes of the global arena. Defaults to half of the available memory on the
+  /// current device.
+  std::optional<std::size_t> arena_size{};
+  /// If true, dump memory log when running out of memory.
+  bool dump_log_on_failure{false};
+  /// Size in bytes that the global arena can grow to. Defaults to the initial size, i.e. the arena
+  /// does not grow.
+  std::optional<std::size_t> maximum_arena_size{};
+  /// Size in bytes above which entirely free upstream regions of the global arena are released.
+  /// By default regions are only released on destruction.
+  std::optional<std::size_t> release_threshold{};
+  /// The policy that rounds allocation sizes up to size classes.
+  std::shared_ptr<size_class_policy> size_classes{default_size_classes()};
+
+  /**
+   * @brief The default size-class policy.
+   *
+   * Allocations are only aligned to 256 bytes, unless `RMM_ARENA_USE_SIZE_CLASSES` is defined, in
+   * which case they are rounded to jemalloc's 4 classes per doubling.
+   *
+   * @return std::shared_ptr<size_class_policy> The default policy.
+   */
+  static std::shared_ptr<size_class_policy> default_size_classes()
+  {
+#ifdef RMM_ARENA_USE_SIZE_CLASSES
+    constexpr std::size_t classes_per_doubling{4};
+    return std::make_shared<geometric_size_classes>(classes_per_doubling);
+#else
+    return std::make_shared<exact_size_classes>();
+#endif
+  }
+};
+
 /**
  * @brief A suballocator that emphasizes fragmentation avoidance and scalable concurrency support.
  *
@@ -68,19 +123,34 @@ namespace rmm::mr {
  * arenas for non-default streams. Each arena allocates memory from the global arena in chunks
  * called superblocks.
  *
- * Blocks in each arena are allocated using address-ordered first fit. When a block is freed, it is
+ * Each arena picks the first superblock, in address order, that fits a block, and takes a free
+ * block of that superblock from the smallest size class that fits. When a block is freed, it is
  * coalesced with neighbouring free blocks if the addresses are contiguous. Free superblocks are
  * returned to the global arena.
  *
+ * A block freed through a different arena than the one it was allocated from, e.g. by a consumer
+ * thread, is pushed onto a lock-free remote-free queue of the owning arena, as in mimalloc, with
+ * an event recorded on the freeing stream. The owner returns queued blocks to its superblocks on
+ * its next allocation once their events have completed, so cross-thread frees neither wait for
+ * their stream nor take the owner's lock or an exclusive lock on the resource. When the owning
+ * thread exits, it waits for the frees still queued and returns them with its superblocks to the
+ * global arena.
+ *
  * In real-world applications, allocation sizes tend to follow a power law distribution in which
  * large allocations are rare, but small ones quite common. By handling small allocations in the
  * per-thread arena, adequate performance can be achieved without introducing excessive memory
  * fragmentation under high concurrency.
  *
+ * The global arena is allocated from upstream up front. Given a maximum size, it starts at the
+ * initial size and adds further upstream regions when an allocation cannot be satisfied even after
+ * returning all free superblocks to the global arena. With a release threshold, regions that become
+ * entirely free are returned to upstream as long as the arena stays at least that large.
+ *
  * This design is inspired by several existing CPU memory allocators targeting multi-threaded
- * applications (glibc malloc, Hoard, jemalloc, TCMalloc), albeit in a simpler form. Possible future
- * improvements include using size classes, allocation caches, and more fine-grained locking or
- * lock-free approaches.
+ * applications (glibc malloc, Hoard, jemalloc, TCMalloc), albeit in a simpler form. Allocation
+ * sizes can be rounded to size classes chosen by a `size_class_policy`, trading internal
+ * fragmentation for reuse of freed blocks. Possible future improvements include allocation caches
+ * and more fine-grained locking.
  *
  * \see Wilson, P. R., Johnstone, M. S., Neely, M., & Boles, D. (1995, September). Dynamic storage
  * allocation: A survey and critical review. In International Workshop on Memory Management (pp.
@@ -93,6 +163,8 @@ namespace rmm::mr {
  * \see http://hoard.org/
  * \see http://jemalloc.net/
  * \see https://github.com/google/tcmalloc
+ * \see Leijen, D., Zorn, B., & de Moura, L. (2019). Mimalloc: Free list sharding in action. In
+ * Asian Symposium on Programming Languages and Systems (pp. 244-265). Springer, Cham.
  *
  * @tparam Upstream Memory resource to use for allocating memory for the global arena. Implements
  * rmm::mr::device_memory_resource interface.
@@ -100,6 +172,8 @@ namespace rmm::mr {
 template <typename Upstream>
 class arena_memory_resource final : public device_memory_resource {
  public:
+  using options = arena_memory_resource_options;  ///< Options for constructing the resource
+
   /**
    * @brief Construct an `arena_memory_resource`.
    *
@@ -113,8 +187,25 @@ class arena_memory_resource final : public device_memory_resource {
   explicit arena_memory_resource(Upstream* upstream_mr,
                                  std::optional<std::size_t> arena_size = std::nullopt,
                                  bool dump_log_on_failure              = false)
-    : global_arena_{upstream_mr, arena_size}, dump_log_on_failure_{dump_log_on_failure}
+    : arena_memory_resource(upstream_mr, options{arena_size, dump_log_on_failure})
   {
+  }
+
+  /**
+   * @brief Construct an `arena_memory_resource` with the given options.
+   *
+   * @throws rmm::logic_error if `upstream_mr == nullptr` or `opts.size_classes == nullptr`.
+   * @throws rmm::logic_error if `opts.maximum_arena_size` is smaller than the initial size.
+   *
+   * @param upstream_mr The memory resource from which to allocate blocks for the global arena.
+   * @param opts The arena options
+   */
+  arena_memory_resource(Upstream* upstream_mr, options const& opts)
+    : global_arena_{upstream_mr, opts.arena_size, opts.maximum_arena_size, opts.release_threshold},
+      dump_log_on_failure_{opts.dump_log_on_failure},
+      size_classes_{opts.size_classes}
+  {
+    RMM_EXPECTS(nullptr != size_classes_, "Unexpected null size-class policy.");
     if (dump_log_on_failure_) {
       logger_ = spdlog::basic_logger_mt("arena_memory_dump", "rmm_arena_memory_dump.log");
       // Set the level to `debug` for more detailed output.
@@ -141,13 +232,129 @@ class arena_memory_resource final : public device_memory_resource {
   /**
    * @brief Query whether the resource supports the get_mem_info API.
    *
-   * @return bool false.
+   * @return bool true.
    */
-  bool supports_get_mem_info() const noexcept override { return false; }
+  bool supports_get_mem_info() const noexcept override { return true; }
+
+  /**
+   * @brief Counts and durations of the stages that reclaim memory held by the per-thread and
+   * per-stream arenas when an allocation fails.
+   */
+  struct reclaim_statistics {
+    std::size_t reclaims{};                  ///< Allocations that reclaimed memory
+    std::size_t idle_reclaims{};             ///< Served after releasing idle superblocks
+    std::size_t stream_reclaims{};           ///< Served after synchronizing individual streams
+    std::size_t growth_reclaims{};           ///< Served after growing the global arena
+    std::size_t device_reclaims{};           ///< Reclaims that synchronized the whole device
+    std::size_t streams_synchronized{};      ///< Stream arenas waited on individually
+    std::chrono::nanoseconds idle_time{};    ///< Time spent releasing idle arenas' superblocks
+    std::chrono::nanoseconds stream_time{};  ///< Time spent waiting on individual stream arenas
+    std::chrono::nanoseconds device_time{};  ///< Time spent synchronizing the device
+  };
+
+  /**
+   * @brief Returns the reclaim counters and timings accumulated since construction.
+   *
+   * @return reclaim_statistics The reclaim statistics.
+   */
+  [[nodiscard]] reclaim_statistics get_reclaim_statistics() const
+  {
+    std::shared_lock lock(mtx_);
+    return reclaim_stats_;
+  }
+
+  /**
+   * @brief Takes a snapshot of the regions, superblocks and free memory of every arena.
+   *
+   * Each superblock is summarized in O(1), so the time spent under each arena's lock is
+   * proportional to its number of superblocks plus the free extents listed, of which there are at
+   * most `max_extents` over the whole snapshot. Allocations may proceed on other arenas while one
+   * is being read. Blocks freed by other threads and not yet reclaimed by their arena are not
+   * counted as free.
+   *
+   * @param max_extents The maximum number of free extents to list
+   * @return memory_snapshot The snapshot
+   */
+  [[nodiscard]] memory_snapshot snapshot(
+    std::size_t max_extents = memory_snapshot::default_max_extents) const
+  {
+    std::shared_lock lock(mtx_);
+    std::shared_lock map_lock(map_mtx_);
+    memory_snapshot snap;
+    global_arena_.snapshot(snap, max_extents);
+    auto add_arena = [&](arena const& held, std::string owner) {
+      memory_snapshot::free_list list{std::move(owner)};
+      bool const complete = held.snapshot(list, max_extents);
+      snap.complete       = snap.complete && complete;
+      snap.add(std::move(list));
+    };
+    for (auto const& [thread_id, thread_arena] : thread_arenas_) {
+      std::ostringstream owner;
+      owner << "thread " << thread_id;
+      add_arena(*thread_arena, owner.str());
+    }
+    for (auto const& [stream, stream_arena] : stream_arenas_) {
+      add_arena(stream_arena.held, fmt::format("stream {}", fmt::ptr(stream)));
+    }
+    return snap;
+  }
+
+  /**
+   * @brief The default size-class policy, `arena_memory_resource_options::default_size_classes()`.
+   *
+   * @return std::shared_ptr<size_class_policy> The default policy.
+   */
+  static std::shared_ptr<size_class_policy> default_size_classes()
+  {
+    return options::default_size_classes();
+  }
 
  private:
-  using global_arena = rmm::mr::detail::arena::global_arena<Upstream>;
-  using arena        = rmm::mr::detail::arena::arena<Upstream>;
+  using global_arena  = rmm::mr::detail::arena::global_arena<Upstream>;
+  using arena         = rmm::mr::detail::arena::arena<Upstream>;
+  using arena_cleaner = rmm::mr::detail::arena::arena_cleaner<Upstream>;
+
+  /**
+   * @brief The arena of a non-default stream and an event recorded on the stream when a
+   * deallocation empties one of the arena's superblocks.
+   *
+   * Recording only then keeps the runtime off most deallocations: once the event has completed, no
+   * pending work uses the empty superblocks, which are all a non-blocking reclaim releases. Other
+   * frees are only noted in `unrecorded`, until the next record covers them. Waiting on the event
+   * rather than the stream is valid even after the stream has been destroyed.
+   */
+  struct stream_arena_entry {
+    explicit stream_arena_entry(global_arena& global) : held{global}
+    {
+      RMM_CUDA_TRY(cudaEventCreateWithFlags(&freed, cudaEventDisableTiming));
+    }
+
+    ~stream_arena_entry() { RMM_ASSERT_CUDA_SUCCESS(cudaEventDestroy(freed)); }
+
+    /**
+     * @brief Notes a deallocation into the arena on `stream`, recording the event if it emptied a
+     * superblock. Must be called under the resource's shared lock, after the deallocation.
+     */
+    void note_free(cuda_stream_view stream, bool emptied)
+    {
+      if (emptied) {
+        // Cleared before the record, so that a concurrent free is either covered or noted.
+        unrecorded.store(false);
+        RMM_ASSERT_CUDA_SUCCESS(cudaEventRecord(freed, stream.value()));
+      } else if (!unrecorded.load()) {
+        unrecorded.store(true);
+      }
+    }
+
+    stream_arena_entry(stream_arena_entry const&)            = delete;
+    stream_arena_entry& operator=(stream_arena_entry const&) = delete;
+    stream_arena_entry(stream_arena_entry&&)                 = delete;
+    stream_arena_entry& operator=(stream_arena_entry&&)      = delete;
+
+    arena held;
+    cudaEvent_t freed{};
+    std::atomic<bool> unrecorded{};  // frees since `freed` was last recorded
+  };
 
   /**
    * @brief Allocates memory of size at least `bytes`.
@@ -163,42 +370,157 @@ class arena_memory_resource final : public device_memory_resource {
   void* do_allocate(std::size_t bytes, cuda_stream_view stream) override
   {
     if (bytes <= 0) { return nullptr; }
-#ifdef RMM_ARENA_USE_SIZE_CLASSES
-    bytes = rmm::mr::detail::arena::align_to_size_class(bytes);
-#else
-    bytes = rmm::detail::align_up(bytes, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
-#endif
+    bytes = size_classes_->align(bytes);
     auto& arena = get_arena(stream);
 
     {
       std::shared_lock lock(mtx_);
       void* pointer = arena.allocate(bytes);
-      if (pointer != nullptr) { return pointer; }
+      if (pointer != nullptr) {
+        allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        return pointer;
+      }
     }
 
     {
       std::unique_lock lock(mtx_);
-      defragment();
-      void* pointer = arena.allocate(bytes);
+      void* pointer = reclaim_and_allocate(arena, bytes, stream);
       if (pointer == nullptr) {
         if (dump_log_on_failure_) { dump_memory_log(bytes); }
         RMM_FAIL("Maximum pool size exceeded", rmm::out_of_memory);
       }
+      allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
       return pointer;
     }
   }
 
+  /**
+   * @brief Returns memory held by the arenas to the global arena in stages of increasing cost,
+   * retrying the allocation after each step until it succeeds.
+   *
+   * 1. Every arena's remote-free queue is drained, and arenas whose frees have completed, as seen
+   *    by a non-blocking query, release their empty superblocks.
+   * 2. The arenas holding free memory wait for their frees one at a time, the arena holding the
+   *    most first, and each arena that has waited releases all of its superblocks, or only its
+   *    empty ones if it was freed into since its last event record.
+   * 3. The global arena grows, if it is below its maximum size.
+   * 4. The device is synchronized and all arenas release all of their superblocks.
+   *
+   * The frees of a stream arena are tracked by its event, never by the stream, which may have been
+   * destroyed since. The calling thread's arena is tracked by its live
+   * per-thread default stream. The per-thread default stream of another thread can neither be
+   * queried nor synchronized from the calling thread, so the arenas of other threads only release
+   * superblocks in stage 4.
+   *
+   * Must be called with the unique lock held.
+   *
+   * @param target The arena to allocate from.
+   * @param bytes The size in bytes of the allocation.
+   * @param stream The stream of the allocation.
+   * @return void* Pointer to the allocated memory, or nullptr if all stages failed.
+   */
+  void* reclaim_and_allocate(arena& target, std::size_t bytes, cuda_stream_view stream)
+  {
+    using clock = std::chrono::steady_clock;
+    ++reclaim_stats_.reclaims;
+
+    // Arenas whose frees this thread can query and wait for: a stream arena through its event, or
+    // the calling thread's arena through its per-thread default stream
+    struct candidate {
+      arena* held;
+      stream_arena_entry* stream_arena;  // nullptr for the calling thread's arena
+      cuda_stream_view stream;
+    };
+    std::vector<candidate> candidates;
+    {
+      std::shared_lock map_lock(map_mtx_);
+      for (auto& thread_arena : thread_arenas_) {
+        thread_arena.second->reclaim_remote_frees();
+      }
+      for (auto& stream_arena : stream_arenas_) {
+        candidates.push_back({&stream_arena.second.held, &stream_arena.second, {}});
+      }
+    }
+    if (use_per_thread_arena(stream)) { candidates.push_back({&target, nullptr, stream}); }
+
+    auto start = clock::now();
+    for (auto const& idle : candidates) {
+      idle.held->reclaim_remote_frees();
+      auto const status = (idle.stream_arena != nullptr)
+                            ? cudaEventQuery(idle.stream_arena->freed)
+                            : cudaStreamQuery(idle.stream.value());
+      if (status == cudaSuccess) {
+        idle.held->defragment();
+      } else if (status != cudaErrorNotReady) {
+        RMM_CUDA_TRY(status);
+      }
+    }
+    void* pointer = target.allocate(bytes);
+    reclaim_stats_.idle_time += clock::now() - start;
+    if (pointer != nullptr) {
+      ++reclaim_stats_.idle_reclaims;
+      return pointer;
+    }
+
+    start = clock::now();
+    std::vector<std::pair<std::size_t, std::size_t>> by_free_size;  // (free bytes, candidate)
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+      auto const free = candidates[i].held->free_size();
+      if (free > 0) { by_free_size.emplace_back(free, i); }
+    }
+    std::sort(by_free_size.begin(), by_free_size.end(), std::greater<>{});
+    for (auto const& entry : by_free_size) {
+      auto const& waited = candidates[entry.second];
+      ++reclaim_stats_.streams_synchronized;
+      if (waited.stream_arena == nullptr) {
+        waited.stream.synchronize();
+        waited.held->clean();
+      } else {
+        RMM_CUDA_TRY(cudaEventSynchronize(waited.stream_arena->freed));
+        // Blocks freed since the last record may still be in use on the stream
+        if (waited.stream_arena->unrecorded.load()) {
+          waited.held->defragment();
+        } else {
+          waited.held->clean();
+        }
+      }
+      pointer = target.allocate(bytes);
+      if (pointer != nullptr) { break; }
+    }
+    reclaim_stats_.stream_time += clock::now() - start;
+    if (pointer != nullptr) {
+      ++reclaim_stats_.stream_reclaims;
+      return pointer;
+    }
+
+    if (global_arena_.grow(bytes)) {
+      pointer = target.allocate(bytes);
+      if (pointer != nullptr) {
+        ++reclaim_stats_.growth_reclaims;
+        return pointer;
+      }
+    }
+
+    start = clock::now();
+    ++reclaim_stats_.device_reclaims;
+    defragment();
+    pointer = target.allocate(bytes);
+    reclaim_stats_.device_time += clock::now() - start;
+    return pointer;
+  }
+
   /**
    * @brief Defragment memory by returning all superblocks to the global arena.
    */
   void defragment()
   {
     RMM_CUDA_TRY(cudaDeviceSynchronize());
+    std::shared_lock map_lock(map_mtx_);
     for (auto& thread_arena : thread_arenas_) {
       thread_arena.second->clean();
     }
     for (auto& stream_arena : stream_arenas_) {
-      stream_arena.second.clean();
+      stream_arena.second.held.clean();
     }
   }
 
@@ -213,47 +535,53 @@ class arena_memory_resource final : public device_memory_resource {
   void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
   {
     if (ptr == nullptr || bytes <= 0) { return; }
-#ifdef RMM_ARENA_USE_SIZE_CLASSES
-    bytes = rmm::mr::detail::arena::align_to_size_class(bytes);
-#else
-    bytes = rmm::detail::align_up(bytes, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
-#endif
-    auto& arena = get_arena(stream);
+    bytes = size_classes_->align(bytes);
+    auto* const stream_arena = use_per_thread_arena(stream) ? nullptr : &get_stream_arena(stream);
+    auto& arena = (stream_arena != nullptr) ? stream_arena->held : get_thread_arena();
+    allocated_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
 
     {
       std::shared_lock lock(mtx_);
       // If the memory being freed does not belong to the arena, the following will return false.
-      if (arena.deallocate(ptr, bytes, stream)) { return; }
+      bool emptied{};
+      if (arena.deallocate(ptr, bytes, stream, emptied)) {
+        // Noted under the lock, so that a reclaim never sees the block before it is noted.
+        if (stream_arena != nullptr) { stream_arena->note_free(stream, emptied); }
+        return;
+      }
+
+      // The block of another arena is queued to its owner with an event recorded on the stream,
+      // so neither the stream is synchronized nor the owner's lock taken.
+      auto* owner = global_arena_.owner_of(ptr);
+      if (owner != nullptr && owner->free_remote(ptr, bytes, stream)) { return; }
     }
 
-    {
-      // Since we are returning this memory to another stream, we need to make sure the current
-      // stream is caught up.
-      stream.synchronize_no_throw();
+    // Since we are returning this memory to another stream, we need to make sure the current
+    // stream is caught up.
+    stream.synchronize_no_throw();
 
-      std::unique_lock lock(mtx_);
-      deallocate_from_other_arena(ptr, bytes, stream);
-    }
+    std::shared_lock lock(mtx_);
+    deallocate_from_other_arena(ptr, bytes);
   }
 
   /**
-   * @brief Deallocate memory pointed to by `ptr` that was allocated in a different arena.
+   * @brief Deallocate memory pointed to by `ptr` that was allocated in a different arena, once the
+   * stream of the deallocation has been synchronized.
+   *
+   * The owning arena is found through the page index of the global arena, and the block is pushed
+   * onto that arena's remote-free queue without taking its lock, or returned under the owner's
+   * lock if the queue's node pool is exhausted. The owner reclaims queued blocks on its next
+   * allocation, or when all arenas are defragmented.
    *
    * @param ptr Pointer to be deallocated.
    * @param bytes The size in bytes of the allocation. This must be equal to the
    * value of `bytes` that was passed to the `allocate` call that returned `ptr`.
-   * @param stream Stream on which to perform deallocation.
    */
-  void deallocate_from_other_arena(void* ptr, std::size_t bytes, cuda_stream_view stream)
+  void deallocate_from_other_arena(void* ptr, std::size_t bytes)
   {
-    if (use_per_thread_arena(stream)) {
-      for (auto const& thread_arena : thread_arenas_) {
-        if (thread_arena.second->deallocate(ptr, bytes)) { return; }
-      }
-    } else {
-      for (auto& stream_arena : stream_arenas_) {
-        if (stream_arena.second.deallocate(ptr, bytes)) { return; }
-      }
+    // Looked up again if the superblock changes hands before the owner's lock is taken
+    while (auto* owner = global_arena_.owner_of(ptr)) {
+      if (owner->free_remote(ptr, bytes) || owner->deallocate(ptr, bytes)) { return; }
     }
 
     if (!global_arena_.deallocate(ptr, bytes)) { RMM_FAIL("allocation not found"); }
@@ -268,37 +596,53 @@ class arena_memory_resource final : public device_memory_resource {
   arena& get_arena(cuda_stream_view stream)
   {
     if (use_per_thread_arena(stream)) { return get_thread_arena(); }
-    return get_stream_arena(stream);
+    return get_stream_arena(stream).held;
+  }
+
+  /**
+   * @brief The calling thread's arena cleaners, one per resource.
+   */
+  static detail::thread_cache_table<arena_cleaner>& this_thread_arenas()
+  {
+    thread_local detail::thread_cache_table<arena_cleaner> table;
+    return table;
   }
 
   /**
    * @brief Get the arena associated with the current thread.
    *
+   * The arena is found in a thread-local table keyed by the resource's unique id, so after a
+   * thread's first allocation no lock is taken and the arena map is not searched.
+   *
    * @return arena& The arena associated with the current thread.
    */
   arena& get_thread_arena()
   {
+    auto& table = this_thread_arenas();
+    if (auto* cleaner = table.find(id_); cleaner != nullptr) { return cleaner->get(); }
+
     auto const thread_id = std::this_thread::get_id();
+    std::shared_ptr<arena> thread_arena;
     {
       std::shared_lock lock(map_mtx_);
       auto const iter = thread_arenas_.find(thread_id);
-      if (iter != thread_arenas_.end()) { return *iter->second; }
+      if (iter != thread_arenas_.end()) { thread_arena = iter->second; }
     }
-    {
+    if (!thread_arena) {
       std::unique_lock lock(map_mtx_);
-      auto thread_arena = std::make_shared<arena>(global_arena_);
+      thread_arena = std::make_shared<arena>(global_arena_);
       thread_arenas_.emplace(thread_id, thread_arena);
-      thread_local detail::arena::arena_cleaner<Upstream> cleaner{thread_arena};
-      return *thread_arena;
     }
+    table.insert(id_, std::make_shared<arena_cleaner>(thread_arena));
+    return *thread_arena;
   }
 
   /**
-   * @brief Get the arena associated with the given stream.
+   * @brief Get the arena associated with the given stream, with its event.
    *
-   * @return arena& The arena associated with the given stream.
+   * @return stream_arena_entry& The arena associated with the given stream.
    */
-  arena& get_stream_arena(cuda_stream_view stream)
+  stream_arena_entry& get_stream_arena(cuda_stream_view stream)
   {
     RMM_LOGGING_ASSERT(!use_per_thread_arena(stream));
     {
@@ -316,13 +660,20 @@ class arena_memory_resource final : public device_memory_resource {
   /**
    * @brief Get free and available memory for memory resource.
    *
+   * Total is the current size of the global arena; free is that size less the bytes currently
+   * allocated.
+   * The allocated byte count is maintained on every allocation and deallocation, so this is O(1)
+   * and takes no locks. Free memory may be fragmented across per-thread and per-stream arenas.
+   *
    * @param stream to execute on.
    * @return std::pair containing free_size and total_size of memory.
    */
   std::pair<std::size_t, std::size_t> do_get_mem_info(
     [[maybe_unused]] cuda_stream_view stream) const override
   {
-    return std::make_pair(0, 0);
+    auto const total = global_arena_.size();
+    auto const used  = allocated_bytes_.load(std::memory_order_relaxed);
+    return std::make_pair((total > used) ? total - used : 0, total);
   }
 
   /**
@@ -356,17 +707,25 @@ class arena_memory_resource final : public device_memory_resource {
   /// Arenas for default streams, one per thread.
   /// Implementation note: for small sizes, map is more efficient than unordered_map.
   std::map<std::thread::id, std::shared_ptr<arena>> thread_arenas_;
+  /// Unique id of this resource in the threads' arena tables.
+  std::uint64_t id_{detail::next_thread_cache_owner_id()};
   /// Arenas for non-default streams, one per stream.
   /// Implementation note: for small sizes, map is more efficient than unordered_map.
-  std::map<cudaStream_t, arena> stream_arenas_;
+  std::map<cudaStream_t, stream_arena_entry> stream_arenas_;
   /// If true, dump memory information to log on allocation failure.
   bool dump_log_on_failure_{};
   /// The logger for memory dump.
   std::shared_ptr<spdlog::logger> logger_{};
+  /// Rounds allocation sizes up to size classes.
+  std::shared_ptr<size_class_policy> size_classes_;
   /// Mutex for read and write locks on arena maps.
   mutable std::shared_mutex map_mtx_;
   /// Mutex for shared and unique locks on the mr.
   mutable std::shared_mutex mtx_;
+  /// Reclaim counters and timings, updated under the unique lock.
+  reclaim_statistics reclaim_stats_{};
+  /// Bytes currently allocated, for O(1) `get_mem_info`.
+  std::atomic<std::size_t> allocated_bytes_{};
 };
 
 /** @} */  // end of group
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <rmm/cuda_stream_view.hpp>
+#include <rmm/detail/error.hpp>
+#include <rmm/mr/device/detail/thread_cache.hpp>
+#include <rmm/mr/device/device_memory_resource.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_resource_adaptors
+ * @{
+ * @file
+ */
+
+/**
+ * @brief The kind of event described by a `trace_record`.
+ */
+enum class trace_action : std::uint32_t {
+  allocate,          ///< A successful allocation
+  free,              ///< A deallocation
+  allocate_failure,  ///< An allocation the upstream resource failed to satisfy
+};
+
+/**
+ * @brief A fixed-width record of one allocation event in a binary trace.
+ *
+ * Records are stored in host byte order. `timestamp_ns` is read from `std::chrono::steady_clock`
+ * and is the only field that orders records written by different threads.
+ */
+struct trace_record {
+  std::uint64_t timestamp_ns;  ///< Monotonic time of the event in nanoseconds
+  std::uint64_t pointer;       ///< Pointer allocated or freed (0 for a failed allocation)
+  std::uint64_t size;          ///< Size in bytes of the allocation
+  std::uint64_t stream;        ///< Numeric value of the stream of the event
+  std::uint32_t thread_id;     ///< Dense identifier of the thread that initiated the event
+  trace_action action;         ///< The kind of event
+};
+
+static_assert(sizeof(trace_record) == 40, "trace_record must be 40 bytes");
+static_assert(std::is_trivially_copyable_v<trace_record> && std::is_standard_layout_v<trace_record>,
+              "trace_record must be written and read as raw bytes");
+
+/**
+ * @brief The header at the start of a binary trace file, followed by the records.
+ */
+struct trace_file_header {
+  /// The magic number identifying a binary trace
+  static constexpr std::array<char, 8> expected_magic{'R', 'M', 'M', 'T', 'R', 'A', 'C', 'E'};
+  /// The current version of the format
+  static constexpr std::uint32_t current_version{1};
+
+  std::array<char, 8> magic{expected_magic};        ///< Identifies a binary trace
+  std::uint32_t version{current_version};           ///< Format version
+  std::uint32_t record_size{sizeof(trace_record)};  ///< Size in bytes of each record
+};
+
+static_assert(sizeof(trace_file_header) == 16, "trace_file_header must be 16 bytes");
+
+namespace detail {
+
+/**
+ * @brief A buffer of trace records owned by a single thread.
+ *
+ * Only the owning thread calls `append`, which takes no lock until the buffer is full and is
+ * written out through the `write` callback. When the thread exits, `release()` writes the
+ * remaining records unless the owning adaptor has detached the buffer first; `detach()` writes
+ * them on behalf of the adaptor.
+ */
+class trace_buffer {
+ public:
+  /// Callback that writes `count` records to the trace file
+  using write_fn = std::function<void(trace_record const*, std::size_t)>;
+
+  /**
+   * @brief Construct an empty buffer.
+   *
+   * @param capacity The number of records buffered before they are written
+   * @param write Callback that writes records to the trace file
+   */
+  trace_buffer(std::size_t capacity, write_fn write)
+    : records_(capacity), write_{std::move(write)}
+  {
+  }
+
+  ~trace_buffer() = default;
+
+  trace_buffer(trace_buffer const&)            = delete;
+  trace_buffer& operator=(trace_buffer const&) = delete;
+  trace_buffer(trace_buffer&&)                 = delete;
+  trace_buffer& operator=(trace_buffer&&)      = delete;
+
+  /**
+   * @brief Appends a record, writing out the buffer if it is full.
+   */
+  void append(trace_record const& record)
+  {
+    records_[count_++] = record;
+    if (count_ == records_.size()) { release(); }
+  }
+
+  /**
+   * @brief Writes the buffered records to the trace file.
+   */
+  void release()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    write_out();
+  }
+
+  /**
+   * @brief Writes the buffered records and severs the buffer from its adaptor, which is being
+   * destroyed. Records appended afterwards are dropped.
+   */
+  void detach()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    write_out();
+    write_ = nullptr;
+  }
+
+  /**
+   * @brief Whether the owning adaptor has detached this buffer.
+   */
+  [[nodiscard]] bool is_detached()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return not write_;
+  }
+
+ private:
+  void write_out()
+  {
+    if (write_ && count_ > 0) { write_(records_.data(), count_); }
+    count_ = 0;
+  }
+
+  std::vector<trace_record> records_;
+  std::size_t count_{};
+
+  std::mutex mtx_;  // guards write_ between thread exit and adaptor destruction
+  write_fn write_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Resource that uses `Upstream` to allocate memory and records every allocation and
+ * deallocation in a compact binary trace.
+ *
+ * This is a low-overhead alternative to `logging_resource_adaptor`. Each event is stored as a
+ * fixed-width `trace_record` in a buffer owned by the calling thread, without formatting and
+ * without a lock; only full buffers are written to the file, under a mutex. The file starts with
+ * a `trace_file_header`. Because each thread writes its buffer as a unit, records of different
+ * threads are not in time order in the file and must be ordered by `timestamp_ns` when read.
+ *
+ * The timestamp of an allocation is taken after the upstream allocation returns and that of a
+ * free before the upstream deallocation, so that a pointer is never freed before it is allocated
+ * in timestamp order, even across threads.
+ *
+ * The trace is complete once the adaptor is destroyed. Records of threads that exit earlier are
+ * written when the thread exits; `flush()` writes those of the calling thread.
+ *
+ * `REPLAY_BENCH` replays these traces directly, and `TRACE_CONVERTER` converts between this
+ * format and the CSV format of `logging_resource_adaptor`.
+ *
+ * @tparam Upstream Type of the upstream resource used for allocation/deallocation.
+ */
+template <typename Upstream>
+class binary_logging_resource_adaptor final : public device_memory_resource {
+ public:
+  static constexpr std::size_t default_buffer_records{4096};  ///< Default records per buffer
+
+  /**
+   * @brief Construct a new binary logging resource adaptor using `upstream` to satisfy
+   * allocation requests and recording each allocation/free in the file `filename`.
+   *
+   * Clears the contents of `filename` if it already exists.
+   *
+   * @throws rmm::logic_error if `upstream == nullptr`
+   * @throws rmm::logic_error if `buffer_records == 0`
+   * @throws rmm::logic_error if `filename` cannot be opened for writing
+   *
+   * @param upstream The resource used for allocating/deallocating device memory
+   * @param filename Name of the trace file
+   * @param buffer_records The number of records each thread buffers before writing them
+   */
+  binary_logging_resource_adaptor(Upstream* upstream,
+                                  std::string const& filename,
+                                  std::size_t buffer_records = default_buffer_records)
+    : upstream_{upstream},
+      file_{filename, std::ios::binary | std::ios::trunc},
+      buffer_records_{buffer_records}
+  {
+    RMM_EXPECTS(nullptr != upstream, "Unexpected null upstream resource pointer.");
+    RMM_EXPECTS(buffer_records > 0, "Trace buffers must hold at least one record.");
+    RMM_EXPECTS(file_.is_open(), "Failed to open the trace file.");
+
+    trace_file_header const header{};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file_.write(reinterpret_cast<char const*>(&header), sizeof(header));
+  }
+
+  /**
+   * @brief Writes the records buffered by every thread and closes the trace file.
+   */
+  ~binary_logging_resource_adaptor() override
+  {
+    std::lock_guard<std::mutex> lock(buffers_mtx_);
+    for (auto& buffer : buffers_) {
+      buffer->detach();
+    }
+  }
+
+  binary_logging_resource_adaptor()                                                  = delete;
+  binary_logging_resource_adaptor(binary_logging_resource_adaptor const&)            = delete;
+  binary_logging_resource_adaptor& operator=(binary_logging_resource_adaptor const&) = delete;
+  binary_logging_resource_adaptor(binary_logging_resource_adaptor&&)                 = delete;
+  binary_logging_resource_adaptor& operator=(binary_logging_resource_adaptor&&)      = delete;
+
+  /**
+   * @brief Return pointer to the upstream resource.
+   *
+   * @return Upstream* Pointer to the upstream resource.
+   */
+  [[nodiscard]] Upstream* get_upstream() const noexcept { return upstream_; }
+
+  /**
+   * @brief Checks whether the upstream resource supports streams.
+   *
+   * @return true The upstream resource supports streams
+   * @return false The upstream resource does not support streams.
+   */
+  [[nodiscard]] bool supports_streams() const noexcept override
+  {
+    return upstream_->supports_streams();
+  }
+
+  /**
+   * @brief Query whether the resource supports the get_mem_info API.
+   *
+   * @return bool true if the upstream resource supports get_mem_info, false otherwise.
+   */
+  [[nodiscard]] bool supports_get_mem_info() const noexcept override
+  {
+    return upstream_->supports_get_mem_info();
+  }
+
+  /**
+   * @brief Writes the records buffered by the calling thread and flushes the file.
+   *
+   * Records buffered by other threads are not written.
+   */
+  void flush()
+  {
+    if (auto* buffer = this_thread_buffers().find(owner_id_); buffer != nullptr) {
+      buffer->release();
+    }
+    std::lock_guard<std::mutex> lock(file_mtx_);
+    file_.flush();
+  }
+
+ private:
+  /**
+   * @brief The calling thread's buffers, one per adaptor.
+   */
+  static detail::thread_cache_table<detail::trace_buffer>& this_thread_buffers()
+  {
+    thread_local detail::thread_cache_table<detail::trace_buffer> table;
+    return table;
+  }
+
+  /**
+   * @brief A dense identifier of the calling thread, shared by all adaptors.
+   */
+  static std::uint32_t this_thread_id()
+  {
+    static std::atomic<std::uint32_t> next_id{};
+    thread_local std::uint32_t const id{next_id++};
+    return id;
+  }
+
+  /**
+   * @brief Returns the calling thread's buffer for this adaptor, creating it if necessary.
+   */
+  detail::trace_buffer& get_buffer()
+  {
+    auto& table = this_thread_buffers();
+    if (auto* buffer = table.find(owner_id_); buffer != nullptr) { return *buffer; }
+
+    auto buffer = std::make_shared<detail::trace_buffer>(
+      buffer_records_,
+      [this](trace_record const* records, std::size_t count) { write_records(records, count); });
+    {
+      std::lock_guard<std::mutex> lock(buffers_mtx_);
+      // Buffers referenced only from here belong to threads that have exited
+      buffers_.erase(std::remove_if(buffers_.begin(),
+                                    buffers_.end(),
+                                    [](auto const& buf) { return buf.use_count() == 1; }),
+                     buffers_.end());
+      buffers_.push_back(buffer);
+    }
+    table.insert(owner_id_, buffer);
+    return *buffer;
+  }
+
+  void write_records(trace_record const* records, std::size_t count)
+  {
+    std::lock_guard<std::mutex> lock(file_mtx_);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file_.write(reinterpret_cast<char const*>(records),
+                static_cast<std::streamsize>(count * sizeof(trace_record)));
+  }
+
+  void record(trace_action action, void const* ptr, std::size_t bytes, cuda_stream_view stream)
+  {
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    get_buffer().append(trace_record{
+      static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()),
+      reinterpret_cast<std::uintptr_t>(ptr),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      bytes,
+      reinterpret_cast<std::uintptr_t>(stream.value()),  // NOLINT
+      this_thread_id(),
+      action});
+  }
+
+  /**
+   * @brief Allocates memory of size at least `bytes` using the upstream resource and records
+   * the allocation, or the failure to allocate.
+   *
+   * If the allocation cannot be recorded, it is returned to upstream and the error is rethrown.
+   *
+   * The returned pointer has at least 256B alignment.
+   *
+   * @throws rmm::bad_alloc if the requested allocation could not be fulfilled
+   * by the upstream resource.
+   *
+   * @param bytes The size, in bytes, of the allocation
+   * @param stream Stream on which to perform the allocation
+   * @return void* Pointer to the newly allocated memory
+   */
+  void* do_allocate(std::size_t bytes, cuda_stream_view stream) override
+  {
+    void* ptr{};
+    try {
+      ptr = upstream_->allocate(bytes, stream);
+    } catch (...) {
+      record(trace_action::allocate_failure, nullptr, bytes, stream);
+      throw;
+    }
+    try {
+      record(trace_action::allocate, ptr, bytes, stream);
+    } catch (...) {
+      // The caller never sees the allocation, so it must not outlive the failed record
+      upstream_->deallocate(ptr, bytes, stream);
+      throw;
+    }
+    return ptr;
+  }
+
+  /**
+   * @brief Records the deallocation and frees the allocation of size `bytes` pointed to by
+   * `ptr`.
+   *
+   * @param ptr Pointer to be deallocated
+   * @param bytes Size of the allocation
+   * @param stream Stream on which to perform the deallocation
+   */
+  void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
+  {
+    record(trace_action::free, ptr, bytes, stream);
+    upstream_->deallocate(ptr, bytes, stream);
+  }
+
+  /**
+   * @brief Compare the upstream resource to another.
+   *
+   * @param other The other resource to compare to
+   * @return true If the two resources are equivalent
+   * @return false If the two resources are not equal
+   */
+  [[nodiscard]] bool do_is_equal(device_memory_resource const& other) const noexcept override
+  {
+    if (this == &other) { return true; }
+    auto const* cast = dynamic_cast<binary_logging_resource_adaptor<Upstream> const*>(&other);
+    if (cast != nullptr) { return upstream_->is_equal(*cast->get_upstream()); }
+    return upstream_->is_equal(other);
+  }
+
+  /**
+   * @brief Get free and available memory from upstream resource.
+   *
+   * @throws rmm::cuda_error if unable to retrieve memory info.
+   *
+   * @param stream Stream on which to get the mem info.
+   * @return std::pair contaiing free_size and total_size of memory
+   */
+  [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
+    cuda_stream_view stream) const override
+  {
+    return upstream_->get_mem_info(stream);
+  }
+
+  Upstream* upstream_;  ///< The upstream resource used for satisfying allocation requests
+
+  std::mutex file_mtx_;  // serializes writes of full buffers
+  std::ofstream file_;
+  std::size_t buffer_records_;
+
+  std::uint64_t owner_id_{detail::next_thread_cache_owner_id()};
+  std::mutex buffers_mtx_;
+  std::vector<std::shared_ptr<detail::trace_buffer>> buffers_;  // buffers of all threads
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
@@ -37,15 +37,25 @@
 #pragma once
 
 #include <rmm/detail/aligned.hpp>
+#include <rmm/detail/error.hpp>
+#include <rmm/mr/device/detail/bin_table.hpp>
+#include <rmm/mr/device/detail/sharded_pointer_map.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
 #include <rmm/mr/device/fixed_size_memory_resource.hpp>
+#include <rmm/mr/device/size_class_policy.hpp>
 
 #include <rmm/cuda_runtime_api.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace rmm::mr {
@@ -55,9 +65,66 @@ namespace rmm::mr {
  * @file
  */
 
+/**
+ * @brief Settings of adaptive binning in a `binning_memory_resource`.
+ *
+ * The resource samples one in `sample_period` allocations into a histogram of size classes. After
+ * every `window` samples, a fixed-size bin is created for each class of at most `max_bin_size`
+ * bytes that received at least `hot_fraction` of the samples, hottest first, as long as the memory
+ * held by adaptive bins stays within `memory_budget`. A bin whose class received less than
+ * `cold_fraction` of the samples stops serving allocations, and is destroyed and its memory
+ * returned upstream once all of its blocks have been freed.
+ */
+struct adaptive_binning_options {
+  std::size_t memory_budget{0};       ///< Bytes adaptive bins may hold; zero disables them
+  std::size_t max_bin_size{1 << 20};  ///< Largest size class given an adaptive bin
+  std::size_t blocks_per_chunk{128};  ///< Blocks a bin takes from upstream at a time
+  std::size_t sample_period{16};      ///< One in this many allocations is sampled
+  std::size_t window{4096};           ///< Samples between re-evaluations of the bins
+  double hot_fraction{0.05};          ///< Share of the samples for which a bin is created
+  double cold_fraction{0.01};         ///< Share of the samples below which a bin is retired
+  /// Size classes that bins are created for; sizes aligned to 256 bytes if null
+  std::shared_ptr<size_class_policy> size_classes{};
+};
+
+/**
+ * @brief The allocations served by each bin of a `binning_memory_resource`.
+ */
+struct binning_statistics {
+  /// Counters of one bin.
+  struct bin {
+    std::size_t size{};         ///< Largest allocation the bin serves
+    bool adaptive{};            ///< Whether the bin was created by adaptive binning
+    bool retiring{};            ///< Whether the adaptive bin is draining to be destroyed
+    std::size_t allocations{};  ///< Allocations served by the bin
+    double hit_rate{};          ///< Share of all allocations served by the bin
+  };
+
+  std::size_t allocations{};           ///< Allocations made through the resource
+  std::size_t upstream_allocations{};  ///< Allocations that no bin served
+  std::size_t bins_created{};          ///< Adaptive bins created
+  std::size_t bins_retired{};          ///< Adaptive bins destroyed after draining
+  std::size_t adaptive_bytes{};        ///< Bytes held by adaptive bins
+  std::vector<bin> bins;               ///< Static bins by size, then adaptive bins by size
+
+  /**
+   * @brief The share of all allocations served by a bin.
+   *
+   * @return double The bin hit rate, or 0 if nothing was allocated
+   */
+  [[nodiscard]] double hit_rate() const noexcept
+  {
+    if (allocations == 0) { return 0; }
+    return 1 - static_cast<double>(upstream_allocations) / static_cast<double>(allocations);
+  }
+};
+
 /**
  * @brief Allocates memory from upstream resources associated with bin sizes.
  *
+ * Bins are added with `add_bin` or, with adaptive binning, created and retired automatically for
+ * the allocation sizes that are currently common (see `adaptive_binning_options`).
+ *
  * @tparam UpstreamResource memory_resource to use for allocations that don't fall within any
  * configured bin size. Implements rmm::mr::device_memory_resource interface.
  */
@@ -107,6 +174,29 @@ class binning_memory_resource final : public device_memory_resource {
     }
   }
 
+  /**
+   * @brief Construct a new binning memory resource object with adaptive binning.
+   *
+   * Bins added with `add_bin` serve the sizes that have no adaptive bin.
+   *
+   * @throws rmm::logic_error if `upstream_resource == nullptr`, if `sample_period`, `window` or
+   * `blocks_per_chunk` is zero, or unless `0 <= cold_fraction <= hot_fraction <= 1`.
+   *
+   * @param upstream_resource The upstream memory resource used to allocate bin pools.
+   * @param options The adaptive binning settings.
+   */
+  binning_memory_resource(Upstream* upstream_resource, adaptive_binning_options options)
+    : binning_memory_resource{upstream_resource}
+  {
+    RMM_EXPECTS(options.sample_period > 0 and options.window > 0 and options.blocks_per_chunk > 0,
+                "Sample period, window and blocks per chunk must be positive.");
+    RMM_EXPECTS(0 <= options.cold_fraction and options.cold_fraction <= options.hot_fraction and
+                  options.hot_fraction <= 1,
+                "Adaptive binning requires 0 <= cold_fraction <= hot_fraction <= 1.");
+    if (not options.size_classes) { options.size_classes = std::make_shared<exact_size_classes>(); }
+    adaptive_ = std::move(options);
+  }
+
   /**
    * @brief Destroy the binning_memory_resource and free all memory allocated from the upstream
    * resource.
@@ -130,9 +220,12 @@ class binning_memory_resource final : public device_memory_resource {
   /**
    * @brief Query whether the resource supports the get_mem_info API.
    *
-   * @return false
+   * @return bool true if the upstream resource supports get_mem_info, false otherwise.
    */
-  [[nodiscard]] bool supports_get_mem_info() const noexcept override { return false; }
+  [[nodiscard]] bool supports_get_mem_info() const noexcept override
+  {
+    return upstream_mr_->supports_get_mem_info();
+  }
 
   /**
    * @brief Get the upstream memory_resource object.
@@ -152,7 +245,8 @@ class binning_memory_resource final : public device_memory_resource {
    *
    * If there is already a bin of the specified size nothing is changed.
    *
-   * This function is not thread safe.
+   * Adding a bin rebuilds the flat table through which allocations find their bin, so bins are
+   * best added before the resource is used. This function is not thread safe.
    *
    * @param allocation_size The maximum size that this bin allocates
    * @param bin_resource The memory resource for the bin
@@ -163,16 +257,152 @@ class binning_memory_resource final : public device_memory_resource {
       rmm::detail::align_up(allocation_size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
 
     if (nullptr != bin_resource) {
-      resource_bins_.insert({allocation_size, bin_resource});
+      resource_bins_.try_emplace(allocation_size, bin_resource);
     } else if (resource_bins_.count(allocation_size) == 0) {  // do nothing if bin already exists
 
       owned_bin_resources_.push_back(
         std::make_unique<fixed_size_memory_resource<Upstream>>(upstream_mr_, allocation_size));
-      resource_bins_.insert({allocation_size, owned_bin_resources_.back().get()});
+      resource_bins_.try_emplace(allocation_size, owned_bin_resources_.back().get());
+    }
+    rebuild_bin_table();
+  }
+
+  /**
+   * @brief Returns the allocations served by each bin and by the upstream resource.
+   *
+   * @return binning_statistics The counters
+   */
+  [[nodiscard]] binning_statistics get_bin_statistics() const
+  {
+    binning_statistics stats;
+    stats.upstream_allocations = upstream_allocations_.load(std::memory_order_relaxed);
+    stats.allocations          = stats.upstream_allocations;
+    {
+      std::shared_lock lock(bins_mtx_);
+      for (auto const& [size, bin] : resource_bins_) {
+        stats.bins.push_back({size, false, false, bin.allocations.load(std::memory_order_relaxed)});
+      }
+      auto const num_static = static_cast<std::ptrdiff_t>(stats.bins.size());
+      for (auto const& bin : adaptive_bins_) {
+        stats.bins.push_back(
+          {bin->size, true, bin->retiring, bin->allocations.load(std::memory_order_relaxed)});
+      }
+      std::sort(stats.bins.begin() + num_static,
+                stats.bins.end(),
+                [](auto const& lhs, auto const& rhs) { return lhs.size < rhs.size; });
+      stats.allocations += retired_allocations_;
+      stats.bins_created = bins_created_;
+      stats.bins_retired = bins_retired_;
     }
+    {
+      std::shared_lock lock(chunks_mtx_);
+      stats.adaptive_bytes = adaptive_bytes_;
+    }
+    for (auto const& bin : stats.bins) {
+      stats.allocations += bin.allocations;
+    }
+    for (auto& bin : stats.bins) {
+      bin.hit_rate = (stats.allocations == 0) ? 0
+                                              : static_cast<double>(bin.allocations) /
+                                                  static_cast<double>(stats.allocations);
+    }
+    return stats;
   }
 
  private:
+  struct adaptive_bin;
+
+  /**
+   * @brief The upstream of an adaptive bin. Takes the bin's chunks from the binning resource's
+   * upstream within the memory budget, and records the bin as the owner of each chunk.
+   */
+  class chunk_recorder final : public device_memory_resource {
+   public:
+    chunk_recorder(binning_memory_resource& owner, adaptive_bin& bin) : owner_{owner}, bin_{bin} {}
+
+    [[nodiscard]] bool supports_streams() const noexcept override { return true; }
+    [[nodiscard]] bool supports_get_mem_info() const noexcept override { return false; }
+
+   private:
+    void* do_allocate(std::size_t bytes, cuda_stream_view stream) override
+    {
+      return owner_.allocate_chunk(bin_, bytes, stream);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
+    {
+      owner_.deallocate_chunk(bin_, ptr, bytes, stream);
+    }
+
+    [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
+      cuda_stream_view) const override
+    {
+      return {0, 0};
+    }
+
+    binning_memory_resource& owner_;
+    adaptive_bin& bin_;
+  };
+
+  /// A bin created by adaptive binning.
+  struct adaptive_bin {
+    adaptive_bin(binning_memory_resource& owner, std::size_t size, std::size_t blocks_per_chunk)
+      : size{size}, upstream{owner, *this}, resource{&upstream, size, blocks_per_chunk}
+    {
+    }
+
+    // The last frees may still be pending on their streams when the bin drains
+    ~adaptive_bin() { resource.synchronize_frees(); }
+
+    adaptive_bin(adaptive_bin const&)            = delete;
+    adaptive_bin(adaptive_bin&&)                 = delete;
+    adaptive_bin& operator=(adaptive_bin const&) = delete;
+    adaptive_bin& operator=(adaptive_bin&&)      = delete;
+
+    std::size_t size;  // initialized first: the resource takes its first chunk on construction
+    chunk_recorder upstream;
+    fixed_size_memory_resource<chunk_recorder> resource;
+    std::atomic<std::size_t> allocations{};  // allocations served
+    std::atomic<std::size_t> outstanding{};  // allocations not yet freed
+    bool retiring{};                         // no longer serving allocations, under unique lock
+  };
+
+  /// A bin added with `add_bin`.
+  struct static_bin {
+    explicit static_bin(device_memory_resource* bin_resource) : resource{bin_resource} {}
+
+    device_memory_resource* resource;
+    std::atomic<std::size_t> allocations{};
+  };
+
+  [[nodiscard]] bool adaptive() const noexcept { return adaptive_.memory_budget > 0; }
+
+  /// Rebuilds the flat copy of `resource_bins_` and its `bin_table`.
+  void rebuild_bin_table()
+  {
+    bin_sizes_.clear();
+    bins_.clear();
+    for (auto& [size, bin] : resource_bins_) {
+      bin_sizes_.push_back(size);
+      bins_.push_back(&bin);
+    }
+    bin_table_ = detail::make_bin_table(bin_sizes_);
+  }
+
+  /**
+   * @brief Get the bin for the requested size
+   *
+   * Chooses the bin that allocates the smallest blocks at least as large as `bytes`.
+   *
+   * @param bytes Requested allocation size in bytes
+   * @return static_bin* The bin, or nullptr if `bytes` is larger than every bin
+   */
+  static_bin* get_bin(std::size_t bytes) const noexcept
+  {
+    auto const index = detail::find_bin(bin_sizes_, bin_table_, bytes);
+    return (index < bins_.size()) ? bins_[index] : nullptr;
+  }
+
   /**
    * @brief Get the memory resource for the requested size
    *
@@ -183,9 +413,8 @@ class binning_memory_resource final : public device_memory_resource {
    */
   device_memory_resource* get_resource(std::size_t bytes)
   {
-    auto iter = resource_bins_.lower_bound(bytes);
-    return (iter != resource_bins_.cend()) ? iter->second
-                                           : static_cast<device_memory_resource*>(get_upstream());
+    auto* bin = get_bin(bytes);
+    return (bin != nullptr) ? bin->resource : static_cast<device_memory_resource*>(get_upstream());
   }
 
   /**
@@ -200,7 +429,20 @@ class binning_memory_resource final : public device_memory_resource {
   void* do_allocate(std::size_t bytes, cuda_stream_view stream) override
   {
     if (bytes <= 0) { return nullptr; }
-    return get_resource(bytes)->allocate(bytes, stream);
+    if (adaptive()) {
+      sample(bytes);
+      void* ptr = allocate_from_adaptive_bin(bytes, stream);
+      if (ptr != nullptr) { return ptr; }
+    }
+    auto* bin = get_bin(bytes);
+    if (bin == nullptr) {
+      void* ptr = get_upstream()->allocate(bytes, stream);
+      upstream_allocations_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+    void* ptr = bin->resource->allocate(bytes, stream);
+    bin->allocations.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
   }
 
   /**
@@ -215,29 +457,286 @@ class binning_memory_resource final : public device_memory_resource {
    */
   void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
   {
+    if (adaptive() && deallocate_to_adaptive_bin(ptr, bytes, stream)) { return; }
     auto res = get_resource(bytes);
     if (res != nullptr) { res->deallocate(ptr, bytes, stream); }
   }
 
   /**
-   * @brief Get free and available memory for memory resource
+   * @brief Adds `bytes` to the size histogram if a sample is due, and re-evaluates the adaptive
+   * bins once the histogram holds a full window of samples.
+   */
+  void sample(std::size_t bytes)
+  {
+    if (sample_count_.fetch_add(1, std::memory_order_relaxed) % adaptive_.sample_period != 0) {
+      return;
+    }
+
+    std::unordered_map<std::size_t, std::size_t> window;
+    {
+      std::lock_guard lock(histogram_mtx_);
+      auto const size = adaptive_.size_classes->align(bytes);
+      if (size <= adaptive_.max_bin_size) { ++histogram_[size]; }
+      if (++samples_ < adaptive_.window) { return; }
+      window.swap(histogram_);
+      samples_ = 0;
+    }
+    rebin(window);
+  }
+
+  /**
+   * @brief Retires the adaptive bins of classes that have gone cold and creates bins for hot
+   * classes within the memory budget.
+   *
+   * @param window The number of samples of each size class in the last window
+   */
+  void rebin(std::unordered_map<std::size_t, std::size_t> const& window)
+  {
+    auto const window_size = static_cast<double>(adaptive_.window);
+    auto const samples     = [&window](std::size_t size) {
+      auto const iter = window.find(size);
+      return static_cast<double>((iter == window.end()) ? 0 : iter->second);
+    };
+
+    std::vector<std::unique_ptr<adaptive_bin>> drained;  // destroyed after the lock is released
+    std::vector<std::pair<std::size_t, std::size_t>> hot;  // (samples, size), hottest first
+    {
+      std::unique_lock lock(bins_mtx_);
+      for (auto iter = active_bins_.begin(); iter != active_bins_.end();) {
+        if (samples(iter->first) >= adaptive_.cold_fraction * window_size) {
+          ++iter;
+          continue;
+        }
+        auto& bin    = *iter->second;
+        bin.retiring = true;
+        iter         = active_bins_.erase(iter);
+        if (bin.outstanding.load(std::memory_order_acquire) == 0) {
+          drained.push_back(retire_bin(bin));
+        }
+      }
+      for (auto const& [size, count] : window) {
+        if (static_cast<double>(count) >= adaptive_.hot_fraction * window_size &&
+            active_bins_.count(size) == 0) {
+          hot.emplace_back(count, size);
+        }
+      }
+    }
+    std::sort(hot.rbegin(), hot.rend());
+
+    // A new bin takes its first chunk from upstream, so build the bins without the lock rather than
+    // stall every allocation behind the upstream
+    std::vector<std::unique_ptr<adaptive_bin>> created;
+    for (auto const& [count, size] : hot) {
+      try {
+        created.push_back(std::make_unique<adaptive_bin>(*this, size, adaptive_.blocks_per_chunk));
+      } catch (rmm::out_of_memory const&) {
+        continue;  // over budget; a smaller class may still fit
+      }
+    }
+    if (created.empty()) { return; }
+
+    std::unique_lock lock(bins_mtx_);
+    for (auto& bin : created) {
+      // A concurrent rebin may have created a bin for the same class in the meantime
+      if (not active_bins_.emplace(bin->size, bin.get()).second) {
+        drained.push_back(std::move(bin));
+        continue;
+      }
+      adaptive_bins_.push_back(std::move(bin));
+      ++bins_created_;
+    }
+  }
+
+  /**
+   * @brief Allocates from the adaptive bin of the size class of `bytes`, if there is one and it
+   * can grow within the memory budget.
+   *
+   * @return void* The allocation, or nullptr
+   */
+  void* allocate_from_adaptive_bin(std::size_t bytes, cuda_stream_view stream)
+  {
+    auto const size = adaptive_.size_classes->align(bytes);
+    if (size > adaptive_.max_bin_size) { return nullptr; }
+    std::shared_lock lock(bins_mtx_);
+    auto const iter = active_bins_.find(size);
+    if (iter == active_bins_.end()) { return nullptr; }
+    auto& bin = *iter->second;
+    void* ptr{};
+    try {
+      ptr = bin.resource.allocate(bytes, stream);
+    } catch (rmm::out_of_memory const&) {
+      return nullptr;
+    }
+    bin.allocations.fetch_add(1, std::memory_order_relaxed);
+    bin.outstanding.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+  }
+
+  /**
+   * @brief Returns `ptr` to the adaptive bin whose chunk contains it, if any, and destroys the bin
+   * if it is retiring and this was its last allocation.
+   *
+   * The bin is destroyed after the lock is released, since destroying it waits for the frees on
+   * its streams to complete.
+   *
+   * @return bool true if an adaptive bin held `ptr`
+   */
+  bool deallocate_to_adaptive_bin(void* ptr, std::size_t bytes, cuda_stream_view stream)
+  {
+    if (adaptive_.size_classes->align(bytes) > adaptive_.max_bin_size) { return false; }
+    adaptive_bin* drained{};
+    {
+      std::shared_lock lock(bins_mtx_);
+      auto* bin = chunk_owner(ptr);
+      if (bin == nullptr) { return false; }
+      bin->resource.deallocate(ptr, bytes, stream);
+      // A retiring bin serves no allocations, so only this thread sees its count reach zero
+      if (bin->outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1 && bin->retiring) {
+        drained = bin;
+      }
+    }
+    if (drained != nullptr) {
+      std::unique_ptr<adaptive_bin> retired;
+      {
+        std::unique_lock lock(bins_mtx_);
+        retired = retire_bin(*drained);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Removes a drained adaptive bin from the resource. The caller must hold the unique lock.
    *
-   * @throws std::runtime_error if we could not get free / total memory
+   * @return std::unique_ptr<adaptive_bin> The bin, which returns its chunks upstream when destroyed
+   */
+  std::unique_ptr<adaptive_bin> retire_bin(adaptive_bin& bin)
+  {
+    retired_allocations_ += bin.allocations.load(std::memory_order_relaxed);
+    ++bins_retired_;
+    auto const iter = std::find_if(adaptive_bins_.begin(),
+                                   adaptive_bins_.end(),
+                                   [&bin](auto const& held) { return held.get() == &bin; });
+    auto retired    = std::move(*iter);
+    adaptive_bins_.erase(iter);
+    return retired;
+  }
+
+  /// The adaptive bin whose chunk contains the block `ptr`, or nullptr.
+  adaptive_bin* chunk_owner(void const* ptr) const
+  {
+    return block_owners_.find(ptr).value_or(nullptr);
+  }
+
+  /// The size of the blocks `bin` carves its chunks into.
+  static std::size_t block_size(adaptive_bin const& bin) noexcept
+  {
+    return rmm::detail::align_up(bin.size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+  }
+
+  /**
+   * @brief Allocates a chunk for `bin` from upstream, if it fits in the memory budget, and records
+   * the bin as the owner of each block of the chunk.
+   *
+   * @throws rmm::out_of_memory if the chunk does not fit in the budget
+   */
+  void* allocate_chunk(adaptive_bin& bin, std::size_t bytes, cuda_stream_view stream)
+  {
+    {
+      std::unique_lock lock(chunks_mtx_);
+      RMM_EXPECTS(adaptive_bytes_ + bytes <= adaptive_.memory_budget,
+                  "Adaptive bin memory budget exceeded.",
+                  rmm::out_of_memory);
+      adaptive_bytes_ += bytes;
+    }
+    void* ptr{};
+    try {
+      ptr = get_upstream()->allocate(bytes, stream);
+    } catch (...) {
+      std::unique_lock lock(chunks_mtx_);
+      adaptive_bytes_ -= bytes;
+      throw;
+    }
+    auto const size = block_size(bin);
+    for (std::size_t offset = 0; offset + size <= bytes; offset += size) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      block_owners_.insert(static_cast<char*>(ptr) + offset, &bin);
+    }
+    return ptr;
+  }
+
+  /// Returns a chunk of `bin` upstream.
+  void deallocate_chunk(adaptive_bin& bin, void* ptr, std::size_t bytes, cuda_stream_view stream)
+  {
+    auto const size = block_size(bin);
+    for (std::size_t offset = 0; offset + size <= bytes; offset += size) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      block_owners_.erase(static_cast<char*>(ptr) + offset);
+    }
+    {
+      std::unique_lock lock(chunks_mtx_);
+      adaptive_bytes_ -= bytes;
+    }
+    get_upstream()->deallocate(ptr, bytes, stream);
+  }
+
+  /**
+   * @brief Get free and total memory for memory resource
+   *
+   * Reports the upstream's free and total memory, plus the free blocks of the bins this resource
+   * owns. Owned bins allocate from the upstream, so the upstream counts their memory as in use.
+   * Bin resources added by the caller are not included.
    *
    * @param stream the stream being executed on
-   * @return std::pair with available and free memory for resource
+   * @return std::pair with free and total memory for resource
    */
   [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
-    [[maybe_unused]] cuda_stream_view stream) const override
+    cuda_stream_view stream) const override
   {
-    return std::make_pair(0, 0);
+    auto [free, total] = upstream_mr_->get_mem_info(stream);
+    for (auto const& bin : owned_bin_resources_) {
+      free += bin->get_mem_info(stream).first;
+    }
+    std::shared_lock lock(bins_mtx_);
+    for (auto const& bin : adaptive_bins_) {
+      free += bin->resource.get_mem_info(stream).first;
+    }
+    return std::make_pair(free, total);
   }
 
   Upstream* upstream_mr_;  // The upstream memory_resource from which to allocate blocks.
 
   std::vector<std::unique_ptr<fixed_size_memory_resource<Upstream>>> owned_bin_resources_;
 
-  std::map<std::size_t, device_memory_resource*> resource_bins_;
+  std::map<std::size_t, static_bin> resource_bins_;
+  // flat copy of resource_bins_ searched on each allocation, rebuilt by add_bin
+  std::vector<std::size_t> bin_sizes_;
+  std::vector<static_bin*> bins_;
+  detail::bin_table bin_table_{};
+  std::atomic<std::size_t> upstream_allocations_{};  // allocations served by upstream
+
+  adaptive_binning_options adaptive_{};  // memory_budget 0: adaptive binning disabled
+
+  // size histogram of the current window of samples
+  std::unordered_map<std::size_t, std::size_t> histogram_;
+  std::size_t samples_{};
+  std::atomic<std::size_t> sample_count_{};  // allocations seen by sample()
+  std::mutex histogram_mtx_;
+
+  // block --> owning bin of every block in the chunks of adaptive bins, so that a free finds its
+  // bin in constant time
+  detail::sharded_pointer_map<adaptive_bin*> block_owners_;
+  std::size_t adaptive_bytes_{};  // total size of the chunks, under chunks_mtx_
+  mutable std::shared_mutex chunks_mtx_;
+
+  // Adaptive bins are destroyed before the chunk index they deregister from. The bin containers
+  // and counters below are written under the unique lock of bins_mtx_.
+  std::vector<std::unique_ptr<adaptive_bin>> adaptive_bins_;        // active and retiring
+  std::unordered_map<std::size_t, adaptive_bin*> active_bins_;     // size class --> active bin
+  std::size_t bins_created_{};
+  std::size_t bins_retired_{};
+  std::size_t retired_allocations_{};  // allocations served by destroyed bins
+  mutable std::shared_mutex bins_mtx_;
 };
 
 /** @} */  // end of group
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+#include <random>
+
+namespace rmm::mr::detail {
+
+/**
+ * @brief Decides which allocations to sample, either every Nth allocation or by byte interval.
+ *
+ * With a byte interval of `I`, the sampler counts down a number of bytes drawn from an exponential
+ * distribution with mean `I`, and samples the allocation that reaches zero. An allocation of `s`
+ * bytes is then sampled with probability `1 - exp(-s / I)`, independently of the allocations
+ * around it, so large allocations are almost always sampled and small ones rarely.
+ */
+class allocation_sampler {
+ public:
+  /**
+   * @brief Construct a sampler.
+   *
+   * @param allocation_interval Sample every `allocation_interval`th allocation, or none if 0
+   * @param byte_interval If nonzero, sample on average once per `byte_interval` bytes allocated
+   * instead
+   */
+  allocation_sampler(std::size_t allocation_interval, std::size_t byte_interval)
+    : allocation_interval_{byte_interval == 0 ? allocation_interval : 0},
+      byte_interval_{byte_interval}
+  {
+    if (byte_interval_ != 0) { bytes_until_sample_ = draw(); }
+  }
+
+  /**
+   * @briefreturn{true if any allocations are sampled}
+   */
+  [[nodiscard]] bool enabled() const noexcept
+  {
+    return allocation_interval_ != 0 or byte_interval_ != 0;
+  }
+
+  /**
+   * @brief Decides whether to sample an allocation of `bytes` bytes.
+   */
+  bool sample(std::size_t bytes)
+  {
+    if (allocation_interval_ != 0) {
+      return allocations_.fetch_add(1, std::memory_order_relaxed) % allocation_interval_ == 0;
+    }
+    if (byte_interval_ == 0) { return false; }
+
+    // The allocation that reaches the sample point restarts the countdown
+    auto remaining = bytes_until_sample_.load(std::memory_order_relaxed);
+    while (true) {
+      if (remaining > bytes) {
+        if (bytes_until_sample_.compare_exchange_weak(
+              remaining, remaining - bytes, std::memory_order_relaxed)) {
+          return false;
+        }
+      } else if (bytes_until_sample_.compare_exchange_weak(
+                   remaining, draw(), std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief The number of bytes that a sampled allocation of `bytes` bytes stands for, so that
+   * summing it over the sampled allocations estimates the bytes of all allocations.
+   */
+  [[nodiscard]] std::size_t estimate(std::size_t bytes) const noexcept
+  {
+    if (allocation_interval_ != 0) { return bytes * allocation_interval_; }
+    if (byte_interval_ == 0 or bytes == 0) { return bytes; }
+    // Divide by the probability of sampling the allocation
+    auto const ratio = static_cast<double>(bytes) / static_cast<double>(byte_interval_);
+    return static_cast<std::size_t>(std::llround(static_cast<double>(bytes) / -std::expm1(-ratio)));
+  }
+
+ private:
+  /// A countdown of at least one byte, with mean `byte_interval_`.
+  std::size_t draw()
+  {
+    std::lock_guard lock(mtx_);
+    std::exponential_distribution<double> distribution(1.0 / static_cast<double>(byte_interval_));
+    return static_cast<std::size_t>(distribution(generator_)) + 1;
+  }
+
+  std::size_t allocation_interval_;
+  std::size_t byte_interval_;
+  std::atomic<std::size_t> allocations_{0};
+  std::atomic<std::size_t> bytes_until_sample_{0};
+  std::mutex mtx_;             // guards generator_
+  std::mt19937_64 generator_;  // default seeded, so that runs are repeatable
+};
+
+}  // namespace rmm::mr::detail
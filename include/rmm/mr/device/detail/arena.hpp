@@ -42,6 +42,8 @@
 #include <rmm/detail/error.hpp>
 #include <rmm/detail/logging_assert.hpp>
 #include <rmm/logger.hpp>
+#include <rmm/mr/device/memory_snapshot.hpp>
+#include <rmm/mr/device/size_class_policy.hpp>
 
 #include <rmm/cuda_runtime_api.h>
 
@@ -49,27 +51,36 @@
 #include <spdlog/common.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <numeric>
 #include <optional>
 #include <set>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
 
 namespace rmm::mr::detail::arena {
 
+/// Number of size classes, including the catch-all class.
+inline constexpr std::size_t num_size_classes{117};
+
 /**
- * @brief Align up to nearest size class.
+ * @brief The size classes that allocations are aligned to, in ascending order.
  *
- * @param[in] value value to align.
- * @return Return the aligned value.
+ * @return The table of size classes.
  */
-inline std::size_t align_to_size_class(std::size_t value) noexcept
+inline std::array<std::size_t, num_size_classes> const& size_classes() noexcept
 {
   // See http://jemalloc.net/jemalloc.3.html.
   // NOLINTBEGIN(readability-magic-numbers,cppcoreguidelines-avoid-magic-numbers)
-  static std::array<std::size_t, 117> size_classes{
+  static std::array<std::size_t, num_size_classes> const classes{
     // clang-format off
     // Spacing 256:
     256UL, 512UL, 768UL, 1024UL, 1280UL, 1536UL, 1792UL, 2048UL,
@@ -82,7 +93,7 @@ inline std::size_t align_to_size_class(std::size_t value) noexcept
     // Spacing 4 KiB:
     20UL << 10, 24UL << 10, 28UL << 10, 32UL << 10,
     // Spacing 8 KiB:
-    40UL << 10, 48UL << 10, 54UL << 10, 64UL << 10,
+    40UL << 10, 48UL << 10, 56UL << 10, 64UL << 10,
     // Spacing 16 KiB:
     80UL << 10, 96UL << 10, 112UL << 10, 128UL << 10,
     // Spacing 32 KiB:
@@ -132,10 +143,51 @@ inline std::size_t align_to_size_class(std::size_t value) noexcept
     // clang-format on
   };
   // NOLINTEND(readability-magic-numbers,cppcoreguidelines-avoid-magic-numbers)
+  return classes;
+}
 
-  auto* bound = std::lower_bound(size_classes.begin(), size_classes.end(), value);
-  RMM_LOGGING_ASSERT(bound != size_classes.end());
-  return *bound;
+/**
+ * @brief Align up to nearest size class.
+ *
+ * The classes of `size_classes()` below the catch-all are spaced 4 per doubling, so the class is
+ * computed from the most significant bit of the value rather than searched for.
+ *
+ * @param[in] value value to align.
+ * @return Return the aligned value.
+ */
+inline std::size_t align_to_size_class(std::size_t value) noexcept
+{
+  constexpr std::size_t log2_classes_per_doubling{2};
+  auto const& classes = size_classes();
+  if (value > classes[num_size_classes - 2]) { return classes.back(); }
+  return rmm::mr::detail::align_to_geometric_class(value, log2_classes_per_doubling);
+}
+
+/**
+ * @brief Index in `size_classes()` of the size class of `value`.
+ *
+ * Like `align_to_size_class`, this uses the spacing of the classes instead of a search: the first
+ * 8 classes are 256 bytes apart, and each doubling above 2 KiB holds 4 more.
+ *
+ * @param[in] value value to classify.
+ * @return The index of `align_to_size_class(value)`.
+ */
+inline std::size_t size_class_index(std::size_t value) noexcept
+{
+  // NOLINTBEGIN(readability-magic-numbers,cppcoreguidelines-avoid-magic-numbers)
+  constexpr std::size_t num_linear_classes{8};
+  constexpr std::size_t log2_last_linear_class{11};
+  constexpr std::size_t log2_classes_per_doubling{2};
+  auto const aligned = align_to_size_class(value);
+  if (aligned == size_classes().back()) { return num_size_classes - 1; }
+  if (aligned <= size_classes()[num_linear_classes - 1]) {
+    return aligned / rmm::detail::CUDA_ALLOCATION_ALIGNMENT - 1;
+  }
+  // `aligned` lies in (2^msb, 2^(msb+1)], whose classes are 2^(msb-2) apart.
+  auto const msb = rmm::mr::detail::most_significant_bit(aligned - 1);
+  return num_linear_classes + ((msb - log2_last_linear_class) << log2_classes_per_doubling) +
+         ((aligned - 1) >> (msb - log2_classes_per_doubling)) - (1U << log2_classes_per_doubling);
+  // NOLINTEND(readability-magic-numbers,cppcoreguidelines-avoid-magic-numbers)
 }
 
 /**
@@ -188,8 +240,8 @@ class byte_span {
 };
 
 /// Calculate the total size of a set of spans.
-template <typename T>
-inline auto total_memory_size(std::set<T> const& spans)
+template <typename T, typename Compare>
+inline auto total_memory_size(std::set<T, Compare> const& spans)
 {
   return std::accumulate(
     spans.cbegin(), spans.cend(), std::size_t{}, [](auto const& lhs, auto const& rhs) {
@@ -200,7 +252,7 @@ inline auto total_memory_size(std::set<T> const& spans)
 /**
  * @brief Represents a chunk of memory that can be allocated and deallocated.
  */
-class block final : public byte_span {
+class block : public byte_span {
  public:
   using byte_span::byte_span;
 
@@ -268,9 +320,28 @@ inline bool block_size_compare(block const& lhs, block const& rhs)
   return lhs.size() < rhs.size();
 }
 
+/**
+ * @brief A free block of a superblock, also linked into the list of free blocks of its size class.
+ *
+ * The links take no part in the ordering, so they can be updated while the block is in a set.
+ */
+struct free_block final : block {
+  free_block(block const& blk) : block{blk} {}  // NOLINT(google-explicit-constructor)
+
+  mutable free_block const* prev{};  ///< The previous free block of the same size class
+  mutable free_block const* next{};  ///< The next free block of the same size class
+};
+
 /**
  * @brief Represents a large chunk of memory that is exchanged between the global arena and
  * per-thread arenas.
+ *
+ * Besides the address-ordered free list, which coalescing needs, the free blocks are threaded
+ * through one intrusive list per size class, the class of a block being the largest class of
+ * `size_classes()` not above its size. A bitmap of the non-empty lists lets `fits` and `best_fit`
+ * find the smallest class holding a block of at least the requested size with a few bit scans,
+ * without touching the blocks and without allocating beyond the address-ordered set. Only a size
+ * that lies strictly between two classes may have to search the list of the class below it.
  */
 class superblock final : public byte_span {
  public:
@@ -294,7 +365,7 @@ class superblock final : public byte_span {
   {
     RMM_LOGGING_ASSERT(size >= minimum_size);
     RMM_LOGGING_ASSERT(size <= maximum_size);
-    free_blocks_.emplace(pointer, size);
+    insert_free_block(free_blocks_.cend(), {pointer, size});
   }
 
   // Disable copy semantics.
@@ -351,9 +422,12 @@ class superblock final : public byte_span {
   [[nodiscard]] bool fits(std::size_t bytes) const
   {
     RMM_LOGGING_ASSERT(is_valid());
-    return std::any_of(free_blocks_.cbegin(), free_blocks_.cend(), [bytes](auto const& blk) {
-      return blk.fits(bytes);
-    });
+    auto const top = last_free_list();
+    if (top == num_free_lists) { return false; }
+    auto const index = size_class_index(bytes);
+    if (top >= index) { return true; }
+    // Only the class just below that of `bytes` can hold blocks both smaller and larger than it.
+    return top + 1 == index && size_classes()[index] != bytes && max_free_size() >= bytes;
   }
 
   /**
@@ -400,28 +474,39 @@ class superblock final : public byte_span {
   }
 
   /**
-   * @brief Get the first free block of at least `size` bytes.
+   * @brief Get a free block of at least `size` bytes from the smallest size class that has one.
    *
-   * @param size The number of bytes to allocate.
+   * This is best fit up to the granularity of the size classes: every block of the first
+   * non-empty class at or above the class of `size` fits, and the most recently freed one is
+   * taken. If there is none, the blocks of the class below are searched, which can only hold a fit
+   * if `size` lies strictly between two classes.
+   *
+   * @param size The number of bytes to allocate, a multiple of 256 like every arena allocation.
    * @return block A block of memory of at least `size` bytes, or an empty block if not found.
    */
-  block first_fit(std::size_t size)
+  block best_fit(std::size_t size)
   {
     RMM_LOGGING_ASSERT(is_valid());
     RMM_LOGGING_ASSERT(size > 0);
-
-    auto fits       = [size](auto const& blk) { return blk.fits(size); };
-    auto const iter = std::find_if(free_blocks_.cbegin(), free_blocks_.cend(), fits);
-    if (iter == free_blocks_.cend()) { return {}; }
+    RMM_LOGGING_ASSERT(rmm::detail::is_aligned(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT));
+
+    auto const index      = size_class_index(size);
+    auto const list       = first_free_list(index);
+    free_block const* fit = (list < num_free_lists) ? free_list_heads_[list] : nullptr;
+    if (fit == nullptr && index > 0 && size_classes()[index] != size) {
+      for (fit = free_list_heads_[index - 1]; fit != nullptr && fit->size() < size;
+           fit = fit->next) {}
+    }
+    if (fit == nullptr) { return {}; }
 
     // Remove the block from the free list.
-    auto const blk  = *iter;
-    auto const next = free_blocks_.erase(iter);
+    block const blk = *fit;
+    auto const next = erase_free_block(free_blocks_.find(blk));
 
     if (blk.size() > size) {
       // Split the block and put the remainder back.
       auto const split = blk.split(size);
-      free_blocks_.insert(next, split.second);
+      insert_free_block(next, split.second);
       return split.first;
     }
     return blk;
@@ -448,19 +533,19 @@ class superblock final : public byte_span {
 
     if (merge_prev && merge_next) {
       auto const merged = previous->merge(blk).merge(*next);
-      free_blocks_.erase(previous);
-      auto const iter = free_blocks_.erase(next);
-      free_blocks_.insert(iter, merged);
+      erase_free_block(previous);
+      auto const iter = erase_free_block(next);
+      insert_free_block(iter, merged);
     } else if (merge_prev) {
       auto const merged = previous->merge(blk);
-      auto const iter   = free_blocks_.erase(previous);
-      free_blocks_.insert(iter, merged);
+      auto const iter   = erase_free_block(previous);
+      insert_free_block(iter, merged);
     } else if (merge_next) {
       auto const merged = blk.merge(*next);
-      auto const iter   = free_blocks_.erase(next);
-      free_blocks_.insert(iter, merged);
+      auto const iter   = erase_free_block(next);
+      insert_free_block(iter, merged);
     } else {
-      free_blocks_.insert(next, blk);
+      insert_free_block(next, blk);
     }
   }
 
@@ -468,7 +553,7 @@ class superblock final : public byte_span {
    * @brief Find the total free block size.
    * @return the total free block size.
    */
-  [[nodiscard]] std::size_t total_free_size() const { return total_memory_size(free_blocks_); }
+  [[nodiscard]] std::size_t total_free_size() const { return free_bytes_; }
 
   /**
    * @brief Find the max free block size.
@@ -476,17 +561,148 @@ class superblock final : public byte_span {
    */
   [[nodiscard]] std::size_t max_free_size() const
   {
-    if (free_blocks_.empty()) { return 0; }
-    return std::max_element(free_blocks_.cbegin(), free_blocks_.cend(), block_size_compare)->size();
+    if (max_free_stale_) {
+      // The largest block is in the highest non-empty class.
+      max_free_       = 0;
+      auto const list = last_free_list();
+      if (list < num_free_lists) {
+        for (auto const* blk = free_list_heads_[list]; blk != nullptr; blk = blk->next) {
+          max_free_ = std::max(max_free_, blk->size());
+        }
+      }
+      max_free_stale_ = false;
+    }
+    return max_free_;
+  }
+
+  /**
+   * @brief The free blocks, in address order.
+   * @return the set of free blocks.
+   */
+  [[nodiscard]] std::set<free_block, std::less<>> const& free_block_set() const
+  {
+    return free_blocks_;
   }
 
  private:
+  using free_list = std::set<free_block, std::less<>>;
+
+  /// Number of size-class lists: one per class of `size_classes()` but the catch-all.
+  static constexpr std::size_t num_free_lists{num_size_classes - 1};
+  /// Number of lists per word of the bitmap.
+  static constexpr std::size_t bitmap_word_bits{std::numeric_limits<std::uint64_t>::digits};
+  /// Number of words of the bitmap.
+  static constexpr std::size_t bitmap_words{(num_free_lists + bitmap_word_bits - 1) /
+                                            bitmap_word_bits};
+
+  /// The size-class list of a free block: that of the largest class not above its size.
+  static std::size_t free_list_index(std::size_t size) noexcept
+  {
+    RMM_LOGGING_ASSERT(size >= size_classes().front());
+    auto const index = size_class_index(size);
+    return (index < num_free_lists && size_classes()[index] == size) ? index : index - 1;
+  }
+
+  /// The first non-empty size-class list at or above `index`, or `num_free_lists` if none.
+  [[nodiscard]] std::size_t first_free_list(std::size_t index) const noexcept
+  {
+    for (auto word = index / bitmap_word_bits; word < bitmap_words; ++word) {
+      auto bits = free_list_bitmap_[word];
+      if (word == index / bitmap_word_bits) {
+        bits &= ~std::uint64_t{0} << (index % bitmap_word_bits);
+      }
+      if (bits != 0) {
+        return word * bitmap_word_bits + static_cast<std::size_t>(__builtin_ctzll(bits));
+      }
+    }
+    return num_free_lists;
+  }
+
+  /// The last non-empty size-class list, or `num_free_lists` if there is none.
+  [[nodiscard]] std::size_t last_free_list() const noexcept
+  {
+    for (auto word = bitmap_words; word > 0; --word) {
+      if (auto const bits = free_list_bitmap_[word - 1]; bits != 0) {
+        return (word - 1) * bitmap_word_bits + rmm::mr::detail::most_significant_bit(bits);
+      }
+    }
+    return num_free_lists;
+  }
+
+  /// Insert a free block into the free list and the list of its size class.
+  void insert_free_block(free_list::const_iterator hint, block const& blk)
+  {
+    auto const& entry = *free_blocks_.emplace_hint(hint, blk);
+    auto const index  = free_list_index(blk.size());
+    entry.next        = free_list_heads_[index];
+    if (entry.next != nullptr) { entry.next->prev = &entry; }
+    free_list_heads_[index] = &entry;
+    free_list_bitmap_[index / bitmap_word_bits] |= std::uint64_t{1} << (index % bitmap_word_bits);
+    free_bytes_ += blk.size();
+    if (not max_free_stale_) { max_free_ = std::max(max_free_, blk.size()); }
+  }
+
+  /// Erase a free block from the free list and the list of its size class.
+  free_list::const_iterator erase_free_block(free_list::const_iterator iter)
+  {
+    auto const& entry = *iter;
+    auto const index  = free_list_index(entry.size());
+    if (entry.next != nullptr) { entry.next->prev = entry.prev; }
+    if (entry.prev != nullptr) {
+      entry.prev->next = entry.next;
+    } else {
+      free_list_heads_[index] = entry.next;
+      if (entry.next == nullptr) {
+        free_list_bitmap_[index / bitmap_word_bits] &=
+          ~(std::uint64_t{1} << (index % bitmap_word_bits));
+      }
+    }
+    free_bytes_ -= entry.size();
+    // The next largest block is only looked for if it is asked for.
+    if (entry.size() == max_free_) { max_free_stale_ = true; }
+    return free_blocks_.erase(iter);
+  }
+
   /// Address-ordered set of free blocks.
-  std::set<block> free_blocks_{};
+  free_list free_blocks_{};
+  /// The most recently inserted free block of each size class.
+  std::array<free_block const*, num_free_lists> free_list_heads_{};
+  /// Bit `i` is set if the list of size class `i` is not empty.
+  std::array<std::uint64_t, bitmap_words> free_list_bitmap_{};
+  /// Total size of the free blocks.
+  std::size_t free_bytes_{};
+  /// Size of the largest free block, unless `max_free_stale_`.
+  mutable std::size_t max_free_{};
+  /// Whether the largest free block was taken since `max_free_` was computed.
+  mutable bool max_free_stale_{};
 };
 
+/**
+ * @brief Address-ordered set of superblocks.
+ *
+ * The comparator is transparent so that the superblock containing a block can be found by address
+ * with `find_containing`, without constructing a superblock key.
+ */
+using superblock_set = std::set<superblock, std::less<>>;
+
+/**
+ * @brief Find the superblock containing the given block in O(log n).
+ *
+ * @param superblocks The set of superblocks to search.
+ * @param blk The block to search for.
+ * @return Iterator to the superblock containing `blk`, or `superblocks.end()` if none does.
+ */
+inline superblock_set::iterator find_containing(superblock_set& superblocks, block const& blk)
+{
+  // The last superblock starting at or before the block is the only one that can contain it.
+  auto iter = superblocks.upper_bound(blk);
+  if (iter == superblocks.begin()) { return superblocks.end(); }
+  --iter;
+  return iter->contains(blk) ? iter : superblocks.end();
+}
+
 /// Calculate the total free size of a set of superblocks.
-inline auto total_free_size(std::set<superblock> const& superblocks)
+inline auto total_free_size(superblock_set const& superblocks)
 {
   return std::accumulate(
     superblocks.cbegin(), superblocks.cend(), std::size_t{}, [](auto const& lhs, auto const& rhs) {
@@ -495,7 +711,7 @@ inline auto total_free_size(std::set<superblock> const& superblocks)
 }
 
 /// Find the max free size from a set of superblocks.
-inline auto max_free_size(std::set<superblock> const& superblocks)
+inline auto max_free_size(superblock_set const& superblocks)
 {
   std::size_t size{};
   for (auto const& sblk : superblocks) {
@@ -504,11 +720,180 @@ inline auto max_free_size(std::set<superblock> const& superblocks)
   return size;
 };
 
+/// The address of `ptr` as an integer, for snapshots.
+inline std::uintptr_t address_of(void const* ptr)
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<std::uintptr_t>(ptr);
+}
+
+/**
+ * @brief Summarize a set of superblocks into a snapshot's free list.
+ *
+ * The summaries take O(1) per superblock. Free extents are listed in address order until
+ * `max_extents` is exhausted, which is decreased by the number listed.
+ *
+ * @param superblocks The superblocks to summarize.
+ * @param list The free list to fill.
+ * @param max_extents The number of free extents that may still be listed.
+ * @return bool true if all free extents were listed.
+ */
+inline bool snapshot_superblocks(superblock_set const& superblocks,
+                                 memory_snapshot::free_list& list,
+                                 std::size_t& max_extents)
+{
+  bool complete{true};
+  list.superblocks.reserve(superblocks.size());
+  for (auto const& sblk : superblocks) {
+    auto const free_bytes   = sblk.total_free_size();
+    auto const largest_free = sblk.max_free_size();
+    list.superblocks.push_back({address_of(sblk.pointer()),
+                                sblk.size(),
+                                free_bytes,
+                                largest_free,
+                                sblk.free_blocks()});
+    list.free_bytes += free_bytes;
+    list.largest_free = std::max(list.largest_free, largest_free);
+    list.free_blocks += sblk.free_blocks();
+    for (auto const& blk : sblk.free_block_set()) {
+      if (max_extents == 0) {
+        complete = false;
+        break;
+      }
+      list.extents.push_back({address_of(blk.pointer()), blk.size()});
+      --max_extents;
+    }
+  }
+  return complete;
+}
+
+/**
+ * @brief A block freed by a thread other than the owner of its arena, waiting in the arena's
+ * remote-free queue.
+ */
+struct remote_free {
+  void* ptr{};                             ///< The freed block
+  std::size_t size{};                      ///< The size of the freed block
+  cudaEvent_t event{};                     ///< Created on first use, then reused with the node
+  bool recorded{};                         ///< Whether `event` was recorded after the free
+  remote_free* next{};                     ///< The next node of a remote-free queue
+  std::atomic<std::uint32_t> next_free{};  ///< The next node of the pool's free stack
+};
+
+/**
+ * @brief A fixed pool of `remote_free` nodes, shared by all arenas of a global arena.
+ *
+ * Nodes are preallocated, so that queuing a cross-thread free does not call the host allocator.
+ * Free nodes are kept on a lock-free stack whose head packs a node index with a tag that changes
+ * on every update, which rules out the ABA problem of concurrent pops. When all nodes are in use,
+ * `acquire` fails and the freeing thread falls back to synchronizing its stream.
+ */
+class remote_free_pool {
+ public:
+  /// Default number of nodes.
+  static constexpr std::size_t default_capacity{1024};
+
+  /**
+   * @brief Construct a pool of `capacity` nodes.
+   *
+   * @param capacity The number of nodes
+   */
+  explicit remote_free_pool(std::size_t capacity = default_capacity)
+    : nodes_{std::make_unique<remote_free[]>(capacity)}, capacity_{capacity}
+  {
+    RMM_EXPECTS(capacity < none, "Too many remote-free nodes.");
+    for (std::size_t i = 0; i < capacity; ++i) {
+      auto const next = (i + 1 == capacity) ? none : static_cast<std::uint32_t>(i + 1);
+      nodes_[i].next_free.store(next, std::memory_order_relaxed);
+    }
+    head_.store(capacity == 0 ? none : 0, std::memory_order_relaxed);
+  }
+
+  ~remote_free_pool()
+  {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      auto* const event = nodes_[i].event;
+      if (event != nullptr) { RMM_ASSERT_CUDA_SUCCESS(cudaEventDestroy(event)); }
+    }
+  }
+
+  // Disable copy (and move) semantics.
+  remote_free_pool(remote_free_pool const&)            = delete;
+  remote_free_pool& operator=(remote_free_pool const&) = delete;
+  remote_free_pool(remote_free_pool&&)                 = delete;
+  remote_free_pool& operator=(remote_free_pool&&)      = delete;
+
+  /**
+   * @brief Takes a free node from the pool.
+   *
+   * @return remote_free* The node, or nullptr if all nodes are in use.
+   */
+  remote_free* acquire() noexcept
+  {
+    auto head = head_.load(std::memory_order_acquire);
+    while (index_of(head) != none) {
+      auto const next = nodes_[index_of(head)].next_free.load(std::memory_order_relaxed);
+      if (head_.compare_exchange_weak(
+            head, pack(next, head), std::memory_order_acquire, std::memory_order_acquire)) {
+        return &nodes_[index_of(head)];
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Returns a node taken by `acquire` to the pool.
+   *
+   * @param node The node
+   */
+  void release(remote_free* node) noexcept
+  {
+    auto const index = static_cast<std::uint32_t>(node - nodes_.get());
+    auto head        = head_.load(std::memory_order_relaxed);
+    do {
+      node->next_free.store(index_of(head), std::memory_order_relaxed);
+    } while (!head_.compare_exchange_weak(
+      head, pack(index, head), std::memory_order_release, std::memory_order_relaxed));
+  }
+
+ private:
+  static constexpr std::uint32_t none{std::numeric_limits<std::uint32_t>::max()};
+
+  static std::uint32_t index_of(std::uint64_t head) noexcept
+  {
+    return static_cast<std::uint32_t>(head);
+  }
+
+  /// Packs `index` with the tag of `previous` incremented.
+  static std::uint64_t pack(std::uint32_t index, std::uint64_t previous) noexcept
+  {
+    return (((previous >> 32U) + 1) << 32U) | index;
+  }
+
+  std::unique_ptr<remote_free[]> nodes_;  // NOLINT(cppcoreguidelines-avoid-c-arrays)
+  std::size_t capacity_;
+  std::atomic<std::uint64_t> head_{};
+};
+
+template <typename Upstream>
+class arena;
+
 /**
  * @brief The global arena for allocating memory from the upstream memory resource.
  *
  * The global arena is a shared memory pool from which other arenas allocate superblocks.
  *
+ * The arena starts as a single region allocated from upstream. If a maximum size larger than the
+ * initial size is given, `grow` adds further regions on demand, each at least as large as the
+ * initial region. Superblocks are only coalesced within a region. With a release threshold, a
+ * region that becomes entirely free is returned to upstream as long as the arena stays at least
+ * as large as the threshold.
+ *
+ * Superblocks are split at multiples of `superblock::minimum_size` from the start of their region,
+ * so every such "page" of a region lies in exactly one superblock. The arena records the owner of
+ * each page, so that the arena holding any pointer is found by `owner_of` with one lookup of the
+ * region.
+ *
  * @tparam Upstream Memory resource to use for allocating the arena. Implements
  * rmm::mr::device_memory_resource interface.
  */
@@ -520,19 +905,32 @@ class global_arena final {
    *
    * @throws rmm::logic_error if `upstream_mr == nullptr`.
    *
+   * @throws rmm::logic_error if `maximum_size` is smaller than the initial size.
+   *
    * @param upstream_mr The memory resource from which to allocate blocks for the pool
-   * @param arena_size Size in bytes of the global arena. Defaults to half of the available memory
-   * on the current device.
+   * @param arena_size Initial size in bytes of the global arena. Defaults to half of the available
+   * memory on the current device.
+   * @param maximum_size Size in bytes that the global arena can grow to. Defaults to the initial
+   * size, i.e. the arena does not grow.
+   * @param release_threshold Size in bytes above which entirely free regions are returned to
+   * upstream. By default regions are only released on destruction.
    */
-  global_arena(Upstream* upstream_mr, std::optional<std::size_t> arena_size)
-    : upstream_mr_{upstream_mr}
+  global_arena(Upstream* upstream_mr,
+               std::optional<std::size_t> arena_size,
+               std::optional<std::size_t> maximum_size      = std::nullopt,
+               std::optional<std::size_t> release_threshold = std::nullopt)
+    : upstream_mr_{upstream_mr}, release_threshold_{release_threshold}
   {
     RMM_EXPECTS(nullptr != upstream_mr_, "Unexpected null upstream pointer.");
     auto const size = rmm::detail::align_down(arena_size.value_or(default_size()),
                                               rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
     RMM_EXPECTS(size >= superblock::minimum_size,
                 "Arena size smaller than minimum superblock size.");
-    initialize(size);
+    region_size_  = size;
+    maximum_size_ = rmm::detail::align_down(maximum_size.value_or(size),
+                                            rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+    RMM_EXPECTS(maximum_size_ >= size, "Maximum arena size smaller than initial arena size.");
+    add_region(size);
   }
 
   // Disable copy (and move) semantics.
@@ -548,7 +946,64 @@ class global_arena final {
   ~global_arena()
   {
     std::lock_guard lock(mtx_);
-    upstream_mr_->deallocate(upstream_block_.pointer(), upstream_block_.size());
+    for (auto const& [start, reg] : regions_) {
+      upstream_mr_->deallocate(reg.upstream.pointer(), reg.upstream.size());
+    }
+  }
+
+  /**
+   * @brief The size in bytes of the global arena.
+   *
+   * @return std::size_t The total size of the regions allocated from upstream
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief The size in bytes that the global arena can grow to.
+   *
+   * @return std::size_t The maximum size of the global arena
+   */
+  [[nodiscard]] std::size_t maximum_size() const noexcept { return maximum_size_; }
+
+  /**
+   * @brief The number of regions allocated from upstream.
+   *
+   * @return std::size_t The number of regions
+   */
+  [[nodiscard]] std::size_t num_regions() const
+  {
+    std::lock_guard lock(mtx_);
+    return regions_.size();
+  }
+
+  /**
+   * @brief Grow the arena by a region that can serve an allocation of `size` bytes.
+   *
+   * The region is as large as the initial arena, or as the allocation if that is larger, but never
+   * takes the arena beyond its maximum size. If upstream cannot supply such a region, a region
+   * just large enough for the allocation is tried.
+   *
+   * @param size The size in bytes of the allocation that could not be satisfied.
+   * @return bool true if a region was added, false if the arena is at its maximum size or upstream
+   * is out of memory.
+   */
+  bool grow(std::size_t size)
+  {
+    std::lock_guard lock(mtx_);
+    auto const needed =
+      rmm::detail::align_up(std::max(size, superblock::minimum_size), superblock::minimum_size);
+    auto const remaining = maximum_size_ - this->size();
+    if (needed > remaining) { return false; }
+    auto const preferred = std::min(std::max(needed, region_size_), remaining);
+    for (auto const region_size : {preferred, needed}) {
+      try {
+        add_region(region_size);
+        return true;
+      } catch (std::exception const&) {
+        if (region_size == needed) { break; }
+      }
+    }
+    return false;
   }
 
   /**
@@ -563,14 +1018,17 @@ class global_arena final {
    * @brief Acquire a superblock that can fit a block of the given size.
    *
    * @param size The size in bytes of the allocation.
+   * @param owner The arena acquiring the superblock, recorded for `owner_of`.
    * @return superblock The acquired superblock.
    */
-  superblock acquire(std::size_t size)
+  superblock acquire(std::size_t size, arena<Upstream>* owner = nullptr)
   {
     // Superblocks should only be acquired if the size is not directly handled by the global arena.
     RMM_LOGGING_ASSERT(!handles(size));
     std::lock_guard lock(mtx_);
-    return first_fit(size);
+    auto sblk = first_fit(size);
+    if (sblk.is_valid()) { set_owner(sblk, owner); }
+    return sblk;
   }
 
   /**
@@ -582,6 +1040,7 @@ class global_arena final {
   {
     RMM_LOGGING_ASSERT(sblk.is_valid());
     std::lock_guard lock(mtx_);
+    set_owner(sblk, nullptr);
     coalesce(std::move(sblk));
   }
 
@@ -590,16 +1049,40 @@ class global_arena final {
    *
    * @param superblocks The set of superblocks.
    */
-  void release(std::set<superblock>& superblocks)
+  void release(superblock_set& superblocks)
   {
     std::lock_guard lock(mtx_);
     while (!superblocks.empty()) {
       auto sblk = std::move(superblocks.extract(superblocks.cbegin()).value());
       RMM_LOGGING_ASSERT(sblk.is_valid());
+      set_owner(sblk, nullptr);
       coalesce(std::move(sblk));
     }
   }
 
+  /**
+   * @brief The nodes for the remote-free queues of the arenas allocating from this global arena.
+   *
+   * @return remote_free_pool& The pool of nodes.
+   */
+  remote_free_pool& remote_frees() noexcept { return remote_frees_; }
+
+  /**
+   * @brief Find the arena holding the superblock that contains `ptr`.
+   *
+   * @param ptr Pointer to look up.
+   * @return arena<Upstream>* The owning arena, or nullptr if the superblock is held by the global
+   * arena or `ptr` is outside the global arena.
+   */
+  arena<Upstream>* owner_of(void const* ptr) const
+  {
+    auto const* const cptr = static_cast<char const*>(ptr);
+    std::shared_lock lock(mtx_);
+    auto const reg = region_of(regions_, cptr);
+    if (reg == regions_.end()) { return nullptr; }
+    return reg->second.owners[reg->second.page_index(cptr)];
+  }
+
   /**
    * @brief Allocate a large block directly.
    *
@@ -612,7 +1095,7 @@ class global_arena final {
     std::lock_guard lock(mtx_);
     auto sblk = first_fit(size);
     if (sblk.is_valid()) {
-      auto blk = sblk.first_fit(size);
+      auto blk = sblk.best_fit(size);
       superblocks_.insert(std::move(sblk));
       return blk.pointer();
     }
@@ -648,21 +1131,40 @@ class global_arena final {
     std::lock_guard lock(mtx_);
 
     block const blk{ptr, bytes};
-    auto const iter = std::find_if(superblocks_.cbegin(),
-                                   superblocks_.cend(),
-                                   [&](auto const& sblk) { return sblk.contains(blk); });
-    if (iter == superblocks_.cend()) { return false; }
+    auto const iter = find_containing(superblocks_, blk);
+    if (iter == superblocks_.end()) { return false; }
 
-    auto sblk = std::move(superblocks_.extract(iter).value());
-    sblk.coalesce(blk);
-    if (sblk.empty()) {
-      coalesce(std::move(sblk));
+    auto node = superblocks_.extract(iter);
+    node.value().coalesce(blk);
+    if (node.value().empty()) {
+      coalesce(std::move(node.value()));
     } else {
-      superblocks_.insert(std::move(sblk));
+      superblocks_.insert(std::move(node));
     }
     return true;
   }
 
+  /**
+   * @brief Add the regions and the superblocks held by the global arena to `snap`.
+   *
+   * @param snap The snapshot to fill.
+   * @param max_extents The number of free extents that may still be listed, decreased by the
+   * number listed.
+   */
+  void snapshot(memory_snapshot& snap, std::size_t& max_extents) const
+  {
+    std::lock_guard lock(mtx_);
+    snap.total_bytes = size();
+    snap.regions.reserve(regions_.size());
+    for (auto const& [start, reg] : regions_) {
+      snap.regions.push_back({address_of(reg.upstream.pointer()), reg.upstream.size()});
+    }
+    memory_snapshot::free_list list{"global"};
+    bool const complete = snapshot_superblocks(superblocks_, list, max_extents);
+    snap.complete       = snap.complete && complete;
+    snap.add(std::move(list));
+  }
+
   /**
    * @brief Dump memory to log.
    *
@@ -672,7 +1174,8 @@ class global_arena final {
   {
     std::lock_guard lock(mtx_);
 
-    logger->info("  Arena size: {}", rmm::detail::bytes{upstream_block_.size()});
+    logger->info("  Arena size: {}", rmm::detail::bytes{size()});
+    logger->info("  # regions: {}", regions_.size());
     logger->info("  # superblocks: {}", superblocks_.size());
     if (!superblocks_.empty()) {
       logger->debug("  Total size of superblocks: {}",
@@ -716,15 +1219,78 @@ class global_arena final {
     return free / 2;
   }
 
+  /// A contiguous allocation from upstream backing part of the arena.
+  struct region {
+    /// The memory allocated from upstream.
+    block upstream;
+    /// Owning arena of each page of the region, or nullptr if held by the global arena.
+    std::vector<arena<Upstream>*> owners;
+
+    /// The index in `owners` of the page containing `ptr`.
+    [[nodiscard]] std::size_t page_index(char const* ptr) const
+    {
+      return static_cast<std::size_t>(ptr - upstream.pointer()) / superblock::minimum_size;
+    }
+  };
+
+  /// Regions keyed by their start address.
+  using region_map = std::map<char*, region, std::less<>>;
+
   /**
-   * @brief Allocate space from upstream to initialize the arena.
+   * @brief Allocate a region from upstream and add it to the arena as one superblock.
    *
    * @param size The size to allocate.
    */
-  void initialize(std::size_t size)
+  void add_region(std::size_t size)
+  {
+    auto* const ptr = static_cast<char*>(upstream_mr_->allocate(size));
+    auto const pages =
+      rmm::detail::align_up(size, superblock::minimum_size) / superblock::minimum_size;
+    regions_.emplace(ptr, region{{ptr, size}, std::vector<arena<Upstream>*>(pages, nullptr)});
+    superblocks_.emplace(ptr, size);
+    size_.fetch_add(size, std::memory_order_relaxed);
+  }
+
+  /// The region of `regions` containing `ptr`, or `regions.end()` if none does.
+  template <typename RegionMap>
+  static auto region_of(RegionMap& regions, char const* ptr)
+  {
+    auto iter = regions.upper_bound(ptr);
+    if (iter == regions.begin()) { return regions.end(); }
+    --iter;
+    return ptr < iter->second.upstream.end() ? iter : regions.end();
+  }
+
+  /// Record `owner` as the owner of every page of `sblk`.
+  void set_owner(superblock const& sblk, arena<Upstream>* owner)
+  {
+    auto const reg = region_of(regions_, sblk.pointer());
+    RMM_LOGGING_ASSERT(reg != regions_.end());
+    auto& owners = reg->second.owners;
+    auto const first =
+      owners.begin() + static_cast<std::ptrdiff_t>(reg->second.page_index(sblk.pointer()));
+    auto const last =
+      owners.begin() + static_cast<std::ptrdiff_t>(reg->second.page_index(sblk.end() - 1));
+    std::fill(first, std::next(last), owner);
+  }
+
+  /**
+   * @brief Return the region covered by the superblock at `iter` to upstream if the superblock is
+   * empty and the arena stays at least as large as the release threshold.
+   *
+   * @param iter The superblock to check.
+   */
+  void release_region_if_free(superblock_set::iterator iter)
   {
-    upstream_block_ = {upstream_mr_->allocate(size), size};
-    superblocks_.emplace(upstream_block_.pointer(), size);
+    if (!release_threshold_.has_value() || !iter->empty()) { return; }
+    auto const reg = regions_.find(iter->pointer());
+    if (reg == regions_.end() || reg->second.upstream.size() != iter->size()) { return; }
+    if (size() < release_threshold_.value() + iter->size()) { return; }
+
+    upstream_mr_->deallocate(reg->second.upstream.pointer(), reg->second.upstream.size());
+    size_.fetch_sub(reg->second.upstream.size(), std::memory_order_relaxed);
+    superblocks_.erase(iter);
+    regions_.erase(reg);
   }
 
   /**
@@ -748,8 +1314,10 @@ class global_arena final {
                                    [=](auto const& sblk) { return sblk.fits(size); });
     if (iter == superblocks_.cend()) { return {}; }
 
-    auto sblk           = std::move(superblocks_.extract(iter).value());
-    auto const min_size = std::max(superblock::minimum_size, size);
+    auto sblk = std::move(superblocks_.extract(iter).value());
+    // Split at a page boundary, so that pages never straddle superblocks
+    auto const min_size =
+      rmm::detail::align_up(std::max(superblock::minimum_size, size), superblock::minimum_size);
     if (sblk.empty() && sblk.size() >= min_size + superblock::minimum_size) {
       // Split the superblock and put the remainder back.
       auto [head, tail] = sblk.split(min_size);
@@ -772,36 +1340,53 @@ class global_arena final {
     auto const next     = superblocks_.lower_bound(sblk);
     auto const previous = next == superblocks_.cbegin() ? next : std::prev(next);
 
-    // Coalesce with neighboring blocks.
-    bool const merge_prev = previous != superblocks_.cend() && previous->is_contiguous_before(sblk);
-    bool const merge_next = next != superblocks_.cend() && sblk.is_contiguous_before(*next);
+    // Coalesce with neighboring blocks in the same region.
+    auto const reg = region_of(regions_, sblk.pointer());
+    RMM_LOGGING_ASSERT(reg != regions_.end());
+    bool const merge_prev = previous != superblocks_.cend() &&
+                            previous->is_contiguous_before(sblk) &&
+                            previous->pointer() >= reg->second.upstream.pointer();
+    bool const merge_next = next != superblocks_.cend() && sblk.is_contiguous_before(*next) &&
+                            next->end() <= reg->second.upstream.end();
 
+    superblock_set::iterator iter;
     if (merge_prev && merge_next) {
       auto prev_sb = std::move(superblocks_.extract(previous).value());
       auto next_sb = std::move(superblocks_.extract(next).value());
       auto merged  = prev_sb.merge(sblk).merge(next_sb);
-      superblocks_.insert(std::move(merged));
+      iter         = superblocks_.insert(std::move(merged)).first;
     } else if (merge_prev) {
       auto prev_sb = std::move(superblocks_.extract(previous).value());
       auto merged  = prev_sb.merge(sblk);
-      superblocks_.insert(std::move(merged));
+      iter         = superblocks_.insert(std::move(merged)).first;
     } else if (merge_next) {
       auto next_sb = std::move(superblocks_.extract(next).value());
       auto merged  = sblk.merge(next_sb);
-      superblocks_.insert(std::move(merged));
+      iter         = superblocks_.insert(std::move(merged)).first;
     } else {
-      superblocks_.insert(std::move(sblk));
+      iter = superblocks_.insert(std::move(sblk)).first;
     }
+    release_region_if_free(iter);
   }
 
   /// The upstream resource to allocate memory from.
   Upstream* upstream_mr_;
-  /// Block allocated from upstream so that it can be quickly freed.
-  block upstream_block_;
+  /// Regions allocated from upstream, so that they can be quickly freed.
+  region_map regions_;
+  /// Total size of the regions, readable without the lock.
+  std::atomic<std::size_t> size_{};
+  /// Minimum size of a region added by `grow`.
+  std::size_t region_size_{};
+  /// Size that the arena can grow to.
+  std::size_t maximum_size_{};
+  /// Size above which entirely free regions are returned to upstream, if set.
+  std::optional<std::size_t> release_threshold_;
   /// Address-ordered set of superblocks.
-  std::set<superblock> superblocks_;
-  /// Mutex for exclusive lock.
-  mutable std::mutex mtx_;
+  superblock_set superblocks_;
+  /// Mutex for exclusive lock, shared by `owner_of` lookups.
+  mutable std::shared_mutex mtx_;
+  /// Nodes for the remote-free queues of all arenas.
+  remote_free_pool remote_frees_;
 };
 
 /**
@@ -829,11 +1414,17 @@ class arena {
   arena(arena&&) noexcept            = delete;
   arena& operator=(arena&&) noexcept = delete;
 
-  ~arena() = default;
+  /**
+   * @brief Destroy the arena, returning the blocks still queued by other threads and all
+   * superblocks to the global arena.
+   */
+  ~arena() { clean_on_exit(); }
 
   /**
    * @brief Allocates memory of size at least `size` bytes.
    *
+   * Blocks freed into this arena by other threads are reclaimed first.
+   *
    * @param size The size in bytes of the allocation.
    * @return void* Pointer to the newly allocated memory.
    */
@@ -841,9 +1432,63 @@ class arena {
   {
     if (global_arena_.handles(size)) { return global_arena_.allocate(size); }
     std::lock_guard lock(mtx_);
+    drain_remote_frees();
     return get_block(size).pointer();
   }
 
+  /**
+   * @brief Queue a block of this arena that is freed by another thread on `stream`.
+   *
+   * An event is recorded on `stream`, and the block is pushed onto a lock-free queue in O(1) with
+   * a node from the global arena's pool, without taking the arena's lock or waiting for the
+   * stream. The block is returned to its superblock on the arena's next allocation,
+   * defragmentation or cleaning after the event has completed.
+   *
+   * @param ptr Pointer to be deallocated.
+   * @param size The size in bytes of the allocation. This must be equal to the value of `size`
+   * that was passed to the `allocate` call that returned `ptr`.
+   * @param stream Stream on which to perform deallocation.
+   * @return bool true if the block was queued, false if no node was free or the event could not
+   * be recorded, in which case the caller must free the block some other way.
+   */
+  bool free_remote(void* ptr, std::size_t size, cuda_stream_view stream)
+  {
+    auto* node = global_arena_.remote_frees().acquire();
+    if (node == nullptr) { return false; }
+    if ((node->event == nullptr &&
+         cudaEventCreateWithFlags(&node->event, cudaEventDisableTiming) != cudaSuccess) ||
+        cudaEventRecord(node->event, stream.value()) != cudaSuccess) {
+      static_cast<void>(cudaGetLastError());
+      global_arena_.remote_frees().release(node);
+      return false;
+    }
+    node->ptr      = ptr;
+    node->size     = size;
+    node->recorded = true;
+    push_remote(node);
+    return true;
+  }
+
+  /**
+   * @brief Queue a block of this arena that is freed by another thread and no longer in use on
+   * any stream.
+   *
+   * @param ptr Pointer to be deallocated.
+   * @param size The size in bytes of the allocation. This must be equal to the value of `size`
+   * that was passed to the `allocate` call that returned `ptr`.
+   * @return bool true if the block was queued, false if no node was free.
+   */
+  bool free_remote(void* ptr, std::size_t size)
+  {
+    auto* node = global_arena_.remote_frees().acquire();
+    if (node == nullptr) { return false; }
+    node->ptr      = ptr;
+    node->size     = size;
+    node->recorded = false;
+    push_remote(node);
+    return true;
+  }
+
   /**
    * @brief Deallocate memory pointed to by `ptr`, and possibly return superblocks to upstream.
    *
@@ -855,8 +1500,27 @@ class arena {
    */
   bool deallocate(void* ptr, std::size_t size, cuda_stream_view stream)
   {
+    bool emptied{};
+    return deallocate(ptr, size, stream, emptied);
+  }
+
+  /**
+   * @brief Deallocate memory pointed to by `ptr`, and report whether this emptied a superblock of
+   * the arena.
+   *
+   * @param ptr Pointer to be deallocated.
+   * @param size The size in bytes of the allocation. This must be equal to the value of `size`
+   * that was passed to the `allocate` call that returned `p`.
+   * @param stream Stream on which to perform deallocation.
+   * @param emptied Set to true if the block was returned to a superblock that is now empty.
+   * @return bool true if the allocation is found, false otherwise.
+   */
+  bool deallocate(void* ptr, std::size_t size, cuda_stream_view stream, bool& emptied)
+  {
+    emptied = false;
     if (global_arena_.handles(size) && global_arena_.deallocate(ptr, size, stream)) { return true; }
-    return deallocate(ptr, size);
+    std::lock_guard lock(mtx_);
+    return deallocate_from_superblock({ptr, size}, emptied);
   }
 
   /**
@@ -873,22 +1537,80 @@ class arena {
     return deallocate_from_superblock({ptr, size});
   }
 
+  /**
+   * @brief Return the blocks freed into this arena by other threads to their superblocks.
+   *
+   * Blocks whose frees are still pending on the freeing streams stay queued.
+   */
+  void reclaim_remote_frees()
+  {
+    std::lock_guard lock(mtx_);
+    drain_remote_frees();
+  }
+
+  /**
+   * @brief Returns the total free size of the arena's superblocks.
+   *
+   * @return std::size_t The free bytes held by the arena.
+   */
+  [[nodiscard]] std::size_t free_size() const
+  {
+    std::lock_guard lock(mtx_);
+    return total_free_size(superblocks_);
+  }
+
+  /**
+   * @brief Summarize the arena's superblocks into `list`.
+   *
+   * Blocks queued by other threads and not yet reclaimed are not counted as free.
+   *
+   * @param list The free list to fill.
+   * @param max_extents The number of free extents that may still be listed, decreased by the
+   * number listed.
+   * @return bool true if all free extents were listed.
+   */
+  bool snapshot(memory_snapshot::free_list& list, std::size_t& max_extents) const
+  {
+    std::lock_guard lock(mtx_);
+    return snapshot_superblocks(superblocks_, list, max_extents);
+  }
+
   /**
    * @brief Clean the arena and release all superblocks to the global arena.
    */
   void clean()
   {
     std::lock_guard lock(mtx_);
+    drain_remote_frees();
+    global_arena_.release(superblocks_);
+    superblocks_.clear();
+  }
+
+  /**
+   * @brief Clean the arena when its owner is gone, and release all superblocks to the global
+   * arena.
+   *
+   * Unlike `clean`, this waits for the frees still queued by other threads and returns their
+   * blocks, since no allocation from this arena will drain the queue again.
+   */
+  void clean_on_exit()
+  {
+    std::lock_guard lock(mtx_);
+    drain_remote_frees(true);
     global_arena_.release(superblocks_);
     superblocks_.clear();
   }
 
   /**
    * @brief Defragment the arena and release empty superblock to the global arena.
+   *
+   * The caller must make sure that no pending work on the arena's stream uses blocks freed into
+   * the arena, since the released superblocks can be acquired by other streams at once.
    */
   void defragment()
   {
     std::lock_guard lock(mtx_);
+    drain_remote_frees();
     while (true) {
       auto const iter = std::find_if(
         superblocks_.cbegin(), superblocks_.cend(), [](auto const& sblk) { return sblk.empty(); });
@@ -934,9 +1656,10 @@ class arena {
                                    [size](auto const& sblk) { return sblk.fits(size); });
     if (iter == superblocks_.cend()) { return {}; }
 
-    auto sblk      = std::move(superblocks_.extract(iter).value());
-    auto const blk = sblk.first_fit(size);
-    superblocks_.insert(std::move(sblk));
+    // Update the superblock through its node, so that it is neither moved nor reallocated.
+    auto node      = superblocks_.extract(iter);
+    auto const blk = node.value().best_fit(size);
+    superblocks_.insert(std::move(node));
     return blk;
   }
 
@@ -944,22 +1667,84 @@ class arena {
    * @brief Deallocate a block from the superblock it belongs to.
    *
    * @param blk The block to deallocate.
-   * @param stream The stream to use for deallocation.
+   * @param emptied Set to true if the superblock is empty after the block is returned to it.
    * @return true if the block is found.
    */
-  bool deallocate_from_superblock(block const& blk)
+  bool deallocate_from_superblock(block const& blk, bool& emptied)
   {
-    auto const iter = std::find_if(superblocks_.cbegin(),
-                                   superblocks_.cend(),
-                                   [&](auto const& sblk) { return sblk.contains(blk); });
-    if (iter == superblocks_.cend()) { return false; }
+    auto const iter = find_containing(superblocks_, blk);
+    if (iter == superblocks_.end()) { return false; }
 
-    auto sblk = std::move(superblocks_.extract(iter).value());
-    sblk.coalesce(blk);
-    superblocks_.insert(std::move(sblk));
+    auto node = superblocks_.extract(iter);
+    node.value().coalesce(blk);
+    emptied = node.value().empty();
+    superblocks_.insert(std::move(node));
     return true;
   }
 
+  /**
+   * @brief Deallocate a block from the superblock it belongs to.
+   *
+   * @param blk The block to deallocate.
+   * @return true if the block is found.
+   */
+  bool deallocate_from_superblock(block const& blk)
+  {
+    bool emptied{};
+    return deallocate_from_superblock(blk, emptied);
+  }
+
+  /**
+   * @brief Push a node onto the remote-free queue.
+   */
+  void push_remote(remote_free* node)
+  {
+    node->next = remote_frees_.load(std::memory_order_relaxed);
+    while (!remote_frees_.compare_exchange_weak(
+      node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+  }
+
+  /**
+   * @brief Return the blocks queued by `free_remote` whose events have completed to their
+   * superblocks, and queue the others again, or wait for them.
+   *
+   * A block whose superblock has meanwhile been released to the global arena is freed there, or
+   * its node is moved to the queue of the arena that has since acquired the superblock.
+   *
+   * @param wait Whether to wait for the events of pending frees instead of queuing them again.
+   */
+  void drain_remote_frees(bool wait = false)
+  {
+    if (remote_frees_.load(std::memory_order_relaxed) == nullptr) { return; }
+    auto* node = remote_frees_.exchange(nullptr, std::memory_order_acquire);
+    remote_free* pending{};
+    while (node != nullptr) {
+      auto* next = std::exchange(node->next, nullptr);
+      if (node->recorded && wait) {
+        RMM_ASSERT_CUDA_SUCCESS(cudaEventSynchronize(node->event));
+      } else if (node->recorded && cudaEventQuery(node->event) == cudaErrorNotReady) {
+        node->next = pending;
+        pending    = node;
+        node       = next;
+        continue;
+      }
+      if (deallocate_from_superblock({node->ptr, node->size})) {
+        global_arena_.remote_frees().release(node);
+      } else if (auto* owner = global_arena_.owner_of(node->ptr);
+                 owner != nullptr && owner != this) {
+        owner->push_remote(node);
+      } else {
+        [[maybe_unused]] auto const found = global_arena_.deallocate(node->ptr, node->size);
+        RMM_LOGGING_ASSERT(found);
+        global_arena_.remote_frees().release(node);
+      }
+      node = next;
+    }
+    while (pending != nullptr) {
+      push_remote(std::exchange(pending, pending->next));
+    }
+  }
+
   /**
    * @brief Allocate space from upstream to supply the arena and return a block.
    *
@@ -968,10 +1753,10 @@ class arena {
    */
   block expand_arena(std::size_t size)
   {
-    auto sblk = global_arena_.acquire(size);
+    auto sblk = global_arena_.acquire(size, this);
     if (sblk.is_valid()) {
       RMM_LOGGING_ASSERT(sblk.size() >= superblock::minimum_size);
-      auto const blk = sblk.first_fit(size);
+      auto const blk = sblk.best_fit(size);
       superblocks_.insert(std::move(sblk));
       return blk;
     }
@@ -981,7 +1766,9 @@ class arena {
   /// The global arena to allocate superblocks from.
   global_arena<Upstream>& global_arena_;
   /// Acquired superblocks.
-  std::set<superblock> superblocks_;
+  superblock_set superblocks_;
+  /// Lock-free stack of blocks freed by other threads, drained under `mtx_`.
+  std::atomic<remote_free*> remote_frees_{};
   /// Mutex for exclusive lock.
   mutable std::mutex mtx_;
 };
@@ -989,7 +1776,9 @@ class arena {
 /**
  * @brief RAII-style cleaner for an arena.
  *
- * This is useful when a thread is about to terminate, and it contains a per-thread arena.
+ * This is useful when a thread is about to terminate, and it contains a per-thread arena. The
+ * cleaner also caches a pointer to the arena, so that a `thread_cache_table` of cleaners lets a
+ * thread find its arena in each resource without locking the resource's arena map.
  *
  * @tparam Upstream Memory resource to use for allocating the global arena. Implements
  * rmm::mr::device_memory_resource interface.
@@ -997,7 +1786,10 @@ class arena {
 template <typename Upstream>
 class arena_cleaner {
  public:
-  explicit arena_cleaner(std::shared_ptr<arena<Upstream>> const& arena) : arena_(arena) {}
+  explicit arena_cleaner(std::shared_ptr<arena<Upstream>> const& arena)
+    : arena_(arena), arena_ptr_(arena.get())
+  {
+  }
 
   // Disable copy (and move) semantics.
   arena_cleaner(arena_cleaner const&)            = delete;
@@ -1005,17 +1797,33 @@ class arena_cleaner {
   arena_cleaner(arena_cleaner&&) noexcept        = delete;
   arena_cleaner& operator=(arena_cleaner&&)      = delete;
 
-  ~arena_cleaner()
+  ~arena_cleaner() { release(); }
+
+  /**
+   * @brief The arena. Only valid while the resource owning the arena is alive.
+   */
+  [[nodiscard]] arena<Upstream>& get() const noexcept { return *arena_ptr_; }
+
+  /**
+   * @brief Returns the blocks queued by other threads, once their frees complete, and all
+   * superblocks of the arena to the global arena, if the arena still exists.
+   */
+  void release()
   {
-    if (!arena_.expired()) {
-      auto arena_ptr = arena_.lock();
-      arena_ptr->clean();
-    }
+    if (auto arena_ptr = arena_.lock()) { arena_ptr->clean_on_exit(); }
+    arena_.reset();
   }
 
+  /**
+   * @brief Whether the arena has been destroyed or released.
+   */
+  [[nodiscard]] bool is_detached() const noexcept { return arena_.expired(); }
+
  private:
   /// A non-owning pointer to the arena that may need cleaning.
   std::weak_ptr<arena<Upstream>> arena_;
+  /// The arena, for lookups by the owning thread while the resource is alive.
+  arena<Upstream>* arena_ptr_;
 };
 
 }  // namespace rmm::mr::detail::arena
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/mr/device/detail/sharded_sum.hpp>
+#include <rmm/mr/device/histogram.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace rmm::mr::detail {
+
+/**
+ * @brief A `histogram` that threads record into without locks.
+ *
+ * Threads record into a few shards by their thread shard, with relaxed atomics, and reading the
+ * histogram merges the shards.
+ */
+class atomic_histogram {
+ public:
+  /// Number of shards. Fewer than `num_thread_shards`, as each shard holds every bucket.
+  static constexpr std::size_t num_shards{8};
+
+  atomic_histogram() noexcept { reset(); }
+
+  /**
+   * @brief Records `value`.
+   */
+  void record(std::uint64_t value) noexcept
+  {
+    auto& shd = shards_[this_thread_shard() % num_shards];
+    shd.counts[histogram::bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    shd.sum.fetch_add(value, std::memory_order_relaxed);
+    auto min = shd.min.load(std::memory_order_relaxed);
+    while (value < min &&
+           not shd.min.compare_exchange_weak(min, value, std::memory_order_relaxed)) {}
+    auto max = shd.max.load(std::memory_order_relaxed);
+    while (value > max &&
+           not shd.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+  }
+
+  /**
+   * @brief The recorded values. Values recorded while the histogram is read may or may not be
+   * included.
+   */
+  [[nodiscard]] histogram load() const
+  {
+    histogram result{};
+    for (auto const& shd : shards_) {
+      histogram part{};
+      for (std::size_t i = 0; i < histogram::num_buckets; ++i) {
+        part.counts[i] = shd.counts[i].load(std::memory_order_relaxed);
+        part.count += part.counts[i];
+      }
+      if (part.count == 0) { continue; }
+      part.sum = shd.sum.load(std::memory_order_relaxed);
+      part.min = shd.min.load(std::memory_order_relaxed);
+      part.max = shd.max.load(std::memory_order_relaxed);
+      // A racing record may have counted its value but not yet updated the bounds
+      part.min = std::min(part.min, part.max);
+      result += part;
+    }
+    return result;
+  }
+
+  /**
+   * @brief Discards the recorded values. Values recorded while the histogram is reset may be
+   * partly kept.
+   */
+  void reset() noexcept
+  {
+    for (auto& shd : shards_) {
+      for (auto& bucket : shd.counts) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      shd.sum.store(0, std::memory_order_relaxed);
+      shd.min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+      shd.max.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct alignas(64) shard {
+    std::array<std::atomic<std::uint64_t>, histogram::num_buckets> counts;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> min;
+    std::atomic<std::uint64_t> max;
+  };
+
+  std::array<shard, num_shards> shards_;
+};
+
+}  // namespace rmm::mr::detail
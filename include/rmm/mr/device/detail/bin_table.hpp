@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+
+namespace rmm::mr::detail {
+
+/**
+ * @brief `ceil(log2(size))`, or 0 if `size <= 1`.
+ */
+constexpr std::size_t ceil_log2(std::size_t size) noexcept
+{
+  if (size <= 1) { return 0; }
+  return static_cast<std::size_t>(std::numeric_limits<unsigned long long>::digits -
+                                  __builtin_clzll(static_cast<unsigned long long>(size - 1)));
+}
+
+/**
+ * @brief Flat index from `ceil(log2(size))` to the first of a set of ascending bin sizes that is
+ * larger than `2^(ceil(log2(size)) - 1)`.
+ *
+ * An allocation of `size` bytes lies in `(2^(k-1), 2^k]` for `k = ceil(log2(size))`, so the search
+ * for its bin starts at entry `k` and only steps over bins within that doubling: at most one step
+ * when the bin sizes are powers of two.
+ */
+using bin_table = std::array<std::size_t, std::numeric_limits<std::size_t>::digits + 1>;
+
+/**
+ * @brief Builds the `bin_table` of `sizes`, which must be strictly ascending.
+ */
+template <typename Sizes>
+constexpr bin_table make_bin_table(Sizes const& sizes) noexcept
+{
+  bin_table table{};
+  std::size_t index{0};
+  for (std::size_t bit = 0; bit < table.size(); ++bit) {
+    auto const lower = (bit == 0) ? std::size_t{0} : std::size_t{1} << (bit - 1);
+    while (index < std::size(sizes) and sizes[index] <= lower) {
+      ++index;
+    }
+    table[bit] = index;
+  }
+  return table;
+}
+
+/**
+ * @brief The index of the smallest of `sizes` that is at least `size`, or `std::size(sizes)` if
+ * there is none.
+ *
+ * @param sizes The strictly ascending bin sizes
+ * @param table The `bin_table` of `sizes`
+ * @param size The allocation size
+ */
+template <typename Sizes>
+constexpr std::size_t find_bin(Sizes const& sizes,
+                               bin_table const& table,
+                               std::size_t size) noexcept
+{
+  auto index = table[ceil_log2(size)];
+  while (index < std::size(sizes) and sizes[index] < size) {
+    ++index;
+  }
+  return index;
+}
+
+}  // namespace rmm::mr::detail
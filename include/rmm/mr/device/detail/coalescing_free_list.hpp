@@ -27,6 +27,8 @@
 #include <iostream>
 #include <iterator>
 #include <list>
+#include <set>
+#include <utility>
 
 namespace rmm::mr::detail {
 
@@ -167,11 +169,14 @@ struct compare_blocks {
 };
 
 /**
- * @brief An ordered list of free memory blocks that coalesces contiguous blocks on insertion.
+ * @brief An ordered set of free memory blocks that coalesces contiguous blocks on insertion.
  *
- * @tparam list_type the type of the internal list data structure.
+ * Blocks are indexed twice: by address, for finding the neighbors to coalesce with on insertion,
+ * and by size, for best-fit search. Both `insert` and `get_block` are O(log n) in the number of
+ * free blocks, so the cost of allocation and deallocation does not grow linearly as the pool
+ * becomes fragmented.
  */
-struct coalescing_free_list : free_list<block> {
+struct coalescing_free_list : free_list<block, std::set<block, compare_blocks<block>>> {
   coalescing_free_list()           = default;
   ~coalescing_free_list() override = default;
 
@@ -184,75 +189,111 @@ struct coalescing_free_list : free_list<block> {
    * @brief Inserts a block into the `free_list` in the correct order, coalescing it with the
    *        preceding and following blocks if either is contiguous.
    *
-   * @param b The block to insert.
+   * @param block The block to insert.
    */
   void insert(block_type const& block)
   {
-    if (is_empty()) {
-      free_list::insert(cend(), block);
-      return;
-    }
-
     // Find the right place (in ascending ptr order) to insert the block
-    // Can't use binary_search because it's a linked list and will be quadratic
-    auto const next =
-      std::find_if(begin(), end(), [block](block_type const& blk) { return block < blk; });
-    auto const previous = (next == cbegin()) ? next : std::prev(next);
+    auto const next     = container().upper_bound(block.pointer());
+    auto const previous = (next == cbegin()) ? cend() : std::prev(next);
 
     // Coalesce with neighboring blocks or insert the new block if it can't be coalesced
-    bool const merge_prev = previous->is_contiguous_before(block);
+    bool const merge_prev = (previous != cend()) && previous->is_contiguous_before(block);
     bool const merge_next = (next != cend()) && block.is_contiguous_before(*next);
 
-    if (merge_prev && merge_next) {
-      *previous = previous->merge(block).merge(*next);
+    block_type merged = block;
+    if (merge_prev) {
+      merged = previous->merge(merged);
+      erase(previous);
+    }
+    if (merge_next) {
+      merged = merged.merge(*next);
       erase(next);
-    } else if (merge_prev) {
-      *previous = previous->merge(block);
-    } else if (merge_next) {
-      *next = block.merge(*next);
-    } else {
-      free_list::insert(next, block);  // cannot be coalesced, just insert
     }
+    insert_indexed(merged);
   }
 
   /**
    * @brief Moves blocks from free_list `other` into this free_list in their correct order,
    *        coalescing them with their preceding and following blocks if they are contiguous.
    *
-   * @tparam InputIt iterator type
+   * `other` is empty after this call.
+   *
    * @param other free_list of blocks to insert
    */
-  void insert(free_list&& other)
+  void insert(coalescing_free_list&& other)
   {
-    using std::make_move_iterator;
-    auto inserter = [this](block_type&& block) { this->insert(block); };
-    std::for_each(make_move_iterator(other.begin()), make_move_iterator(other.end()), inserter);
+    std::for_each(other.cbegin(), other.cend(), [this](block_type const& blk) { insert(blk); });
+    other.clear();
   }
 
   /**
    * @brief Finds the smallest block in the `free_list` large enough to fit `size` bytes.
    *
-   * This is a "best fit" search.
+   * This is a "best fit" search. Among equally sized blocks, the one with the lowest address is
+   * returned.
    *
    * @param size The size in bytes of the desired block.
    * @return A block large enough to store `size` bytes.
    */
   block_type get_block(std::size_t size)
   {
-    // find best fit block
-    auto finder = [size](block_type const& lhs, block_type const& rhs) {
-      return lhs.is_better_fit(size, rhs);
-    };
-    auto const iter = std::min_element(cbegin(), cend(), finder);
-
-    if (iter != cend() && iter->fits(size)) {
-      // Remove the block from the free_list and return it.
-      block_type const found = *iter;
-      erase(iter);
-      return found;
-    }
+    auto const fit = blocks_by_size_.lower_bound({size, nullptr});
+    if (fit == blocks_by_size_.end()) { return block_type{}; }  // not found
+
+    // Remove the block from the free_list and return it.
+    auto const iter = container().find(fit->second);
+    assert(iter != cend());
+    block_type const found = *iter;
+    erase(iter);
+    return found;
+  }
+
+  /**
+   * @brief Finds the free block that starts at `ptr`.
+   *
+   * @param ptr The start address of the block to find.
+   * @return An iterator to the block, or `cend()` if no free block starts at `ptr`.
+   */
+  [[nodiscard]] const_iterator find(char const* ptr) const { return container().find(ptr); }
+
+  /**
+   * @brief Returns the size of the largest block in the free list, or zero if it is empty.
+   *
+   * @return The size in bytes of the largest free block.
+   */
+  [[nodiscard]] std::size_t largest_block_size() const noexcept
+  {
+    return blocks_by_size_.empty() ? 0 : blocks_by_size_.rbegin()->first;
+  }
+
+  /**
+   * @brief Returns the total size of the blocks in the free list.
+   *
+   * @return The number of free bytes.
+   */
+  [[nodiscard]] std::size_t total_size() const noexcept { return total_size_; }
 
-    return block_type{};  // not found
+  /**
+   * @brief Removes the block indicated by `iter` from the free list.
+   *
+   * @param iter An iterator referring to the block to erase.
+   */
+  void erase(const_iterator iter)
+  {
+    blocks_by_size_.erase({iter->size(), iter->pointer()});
+    total_size_ -= iter->size();
+    free_list::erase(iter);
+  }
+
+  /**
+   * @brief Erase all blocks from the free_list.
+   */
+  void clear() noexcept
+  {
+    blocks_by_size_.clear();
+    total_size_ = 0;
+    free_list::clear();
   }
 
 #ifdef RMM_DEBUG_PRINT
@@ -265,6 +306,23 @@ struct coalescing_free_list : free_list<block> {
     std::for_each(cbegin(), cend(), [](auto const iter) { iter.print(); });
   }
 #endif
+
+ private:
+  /**
+   * @brief Adds `block` to both the address and size indexes. `block` must not overlap or be
+   * contiguous with any block already in the free list.
+   */
+  void insert_indexed(block_type const& block)
+  {
+    blocks_by_size_.emplace(block.size(), block.pointer());
+    total_size_ += block.size();
+    free_list::insert(container().upper_bound(block.pointer()), block);
+  }
+
+  // (size, address) pairs, ordered by size then address, for best-fit search
+  std::set<std::pair<std::size_t, char*>> blocks_by_size_;
+  // total size of the blocks
+  std::size_t total_size_{};
 };  // coalescing_free_list
 
 }  // namespace rmm::mr::detail
@@ -18,12 +18,21 @@
 
 #include <rmm/mr/device/detail/free_list.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <vector>
 
 namespace rmm::mr::detail {
 
-struct fixed_size_free_list : free_list<block_base> {
+/**
+ * @brief A free list of fixed-size blocks, kept as an array-backed stack.
+ *
+ * The most recently freed block is reused first, and adding or removing a block does not allocate
+ * unless the array has to grow.
+ */
+struct fixed_size_free_list : free_list<block_base, std::vector<block_base>> {
   fixed_size_free_list()           = default;
   ~fixed_size_free_list() override = default;
 
@@ -35,6 +44,8 @@ struct fixed_size_free_list : free_list<block_base> {
   /**
    * @brief Construct a new free_list from range defined by input iterators
    *
+   * The blocks are taken from the stack in the order of the range.
+   *
    * @tparam InputIt Input iterator
    * @param first The start of the range to insert into the free_list
    * @param last The end of the range to insert into the free_list
@@ -42,37 +53,65 @@ struct fixed_size_free_list : free_list<block_base> {
   template <class InputIt>
   fixed_size_free_list(InputIt first, InputIt last)
   {
-    std::for_each(first, last, [this](block_type const& block) { insert(block); });
+    auto& blocks = container();
+    blocks.reserve(static_cast<std::size_t>(std::distance(first, last)));
+    std::copy(first, last, std::back_inserter(blocks));
+    std::reverse(blocks.begin(), blocks.end());
   }
 
   /**
-   * @brief Inserts a block into the `free_list` in the correct order, coalescing it with the
-   *        preceding and following blocks if either is contiguous.
+   * @brief Pushes a block onto the stack.
    *
    * @param block The block to insert.
    */
   void insert(block_type const& block) { push_back(block); }
 
   /**
-   * @brief Inserts blocks from another free list into this free_list.
+   * @brief Moves the blocks of another free list onto this one, leaving `other` empty.
    *
    * @param other The free_list to insert into this free_list.
    */
-  void insert(free_list&& other) { splice(cend(), std::move(other)); }
+  void insert(fixed_size_free_list&& other)
+  {
+    auto& blocks = container();
+    auto& others = other.container();
+    if (blocks.empty()) {
+      blocks.swap(others);
+      return;
+    }
+    blocks.insert(blocks.end(), others.begin(), others.end());
+    others.clear();
+  }
 
   /**
-   * @brief Returns the first block in the free list.
+   * @brief Pops the block on top of the stack.
    *
    * @param size The size in bytes of the desired block (unused).
-   * @return A block large enough to store `size` bytes.
+   * @return A block large enough to store `size` bytes, or an invalid block if the list is empty.
    */
   block_type get_block(std::size_t size)
   {
     if (is_empty()) { return block_type{}; }
-    block_type block = *begin();
-    pop_front();
+    block_type block = container().back();
+    pop_back();
     return block;
   }
+
+  /**
+   * @brief Removes every block for which `pred` returns true.
+   *
+   * @param pred Unary predicate on `block_type`
+   * @return The number of blocks removed
+   */
+  template <typename Predicate>
+  std::size_t remove_if(Predicate pred)
+  {
+    auto& blocks     = container();
+    auto const first = std::remove_if(blocks.begin(), blocks.end(), pred);
+    auto const count = static_cast<std::size_t>(std::distance(first, blocks.end()));
+    blocks.erase(first, blocks.end());
+    return count;
+  }
 };
 
 }  // namespace rmm::mr::detail
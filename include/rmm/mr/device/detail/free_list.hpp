@@ -175,6 +175,25 @@ class free_list {
    */
   void pop_front() { blocks.pop_front(); }
 
+  /**
+   * @brief Removes the last element of the free list. If there are no elements in the free list,
+   * the behavior is undefined.
+   */
+  void pop_back() { blocks.pop_back(); }
+
+  /**
+   * @brief Returns the internal container of blocks.
+   *
+   * Allows derived classes to use lookups specific to `list_type`, such as `upper_bound` on an
+   * ordered set.
+   *
+   * @return The internal container of blocks.
+   */
+  [[nodiscard]] list_type const& container() const noexcept { return blocks; }
+
+  /// @copydoc container() const
+  [[nodiscard]] list_type& container() noexcept { return blocks; }
+
  private:
   list_type blocks;  // The internal container of blocks
 };
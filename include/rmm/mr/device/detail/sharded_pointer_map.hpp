@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr::detail {
+
+/**
+ * @brief A map from non-null pointers to values, split into independently locked shards.
+ *
+ * A pointer's shard is chosen from a hash of its address, and each shard is an open-addressing
+ * hash table with linear probing and backward-shift deletion. Inserting or erasing takes one shard
+ * lock and does not allocate unless the shard's table grows, so threads working on different
+ * pointers rarely contend.
+ *
+ * @tparam Value The mapped type, which must be default constructible and movable
+ */
+template <typename Value>
+class sharded_pointer_map {
+ public:
+  /// Default number of shards.
+  static constexpr std::size_t default_num_shards{64};
+
+  /**
+   * @brief Construct an empty map.
+   *
+   * @param num_shards The number of shards, rounded up to a power of two
+   */
+  explicit sharded_pointer_map(std::size_t num_shards = default_num_shards)
+  {
+    while ((std::size_t{1} << shard_bits_) < num_shards) {
+      ++shard_bits_;
+    }
+    shard_mask_ = (std::size_t{1} << shard_bits_) - 1;
+    shards_     = std::make_unique<shard[]>(shard_mask_ + 1);  // NOLINT(modernize-avoid-c-arrays)
+  }
+
+  /**
+   * @brief Inserts `value` for `ptr` unless `ptr` is already in the map.
+   *
+   * @return bool true if the value was inserted
+   */
+  bool insert(void* ptr, Value value)
+  {
+    auto const hash = hash_of(ptr);
+    auto& shd       = shard_of(hash);
+    std::lock_guard lock(shd.mtx);
+    if (2 * (shd.size + 1) > shd.slots.size()) { grow(shd); }
+    auto const mask = shd.slots.size() - 1;
+    for (auto index = home(hash, mask);; index = (index + 1) & mask) {
+      auto& slt = shd.slots[index];
+      if (slt.key == ptr) { return false; }
+      if (slt.key == nullptr) {
+        slt.key   = ptr;
+        slt.value = std::move(value);
+        ++shd.size;
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief Removes `ptr` from the map.
+   *
+   * @return std::optional<Value> The value that was mapped to `ptr`, or nothing if it was absent
+   */
+  std::optional<Value> erase(void* ptr)
+  {
+    auto const hash = hash_of(ptr);
+    auto& shd       = shard_of(hash);
+    std::lock_guard lock(shd.mtx);
+    if (shd.size == 0) { return std::nullopt; }
+    auto const mask = shd.slots.size() - 1;
+    auto index      = home(hash, mask);
+    while (shd.slots[index].key != ptr) {
+      if (shd.slots[index].key == nullptr) { return std::nullopt; }
+      index = (index + 1) & mask;
+    }
+    std::optional<Value> value{std::move(shd.slots[index].value)};
+
+    // Shift later entries of the probe sequence back, so lookups need no tombstones
+    for (auto next = (index + 1) & mask; shd.slots[next].key != nullptr; next = (next + 1) & mask) {
+      auto const desired = home(hash_of(shd.slots[next].key), mask);
+      // The entry at `next` may move to `index` unless its home lies cyclically in (index, next]
+      bool const stays = (index <= next) ? (index < desired && desired <= next)
+                                         : (index < desired || desired <= next);
+      if (not stays) {
+        shd.slots[index] = std::move(shd.slots[next]);
+        index            = next;
+      }
+    }
+    shd.slots[index] = slot{};
+    --shd.size;
+    return value;
+  }
+
+  /**
+   * @brief Looks up the value mapped to `ptr`.
+   *
+   * @return std::optional<Value> A copy of the value mapped to `ptr`, or nothing if it is absent
+   */
+  std::optional<Value> find(void const* ptr) const
+  {
+    auto const hash = hash_of(ptr);
+    auto& shd       = shard_of(hash);
+    std::lock_guard lock(shd.mtx);
+    if (shd.size == 0) { return std::nullopt; }
+    auto const mask = shd.slots.size() - 1;
+    // The table is at most half full, so every probe sequence reaches an empty slot
+    for (auto index = home(hash, mask);; index = (index + 1) & mask) {
+      auto const& slt = shd.slots[index];
+      if (slt.key == ptr) { return slt.value; }
+      if (slt.key == nullptr) { return std::nullopt; }
+    }
+  }
+
+  /**
+   * @brief The number of pointers in the map. Each shard is counted under its lock, so the total
+   * may combine counts taken at slightly different times.
+   */
+  [[nodiscard]] std::size_t size() const
+  {
+    std::size_t total{0};
+    for (std::size_t i = 0; i <= shard_mask_; ++i) {
+      std::lock_guard lock(shards_[i].mtx);
+      total += shards_[i].size;
+    }
+    return total;
+  }
+
+  /**
+   * @brief Calls `func(ptr, value)` for every entry, holding the lock of one shard at a time.
+   *
+   * `func` must not call back into the map.
+   */
+  template <typename Func>
+  void for_each(Func&& func) const
+  {
+    for (std::size_t i = 0; i <= shard_mask_; ++i) {
+      std::lock_guard lock(shards_[i].mtx);
+      for (auto const& slt : shards_[i].slots) {
+        if (slt.key != nullptr) { func(slt.key, slt.value); }
+      }
+    }
+  }
+
+ private:
+  struct slot {
+    void* key{};  // nullptr: empty
+    Value value{};
+  };
+
+  // Aligned to a cache line so that threads locking neighbouring shards do not share one
+  struct alignas(64) shard {
+    mutable std::mutex mtx;
+    std::vector<slot> slots;  // empty, or a power of two in size
+    std::size_t size{};
+  };
+
+  /// A 64-bit mix of the address (the splitmix64 finalizer), so aligned pointers spread evenly.
+  static std::uint64_t hash_of(void const* ptr) noexcept
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr));
+    hash      = (hash ^ (hash >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    hash      = (hash ^ (hash >> 27U)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31U);
+  }
+
+  shard& shard_of(std::uint64_t hash) const noexcept { return shards_[hash & shard_mask_]; }
+
+  /// The first slot probed for `hash` in a table of `mask + 1` slots.
+  std::size_t home(std::uint64_t hash, std::size_t mask) const noexcept
+  {
+    return static_cast<std::size_t>(hash >> shard_bits_) & mask;
+  }
+
+  /// Doubles the table of `shd`, which must be locked.
+  void grow(shard& shd)
+  {
+    constexpr std::size_t initial_slots{16};
+    std::vector<slot> slots(shd.slots.empty() ? initial_slots : 2 * shd.slots.size());
+    auto const mask = slots.size() - 1;
+    for (auto& slt : shd.slots) {
+      if (slt.key == nullptr) { continue; }
+      auto index = home(hash_of(slt.key), mask);
+      while (slots[index].key != nullptr) {
+        index = (index + 1) & mask;
+      }
+      slots[index] = std::move(slt);
+    }
+    shd.slots.swap(slots);
+  }
+
+  std::unique_ptr<shard[]> shards_;  // NOLINT(modernize-avoid-c-arrays)
+  std::size_t shard_mask_{};
+  std::size_t shard_bits_{};
+};
+
+}  // namespace rmm::mr::detail
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rmm::mr::detail {
+
+/// Number of shards of per-thread statistics.
+constexpr std::size_t num_thread_shards{64};
+
+/**
+ * @brief The shard of per-thread statistics used by the calling thread.
+ *
+ * Threads are assigned shards round-robin on first use, so up to `num_thread_shards` threads each
+ * have a shard of their own.
+ */
+inline std::size_t this_thread_shard() noexcept
+{
+  static std::atomic<std::size_t> next_shard{0};
+  thread_local std::size_t const shard =
+    next_shard.fetch_add(1, std::memory_order_relaxed) % num_thread_shards;
+  return shard;
+}
+
+/**
+ * @brief A sum that threads add to without contending, by each adding to its own cache line.
+ *
+ * Reading the sum adds up all shards, so it is much slower than adding to it.
+ */
+class sharded_sum {
+ public:
+  /**
+   * @brief Adds `val` to the sum.
+   */
+  void add(std::int64_t val) noexcept
+  {
+    shards_[this_thread_shard()].value.fetch_add(val, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief The sum. Additions that race with the read may or may not be included.
+   */
+  [[nodiscard]] std::int64_t load() const noexcept
+  {
+    std::int64_t sum{0};
+    for (auto const& shard : shards_) {
+      sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  struct alignas(64) shard {
+    std::atomic<std::int64_t> value{0};
+  };
+
+  std::array<shard, num_thread_shards> shards_{};
+};
+
+}  // namespace rmm::mr::detail
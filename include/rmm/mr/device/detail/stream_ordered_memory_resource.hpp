@@ -40,16 +40,57 @@
 #include <rmm/detail/aligned.hpp>
 #include <rmm/detail/error.hpp>
 #include <rmm/logger.hpp>
+#include <rmm/mr/device/detail/free_list.hpp>
+#include <rmm/mr/device/detail/thread_cache.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/memory_snapshot.hpp>
 
 #include <rmm/cuda_runtime_api.h>
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr {
+
+/**
+ * @brief Controls when a stream-ordered memory resource records a stream's event after
+ * deallocations on that stream.
+ *
+ * By default the event is recorded on every deallocation. With `max_deferred_frees` greater than
+ * one, a deallocation only marks the stream's free list as having unrecorded frees, and the event
+ * is recorded once for the whole batch: by a later deallocation on the same stream when the list
+ * reaches `max_deferred_frees` unrecorded frees, or by any allocation or deallocation once the
+ * oldest unrecorded free is older than `max_deferral`. When another stream takes blocks from a
+ * list with unrecorded frees, or memory is returned upstream, the event is recorded right away.
+ *
+ * Deferred events are recorded on the stream of the frees after the frees themselves, so that
+ * stream must outlive them: call `flush_deferred_frees(stream)` on the resource before destroying
+ * a stream that may have deferred frees.
+ *
+ * Frees on the per-thread default stream are always recorded immediately.
+ */
+struct deferred_event_options {
+  /// Maximum number of frees covered by one event record
+  std::size_t max_deferred_frees{1};
+  /// Maximum age of the oldest unrecorded free, checked on each allocation and free
+  std::chrono::microseconds max_deferral{std::chrono::milliseconds{1}};
+};
+
+}  // namespace rmm::mr
 
 namespace rmm::mr::detail {
 
@@ -90,6 +131,11 @@ struct crtp {
  * 2. `block_type expand_pool(std::size_t size, free_list& blocks, cuda_stream_view stream)`
  * 3. `split_block allocate_from_block(block_type const& b, std::size_t size)`
  * 4. `block_type free_block(void* p, std::size_t size) noexcept`
+ *
+ * Derived classes may also call `enable_thread_cache()` to serve same-thread, same-stream reuse of
+ * small blocks from per-thread caches without taking the resource lock. Such classes must call
+ * `detach_thread_caches()` before releasing their memory on destruction. They may call
+ * `defer_event_records()` to batch the event records that order freed blocks for other streams.
  */
 template <typename PoolResource, typename FreeListType>
 class stream_ordered_memory_resource : public crtp<PoolResource>, public device_memory_resource {
@@ -102,6 +148,51 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
   stream_ordered_memory_resource& operator=(stream_ordered_memory_resource const&) = delete;
   stream_ordered_memory_resource& operator=(stream_ordered_memory_resource&&)      = delete;
 
+  /**
+   * @brief Waits for the work ordered before every free so far to complete.
+   *
+   * Call this before memory of the pool is returned upstream while frees may still be pending on
+   * their streams. Deferred events are recorded first, on the streams of their frees.
+   */
+  void synchronize_frees()
+  {
+    lock_guard lock(mtx_);
+    synchronize_frees_unlocked();
+  }
+
+  /**
+   * @brief Records the event of `stream` if frees on it have been deferred.
+   *
+   * With deferred event records (see `deferred_event_options`) or per-thread caches, unrecorded
+   * frees are later recorded on the stream they were made on. Call this before destroying a stream
+   * that may have deferred or cached frees. Blocks freed on `stream` are taken from the caches of
+   * all threads.
+   *
+   * @param stream The stream that is about to be destroyed
+   */
+  void flush_deferred_frees(cuda_stream_view stream)
+  {
+    std::optional<stream_event_pair> stream_event;
+    {
+      lock_guard lock(mtx_);
+      auto const iter = stream_events_.find(stream_key(stream));
+      if (iter == stream_events_.end()) { return; }
+      stream_event = iter->second;
+    }
+    // Not under mtx_: a cache's release() holds its own mutex while taking mtx_
+    for (auto& cache : thread_caches()) {
+      return_cached_blocks(cache->drain_if([event = stream_event->event](auto const& blk) {
+        return blk.stream_event.event == event;
+      }));
+    }
+
+    lock_guard lock(mtx_);
+    auto const list = stream_free_blocks_.find(stream_event->event);
+    if (list != stream_free_blocks_.end()) { complete_deferred_frees(list->second); }
+    // Threads forget the event of the stream, which is about to be destroyed
+    list_retirements_.fetch_add(1, std::memory_order_relaxed);
+  }
+
  protected:
   using free_list  = FreeListType;
   using block_type = typename free_list::block_type;
@@ -171,12 +262,16 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
    */
   void insert_block(block_type const& block, cuda_stream_view stream)
   {
-    stream_free_blocks_[get_event(stream)].insert(block);
+    auto& list = get_free_list(get_event(stream));
+    list.blocks.insert(block);
+    update_largest_block(list);
   }
 
   void insert_blocks(free_list&& blocks, cuda_stream_view stream)
   {
-    stream_free_blocks_[get_event(stream)].insert(std::move(blocks));
+    auto& list = get_free_list(get_event(stream));
+    list.blocks.insert(std::move(blocks));
+    update_largest_block(list);
   }
 
 #ifdef RMM_DEBUG_PRINT
@@ -184,9 +279,9 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
   {
     std::cout << "stream free blocks: ";
     for (auto& free_blocks : stream_free_blocks_) {
-      std::cout << "stream: " << free_blocks.first.stream << " event: " << free_blocks.first.event
-                << " ";
-      free_blocks.second.print();
+      std::cout << "stream: " << free_blocks.second.stream_event.stream
+                << " event: " << free_blocks.first << " ";
+      free_blocks.second.blocks.print();
       std::cout << std::endl;
     }
     std::cout << std::endl;
@@ -198,7 +293,7 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
    *
    * @return std::mutex
    */
-  std::mutex& get_mutex() { return mtx_; }
+  std::mutex& get_mutex() const { return mtx_; }
 
   struct stream_event_pair {
     cudaStream_t stream;
@@ -207,6 +302,184 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
     bool operator<(stream_event_pair const& rhs) const { return event < rhs.event; }
   };
 
+  /**
+   * @brief Enables per-thread caches of freed blocks of at most `options.max_block_size` bytes.
+   *
+   * Must be called before the resource is used for any allocation.
+   *
+   * @param options The cache limits
+   */
+  void enable_thread_cache(thread_cache_options const& options)
+  {
+    cache_options_ = options;
+    cache_options_.max_block_size =
+      rmm::detail::align_down(options.max_block_size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+  }
+
+  /**
+   * @brief Sets when stream events are recorded after deallocations.
+   *
+   * @param options The deferral limits
+   */
+  void defer_event_records(deferred_event_options const& options) { event_options_ = options; }
+
+  /**
+   * @brief Returns the number of bytes handed out from the free lists and not yet returned to them.
+   *
+   * Blocks held in per-thread caches count as allocated. The counter is maintained under the mutex
+   * and may be read without it.
+   *
+   * @return std::size_t The number of allocated bytes
+   */
+  [[nodiscard]] std::size_t allocated_bytes() const noexcept
+  {
+    return allocated_bytes_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the size of the largest block in any stream's free list.
+   *
+   * Maintained under the mutex and may be read without it.
+   *
+   * @return std::size_t The size in bytes of the largest free block, or 0 if there is none
+   */
+  [[nodiscard]] std::size_t largest_free_block_size() const noexcept
+  {
+    return largest_free_block_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Adds the free list of every stream to `snap`, listing free extents in address order
+   * until `max_extents` is exhausted.
+   *
+   * Requires a free list type with `total_size()` and `largest_block_size()`, so that each list is
+   * summarized in O(1). The caller must hold the mutex. Blocks held in per-thread caches count as
+   * allocated.
+   *
+   * @param snap The snapshot to fill
+   * @param max_extents The number of free extents that may still be listed, decreased by the
+   * number listed
+   */
+  void snapshot_free_lists(memory_snapshot& snap, std::size_t& max_extents) const
+  {
+    for (auto const& [event, list] : stream_free_blocks_) {
+      memory_snapshot::free_list summary{
+        fmt::format("stream {}", fmt::ptr(list.stream_event.stream)),
+        list.blocks.total_size(),
+        largest_block_bytes(list.blocks),
+        list.blocks.size()};
+      for (auto const& block : list.blocks) {
+        if (max_extents == 0) {
+          snap.complete = false;
+          break;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto const address = reinterpret_cast<std::uintptr_t>(block.pointer());
+        summary.extents.push_back({address, block.size()});
+        --max_extents;
+      }
+      snap.add(std::move(summary));
+    }
+  }
+
+  /**
+   * @brief Removes `block` from whichever free list holds exactly that block, once the work
+   * ordered before it was freed has completed.
+   *
+   * Requires a free list type with `find(ptr)` and `erase(iterator)`. The caller must hold the
+   * mutex. Used to return whole blocks to upstream.
+   *
+   * @param block The block to remove
+   * @return true if the block was free and has been removed.
+   */
+  bool take_free_block(block_type const& block)
+  {
+    return std::any_of(stream_free_blocks_.begin(), stream_free_blocks_.end(), [&](auto& entry) {
+      return take_free_block(block, entry.second);
+    });
+  }
+
+  /// The outcome of `try_take_free_block`.
+  enum class take_result {
+    taken,     ///< The block was free and its frees had completed; it has been removed
+    pending,   ///< The block is free, but work ordered before its frees may still be running
+    not_free,  ///< No free list holds exactly the block
+  };
+
+  /**
+   * @brief Removes `block` from whichever free list holds exactly that block, if the work ordered
+   * before the frees of that list has already completed. Never waits.
+   *
+   * Requires a free list type with `find(ptr)` and `erase(iterator)`. The caller must hold the
+   * mutex. Deferred events of the list are recorded now, so its frees count as pending.
+   *
+   * @param block The block to remove
+   * @return take_result Whether the block was removed, is still pending, or is not free
+   */
+  take_result try_take_free_block(block_type const& block)
+  {
+    for (auto& [event, list] : stream_free_blocks_) {
+      auto const iter = list.blocks.find(block.pointer());
+      if (iter == list.blocks.cend() || iter->size() != block.size()) { continue; }
+      complete_deferred_frees(list);
+      auto const status = cudaEventQuery(list.stream_event.event);
+      if (status != cudaSuccess) {
+        static_cast<void>(cudaGetLastError());
+        return take_result::pending;
+      }
+      list.blocks.erase(iter);
+      update_largest_block(list);
+      return take_result::taken;
+    }
+    return take_result::not_free;
+  }
+
+  /**
+   * @brief Removes every free block for which `pred` returns true from the free lists, once the
+   * work ordered before the blocks of each affected list were freed has completed.
+   *
+   * Requires a free list type with `remove_if(pred)` returning the number of blocks removed. The
+   * caller must hold the mutex. Used to return memory to upstream when its blocks are scattered
+   * over the lists of several streams.
+   *
+   * @param pred Unary predicate on `block_type`
+   * @return std::size_t The number of blocks removed
+   */
+  template <typename Predicate>
+  std::size_t take_free_blocks_if(Predicate pred)
+  {
+    std::size_t taken{0};
+    for (auto& [event, list] : stream_free_blocks_) {
+      auto const removed = list.blocks.remove_if(pred);
+      if (removed == 0) { continue; }
+      synchronize_list(list);
+      update_largest_block(list);
+      taken += removed;
+    }
+    return taken;
+  }
+
+  /**
+   * @brief Detaches all per-thread caches so that threads exiting concurrently with destruction
+   * no longer return blocks to this resource.
+   *
+   * Blocks still cached are returned to the free lists of their streams, so that their frees are
+   * completed with the others before the memory is released.
+   */
+  void detach_thread_caches()
+  {
+    std::vector<std::shared_ptr<thread_cache>> caches;
+    {
+      lock_guard lock(mtx_);
+      caches.swap(thread_caches_);
+    }
+    // Not under mtx_: a cache's release() holds its own mutex while taking mtx_
+    for (auto& cache : caches) {
+      cache->detach();
+      return_cached_blocks(cache->drain());
+    }
+  }
+
   /**
    * @brief Allocates memory of size at least `bytes`.
    *
@@ -224,15 +497,85 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
 
     if (size <= 0) { return nullptr; }
 
+    size = rmm::detail::align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+
+    if (size <= cache_options_.max_block_size) {
+      if (void* ptr = get_cached_block(size, stream); ptr != nullptr) {
+        RMM_LOG_TRACE(
+          "[A][stream {:p}][{}B][{:p}][thread cache]", fmt::ptr(stream.value()), size, ptr);
+        return ptr;
+      }
+    }
+
+    try {
+      return allocate_block(size, stream);
+    } catch (rmm::out_of_memory const&) {
+      // Blocks held in thread caches are unavailable to the pool; return them and retry
+      if (not reclaim_thread_caches()) { throw; }
+      return allocate_block(size, stream);
+    }
+  }
+
+  /**
+   * @brief Deallocate memory pointed to by `p`.
+   *
+   * @throws nothing
+   *
+   * @param p Pointer to be deallocated
+   * @param size The size in bytes of the allocation to deallocate
+   * @param stream The stream in which to order this deallocation
+   */
+  void do_deallocate(void* ptr, std::size_t size, cuda_stream_view stream) override
+  {
+    RMM_LOG_TRACE("[D][stream {:p}][{}B][{:p}]", fmt::ptr(stream.value()), size, ptr);
+
+    if (size <= 0 || ptr == nullptr) { return; }
+
+    size = rmm::detail::align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+
+    if (size <= cache_options_.max_block_size) {
+      cache_block(ptr, size, stream);
+      return;
+    }
+
+    lock_guard lock(mtx_);
+    auto stream_event = get_event(stream);
+
+    auto const block = this->underlying().free_block(ptr, size);
+    add_allocated_bytes(-static_cast<std::ptrdiff_t>(block_bytes(block)));
+
+    auto& list = get_free_list(stream_event);
+    list.blocks.insert(block);
+    update_largest_block(list);
+
+    // cudaEventRecord has significant overhead on deallocations, so it may be deferred and
+    // batched over frees on this stream. Using events rather than streams allows stealing from
+    // deleted streams.
+    record_or_defer_event(list, stream);
+    record_overdue_events();
+
+    log_summary_trace();
+  }
+
+ private:
+  using thread_cache = detail::thread_cache<stream_event_pair>;
+  using cached_block = typename thread_cache::cached_block;
+
+  /**
+   * @brief Allocates a block of `size` (aligned) bytes from the pool under the resource lock.
+   */
+  void* allocate_block(std::size_t size, cuda_stream_view stream)
+  {
     lock_guard lock(mtx_);
+    record_overdue_events();
 
     auto stream_event = get_event(stream);
 
-    size = rmm::detail::align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
     RMM_EXPECTS(size <= this->underlying().get_maximum_allocation_size(),
                 "Maximum allocation size exceeded",
                 rmm::out_of_memory);
     auto const block = this->underlying().get_block(size, stream_event);
+    add_allocated_bytes(static_cast<std::ptrdiff_t>(block_bytes(block)));
 
     RMM_LOG_TRACE("[A][stream {:p}][{}B][{:p}]",
                   fmt::ptr(stream_event.stream),
@@ -245,37 +588,155 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
   }
 
   /**
-   * @brief Deallocate memory pointed to by `p`.
+   * @brief The calling thread's caches, one per resource.
+   */
+  static thread_cache_table<thread_cache>& this_thread_caches()
+  {
+    thread_local detail::thread_cache_table<thread_cache> table;
+    return table;
+  }
+
+  /**
+   * @brief Returns the calling thread's cache for this resource, creating it if necessary.
+   */
+  thread_cache& get_thread_cache()
+  {
+    auto& table = this_thread_caches();
+    if (auto* cache = table.find(cache_owner_id_); cache != nullptr) { return *cache; }
+
+    auto cache = std::make_shared<thread_cache>(
+      cache_options_, [this](std::vector<cached_block>&& blocks) { return_cached_blocks(blocks); });
+    {
+      lock_guard lock(mtx_);
+      // Caches referenced only from here belong to threads that have exited
+      thread_caches_.erase(std::remove_if(thread_caches_.begin(),
+                                          thread_caches_.end(),
+                                          [](auto const& c) { return c.use_count() == 1; }),
+                           thread_caches_.end());
+      thread_caches_.push_back(cache);
+    }
+    table.insert(cache_owner_id_, cache);
+    return *cache;
+  }
+
+  /**
+   * @brief Takes a block of `size` bytes freed on `stream` from the calling thread's cache.
    *
-   * @throws nothing
+   * No synchronization is needed: the block was last used on the same stream.
    *
-   * @param p Pointer to be deallocated
-   * @param size The size in bytes of the allocation to deallocate
-   * @param stream The stream in which to order this deallocation
+   * @return Pointer to the block, or nullptr if none is cached.
    */
-  void do_deallocate(void* ptr, std::size_t size, cuda_stream_view stream) override
+  void* get_cached_block(std::size_t size, cuda_stream_view stream)
   {
-    RMM_LOG_TRACE("[D][stream {:p}][{}B][{:p}]", fmt::ptr(stream.value()), size, ptr);
+    auto* cache = this_thread_caches().find(cache_owner_id_);
+    if (cache == nullptr) { return nullptr; }
+    auto const stream_event = cache->find_event(stream.value());
+    return stream_event.has_value() ? cache->get(size, stream_event->event) : nullptr;
+  }
 
-    if (size <= 0 || ptr == nullptr) { return; }
+  /**
+   * @brief Frees `ptr` into the calling thread's cache, flushing the older half of its magazine
+   * to the pool in one batch if the cache is full.
+   *
+   * No event is recorded for a cached free: a block reused from the cache stays on its stream.
+   * Blocks flushed to the pool count as deferred frees of their streams, and the event of `stream`
+   * is recorded once for the whole batch. Only frees on the per-thread default stream are recorded
+   * immediately, since no other thread can record on that stream later.
+   */
+  void cache_block(void* ptr, std::size_t size, cuda_stream_view stream)
+  {
+    auto& cache = get_thread_cache();
+    cache.prune_events(list_retirements_.load(std::memory_order_relaxed));
+    auto stream_event = cache.find_event(stream.value());
+    if (not stream_event.has_value()) {
+      lock_guard lock(mtx_);
+      stream_event = get_event(stream);
+      cache.remember_event(stream.value(), stream_event.value());
+    }
 
-    lock_guard lock(mtx_);
-    auto stream_event = get_event(stream);
+    if (stream.is_per_thread_default()) {
+      RMM_ASSERT_CUDA_SUCCESS(cudaEventRecord(stream_event->event, stream.value()));
+    }
 
-    size             = rmm::detail::align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
-    auto const block = this->underlying().free_block(ptr, size);
+    cached_block const blk{ptr, size, stream_event.value()};
+    if (cache.put(blk)) { return; }
 
-    // TODO: cudaEventRecord has significant overhead on deallocations. For the non-PTDS case
-    // we may be able to delay recording the event in some situations. But using events rather than
-    // streams allows stealing from deleted streams.
-    RMM_ASSERT_CUDA_SUCCESS(cudaEventRecord(stream_event.event, stream.value()));
+    auto evicted = cache.evict(size);
+    if (not cache.put(blk)) { evicted.push_back(blk); }
+    return_cached_blocks(evicted, stream_event);
+  }
 
-    stream_free_blocks_[stream_event].insert(block);
+  /**
+   * @brief Returns the cached blocks of every thread to the pool, so that they can coalesce.
+   *
+   * @return true if any blocks were returned.
+   */
+  bool reclaim_thread_caches()
+  {
+    bool reclaimed{false};
+    // Not under mtx_: a cache's release() holds its own mutex while taking mtx_
+    for (auto& cache : thread_caches()) {
+      auto const blocks = cache->drain();
+      return_cached_blocks(blocks);
+      reclaimed = reclaimed || not blocks.empty();
+    }
+    return reclaimed;
+  }
 
+  /**
+   * @brief Returns a copy of the list of all threads' caches.
+   */
+  std::vector<std::shared_ptr<thread_cache>> thread_caches()
+  {
+    lock_guard lock(mtx_);
+    return thread_caches_;
+  }
+
+  /**
+   * @brief Inserts cached blocks into the free lists of the streams they were freed on.
+   *
+   * Their frees were not recorded when the blocks were cached, so they count as deferred frees of
+   * their lists (except on the per-thread default stream). If the stream of `live` is known to be
+   * alive, the event of its list is recorded once for the batch. Otherwise this makes no CUDA
+   * calls and is safe to call from a thread that is exiting.
+   *
+   * @param blocks The blocks taken from a cache
+   * @param live The stream/event of the free being made by the calling thread, if any
+   */
+  void return_cached_blocks(std::vector<cached_block> const& blocks,
+                            std::optional<stream_event_pair> live = std::nullopt)
+  {
+    if (blocks.empty()) { return; }
+    lock_guard lock(mtx_);
+    auto const now = std::chrono::steady_clock::now();
+    for (auto const& blk : blocks) {
+      auto& list       = get_free_list(blk.stream_event);
+      auto const freed = this->underlying().free_block(blk.ptr, blk.size);
+      add_allocated_bytes(-static_cast<std::ptrdiff_t>(block_bytes(freed)));
+      list.blocks.insert(freed);
+      update_largest_block(list);
+      if (not cuda_stream_view{blk.stream_event.stream}.is_per_thread_default()) {
+        defer_free(list, now);
+      }
+    }
+    if (live.has_value()) { complete_deferred_frees(get_free_list(*live)); }
     log_summary_trace();
   }
 
- private:
+  /**
+   * @brief Returns the key of `stream` in `stream_events_`.
+   *
+   * We use cudaStreamLegacy as the event map key for the default stream for consistency between
+   * PTDS and non-PTDS mode. In PTDS mode, the cudaStreamLegacy map key will only exist if the user
+   * explicitly passes it, so it is used as the default location for the free list at construction.
+   * For consistency, the same key is used for null stream free lists in non-PTDS mode.
+   */
+  static cudaStream_t stream_key(cuda_stream_view stream)
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+    return stream.is_default() ? cudaStreamLegacy : stream.value();
+  }
+
   /**
    * @brief get a unique CUDA event (possibly new) associated with `stream`
    *
@@ -306,13 +767,7 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
       }();
       return stream_event_pair{stream.value(), event};
     }
-    // We use cudaStreamLegacy as the event map key for the default stream for consistency between
-    // PTDS and non-PTDS mode. In PTDS mode, the cudaStreamLegacy map key will only exist if the
-    // user explicitly passes it, so it is used as the default location for the free list
-    // at construction. For consistency, the same key is used for null stream free lists in
-    // non-PTDS mode.
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
-    auto* const stream_to_store = stream.is_default() ? cudaStreamLegacy : stream.value();
+    auto* const stream_to_store = stream_key(stream);
 
     auto const iter = stream_events_.find(stream_to_store);
     return (iter != stream_events_.end()) ? iter->second : [&]() {
@@ -325,19 +780,201 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
     }();
   }
 
+  /**
+   * @brief The free list of a stream and the size of its largest block.
+   */
+  struct stream_free_list {
+    explicit stream_free_list(stream_event_pair stream_event) : stream_event{stream_event} {}
+
+    stream_event_pair stream_event;
+    free_list blocks;
+    std::size_t largest{};         // key of this list in largest_free_blocks_, or 0 if none
+    std::size_t deferred_frees{};  // frees since the event was last recorded
+    std::chrono::steady_clock::time_point first_deferred{};  // time of the oldest such free
+  };
+
+  /**
+   * @brief Removes `block` from `list` if the list holds exactly that block, once the work ordered
+   * before it was freed has completed.
+   */
+  bool take_free_block(block_type const& block, stream_free_list& list)
+  {
+    auto const iter = list.blocks.find(block.pointer());
+    if (iter == list.blocks.cend() || iter->size() != block.size()) { return false; }
+    synchronize_list(list);
+    list.blocks.erase(iter);
+    update_largest_block(list);
+    return true;
+  }
+
+  /**
+   * @brief Records the event of `list` on `stream` and clears its deferred frees.
+   */
+  void record_event(stream_free_list& list, cudaStream_t stream)
+  {
+    RMM_ASSERT_CUDA_SUCCESS(cudaEventRecord(list.stream_event.event, stream));
+    list.deferred_frees = 0;
+  }
+
+  /**
+   * @brief Records the event of `list` after a free on `stream`, unless it can be deferred.
+   */
+  void record_or_defer_event(stream_free_list& list, cuda_stream_view stream)
+  {
+    if (event_options_.max_deferred_frees > 1 && not stream.is_per_thread_default()) {
+      auto const now = std::chrono::steady_clock::now();
+      defer_free(list, now);
+      if (list.deferred_frees < event_options_.max_deferred_frees &&
+          now - list.first_deferred < event_options_.max_deferral) {
+        return;
+      }
+    }
+    record_event(list, stream.value());
+  }
+
+  /**
+   * @brief Counts a free on `list` whose event is not recorded yet.
+   */
+  void defer_free(stream_free_list& list, std::chrono::steady_clock::time_point now)
+  {
+    if (list.deferred_frees++ == 0) {
+      list.first_deferred  = now;
+      next_deferral_check_ = std::min(next_deferral_check_, now + event_options_.max_deferral);
+    }
+  }
+
+  /**
+   * @brief Records the event of `list` if it has unrecorded frees, before another stream uses its
+   * blocks or they are returned upstream.
+   *
+   * The event is recorded on the stream of the frees, which must not have been destroyed without
+   * `flush_deferred_frees`.
+   */
+  void complete_deferred_frees(stream_free_list& list)
+  {
+    if (list.deferred_frees > 0) { record_event(list, list.stream_event.stream); }
+  }
+
+  /**
+   * @brief Records the events of lists whose oldest unrecorded free is older than `max_deferral`,
+   * so that frees on streams that have gone idle are recorded too. The caller must hold the mutex.
+   */
+  void record_overdue_events()
+  {
+    if (next_deferral_check_ == std::chrono::steady_clock::time_point::max()) { return; }
+    auto const now = std::chrono::steady_clock::now();
+    if (now < next_deferral_check_) { return; }
+    next_deferral_check_ = std::chrono::steady_clock::time_point::max();
+    for (auto& [event, list] : stream_free_blocks_) {
+      if (list.deferred_frees == 0) { continue; }
+      auto const due = list.first_deferred + event_options_.max_deferral;
+      if (now >= due) {
+        record_event(list, list.stream_event.stream);
+      } else {
+        next_deferral_check_ = std::min(next_deferral_check_, due);
+      }
+    }
+  }
+
+  /**
+   * @brief Waits for the work ordered before every free in `list` to complete.
+   */
+  void synchronize_list(stream_free_list& list)
+  {
+    complete_deferred_frees(list);
+    RMM_ASSERT_CUDA_SUCCESS(cudaEventSynchronize(list.stream_event.event));
+  }
+
+  /**
+   * @brief Waits for the work ordered before every free so far to complete. The caller must hold
+   * the mutex.
+   */
+  void synchronize_frees_unlocked()
+  {
+    for (auto& [event, list] : stream_free_blocks_) {
+      complete_deferred_frees(list);
+    }
+    for (auto& [event, list] : stream_free_blocks_) {
+      RMM_ASSERT_CUDA_SUCCESS(cudaEventSynchronize(list.stream_event.event));
+    }
+  }
+
+  /**
+   * @brief Returns the free list of `stream_event`, creating an empty one if necessary.
+   */
+  stream_free_list& get_free_list(stream_event_pair stream_event)
+  {
+    return stream_free_blocks_.try_emplace(stream_event.event, stream_event).first->second;
+  }
+
+  /**
+   * @brief Updates the entry of `list` in `largest_free_blocks_` after its blocks changed.
+   */
+  void update_largest_block(stream_free_list& list)
+  {
+    auto const largest = largest_block_bytes(list.blocks);
+    if (largest == list.largest) { return; }
+    if (list.largest > 0) { largest_free_blocks_.erase({list.largest, list.stream_event.event}); }
+    if (largest > 0) { largest_free_blocks_.emplace(largest, list.stream_event.event); }
+    list.largest = largest;
+    auto const overall = largest_free_blocks_.empty() ? 0 : largest_free_blocks_.rbegin()->first;
+    largest_free_block_.store(overall, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the size in bytes of `block`. Blocks of fixed-size resources do not store their
+   * size, which is the resource's block size.
+   */
+  std::size_t block_bytes(block_type const& block) const
+  {
+    if constexpr (std::is_same_v<block_type, block_base>) {
+      return this->underlying().get_block_size();
+    } else {
+      return block.size();
+    }
+  }
+
+  /**
+   * @brief Returns the size in bytes of the largest block in `blocks`, or 0 if it is empty. Lists
+   * of fixed-size resources do not track sizes; their blocks are all of the resource's block size.
+   */
+  std::size_t largest_block_bytes(free_list const& blocks) const
+  {
+    if (blocks.is_empty()) { return 0; }
+    if constexpr (std::is_same_v<block_type, block_base>) {
+      return this->underlying().get_block_size();
+    } else {
+      return blocks.largest_block_size();
+    }
+  }
+
+  /**
+   * @brief Adds `delta` to the allocated byte count. The caller must hold the mutex, so the
+   * counter is only ever written by one thread at a time and needs no read-modify-write.
+   */
+  void add_allocated_bytes(std::ptrdiff_t delta)
+  {
+    auto const bytes = allocated_bytes_.load(std::memory_order_relaxed);
+    allocated_bytes_.store(bytes + static_cast<std::size_t>(delta), std::memory_order_relaxed);
+  }
+
   /**
    * @brief Splits a block into an allocated block of `size` bytes and a remainder block, and
    * inserts the remainder into a free list.
    *
    * @param block The block to split into allocated and remainder portions.
    * @param size The size of the block to allocate from `b`.
-   * @param blocks The `free_list` in which to insert the remainder block.
+   * @param list The free list from which `block` was taken, and into which to insert the
+   * remainder block.
    * @return The allocated block.
    */
-  block_type allocate_and_insert_remainder(block_type block, std::size_t size, free_list& blocks)
+  block_type allocate_and_insert_remainder(block_type block,
+                                           std::size_t size,
+                                           stream_free_list& list)
   {
     auto const [allocated, remainder] = this->underlying().allocate_from_block(block, size);
-    if (remainder.is_valid()) { blocks.insert(remainder); }
+    if (remainder.is_valid()) { list.blocks.insert(remainder); }
+    update_largest_block(list);
     return allocated;
   }
 
@@ -351,24 +988,21 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
   block_type get_block(std::size_t size, stream_event_pair stream_event)
   {
     // Try to find a satisfactory block in free list for the same stream (no sync required)
-    auto iter = stream_free_blocks_.find(stream_event);
-    if (iter != stream_free_blocks_.end()) {
-      block_type const block = iter->second.get_block(size);
-      if (block.is_valid()) { return allocate_and_insert_remainder(block, size, iter->second); }
+    auto& list = get_free_list(stream_event);
+    {
+      block_type const block = list.blocks.get_block(size);
+      if (block.is_valid()) { return allocate_and_insert_remainder(block, size, list); }
     }
 
-    free_list& blocks =
-      (iter != stream_free_blocks_.end()) ? iter->second : stream_free_blocks_[stream_event];
-
     // Try to find an existing block in another stream
     {
-      block_type const block = get_block_from_other_stream(size, stream_event, blocks, false);
+      block_type const block = get_block_from_other_stream(size, list);
       if (block.is_valid()) { return block; }
     }
 
     // no large enough blocks available on other streams, so sync and merge until we find one
     {
-      block_type const block = get_block_from_other_stream(size, stream_event, blocks, true);
+      block_type const block = merge_and_get_block(size, list);
       if (block.is_valid()) { return block; }
     }
 
@@ -376,74 +1010,94 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
 
     // no large enough blocks available after merging, so grow the pool
     block_type const block =
-      this->underlying().expand_pool(size, blocks, cuda_stream_view{stream_event.stream});
+      this->underlying().expand_pool(size, list.blocks, cuda_stream_view{stream_event.stream});
 
-    return allocate_and_insert_remainder(block, size, blocks);
+    return allocate_and_insert_remainder(block, size, list);
   }
 
   /**
-   * @brief Find a free block of at least `size` bytes in a `free_list` with a different
-   * stream/event than `stream_event`.
+   * @brief Find a free block of at least `size` bytes in the free list of a stream other than
+   * that of `list`.
    *
-   * If an appropriate block is found in a free list F associated with event E,
-   * `stream_event.stream` will be made to wait on event E.
+   * Only lists whose largest block fits are visited, tightest first, so the search does not depend
+   * on the number of streams. If a block is found in a free list associated with event E,
+   * `list.stream_event.stream` will be made to wait on event E.
    *
    * @param size The requested size of the allocation.
-   * @param stream_event The stream and associated event on which the allocation is being
-   * requested.
+   * @param list The free list of the stream on which the allocation is being requested.
    * @return A block with non-null pointer and size >= `size`, or a nullptr block if none is
-   *         available in `blocks`.
+   *         available in other streams' free lists.
    */
-  block_type get_block_from_other_stream(std::size_t size,
-                                         stream_event_pair stream_event,
-                                         free_list& blocks,
-                                         bool merge_first)
+  block_type get_block_from_other_stream(std::size_t size, stream_free_list const& list)
   {
-    auto find_block = [&](auto iter) {
-      auto other_event   = iter->first.event;
-      auto& other_blocks = iter->second;
-      if (merge_first) {
-        merge_lists(stream_event, blocks, other_event, std::move(other_blocks));
-
-        RMM_LOG_DEBUG("[A][Stream {:p}][{}B][Merged stream {:p}]",
-                      fmt::ptr(stream_event.stream),
+    for (auto iter = largest_free_blocks_.lower_bound({size, nullptr});
+         iter != largest_free_blocks_.end();
+         ++iter) {
+      if (iter->second == list.stream_event.event) { continue; }
+
+      auto& other            = stream_free_blocks_.find(iter->second)->second;
+      block_type const block = other.blocks.get_block(size);
+      if (block.is_valid()) {
+        // Since we found a block associated with a different stream, we have to insert a wait
+        // on the stream's associated event into the allocating stream.
+        complete_deferred_frees(other);
+        RMM_CUDA_TRY(cudaStreamWaitEvent(list.stream_event.stream, other.stream_event.event, 0));
+        RMM_LOG_DEBUG("[A][Stream {:p}][{}B][Taken from stream {:p}]",
+                      fmt::ptr(list.stream_event.stream),
                       size,
-                      fmt::ptr(iter->first.stream));
-
-        stream_free_blocks_.erase(iter);
+                      fmt::ptr(other.stream_event.stream));
+        return allocate_and_insert_remainder(block, size, other);
+      }
+    }
+    return block_type{};
+  }
 
-        block_type const block = blocks.get_block(size);  // get the best fit block in merged lists
-        if (block.is_valid()) { return allocate_and_insert_remainder(block, size, blocks); }
-      } else {
-        block_type const block = other_blocks.get_block(size);
-        if (block.is_valid()) {
-          // Since we found a block associated with a different stream, we have to insert a wait
-          // on the stream's associated event into the allocating stream.
-          RMM_CUDA_TRY(cudaStreamWaitEvent(stream_event.stream, other_event, 0));
-          return allocate_and_insert_remainder(block, size, other_blocks);
-        }
+  /**
+   * @brief Merges the free lists of other streams into `list` one at a time until it contains a
+   * block of at least `size` bytes.
+   *
+   * Each merged stream's event is waited on by `list.stream_event.stream`, and its (now empty)
+   * free list is removed.
+   *
+   * @param size The requested size of the allocation.
+   * @param list The free list of the stream on which the allocation is being requested.
+   * @return A block with non-null pointer and size >= `size`, or a nullptr block if none is
+   *         available after merging all free lists.
+   */
+  block_type merge_and_get_block(std::size_t size, stream_free_list& list)
+  {
+    for (auto iter = stream_free_blocks_.begin(); iter != stream_free_blocks_.end();) {
+      auto& other = iter->second;
+      if (&other == &list || other.blocks.is_empty()) {
+        ++iter;
+        continue;
       }
-      return block_type{};
-    };
-
-    for (auto iter = stream_free_blocks_.begin(), next_iter = iter;
-         iter != stream_free_blocks_.end();
-         iter = next_iter) {
-      ++next_iter;  // Points to element after `iter` to allow erasing `iter` in the loop body
-
-      if (iter->first.event != stream_event.event) {
-        block_type const block = find_block(iter);
-
-        if (block.is_valid()) {
-          RMM_LOG_DEBUG((merge_first) ? "[A][Stream {:p}][{}B][Found after merging stream {:p}]"
-                                      : "[A][Stream {:p}][{}B][Taken from stream {:p}]",
-                        fmt::ptr(stream_event.stream),
-                        size,
-                        fmt::ptr(iter->first.stream));
-          return block;
-        }
+
+      complete_deferred_frees(other);
+      merge_lists(
+        list.stream_event, list.blocks, other.stream_event.event, std::move(other.blocks));
+
+      RMM_LOG_DEBUG("[A][Stream {:p}][{}B][Merged stream {:p}]",
+                    fmt::ptr(list.stream_event.stream),
+                    size,
+                    fmt::ptr(other.stream_event.stream));
+
+      [[maybe_unused]] auto const merged_stream = other.stream_event.stream;
+      other.blocks.clear();
+      update_largest_block(other);
+      iter = stream_free_blocks_.erase(iter);
+      list_retirements_.fetch_add(1, std::memory_order_relaxed);
+
+      block_type const block = list.blocks.get_block(size);  // best fit block in merged lists
+      if (block.is_valid()) {
+        RMM_LOG_DEBUG("[A][Stream {:p}][{}B][Found after merging stream {:p}]",
+                      fmt::ptr(list.stream_event.stream),
+                      size,
+                      fmt::ptr(merged_stream));
+        return allocate_and_insert_remainder(block, size, list);
       }
     }
+    update_largest_block(list);
     return block_type{};
   }
 
@@ -469,6 +1123,10 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
   {
     lock_guard lock(mtx_);
 
+    // Frees not covered by a recorded event must complete as well
+    for (auto& [event, list] : stream_free_blocks_) {
+      complete_deferred_frees(list);
+    }
     for (auto s_e : stream_events_) {
       RMM_ASSERT_CUDA_SUCCESS(cudaEventSynchronize(s_e.second.event));
       RMM_ASSERT_CUDA_SUCCESS(cudaEventDestroy(s_e.second.event));
@@ -476,6 +1134,8 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
 
     stream_events_.clear();
     stream_free_blocks_.clear();
+    largest_free_blocks_.clear();
+    largest_free_block_.store(0, std::memory_order_relaxed);
   }
 
   void log_summary_trace()
@@ -487,8 +1147,8 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
     std::for_each(stream_free_blocks_.cbegin(),
                   stream_free_blocks_.cend(),
                   [this, &num_blocks, &max_block, &free_mem](auto const& freelist) {
-                    num_blocks += freelist.second.size();
-                    auto summary = this->underlying().free_list_summary(freelist.second);
+                    num_blocks += freelist.second.blocks.size();
+                    auto summary = this->underlying().free_list_summary(freelist.second.blocks);
                     max_block    = std::max(summary.first, max_block);
                     free_mem += summary.second;
                   });
@@ -500,17 +1160,35 @@ class stream_ordered_memory_resource : public crtp<PoolResource>, public device_
 #endif
   }
 
-  // map of stream_event_pair --> free_list
+  // map of event --> free list of the associated stream
   // Event (or associated stream) must be synced before allocating from associated free_list to a
   // different stream
-  std::map<stream_event_pair, free_list> stream_free_blocks_;
+  std::unordered_map<cudaEvent_t, stream_free_list> stream_free_blocks_;
+
+  // (largest block size, event) of every non-empty free list, for cross-stream best fit
+  std::set<std::pair<std::size_t, cudaEvent_t>> largest_free_blocks_;
 
   // bidirectional mapping between non-default streams and events
   std::unordered_map<cudaStream_t, stream_event_pair> stream_events_;
 
-  std::mutex mtx_;  // mutex for thread-safe access
+  mutable std::mutex mtx_;  // mutex for thread-safe access
 
   rmm::cuda_device_id device_id_{rmm::get_current_cuda_device()};
+
+  deferred_event_options event_options_{};  // max_deferred_frees 1: record on every free
+  // Earliest time a deferred event may become overdue, or max() if no frees are deferred
+  std::chrono::steady_clock::time_point next_deferral_check_{
+    std::chrono::steady_clock::time_point::max()};
+
+  // O(1) memory statistics, written under mtx_ and read without it by get_mem_info
+  std::atomic<std::size_t> allocated_bytes_{};
+  std::atomic<std::size_t> largest_free_block_{};
+
+  thread_cache_options cache_options_{};  // max_block_size 0: thread caches disabled
+  std::uint64_t cache_owner_id_{next_thread_cache_owner_id()};
+  std::vector<std::shared_ptr<thread_cache>> thread_caches_;  // caches of all threads, under mtx_
+  // Free lists retired so far, so that thread caches forget the events of their streams
+  std::atomic<std::uint64_t> list_retirements_{};
 };  // namespace detail
 
 }  // namespace rmm::mr::detail
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/detail/aligned.hpp>
+
+#include <rmm/cuda_runtime_api.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr {
+
+/**
+ * @brief Limits for the per-thread block caches of a stream-ordered memory resource.
+ *
+ * A `max_block_size` of zero (the default) disables the caches. Cached frees are recorded on their
+ * stream's event in batches, like deferred frees, so a stream with cached frees must be flushed
+ * with `flush_deferred_frees(stream)` before it is destroyed.
+ */
+struct thread_cache_options {
+  std::size_t max_block_size{0};              ///< Largest (aligned) block size that is cached
+  std::size_t max_blocks_per_size{64};        ///< Maximum number of cached blocks of each size
+  std::size_t max_bytes_per_thread{1 << 26};  ///< Maximum total bytes cached by each thread
+};
+
+namespace detail {
+
+/**
+ * @brief A cache ("magazine") of freed blocks owned by a single thread.
+ *
+ * Blocks are cached by exact aligned size together with the stream and event they were freed on,
+ * so that a later allocation of the same size on the same stream by the same thread can reuse a
+ * block without synchronization and without taking the owning resource's lock. Only the owning
+ * thread calls `get`, `put`, `evict` and the event lookups, and these never wait: the blocks are
+ * handed between the owning thread and others by an atomic claim. The owning thread only tries to
+ * claim them, and bypasses the cache while another thread drains it because the owning resource
+ * ran out of memory; draining threads wait for the owning thread's claim to end.
+ *
+ * When the thread exits, `release()` hands any cached blocks back to the owning resource through
+ * the `reclaim` callback, unless the resource has detached the cache first.
+ *
+ * @tparam StreamEvent The stream/event pair type of the owning resource
+ */
+template <typename StreamEvent>
+class thread_cache {
+ public:
+  /// A block held in the cache and the stream/event it was freed on
+  struct cached_block {
+    void* ptr;                 ///< Pointer to the block
+    std::size_t size;          ///< Aligned size of the block
+    StreamEvent stream_event;  ///< Stream and event on which the block was freed
+  };
+
+  using reclaim_fn = std::function<void(std::vector<cached_block>&&)>;  ///< Reclaim callback
+
+  /**
+   * @brief Construct an empty cache.
+   *
+   * @param options The cache limits
+   * @param reclaim Callback that returns blocks to the owning resource when the thread exits
+   */
+  thread_cache(thread_cache_options const& options, reclaim_fn reclaim)
+    : magazines_(options.max_block_size / rmm::detail::CUDA_ALLOCATION_ALIGNMENT),
+      max_blocks_per_size_{options.max_blocks_per_size},
+      max_bytes_{options.max_bytes_per_thread},
+      reclaim_{std::move(reclaim)}
+  {
+  }
+
+  ~thread_cache() = default;
+
+  thread_cache(thread_cache const&)            = delete;
+  thread_cache& operator=(thread_cache const&) = delete;
+  thread_cache(thread_cache&&)                 = delete;
+  thread_cache& operator=(thread_cache&&)      = delete;
+
+  /**
+   * @brief Returns the stream/event pair previously remembered for `stream`, if any.
+   */
+  [[nodiscard]] std::optional<StreamEvent> find_event(cudaStream_t stream) const
+  {
+    auto const iter = std::find_if(events_.cbegin(), events_.cend(), [stream](auto const& entry) {
+      return entry.first == stream;
+    });
+    return (iter != events_.cend()) ? std::optional<StreamEvent>{iter->second} : std::nullopt;
+  }
+
+  /**
+   * @brief Remembers the stream/event pair of `stream` so later frees need not look it up.
+   */
+  void remember_event(cudaStream_t stream, StreamEvent const& stream_event)
+  {
+    events_.emplace_back(stream, stream_event);
+  }
+
+  /**
+   * @brief Forgets all remembered stream/event pairs if the owning resource has retired the free
+   * list of any stream since the last call, so that pairs of destroyed streams do not accumulate.
+   *
+   * @param retirements The number of free lists the owning resource has retired so far
+   */
+  void prune_events(std::uint64_t retirements)
+  {
+    if (retirements == retirements_seen_) { return; }
+    events_.clear();
+    retirements_seen_ = retirements;
+  }
+
+  /**
+   * @brief Removes and returns the most recently cached block of `size` bytes freed on the
+   * stream associated with `event`.
+   *
+   * @param size The aligned size of the block
+   * @param event The event of the stream on which the block will be used
+   * @return Pointer to the block, or nullptr if no such block is cached or another thread is
+   * draining the cache.
+   */
+  void* get(std::size_t size, cudaEvent_t event)
+  {
+    if (not try_claim()) { return nullptr; }
+    auto& magazine  = magazines_[index(size)];
+    auto const iter = std::find_if(magazine.rbegin(), magazine.rend(), [event](auto const& blk) {
+      return blk.stream_event.event == event;
+    });
+    void* ptr{nullptr};
+    if (iter != magazine.rend()) {
+      ptr = iter->ptr;
+      magazine.erase(std::next(iter).base());
+      cached_bytes_ -= size;
+    }
+    unclaim();
+    return ptr;
+  }
+
+  /**
+   * @brief Caches `blk` unless its magazine or the thread's byte budget is full.
+   *
+   * @return true if the block was cached; false if the cache is full or another thread is
+   * draining it.
+   */
+  bool put(cached_block const& blk)
+  {
+    if (not try_claim()) { return false; }
+    auto& magazine    = magazines_[index(blk.size)];
+    bool const cached =
+      magazine.size() < max_blocks_per_size_ && cached_bytes_ + blk.size <= max_bytes_;
+    if (cached) {
+      magazine.push_back(blk);
+      cached_bytes_ += blk.size;
+    }
+    unclaim();
+    return cached;
+  }
+
+  /**
+   * @brief Removes the older half of the magazine for `size` so it can be flushed in one batch.
+   *
+   * If that magazine is empty (the byte budget is held by other sizes), the older half of every
+   * magazine is removed instead.
+   *
+   * @param size The aligned size whose magazine is full
+   * @return The removed blocks; none if another thread is draining the cache
+   */
+  std::vector<cached_block> evict(std::size_t size)
+  {
+    std::vector<cached_block> evicted;
+    if (not try_claim()) { return evicted; }
+    auto take_older_half = [this, &evicted](auto& magazine) {
+      auto const count = (magazine.size() + 1) / 2;
+      auto const last  = std::next(magazine.begin(), static_cast<std::ptrdiff_t>(count));
+      std::for_each(magazine.begin(), last, [this](auto const& blk) { cached_bytes_ -= blk.size; });
+      evicted.insert(evicted.end(), magazine.begin(), last);
+      magazine.erase(magazine.begin(), last);
+    };
+
+    if (auto& magazine = magazines_[index(size)]; not magazine.empty()) {
+      take_older_half(magazine);
+    } else {
+      std::for_each(magazines_.begin(), magazines_.end(), take_older_half);
+    }
+    unclaim();
+    return evicted;
+  }
+
+  /**
+   * @brief Removes and returns every cached block for which `pred` returns true. May be called
+   * from any thread.
+   */
+  template <typename Predicate>
+  std::vector<cached_block> drain_if(Predicate pred)
+  {
+    claim();
+    std::vector<cached_block> drained;
+    for (auto& magazine : magazines_) {
+      auto const first = std::stable_partition(
+        magazine.begin(), magazine.end(), [&pred](auto const& blk) { return not pred(blk); });
+      std::for_each(first, magazine.end(), [this](auto const& blk) { cached_bytes_ -= blk.size; });
+      drained.insert(drained.end(), first, magazine.end());
+      magazine.erase(first, magazine.end());
+    }
+    unclaim();
+    return drained;
+  }
+
+  /**
+   * @brief Removes and returns every cached block. May be called from any thread.
+   */
+  std::vector<cached_block> drain()
+  {
+    return drain_if([](auto const&) { return true; });
+  }
+
+  /**
+   * @brief Returns cached blocks to the owning resource. Called when the owning thread exits.
+   */
+  void release()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (reclaim_) { reclaim_(drain()); }
+  }
+
+  /**
+   * @brief Severs the cache from its owning resource, which is being destroyed.
+   *
+   * Waits for a concurrent `release()` to finish; blocks still cached afterwards are never
+   * returned to the resource.
+   */
+  void detach()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    reclaim_ = nullptr;
+  }
+
+  /**
+   * @brief Whether the owning resource has detached this cache.
+   */
+  [[nodiscard]] bool is_detached()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return not reclaim_;
+  }
+
+ private:
+  /// Claims the blocks if no other thread holds them.
+  bool try_claim() noexcept
+  {
+    bool expected{false};
+    return claimed_.compare_exchange_strong(
+      expected, true, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  /// Claims the blocks, waiting for another thread's claim to end.
+  void claim() noexcept
+  {
+    while (not try_claim()) {
+      std::this_thread::yield();
+    }
+  }
+
+  void unclaim() noexcept { claimed_.store(false, std::memory_order_release); }
+
+  static std::size_t index(std::size_t size)
+  {
+    return size / rmm::detail::CUDA_ALLOCATION_ALIGNMENT - 1;
+  }
+
+  std::vector<std::vector<cached_block>> magazines_;  // one per aligned size, oldest first
+  std::size_t max_blocks_per_size_;
+  std::size_t max_bytes_;
+  std::size_t cached_bytes_{};
+  std::atomic<bool> claimed_{};  // whether a thread holds the magazines and cached_bytes_
+
+  // Used by the owning thread only
+  std::vector<std::pair<cudaStream_t, StreamEvent>> events_;
+  std::uint64_t retirements_seen_{};
+
+  std::mutex mtx_;  // guards reclaim_ against a concurrent detach
+  reclaim_fn reclaim_;
+};
+
+/**
+ * @brief The thread caches of the calling thread, one per owning resource.
+ *
+ * Instances are `thread_local`; the destructor runs on thread exit and returns cached blocks to
+ * every owner that is still alive.
+ *
+ * @tparam Cache The thread cache type, providing `release()` and `is_detached()`
+ */
+template <typename Cache>
+class thread_cache_table {
+ public:
+  thread_cache_table() = default;
+  ~thread_cache_table()
+  {
+    for (auto& entry : entries_) {
+      entry.second->release();
+    }
+  }
+
+  thread_cache_table(thread_cache_table const&)            = delete;
+  thread_cache_table& operator=(thread_cache_table const&) = delete;
+  thread_cache_table(thread_cache_table&&)                 = delete;
+  thread_cache_table& operator=(thread_cache_table&&)      = delete;
+
+  /**
+   * @brief Returns the cache of owner `owner_id`, or nullptr if this thread has none.
+   */
+  [[nodiscard]] Cache* find(std::uint64_t owner_id) const noexcept
+  {
+    auto const iter = std::find_if(entries_.cbegin(), entries_.cend(), [owner_id](auto const& e) {
+      return e.first == owner_id;
+    });
+    return (iter != entries_.cend()) ? iter->second.get() : nullptr;
+  }
+
+  /**
+   * @brief Adds the cache of owner `owner_id`, dropping caches of owners that no longer exist.
+   */
+  void insert(std::uint64_t owner_id, std::shared_ptr<Cache> cache)
+  {
+    entries_.erase(std::remove_if(entries_.begin(),
+                                  entries_.end(),
+                                  [](auto const& entry) { return entry.second->is_detached(); }),
+                   entries_.end());
+    entries_.emplace_back(owner_id, std::move(cache));
+  }
+
+ private:
+  std::vector<std::pair<std::uint64_t, std::shared_ptr<Cache>>> entries_;
+};
+
+/**
+ * @brief Returns a process-wide unique identifier for a thread cache owner.
+ *
+ * Identifiers are never reused, so a stale table entry can never match a new owner that happens to
+ * be constructed at the address of a destroyed one.
+ */
+inline std::uint64_t next_thread_cache_owner_id()
+{
+  static std::atomic<std::uint64_t> next_id{};
+  return ++next_id;
+}
+
+}  // namespace detail
+}  // namespace rmm::mr
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/detail/aligned.hpp>
+#include <rmm/mr/device/detail/coalescing_free_list.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace rmm::mr::detail {
+
+/**
+ * @brief A free list of memory blocks organized as a two-level segregated fit (TLSF) structure.
+ *
+ * Free blocks are binned into size classes. The first level splits sizes by power of two, and the
+ * second level splits each power-of-two range linearly into `sl_count` classes. A bitmap per level
+ * records which classes are non-empty, so finding a class that is guaranteed to satisfy a request
+ * takes a constant number of bit-scan operations regardless of the number of free blocks.
+ *
+ * Device memory cannot hold boundary tags, so physical neighbors are found through hash maps
+ * keyed by the start and end addresses of each free block. Both `insert` (including coalescing)
+ * and `get_block` are therefore O(1) (expected).
+ */
+class tlsf_free_list {
+ public:
+  using block_type = block;        ///< The type of block managed by the free list
+  using size_type  = std::size_t;  ///< The type used to count blocks
+
+  tlsf_free_list()  = default;
+  ~tlsf_free_list() = default;
+
+  tlsf_free_list(tlsf_free_list const&)            = delete;
+  tlsf_free_list& operator=(tlsf_free_list const&) = delete;
+  tlsf_free_list(tlsf_free_list&&)                 = delete;
+  tlsf_free_list& operator=(tlsf_free_list&&)      = delete;
+
+  /**
+   * @brief The size of the free list in blocks.
+   *
+   * @return size_type The number of blocks in the free list.
+   */
+  [[nodiscard]] size_type size() const noexcept { return by_start_.size(); }
+
+  /**
+   * @brief checks whether the free_list is empty.
+   *
+   * @return true If there are no blocks in the free_list.
+   * @return false If there are blocks in the free_list.
+   */
+  [[nodiscard]] bool is_empty() const noexcept { return by_start_.empty(); }
+
+  /**
+   * @brief Inserts a block into the free list, coalescing it with its physical predecessor and
+   * successor if either is free and contiguous.
+   *
+   * @param blk The block to insert.
+   */
+  void insert(block_type const& blk)
+  {
+    block_type merged = blk;
+
+    if (not blk.is_head()) {
+      auto const prev = by_end_.find(blk.pointer());
+      if (prev != by_end_.end()) {
+        auto const iter = prev->second;
+        merged          = iter->merge(merged);
+        remove(iter);
+      }
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    auto const next = by_start_.find(merged.pointer() + merged.size());
+    if (next != by_start_.end() && not next->second->is_head()) {
+      auto const iter = next->second;
+      merged          = merged.merge(*iter);
+      remove(iter);
+    }
+
+    insert_into_bin(merged);
+  }
+
+  /**
+   * @brief Moves blocks from free list `other` into this free list, coalescing contiguous blocks.
+   *
+   * `other` is empty after this call.
+   *
+   * @param other The free list of blocks to insert
+   */
+  void insert(tlsf_free_list&& other)
+  {
+    other.for_each([this](block_type const& blk) { insert(blk); });
+    other.clear();
+  }
+
+  /**
+   * @brief Returns a free block of at least `size` bytes, removing it from the free list.
+   *
+   * The request is rounded up to the next size class boundary so that any block in the first
+   * non-empty class found by the bitmap search fits ("good fit"). As in TLSF, a block in the
+   * request's own size class that happens to fit is not searched for, so that the search takes
+   * constant time; the pool grows instead.
+   *
+   * @param size The size in bytes of the desired block.
+   * @return A block large enough to store `size` bytes, or an invalid block if none is available.
+   */
+  block_type get_block(std::size_t size)
+  {
+    auto const [fl, sl] = mapping_search(size);
+    auto* bin           = find_suitable_bin(fl, sl);
+    if (bin == nullptr) { return block_type{}; }  // not found
+    block_type const found = bin->front();
+    remove(bin->begin());
+    return found;
+  }
+
+  /**
+   * @brief Returns the size of the largest request `get_block` can serve.
+   *
+   * This is the lower bound of the highest non-empty size class, found with two bit scans. It is
+   * at most 1/16th smaller than the largest free block, which good-fit search cannot fully use.
+   *
+   * @return The size in bytes of the largest servable request, or 0 if the list is empty.
+   */
+  [[nodiscard]] std::size_t largest_block_size() const noexcept
+  {
+    if (fl_bitmap_ == 0) { return 0; }
+    auto const fl = most_significant_bit(fl_bitmap_);
+    return class_lower_bound(fl, most_significant_bit(sl_bitmaps_[fl]));
+  }
+
+  /**
+   * @brief Erase all blocks from the free list.
+   */
+  void clear() noexcept
+  {
+    std::for_each(bins_.begin(), bins_.end(), [](auto& bin) { bin.clear(); });
+    by_start_.clear();
+    by_end_.clear();
+    fl_bitmap_ = 0;
+    sl_bitmaps_.fill(0);
+  }
+
+  /**
+   * @brief Invokes `visit` on every block in the free list, in no particular order.
+   *
+   * @tparam Visitor A callable taking a `block_type const&`
+   * @param visit The callable to invoke
+   */
+  template <typename Visitor>
+  void for_each(Visitor visit) const
+  {
+    for (auto const& bin : bins_) {
+      std::for_each(bin.cbegin(), bin.cend(), visit);
+    }
+  }
+
+#ifdef RMM_DEBUG_PRINT
+  /**
+   * @brief Print all blocks in the free list.
+   */
+  void print() const
+  {
+    std::cout << size() << '\n';
+    for_each([](block_type const& blk) { blk.print(); });
+  }
+#endif
+
+ private:
+  using bin_type = std::list<block_type>;
+
+  static constexpr std::size_t granularity{rmm::detail::CUDA_ALLOCATION_ALIGNMENT};
+  static constexpr int sl_log2{4};                 // log2 of the number of second-level classes
+  static constexpr int sl_count{1 << sl_log2};     // second-level classes per first-level class
+  static constexpr int fl_count{64};               // first-level classes (bits in fl_bitmap_)
+  static constexpr int bin_count{fl_count * sl_count};
+
+  static constexpr std::size_t bin_index(int fl, int sl)
+  {
+    return static_cast<std::size_t>(fl) * sl_count + static_cast<std::size_t>(sl);
+  }
+
+  static int most_significant_bit(std::size_t value)
+  {
+    return std::numeric_limits<unsigned long long>::digits - 1 -
+           __builtin_clzll(static_cast<unsigned long long>(value));
+  }
+
+  /**
+   * @brief Returns the size class of a block of `units` allocation granules.
+   *
+   * Classes below `sl_count` granules are exact; above that each power of two is split into
+   * `sl_count` equal classes.
+   */
+  static std::pair<int, int> bin_for_units(std::size_t units)
+  {
+    if (units < static_cast<std::size_t>(sl_count)) { return {0, static_cast<int>(units)}; }
+    auto const msb = most_significant_bit(units);
+    return {msb - sl_log2 + 1, static_cast<int>(units >> (msb - sl_log2)) - sl_count};
+  }
+
+  /// The smallest block size in class (`fl`, `sl`), the inverse of `bin_for_units`
+  static std::size_t class_lower_bound(int fl, int sl)
+  {
+    auto const units = (fl == 0) ? static_cast<std::size_t>(sl)
+                                 : static_cast<std::size_t>(sl_count + sl) << (fl - 1);
+    return units * granularity;
+  }
+
+  /// The size class a free block of `size` bytes is stored in
+  static std::pair<int, int> mapping_insert(std::size_t size)
+  {
+    return bin_for_units(size / granularity);
+  }
+
+  /// The smallest size class whose blocks are all at least `size` bytes
+  static std::pair<int, int> mapping_search(std::size_t size)
+  {
+    auto units = (size + granularity - 1) / granularity;
+    if (units >= static_cast<std::size_t>(sl_count)) {
+      units += (std::size_t{1} << (most_significant_bit(units) - sl_log2)) - 1;
+    }
+    return bin_for_units(units);
+  }
+
+  /**
+   * @brief Finds the first non-empty bin at or above class (`fl`, `sl`) using the bitmaps.
+   *
+   * @return Pointer to the bin, or nullptr if every such bin is empty.
+   */
+  bin_type* find_suitable_bin(int fl, int sl)
+  {
+    if (fl >= fl_count) { return nullptr; }
+    auto sl_map = sl_bitmaps_[fl] & (~std::uint32_t{0} << sl);
+    if (sl_map == 0) {
+      auto const fl_map = (fl + 1 < fl_count) ? fl_bitmap_ & (~std::uint64_t{0} << (fl + 1)) : 0;
+      if (fl_map == 0) { return nullptr; }
+      fl     = __builtin_ctzll(fl_map);
+      sl_map = sl_bitmaps_[fl];
+    }
+    return &bins_[bin_index(fl, __builtin_ctz(sl_map))];
+  }
+
+  void insert_into_bin(block_type const& blk)
+  {
+    auto const [fl, sl] = mapping_insert(blk.size());
+    auto& bin           = bins_[bin_index(fl, sl)];
+    bin.push_front(blk);
+    by_start_[blk.pointer()] = bin.begin();
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    by_end_[blk.pointer() + blk.size()] = bin.begin();
+    sl_bitmaps_[fl] |= std::uint32_t{1} << sl;
+    fl_bitmap_ |= std::uint64_t{1} << fl;
+  }
+
+  void remove(bin_type::iterator iter)
+  {
+    auto const [fl, sl] = mapping_insert(iter->size());
+    by_start_.erase(iter->pointer());
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    by_end_.erase(iter->pointer() + iter->size());
+    auto& bin = bins_[bin_index(fl, sl)];
+    bin.erase(iter);
+    if (bin.empty()) {
+      sl_bitmaps_[fl] &= ~(std::uint32_t{1} << sl);
+      if (sl_bitmaps_[fl] == 0) { fl_bitmap_ &= ~(std::uint64_t{1} << fl); }
+    }
+  }
+
+  std::uint64_t fl_bitmap_{};                        // bit i set if any class in sl_bitmaps_[i]
+  std::array<std::uint32_t, fl_count> sl_bitmaps_{};  // bit j set if bins_[i][j] is non-empty
+  std::array<bin_type, bin_count> bins_;
+
+  // free blocks indexed by start and by end address, for physical-neighbor coalescing
+  std::unordered_map<char const*, bin_type::iterator> by_start_;
+  std::unordered_map<char const*, bin_type::iterator> by_end_;
+};  // tlsf_free_list
+
+}  // namespace rmm::mr::detail
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/cuda_stream_view.hpp>
+#include <rmm/detail/aligned.hpp>
+#include <rmm/detail/cuda_util.hpp>
+#include <rmm/detail/error.hpp>
+#include <rmm/logger.hpp>
+#include <rmm/mr/device/detail/coalescing_free_list.hpp>
+#include <rmm/mr/device/growth_policy.hpp>
+
+#include <rmm/detail/thrust_namespace.h>
+#include <thrust/optional.h>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr::detail {
+
+/**
+ * @brief The upstream allocations of a coalescing pool suballocator.
+ *
+ * Grows the pool from an upstream memory resource by the amount a `growth_policy` chooses,
+ * backing off towards the requested size when upstream fails, and returns upstream allocations
+ * either one at a time (to trim the pool) or all at once. Shared by `pool_memory_resource` and
+ * `tlsf_memory_resource`, which differ only in how they keep their free blocks.
+ *
+ * Not synchronized: the owning resource calls every member except `pool_size()` with its lock
+ * held.
+ *
+ * @tparam Upstream memory_resource to use for allocating the pool
+ */
+template <typename Upstream>
+class upstream_blocks {
+ public:
+  using block_type = block;  ///< The type of an upstream allocation
+  using block_set  = std::set<block_type, compare_blocks<block_type>>;  ///< Address-ordered set
+
+  /**
+   * @brief Construct an empty set of upstream allocations.
+   *
+   * @throws rmm::logic_error if `upstream_mr == nullptr` or `growth == nullptr`
+   *
+   * @param upstream_mr The memory_resource from which to allocate blocks for the pool
+   * @param growth The policy that sizes expansions of the pool, of which a private copy is made
+   */
+  upstream_blocks(Upstream* upstream_mr, std::shared_ptr<growth_policy> const& growth)
+    : upstream_mr_{upstream_mr}, growth_policy_{(growth != nullptr) ? growth->clone() : nullptr}
+  {
+    RMM_EXPECTS(nullptr != upstream_mr_, "Unexpected null upstream pointer.");
+    RMM_EXPECTS(nullptr != growth_policy_, "Unexpected null growth policy.");
+  }
+
+  /**
+   * @brief Get the upstream memory_resource object.
+   *
+   * @return Upstream* the upstream memory resource.
+   */
+  [[nodiscard]] Upstream* get_upstream() const noexcept { return upstream_mr_; }
+
+  /**
+   * @brief Returns the total size of the upstream allocations. May be read without the owner's
+   * lock.
+   *
+   * @return std::size_t The size of the pool in bytes
+   */
+  [[nodiscard]] std::size_t pool_size() const noexcept { return pool_size_; }
+
+  /**
+   * @brief Returns the policy that sizes expansions of the pool.
+   *
+   * @return growth_policy& The growth policy
+   */
+  [[nodiscard]] growth_policy& get_growth_policy() const noexcept { return *growth_policy_; }
+
+  /**
+   * @brief Allocate the initial upstream block of the pool.
+   *
+   * If initial_size is unset, then queries the upstream memory resource for available memory if
+   * upstream supports `get_mem_info`, or queries the device (using CUDA API) for available memory
+   * if not. Then attempts to initialize to half the available memory.
+   *
+   * @throws rmm::logic_error if either size is neither unset nor aligned to a multiple of 256 bytes,
+   * or if the initial size exceeds the maximum size
+   * @throws rmm::out_of_memory if the initial block cannot be allocated
+   *
+   * @param initial_size The optional initial size for the pool
+   * @param maximum_size The optional maximum size for the pool
+   * @return block_type The initial block, or an invalid block if the pool starts empty
+   */
+  // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+  block_type initialize(thrust::optional<std::size_t> initial_size,
+                        thrust::optional<std::size_t> maximum_size)
+  {
+    RMM_EXPECTS(rmm::detail::is_aligned(initial_size.value_or(0),
+                                        rmm::detail::CUDA_ALLOCATION_ALIGNMENT),
+                "Error, Initial pool size required to be a multiple of 256 bytes");
+    RMM_EXPECTS(rmm::detail::is_aligned(maximum_size.value_or(0),
+                                        rmm::detail::CUDA_ALLOCATION_ALIGNMENT),
+                "Error, Maximum pool size required to be a multiple of 256 bytes");
+
+    auto const try_size = [&]() {
+      if (not initial_size.has_value()) {
+        auto const [free, total] = (get_upstream()->supports_get_mem_info())
+                                     ? get_upstream()->get_mem_info(cuda_stream_legacy)
+                                     : rmm::detail::available_device_memory();
+        return rmm::detail::align_up(std::min(free, total / 2),
+                                     rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+      }
+      return initial_size.value();
+    }();
+
+    pool_size_         = 0;  // try_to_expand will set this if it succeeds
+    maximum_pool_size_ = maximum_size;
+
+    RMM_EXPECTS(try_size <= maximum_pool_size_.value_or(std::numeric_limits<std::size_t>::max()),
+                "Initial pool size exceeds the maximum pool size!");
+
+    return (try_size > 0) ? try_to_expand(try_size, try_size, cuda_stream_legacy) : block_type{};
+  }
+
+  /**
+   * @brief Allocate a new upstream block of at least `size` bytes.
+   *
+   * Grows by the amount chosen by the growth policy. Upon failure, backs off exponentially, i.e.
+   * by half the attempted size, until either success or the attempt is less than `size`.
+   *
+   * @throws rmm::out_of_memory if `size` bytes cannot be allocated from upstream or the maximum
+   * pool size is exceeded.
+   *
+   * @param size The minimum size to allocate
+   * @param stream The stream on which the memory is to be used.
+   * @return block_type a block of at least `size` bytes
+   */
+  block_type expand(std::size_t size, cuda_stream_view stream)
+  {
+    return try_to_expand(size_to_grow(size), size, stream);
+  }
+
+  /**
+   * @brief Whether `ptr` is the start of an upstream allocation.
+   */
+  [[nodiscard]] bool is_head(void* ptr) const
+  {
+    return blocks_.find(static_cast<char*>(ptr)) != blocks_.end();
+  }
+
+  /**
+   * @brief Returns the upstream allocation that contains `ptr`.
+   *
+   * @return block_type The allocation, or an invalid block if `ptr` is not in the pool
+   */
+  [[nodiscard]] block_type containing(void* ptr) const
+  {
+    auto const* address = static_cast<char*>(ptr);
+    auto iter           = blocks_.upper_bound(address);
+    if (iter == blocks_.begin()) { return block_type{}; }
+    --iter;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return (address < iter->pointer() + iter->size()) ? *iter : block_type{};
+  }
+
+  /**
+   * @brief Returns the upstream allocations, largest first.
+   */
+  [[nodiscard]] std::vector<block_type> largest_first() const
+  {
+    std::vector<block_type> sorted(blocks_.begin(), blocks_.end());
+    std::sort(sorted.begin(), sorted.end(), [](auto const& lhs, auto const& rhs) {
+      return lhs.size() > rhs.size();
+    });
+    return sorted;
+  }
+
+  /**
+   * @brief Returns the upstream allocation `block`, which must be entirely free and no longer in
+   * use on any stream, to upstream.
+   */
+  void release(block_type const& block)
+  {
+    RMM_LOG_DEBUG("[T][Upstream {}B][{:p}]", block.size(), fmt::ptr(block.pointer()));
+    get_upstream()->deallocate(block.pointer(), block.size());
+    blocks_.erase(block);
+    pool_size_ -= block.size();
+  }
+
+  /**
+   * @brief Returns every upstream allocation to upstream.
+   */
+  void release()
+  {
+    for (auto const& block : blocks_) {
+      get_upstream()->deallocate(block.pointer(), block.size());
+    }
+    blocks_.clear();
+    pool_size_ = 0;
+  }
+
+  /// @return An iterator to the first upstream allocation, in address order
+  [[nodiscard]] auto begin() const noexcept { return blocks_.begin(); }
+  /// @return An iterator past the last upstream allocation
+  [[nodiscard]] auto end() const noexcept { return blocks_.end(); }
+  /// @return The number of upstream allocations
+  [[nodiscard]] std::size_t size() const noexcept { return blocks_.size(); }
+
+ private:
+  /**
+   * @brief Try to allocate a block of at least `min_size` bytes from upstream, starting with
+   * `try_size` bytes and halving the attempt until `min_size`.
+   */
+  block_type try_to_expand(std::size_t try_size, std::size_t min_size, cuda_stream_view stream)
+  {
+    while (try_size >= min_size) {
+      auto block = block_from_upstream(try_size, stream);
+      if (block.has_value()) {
+        pool_size_ += block.value().size();
+        return block.value();
+      }
+      if (try_size == min_size) {
+        break;  // only try `size` once
+      }
+      try_size = std::max(min_size, try_size / 2);
+    }
+    RMM_LOG_ERROR("[A][Stream {}][Upstream {}B][FAILURE maximum pool size exceeded]",
+                  fmt::ptr(stream.value()),
+                  min_size);
+    RMM_FAIL("Maximum pool size exceeded", rmm::out_of_memory);
+  }
+
+  /**
+   * @brief Given a minimum size, computes an appropriate size to grow the pool.
+   *
+   * The growth policy chooses the size, which is then clamped to at least `size` and at most the
+   * space remaining below the maximum pool size, if it is set. Returns 0 if the requested size
+   * cannot be satisfied.
+   */
+  [[nodiscard]] std::size_t size_to_grow(std::size_t size) const
+  {
+    using rmm::detail::align_up;
+    auto const aligned_size = align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+    auto const growth       = std::max(
+      aligned_size, growth_policy_->size_to_grow(aligned_size, pool_size(), maximum_pool_size_));
+    if (maximum_pool_size_.has_value()) {
+      auto const unaligned_remaining = maximum_pool_size_.value() - pool_size();
+      auto const remaining = align_up(unaligned_remaining, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+      return (aligned_size <= remaining) ? std::min(growth, remaining) : 0;
+    }
+    return growth;
+  }
+
+  /**
+   * @brief Allocate a block of `size` bytes from upstream, or return an empty optional if
+   * upstream allocation fails.
+   */
+  thrust::optional<block_type> block_from_upstream(std::size_t size, cuda_stream_view stream)
+  {
+    RMM_LOG_DEBUG("[A][Stream {}][Upstream {}B]", fmt::ptr(stream.value()), size);
+
+    if (size == 0) { return {}; }
+
+    try {
+      void* ptr = get_upstream()->allocate(size, stream);
+      return thrust::optional<block_type>{
+        *blocks_.emplace(static_cast<char*>(ptr), size, true).first};
+    } catch (std::exception const& e) {
+      return thrust::nullopt;
+    }
+  }
+
+  Upstream* upstream_mr_;  // The "heap" to allocate the pool from
+  std::unique_ptr<growth_policy> growth_policy_;  // this pool's own copy
+  std::atomic<std::size_t> pool_size_{};
+  thrust::optional<std::size_t> maximum_pool_size_{};
+  block_set blocks_;  // blocks allocated from upstream
+};
+
+}  // namespace rmm::mr::detail
@@ -40,19 +40,22 @@
 #include <rmm/detail/aligned.hpp>
 #include <rmm/detail/error.hpp>
 #include <rmm/detail/logging_assert.hpp>
+#include <rmm/logger.hpp>
 #include <rmm/mr/device/detail/fixed_size_free_list.hpp>
 #include <rmm/mr/device/detail/stream_ordered_memory_resource.hpp>
 
 #include <rmm/detail/thrust_namespace.h>
 #include <thrust/iterator/counting_iterator.h>
 #include <thrust/iterator/transform_iterator.h>
+#include <thrust/optional.h>
+
+#include <fmt/core.h>
 
 #include <rmm/cuda_runtime_api.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
-#include <list>
-#include <map>
 #include <utility>
 #include <vector>
 
@@ -67,6 +70,12 @@ namespace rmm::mr {
  * @brief A `device_memory_resource` which allocates memory blocks of a single fixed size.
  *
  * Supports only allocations of size smaller than the configured block_size.
+ *
+ * Blocks are carved from chunks allocated from upstream, and free blocks are kept in array-backed
+ * stacks, one per stream. The resource counts the allocated blocks of each chunk, so chunks whose
+ * blocks are all free can be returned upstream with `trim()`. With a release threshold, the
+ * resource trims itself to the threshold whenever a deallocation leaves a chunk entirely free
+ * while the resource is at least a chunk larger than the threshold.
  */
 template <typename Upstream>
 class fixed_size_memory_resource
@@ -92,14 +101,18 @@ class fixed_size_memory_resource
    * @param upstream_mr The memory_resource from which to allocate blocks for the pool.
    * @param block_size The size of blocks to allocate.
    * @param blocks_to_preallocate The number of blocks to allocate to initialize the pool.
+   * @param release_threshold Optional size in bytes above which entirely free chunks are returned
+   * to upstream after deallocations. By default memory is only released on destruction.
    */
   explicit fixed_size_memory_resource(
     Upstream* upstream_mr,
-    std::size_t block_size            = default_block_size,
-    std::size_t blocks_to_preallocate = default_blocks_to_preallocate)
+    std::size_t block_size                          = default_block_size,
+    std::size_t blocks_to_preallocate               = default_blocks_to_preallocate,
+    thrust::optional<std::size_t> release_threshold = thrust::nullopt)
     : upstream_mr_{upstream_mr},
       block_size_{rmm::detail::align_up(block_size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT)},
-      upstream_chunk_size_{block_size * blocks_to_preallocate}
+      upstream_chunk_size_{block_size * blocks_to_preallocate},
+      release_threshold_{release_threshold}
   {
     // allocate initial blocks and insert into free list
     this->insert_blocks(std::move(blocks_from_upstream(cuda_stream_legacy)), cuda_stream_legacy);
@@ -128,9 +141,9 @@ class fixed_size_memory_resource
   /**
    * @brief Query whether the resource supports the get_mem_info API.
    *
-   * @return false
+   * @return true
    */
-  [[nodiscard]] bool supports_get_mem_info() const noexcept override { return false; }
+  [[nodiscard]] bool supports_get_mem_info() const noexcept override { return true; }
 
   /**
    * @brief Get the upstream memory_resource object.
@@ -146,12 +159,72 @@ class fixed_size_memory_resource
    */
   [[nodiscard]] std::size_t get_block_size() const noexcept { return block_size_; }
 
+  /**
+   * @brief Computes the size of the current pool of blocks, allocated and free.
+   *
+   * @return std::size_t The total size of the blocks carved from upstream chunks
+   */
+  [[nodiscard]] std::size_t pool_size() const noexcept { return pool_size_; }
+
+  /**
+   * @brief Returns the size of the largest free block, across all streams.
+   *
+   * This is O(1) and does not lock the resource.
+   *
+   * @return std::size_t The block size if any block is free, otherwise 0
+   */
+  [[nodiscard]] std::size_t largest_free_block() const noexcept
+  {
+    return this->largest_free_block_size();
+  }
+
+  /**
+   * @brief Returns entirely free chunks to the upstream resource, keeping at least `target` bytes
+   * of blocks.
+   *
+   * A chunk can be returned once all of its blocks have been freed. Its blocks are removed from
+   * the free lists of every stream that holds them, and the host waits for the work last ordered
+   * before those streams' frees to complete before returning the chunk. Takes time proportional
+   * to the number of free blocks.
+   *
+   * @param target Minimum size in bytes of blocks to keep
+   * @return std::size_t The number of bytes returned to upstream
+   */
+  std::size_t trim(std::size_t target)
+  {
+    lock_guard lock(this->get_mutex());
+    return trim_unlocked(target);
+  }
+
+  /**
+   * @brief Returns the total number of bytes returned to upstream by trimming.
+   *
+   * @return std::size_t Bytes trimmed since construction
+   */
+  [[nodiscard]] std::size_t bytes_trimmed() const noexcept
+  {
+    return bytes_trimmed_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the number of chunks returned to upstream by trimming.
+   *
+   * @return std::size_t Chunks trimmed since construction
+   */
+  [[nodiscard]] std::size_t chunks_trimmed() const noexcept
+  {
+    return chunks_trimmed_.load(std::memory_order_relaxed);
+  }
+
  protected:
   using free_list  = detail::fixed_size_free_list;  ///< The free list type
   using block_type = free_list::block_type;         ///< The type of block managed by the free list
   using typename detail::stream_ordered_memory_resource<fixed_size_memory_resource<Upstream>,
                                                         detail::fixed_size_free_list>::split_block;
   using lock_guard = std::lock_guard<std::mutex>;  ///< Type of lock used to synchronize access
+  using stream_ordered_base =
+    detail::stream_ordered_memory_resource<fixed_size_memory_resource<Upstream>,
+                                           detail::fixed_size_free_list>;  ///< The base class
 
   /**
    * @brief Get the (fixed) size of allocations supported by this memory resource
@@ -187,10 +260,13 @@ class fixed_size_memory_resource
   free_list blocks_from_upstream(cuda_stream_view stream)
   {
     void* ptr = get_upstream()->allocate(upstream_chunk_size_, stream);
-    block_type block{ptr};
-    upstream_blocks_.push_back(block);
+    auto* const start = static_cast<char*>(ptr);
+    chunks_.insert(std::upper_bound(chunks_.begin(), chunks_.end(), start, starts_before),
+                   chunk{start});
+    ++free_chunks_;
 
     auto num_blocks = upstream_chunk_size_ / block_size_;
+    pool_size_ += chunk_pool_size();
 
     auto block_gen = [ptr, this](int index) {
       // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
@@ -213,6 +289,7 @@ class fixed_size_memory_resource
    */
   split_block allocate_from_block(block_type const& block, std::size_t size)
   {
+    if (chunk_of(block.pointer()).allocated++ == 0) { --free_chunks_; }
     return {block, block_type{nullptr}};
   }
 
@@ -230,21 +307,85 @@ class fixed_size_memory_resource
     // handled by the parent class
     RMM_LOGGING_ASSERT(rmm::detail::align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT) <=
                        block_size_);
+    if (--chunk_of(ptr).allocated == 0) { ++free_chunks_; }
     return block_type{ptr};
   }
 
   /**
-   * @brief Get free and available memory for memory resource
+   * @brief Deallocate memory pointed to by `ptr`, then trim to the release threshold if one is
+   * set, a chunk is entirely free, and the pool exceeds the threshold by at least a chunk.
+   *
+   * @throws nothing
+   *
+   * @param ptr Pointer to be deallocated
+   * @param size The size in bytes of the allocation to deallocate
+   * @param stream The stream in which to order this deallocation
+   */
+  void do_deallocate(void* ptr, std::size_t size, cuda_stream_view stream) override
+  {
+    stream_ordered_base::do_deallocate(ptr, size, stream);
+    if (release_threshold_.has_value()) {
+      lock_guard lock(this->get_mutex());
+      if (free_chunks_ > 0 && pool_size() >= release_threshold_.value() + chunk_pool_size()) {
+        trim_unlocked(release_threshold_.value());
+      }
+    }
+  }
+
+  /**
+   * @brief Returns entirely free chunks to upstream while at least `target` bytes of blocks
+   * remain. The caller must hold the mutex.
+   *
+   * @param target Minimum size in bytes of blocks to keep
+   * @return std::size_t The number of bytes returned to upstream
+   */
+  std::size_t trim_unlocked(std::size_t target)
+  {
+    std::size_t reclaimed{0};
+    for (auto& chk : chunks_) {
+      if (chk.allocated == 0 && pool_size() >= target + (reclaimed + 1) * chunk_pool_size()) {
+        chk.reclaiming = true;
+        ++reclaimed;
+      }
+    }
+    if (reclaimed == 0) { return 0; }
+
+    [[maybe_unused]] auto const taken = this->take_free_blocks_if(
+      [this](block_type const& block) { return chunk_of(block.pointer()).reclaiming; });
+    RMM_LOGGING_ASSERT(taken * block_size_ == reclaimed * chunk_pool_size());
+
+    for (auto const& chk : chunks_) {
+      if (chk.reclaiming) {
+        RMM_LOG_DEBUG("[T][Upstream {}B][{:p}]", upstream_chunk_size_, fmt::ptr(chk.start));
+        get_upstream()->deallocate(chk.start, upstream_chunk_size_);
+      }
+    }
+    chunks_.erase(std::remove_if(chunks_.begin(),
+                                 chunks_.end(),
+                                 [](auto const& chk) { return chk.reclaiming; }),
+                  chunks_.end());
+    free_chunks_ -= reclaimed;
+    pool_size_ -= reclaimed * chunk_pool_size();
+    bytes_trimmed_.fetch_add(reclaimed * upstream_chunk_size_, std::memory_order_relaxed);
+    chunks_trimmed_.fetch_add(reclaimed, std::memory_order_relaxed);
+    return reclaimed * upstream_chunk_size_;
+  }
+
+  /**
+   * @brief Get free and total memory in the blocks of this resource
    *
-   * @throws std::runtime_error if we could not get free / total memory
+   * Total is the size of all blocks carved from upstream chunks; free is the size of the blocks
+   * not currently allocated. Both are maintained counters, so this is O(1).
    *
-   * @param stream the stream being executed on
-   * @return std::pair with available and free memory for resource
+   * @param stream the stream being executed on (unused)
+   * @return std::pair with free and total memory for resource
    */
   [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
     [[maybe_unused]] cuda_stream_view stream) const override
   {
-    return std::make_pair(0, 0);
+    auto const total = pool_size_.load();
+    auto const used  = this->allocated_bytes();
+    return std::make_pair((total > used) ? total - used : 0, total);
   }
 
   /**
@@ -255,10 +396,12 @@ class fixed_size_memory_resource
   {
     lock_guard lock(this->get_mutex());
 
-    for (auto block : upstream_blocks_) {
-      get_upstream()->deallocate(block.pointer(), upstream_chunk_size_);
+    for (auto const& chk : chunks_) {
+      get_upstream()->deallocate(chk.start, upstream_chunk_size_);
     }
-    upstream_blocks_.clear();
+    chunks_.clear();
+    free_chunks_ = 0;
+    pool_size_   = 0;
   }
 
 #ifdef RMM_DEBUG_PRINT
@@ -269,11 +412,11 @@ class fixed_size_memory_resource
     auto const [free, total] = get_upstream()->get_mem_info(rmm::cuda_stream_default);
     std::cout << "GPU free memory: " << free << " total: " << total << "\n";
 
-    std::cout << "upstream_blocks: " << upstream_blocks_.size() << "\n";
+    std::cout << "upstream_blocks: " << chunks_.size() << "\n";
     std::size_t upstream_total{0};
 
-    for (auto blocks : upstream_blocks_) {
-      blocks.print();
+    for (auto const& chk : chunks_) {
+      std::cout << static_cast<void*>(chk.start) << " allocated blocks: " << chk.allocated << "\n";
       upstream_total += upstream_chunk_size_;
     }
     std::cout << "total upstream: " << upstream_total << " B\n";
@@ -297,13 +440,43 @@ class fixed_size_memory_resource
   }
 
  private:
+  /// A chunk allocated from upstream and the number of its blocks currently allocated.
+  struct chunk {
+    char* start{};
+    std::size_t allocated{};
+    bool reclaiming{};  // being returned to upstream by trim_unlocked
+  };
+
+  static bool starts_before(char const* ptr, chunk const& chk) { return ptr < chk.start; }
+
+  /// The size of the blocks carved from one chunk.
+  [[nodiscard]] std::size_t chunk_pool_size() const noexcept
+  {
+    return (upstream_chunk_size_ / block_size_) * block_size_;
+  }
+
+  /// The chunk containing `ptr`. The caller must hold the mutex.
+  chunk& chunk_of(void const* ptr) noexcept
+  {
+    auto iter = std::upper_bound(
+      chunks_.begin(), chunks_.end(), static_cast<char const*>(ptr), starts_before);
+    RMM_LOGGING_ASSERT(iter != chunks_.begin());
+    return *--iter;
+  }
+
   Upstream* upstream_mr_;  // The resource from which to allocate new blocks
 
   std::size_t const block_size_;           // size of blocks this MR allocates
   std::size_t const upstream_chunk_size_;  // size of chunks allocated from heap MR
+  std::atomic<std::size_t> pool_size_{};   // total size of blocks carved from upstream chunks
+
+  thrust::optional<std::size_t> release_threshold_{};
+  std::atomic<std::size_t> bytes_trimmed_{};  // written under the mutex, read without it
+  std::atomic<std::size_t> chunks_trimmed_{};
 
-  // blocks allocated from heap: so they can be easily freed
-  std::vector<block_type> upstream_blocks_;
+  // chunks allocated from upstream, in address order, under the mutex
+  std::vector<chunk> chunks_;
+  std::size_t free_chunks_{};  // chunks with no allocated blocks
 };
 
 /** @} */  // end of group
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/detail/aligned.hpp>
+#include <rmm/detail/error.hpp>
+
+#include <rmm/detail/thrust_namespace.h>
+#include <thrust/optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_memory_resources
+ * @{
+ * @file
+ */
+
+/**
+ * @brief Strategy deciding how many bytes a pool requests from upstream when it must grow.
+ *
+ * The pool calls `size_to_grow` with its lock held whenever no free block can satisfy an
+ * allocation, and clamps the result to at least the requested size and at most the space left
+ * below the maximum pool size. If the upstream allocation fails, the pool halves the attempt until
+ * it reaches the requested size. `record_allocation` is called, also with the lock held, for every
+ * allocation served from the pool so that a policy can adapt to the workload.
+ *
+ * Each pool works on its own copy of the policy made with `clone`, so one policy object can
+ * configure several pools. The copy is not otherwise synchronized.
+ */
+class growth_policy {
+ public:
+  growth_policy()                                = default;
+  virtual ~growth_policy()                       = default;
+  growth_policy(growth_policy const&)            = default;
+  growth_policy& operator=(growth_policy const&) = default;
+  growth_policy(growth_policy&&)                 = default;
+  growth_policy& operator=(growth_policy&&)      = default;
+
+  /**
+   * @brief Returns the number of bytes to request from upstream.
+   *
+   * @param size The aligned size of the allocation that could not be satisfied
+   * @param pool_size The current size of the pool
+   * @param maximum_pool_size The maximum size of the pool, if any
+   * @return std::size_t The desired growth in bytes
+   */
+  [[nodiscard]] virtual std::size_t size_to_grow(
+    std::size_t size, std::size_t pool_size, thrust::optional<std::size_t> maximum_pool_size) = 0;
+
+  /**
+   * @brief Observes an allocation served from the pool. Does nothing by default.
+   *
+   * @param size The aligned size of the allocation
+   */
+  virtual void record_allocation([[maybe_unused]] std::size_t size) {}
+
+  /**
+   * @brief Returns a copy of this policy, including any state it has recorded.
+   *
+   * @return std::unique_ptr<growth_policy> The copy
+   */
+  [[nodiscard]] virtual std::unique_ptr<growth_policy> clone() const = 0;
+};
+
+/**
+ * @brief The default growth policy: grow halfway to the maximum pool size if there is one,
+ * otherwise double the pool.
+ */
+class default_growth_policy final : public growth_policy {
+ public:
+  /**
+   * @copydoc growth_policy::size_to_grow
+   */
+  [[nodiscard]] std::size_t size_to_grow(
+    std::size_t size,
+    std::size_t pool_size,
+    thrust::optional<std::size_t> maximum_pool_size) override
+  {
+    if (maximum_pool_size.has_value()) {
+      return std::max(size, (maximum_pool_size.value() - pool_size) / 2);
+    }
+    return std::max(size, pool_size);
+  }
+
+  /**
+   * @copydoc growth_policy::clone
+   */
+  [[nodiscard]] std::unique_ptr<growth_policy> clone() const override
+  {
+    return std::make_unique<default_growth_policy>(*this);
+  }
+};
+
+/**
+ * @brief Grows the pool by the smallest multiple of a fixed chunk size that fits the allocation.
+ *
+ * Keeps every upstream allocation the same size, which avoids large requests that fail on a shared
+ * device and then fall back to many small ones.
+ */
+class fixed_chunk_growth_policy final : public growth_policy {
+ public:
+  /**
+   * @brief Construct a fixed-chunk growth policy.
+   *
+   * @throws rmm::logic_error if `chunk_size` is zero or not a multiple of 256 bytes
+   *
+   * @param chunk_size The size in bytes of each upstream allocation
+   */
+  explicit fixed_chunk_growth_policy(std::size_t chunk_size) : chunk_size_{chunk_size}
+  {
+    RMM_EXPECTS(chunk_size > 0 and
+                  rmm::detail::is_aligned(chunk_size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT),
+                "Chunk size must be a non-zero multiple of 256 bytes");
+  }
+
+  /**
+   * @copydoc growth_policy::size_to_grow
+   */
+  [[nodiscard]] std::size_t size_to_grow(std::size_t size,
+                                         std::size_t,
+                                         thrust::optional<std::size_t>) override
+  {
+    return rmm::detail::align_up(size, chunk_size_);
+  }
+
+  /**
+   * @copydoc growth_policy::clone
+   */
+  [[nodiscard]] std::unique_ptr<growth_policy> clone() const override
+  {
+    return std::make_unique<fixed_chunk_growth_policy>(*this);
+  }
+
+ private:
+  std::size_t chunk_size_;
+};
+
+/**
+ * @brief Grows the pool geometrically, but by no more than a fixed cap per expansion.
+ *
+ * The pool grows by `(factor - 1)` times its current size, so early expansions are cheap in
+ * upstream calls while the cap bounds the size of any single upstream request.
+ */
+class geometric_growth_policy final : public growth_policy {
+ public:
+  /**
+   * @brief Construct a geometric growth policy.
+   *
+   * @throws rmm::logic_error if `factor` is not greater than 1
+   *
+   * @param factor The factor by which each expansion multiplies the pool size
+   * @param max_chunk_size The largest expansion in bytes, unless a single allocation needs more
+   */
+  geometric_growth_policy(double factor, std::size_t max_chunk_size)
+    : factor_{factor}, max_chunk_size_{max_chunk_size}
+  {
+    RMM_EXPECTS(factor > 1.0, "Growth factor must be greater than 1");
+  }
+
+  /**
+   * @copydoc growth_policy::size_to_grow
+   */
+  [[nodiscard]] std::size_t size_to_grow(std::size_t size,
+                                         std::size_t pool_size,
+                                         thrust::optional<std::size_t>) override
+  {
+    auto const growth = static_cast<std::size_t>(static_cast<double>(pool_size) * (factor_ - 1.0));
+    return std::max(size,
+                    rmm::detail::align_up(std::min(growth, max_chunk_size_),
+                                          rmm::detail::CUDA_ALLOCATION_ALIGNMENT));
+  }
+
+  /**
+   * @copydoc growth_policy::clone
+   */
+  [[nodiscard]] std::unique_ptr<growth_policy> clone() const override
+  {
+    return std::make_unique<geometric_growth_policy>(*this);
+  }
+
+ private:
+  double factor_;
+  std::size_t max_chunk_size_;
+};
+
+/**
+ * @brief Sizes each expansion from the recent allocation history.
+ *
+ * The policy tracks the bytes requested by the last `window` allocations served from the pool and
+ * grows by that amount, i.e. by the demand the workload placed on the pool in the recent past,
+ * clamped to `[min_chunk_size, max_chunk_size]`. Bursty workloads therefore receive large
+ * expansions and steady ones small expansions.
+ */
+class adaptive_growth_policy final : public growth_policy {
+ public:
+  /**
+   * @brief Construct an adaptive growth policy.
+   *
+   * @throws rmm::logic_error if `window` is zero or `min_chunk_size > max_chunk_size`
+   *
+   * @param window The number of recent allocations considered
+   * @param min_chunk_size The smallest expansion in bytes
+   * @param max_chunk_size The largest expansion in bytes, unless a single allocation needs more
+   */
+  adaptive_growth_policy(std::size_t window,
+                         std::size_t min_chunk_size,
+                         std::size_t max_chunk_size)
+    : history_(window), min_chunk_size_{min_chunk_size}, max_chunk_size_{max_chunk_size}
+  {
+    RMM_EXPECTS(window > 0, "History window must not be empty");
+    RMM_EXPECTS(min_chunk_size <= max_chunk_size,
+                "Minimum chunk size must not exceed the maximum chunk size");
+  }
+
+  /**
+   * @copydoc growth_policy::size_to_grow
+   */
+  [[nodiscard]] std::size_t size_to_grow(std::size_t size,
+                                         std::size_t,
+                                         thrust::optional<std::size_t>) override
+  {
+    auto const demand = std::clamp(recent_bytes_, min_chunk_size_, max_chunk_size_);
+    return std::max(size, rmm::detail::align_up(demand, rmm::detail::CUDA_ALLOCATION_ALIGNMENT));
+  }
+
+  /**
+   * @copydoc growth_policy::record_allocation
+   */
+  void record_allocation(std::size_t size) override
+  {
+    recent_bytes_ += size - history_[next_];
+    history_[next_] = size;
+    next_           = (next_ + 1) % history_.size();
+  }
+
+  /**
+   * @copydoc growth_policy::clone
+   */
+  [[nodiscard]] std::unique_ptr<growth_policy> clone() const override
+  {
+    return std::make_unique<adaptive_growth_policy>(*this);
+  }
+
+ private:
+  std::vector<std::size_t> history_;  // ring buffer of the most recent allocation sizes
+  std::size_t next_{};                // index of the oldest entry in history_
+  std::size_t recent_bytes_{};        // sum of history_
+  std::size_t min_chunk_size_;
+  std::size_t max_chunk_size_;
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
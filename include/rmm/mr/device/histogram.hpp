@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_memory_resources
+ * @{
+ * @file
+ */
+
+/**
+ * @brief A log-linear histogram of unsigned 64-bit values, in the style of HDR histograms.
+ *
+ * Values below 16 have a bucket each. Above that, every power-of-two range `[2^k, 2^(k+1))` is
+ * split into `sub_buckets` equal buckets, so a bucket's bounds are within 12.5% of any value in it
+ * and all 64-bit values fit in `num_buckets` buckets. Histograms with this fixed layout can be
+ * merged by adding their bucket counts.
+ */
+struct histogram {
+  /// Number of buckets per power of two.
+  static constexpr std::size_t sub_buckets{8};
+  /// Number of buckets covering all 64-bit values.
+  static constexpr std::size_t num_buckets{(std::numeric_limits<std::uint64_t>::digits - 2) *
+                                           sub_buckets};
+
+  std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(num_buckets);  ///< Per bucket
+  std::uint64_t count{};  ///< Number of recorded values
+  std::uint64_t sum{};    ///< Sum of recorded values, wrapping on overflow
+  std::uint64_t min{};    ///< Smallest recorded value, or 0 if empty
+  std::uint64_t max{};    ///< Largest recorded value, or 0 if empty
+
+  /**
+   * @brief The index of the bucket holding `value`.
+   */
+  static constexpr std::size_t bucket_of(std::uint64_t value) noexcept
+  {
+    if (value < 2 * sub_buckets) { return static_cast<std::size_t>(value); }
+    // Keep the four most significant bits of the value: the leading one and three more
+    auto const shift = static_cast<std::size_t>(std::numeric_limits<std::uint64_t>::digits - 4 -
+                                                __builtin_clzll(value));
+    return shift * sub_buckets + static_cast<std::size_t>(value >> shift);
+  }
+
+  /**
+   * @brief The smallest value in bucket `bucket`.
+   */
+  static constexpr std::uint64_t bucket_lower_bound(std::size_t bucket) noexcept
+  {
+    if (bucket < 2 * sub_buckets) { return bucket; }
+    auto const shift = bucket / sub_buckets - 1;
+    return static_cast<std::uint64_t>(bucket % sub_buckets + sub_buckets) << shift;
+  }
+
+  /**
+   * @brief The largest value in bucket `bucket`.
+   */
+  static constexpr std::uint64_t bucket_upper_bound(std::size_t bucket) noexcept
+  {
+    if (bucket < 2 * sub_buckets) { return bucket; }
+    auto const shift = bucket / sub_buckets - 1;
+    return bucket_lower_bound(bucket) + ((std::uint64_t{1} << shift) - 1);
+  }
+
+  /**
+   * @brief Records `value`.
+   *
+   * @param value The value to record
+   */
+  void record(std::uint64_t value)
+  {
+    ++counts[bucket_of(value)];
+    min = (count == 0) ? value : std::min(min, value);
+    max = std::max(max, value);
+    sum += value;
+    ++count;
+  }
+
+  /**
+   * @brief Adds the values recorded in `other` to this histogram.
+   *
+   * @param other The histogram to merge
+   * @return histogram& Reference to this object
+   */
+  histogram& operator+=(histogram const& other)
+  {
+    if (other.count == 0) { return *this; }
+    for (std::size_t i = 0; i < num_buckets; ++i) {
+      counts[i] += other.counts[i];
+    }
+    min = (count == 0) ? other.min : std::min(min, other.min);
+    max = std::max(max, other.max);
+    sum += other.sum;
+    count += other.count;
+    return *this;
+  }
+
+  /**
+   * @brief The mean of the recorded values, or 0 if empty.
+   */
+  [[nodiscard]] double mean() const noexcept
+  {
+    return count == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(count);
+  }
+
+  /**
+   * @brief A value that at least `pct` percent of the recorded values are less than or equal to.
+   *
+   * The result is the upper bound of the bucket holding that percentile, limited to the largest
+   * recorded value, so it overestimates the exact percentile by at most the bucket's width.
+   *
+   * @param pct The percentile, in `[0, 100]`
+   * @return std::uint64_t The percentile value, or 0 if empty
+   */
+  [[nodiscard]] std::uint64_t percentile(double pct) const noexcept
+  {
+    if (count == 0) { return 0; }
+    auto const rank = std::clamp(
+      static_cast<std::uint64_t>(std::ceil(std::clamp(pct, 0.0, 100.0) / 100 *
+                                           static_cast<double>(count))),
+      std::uint64_t{1},
+      count);
+    std::uint64_t seen{0};
+    for (std::size_t i = 0; i < num_buckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) { return std::min(std::max(bucket_upper_bound(i), min), max); }
+    }
+    return max;
+  }
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
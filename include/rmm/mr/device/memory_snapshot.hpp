@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_memory_resources
+ * @{
+ * @file
+ */
+
+/**
+ * @brief A point-in-time description of the memory held by a suballocating resource and of how
+ * its free memory is fragmented.
+ *
+ * A snapshot lists the regions allocated from upstream and, for each free list (the global arena,
+ * a per-thread or per-stream arena, or a stream's free list in a pool), its free bytes, largest
+ * free block and, where the resource has them, its superblocks. Individual free extents are only
+ * listed up to the limit passed when taking the snapshot; `complete` is false if some were left
+ * out. The summary figures always cover all free memory.
+ *
+ * Each free list is read under its own lock, so the lists are individually consistent but may be
+ * taken at slightly different times while other threads allocate.
+ */
+struct memory_snapshot {
+  /// Default limit on the number of free extents listed.
+  static constexpr std::size_t default_max_extents{1024};
+
+  /// A contiguous range of device memory.
+  struct extent {
+    std::uintptr_t address{};  ///< Start address
+    std::size_t size{};        ///< Size in bytes
+  };
+
+  /// Summary of a superblock of an arena.
+  struct superblock {
+    std::uintptr_t address{};    ///< Start address
+    std::size_t size{};          ///< Size in bytes
+    std::size_t free_bytes{};    ///< Free bytes in the superblock
+    std::size_t largest_free{};  ///< Size of the largest free block
+    std::size_t free_blocks{};   ///< Number of free blocks
+  };
+
+  /// The free memory held by one arena or stream.
+  struct free_list {
+    std::string owner;                    ///< "global", "thread <id>" or "stream <handle>"
+    std::size_t free_bytes{};             ///< Free bytes in the list
+    std::size_t largest_free{};           ///< Size of the largest free block
+    std::size_t free_blocks{};            ///< Number of free blocks
+    std::vector<superblock> superblocks;  ///< Superblocks held, for arenas
+    std::vector<extent> extents;          ///< Free extents, in address order, up to the limit
+  };
+
+  std::size_t total_bytes{};          ///< Bytes allocated from upstream
+  std::size_t free_bytes{};           ///< Free bytes over all free lists
+  std::size_t largest_free{};         ///< Largest free block over all free lists
+  std::vector<extent> regions;        ///< Allocations from upstream
+  std::vector<free_list> free_lists;  ///< One entry per arena or stream
+  bool complete{true};                ///< False if free extents were left out
+
+  /**
+   * @brief The fraction of free memory that cannot serve an allocation of all free bytes at once,
+   * `1 - largest_free / free_bytes`, or 0 if nothing is free.
+   *
+   * @return double The fragmentation index in `[0, 1)`
+   */
+  [[nodiscard]] double fragmentation() const noexcept
+  {
+    if (free_bytes == 0) { return 0; }
+    return 1 - static_cast<double>(largest_free) / static_cast<double>(free_bytes);
+  }
+
+  /**
+   * @brief Adds `list` to the snapshot and to its totals.
+   *
+   * @param list The free list to add
+   */
+  void add(free_list&& list)
+  {
+    free_bytes += list.free_bytes;
+    largest_free = std::max(largest_free, list.largest_free);
+    free_lists.push_back(std::move(list));
+  }
+
+  /**
+   * @brief Serializes the snapshot as a JSON object. Addresses are written as hexadecimal strings.
+   *
+   * @return std::string The JSON text
+   */
+  [[nodiscard]] std::string to_json() const
+  {
+    std::ostringstream out;
+    out << R"({"total_bytes":)" << total_bytes << R"(,"free_bytes":)" << free_bytes
+        << R"(,"largest_free":)" << largest_free << R"(,"fragmentation":)" << fragmentation()
+        << R"(,"complete":)" << (complete ? "true" : "false") << R"(,"regions":)";
+    write_extents(out, regions);
+    out << R"(,"free_lists":[)";
+    for (std::size_t i = 0; i < free_lists.size(); ++i) {
+      auto const& list = free_lists[i];
+      if (i > 0) { out << ','; }
+      out << R"({"owner":")" << list.owner << R"(","free_bytes":)" << list.free_bytes
+          << R"(,"largest_free":)" << list.largest_free << R"(,"free_blocks":)" << list.free_blocks
+          << R"(,"superblocks":[)";
+      for (std::size_t j = 0; j < list.superblocks.size(); ++j) {
+        auto const& sblk = list.superblocks[j];
+        if (j > 0) { out << ','; }
+        out << R"({"address":)";
+        write_address(out, sblk.address);
+        out << R"(,"size":)" << sblk.size << R"(,"free_bytes":)" << sblk.free_bytes
+            << R"(,"largest_free":)" << sblk.largest_free << R"(,"free_blocks":)"
+            << sblk.free_blocks << '}';
+      }
+      out << R"(],"extents":)";
+      write_extents(out, list.extents);
+      out << '}';
+    }
+    out << "]}";
+    return out.str();
+  }
+
+ private:
+  static void write_address(std::ostringstream& out, std::uintptr_t address)
+  {
+    out << "\"0x" << std::hex << address << std::dec << '"';
+  }
+
+  static void write_extents(std::ostringstream& out, std::vector<extent> const& extents)
+  {
+    out << '[';
+    for (std::size_t i = 0; i < extents.size(); ++i) {
+      if (i > 0) { out << ','; }
+      out << R"({"address":)";
+      write_address(out, extents[i].address);
+      out << R"(,"size":)" << extents[i].size << '}';
+    }
+    out << ']';
+  }
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
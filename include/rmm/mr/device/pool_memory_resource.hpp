@@ -44,7 +44,10 @@
 #include <rmm/logger.hpp>
 #include <rmm/mr/device/detail/coalescing_free_list.hpp>
 #include <rmm/mr/device/detail/stream_ordered_memory_resource.hpp>
+#include <rmm/mr/device/detail/upstream_blocks.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/growth_policy.hpp>
+#include <rmm/mr/device/memory_snapshot.hpp>
 
 #include <rmm/detail/thrust_namespace.h>
 #include <thrust/iterator/counting_iterator.h>
@@ -56,9 +59,12 @@
 #include <rmm/cuda_runtime_api.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <set>
@@ -73,6 +79,34 @@ namespace rmm::mr {
  * @file
  */
 
+/**
+ * @brief Options for constructing a `pool_memory_resource`, also available as
+ * `pool_memory_resource<Upstream>::options`.
+ *
+ * Every field has a default, so callers set only the fields they need.
+ */
+struct pool_memory_resource_options {
+  /// Minimum size, in bytes, of the initial pool. Defaults to half of the available memory on the
+  /// current device.
+  thrust::optional<std::size_t> initial_pool_size{};
+  /// Maximum size, in bytes, that the pool can grow to. Defaults to all of the available memory on
+  /// the current device.
+  thrust::optional<std::size_t> maximum_pool_size{};
+  /// Limits for the per-thread block caches. Defaults to disabled. When enabled, streams must be
+  /// flushed with `flush_deferred_frees()` before they are destroyed.
+  thread_cache_options thread_cache{};
+  /// When to record stream events after deallocations. Defaults to every deallocation. When
+  /// deferred, streams must be flushed with `flush_deferred_frees()` before they are destroyed.
+  deferred_event_options deferred_events{};
+  /// Size in bytes above which the pool returns entirely free upstream allocations after
+  /// deallocations, without waiting on the device. By default memory is only released on
+  /// destruction.
+  thrust::optional<std::size_t> release_threshold{};
+  /// The policy that sizes expansions of the pool. Each pool constructed from these options works
+  /// on its own copy.
+  std::shared_ptr<growth_policy> growth{std::make_shared<default_growth_policy>()};
+};
+
 /**
  * @brief A coalescing best-fit suballocator which uses a pool of memory allocated from
  *        an upstream memory_resource.
@@ -80,6 +114,21 @@ namespace rmm::mr {
  * Allocation (do_allocate()) and deallocation (do_deallocate()) are thread-safe. Also,
  * this class is compatible with CUDA per-thread default stream.
  *
+ * Optionally, freed blocks up to a configured size are kept in per-thread caches (see
+ * `thread_cache_options`). A thread that frees and then reallocates a block of the same size on
+ * the same stream is served from its cache without taking the pool lock, which removes lock
+ * contention for host-multithreaded workloads dominated by small allocations. Full caches are
+ * flushed back to the pool in batches, a thread's cache is returned to the pool when the thread
+ * exits, and the caches of all threads are returned when an allocation would otherwise fail.
+ *
+ * The pool grows on demand and can be shrunk with `trim()`, which returns upstream allocations
+ * that are entirely free. With a release threshold, a deallocation that leaves an upstream
+ * allocation entirely free returns it to upstream, as long as the pool stays at or above the
+ * threshold.
+ *
+ * How much the pool grows by is decided by a `growth_policy`. By default it grows halfway to the
+ * maximum pool size, or doubles if there is no maximum.
+ *
  * @tparam UpstreamResource memory_resource to use for allocating the pool. Implements
  *                          rmm::mr::device_memory_resource interface.
  */
@@ -91,6 +140,8 @@ class pool_memory_resource final
   friend class detail::stream_ordered_memory_resource<pool_memory_resource<Upstream>,
                                                       detail::coalescing_free_list>;
 
+  using options = pool_memory_resource_options;  ///< Options for constructing the resource
+
   /**
    * @brief Construct a `pool_memory_resource` and allocate the initial device memory pool using
    * `upstream_mr`.
@@ -110,19 +161,28 @@ class pool_memory_resource final
   explicit pool_memory_resource(Upstream* upstream_mr,
                                 thrust::optional<std::size_t> initial_pool_size = thrust::nullopt,
                                 thrust::optional<std::size_t> maximum_pool_size = thrust::nullopt)
-    : upstream_mr_{[upstream_mr]() {
-        RMM_EXPECTS(nullptr != upstream_mr, "Unexpected null upstream pointer.");
-        return upstream_mr;
-      }()}
+    : pool_memory_resource(upstream_mr, options{initial_pool_size, maximum_pool_size})
+  {
+  }
+
+  /**
+   * @brief Construct a `pool_memory_resource` with the given options and allocate the initial
+   * device memory pool using `upstream_mr`.
+   *
+   * @throws rmm::logic_error if `upstream_mr == nullptr` or `opts.growth == nullptr`
+   * @throws rmm::logic_error if `opts.initial_pool_size` or `opts.maximum_pool_size` is neither
+   * unset nor aligned to a multiple of pool_memory_resource::allocation_alignment bytes.
+   *
+   * @param upstream_mr The memory_resource from which to allocate blocks for the pool.
+   * @param opts The pool options
+   */
+  pool_memory_resource(Upstream* upstream_mr, options const& opts)
+    : upstream_{upstream_mr, opts.growth}, release_threshold_{opts.release_threshold}
   {
-    RMM_EXPECTS(rmm::detail::is_aligned(initial_pool_size.value_or(0),
-                                        rmm::detail::CUDA_ALLOCATION_ALIGNMENT),
-                "Error, Initial pool size required to be a multiple of 256 bytes");
-    RMM_EXPECTS(rmm::detail::is_aligned(maximum_pool_size.value_or(0),
-                                        rmm::detail::CUDA_ALLOCATION_ALIGNMENT),
-                "Error, Maximum pool size required to be a multiple of 256 bytes");
-
-    initialize_pool(initial_pool_size, maximum_pool_size);
+    auto const block = upstream_.initialize(opts.initial_pool_size, opts.maximum_pool_size);
+    if (block.is_valid()) { this->insert_block(block, cuda_stream_legacy); }
+    this->enable_thread_cache(opts.thread_cache);
+    this->defer_event_records(opts.deferred_events);
   }
 
   /**
@@ -148,16 +208,16 @@ class pool_memory_resource final
   /**
    * @brief Query whether the resource supports the get_mem_info API.
    *
-   * @return bool false
+   * @return bool true
    */
-  [[nodiscard]] bool supports_get_mem_info() const noexcept override { return false; }
+  [[nodiscard]] bool supports_get_mem_info() const noexcept override { return true; }
 
   /**
    * @brief Get the upstream memory_resource object.
    *
    * @return UpstreamResource* the upstream memory resource.
    */
-  Upstream* get_upstream() const noexcept { return upstream_mr_; }
+  Upstream* get_upstream() const noexcept { return upstream_.get_upstream(); }
 
   /**
    * @brief Computes the size of the current pool
@@ -166,163 +226,111 @@ class pool_memory_resource final
    *
    * @return std::size_t The total size of the currently allocated pool.
    */
-  [[nodiscard]] std::size_t pool_size() const noexcept { return current_pool_size_; }
-
- protected:
-  using free_list  = detail::coalescing_free_list;  ///< The free list implementation
-  using block_type = free_list::block_type;         ///< The type of block returned by the free list
-  using typename detail::stream_ordered_memory_resource<pool_memory_resource<Upstream>,
-                                                        detail::coalescing_free_list>::split_block;
-  using lock_guard = std::lock_guard<std::mutex>;  ///< Type of lock used to synchronize access
+  [[nodiscard]] std::size_t pool_size() const noexcept { return upstream_.pool_size(); }
 
   /**
-   * @brief Get the maximum size of allocations supported by this memory resource
+   * @brief Returns the size of the largest free block in the pool, across all streams.
    *
-   * Note this does not depend on the memory size of the device. It simply returns the maximum
-   * value of `std::size_t`
+   * Blocks held in per-thread caches are not included. This is O(1) and does not lock the pool.
    *
-   * @return std::size_t The maximum size of a single allocation supported by this memory resource
+   * @return std::size_t The size in bytes of the largest free block
    */
-  [[nodiscard]] std::size_t get_maximum_allocation_size() const
+  [[nodiscard]] std::size_t largest_free_block() const noexcept
   {
-    return std::numeric_limits<std::size_t>::max();
+    return this->largest_free_block_size();
   }
 
   /**
-   * @brief Try to expand the pool by allocating a block of at least `min_size` bytes from
-   * upstream
-   *
-   * Attempts to allocate `try_size` bytes from upstream. If it fails, it iteratively reduces the
-   * attempted size by half until `min_size`, returning the allocated block once it succeeds.
+   * @brief Takes a snapshot of the upstream allocations and of the free list of every stream.
    *
-   * @throws rmm::bad_alloc if `min_size` bytes cannot be allocated from upstream or maximum pool
-   * size is exceeded.
+   * Each free list is summarized in O(1), so the pool is locked for time proportional to its
+   * number of upstream allocations and streams plus the free extents listed, of which there are
+   * at most `max_extents`. Blocks held in per-thread caches count as allocated.
    *
-   * @param try_size The initial requested size to try allocating.
-   * @param min_size The minimum requested size to try allocating.
-   * @param stream The stream on which the memory is to be used.
-   * @return block_type a block of at least `min_size` bytes
+   * @param max_extents The maximum number of free extents to list
+   * @return memory_snapshot The snapshot
    */
-  block_type try_to_expand(std::size_t try_size, std::size_t min_size, cuda_stream_view stream)
+  [[nodiscard]] memory_snapshot snapshot(
+    std::size_t max_extents = memory_snapshot::default_max_extents) const
   {
-    while (try_size >= min_size) {
-      auto block = block_from_upstream(try_size, stream);
-      if (block.has_value()) {
-        current_pool_size_ += block.value().size();
-        return block.value();
-      }
-      if (try_size == min_size) {
-        break;  // only try `size` once
-      }
-      try_size = std::max(min_size, try_size / 2);
+    lock_guard lock(this->get_mutex());
+    memory_snapshot snap;
+    snap.total_bytes = pool_size();
+    snap.regions.reserve(upstream_.size());
+    for (auto const& block : upstream_) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      snap.regions.push_back({reinterpret_cast<std::uintptr_t>(block.pointer()), block.size()});
     }
-    RMM_LOG_ERROR("[A][Stream {}][Upstream {}B][FAILURE maximum pool size exceeded]",
-                  fmt::ptr(stream.value()),
-                  min_size);
-    RMM_FAIL("Maximum pool size exceeded", rmm::out_of_memory);
+    this->snapshot_free_lists(snap, max_extents);
+    return snap;
   }
 
   /**
-   * @brief Allocate initial memory for the pool
-   *
-   * If initial_size is unset, then queries the upstream memory resource for available memory if
-   * upstream supports `get_mem_info`, or queries the device (using CUDA API) for available memory
-   * if not. Then attempts to initialize to half the available memory.
+   * @brief Returns entirely free upstream allocations to the upstream resource, keeping at least
+   * `target` bytes in the pool.
    *
-   * If initial_size is set, then tries to initialize the pool to that size.
+   * An upstream allocation can be returned only once all of its blocks have been freed and have
+   * coalesced back into a single block in one stream's free list. The host waits for the work
+   * last ordered before that block was freed to complete before returning it.
    *
-   * @param initial_size The optional initial size for the pool
-   * @param maximum_size The optional maximum size for the pool
+   * @param target Minimum size in bytes to keep in the pool
+   * @return std::size_t The number of bytes returned to upstream
    */
-  // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-  void initialize_pool(thrust::optional<std::size_t> initial_size,
-                       thrust::optional<std::size_t> maximum_size)
+  std::size_t trim(std::size_t target)
   {
-    auto const try_size = [&]() {
-      if (not initial_size.has_value()) {
-        auto const [free, total] = (get_upstream()->supports_get_mem_info())
-                                     ? get_upstream()->get_mem_info(cuda_stream_legacy)
-                                     : rmm::detail::available_device_memory();
-        return rmm::detail::align_up(std::min(free, total / 2),
-                                     rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
-      }
-      return initial_size.value();
-    }();
-
-    current_pool_size_ = 0;  // try_to_expand will set this if it succeeds
-    maximum_pool_size_ = maximum_size;
-
-    RMM_EXPECTS(try_size <= maximum_pool_size_.value_or(std::numeric_limits<std::size_t>::max()),
-                "Initial pool size exceeds the maximum pool size!");
-
-    if (try_size > 0) {
-      auto const block = try_to_expand(try_size, try_size, cuda_stream_legacy);
-      this->insert_block(block, cuda_stream_legacy);
-    }
+    lock_guard lock(this->get_mutex());
+    return trim_unlocked(target);
   }
 
   /**
-   * @brief Allocate space from upstream to supply the suballocation pool and return
-   * a sufficiently sized block.
+   * @brief Returns the total number of bytes returned to upstream by trimming.
    *
-   * @param size The minimum size to allocate
-   * @param blocks The free list (ignored in this implementation)
-   * @param stream The stream on which the memory is to be used.
-   * @return block_type a block of at least `size` bytes
+   * @return std::size_t Bytes trimmed since construction
    */
-  block_type expand_pool(std::size_t size, free_list& blocks, cuda_stream_view stream)
-  {
-    // Strategy: If maximum_pool_size_ is set, then grow geometrically, e.g. by halfway to the
-    // limit each time. If it is not set, grow exponentially, e.g. by doubling the pool size each
-    // time. Upon failure, attempt to back off exponentially, e.g. by half the attempted size,
-    // until either success or the attempt is less than the requested size.
-    return try_to_expand(size_to_grow(size), size, stream);
-  }
+  [[nodiscard]] std::size_t bytes_trimmed() const noexcept { return bytes_trimmed_; }
 
   /**
-   * @brief Given a minimum size, computes an appropriate size to grow the pool.
+   * @brief Returns the number of upstream allocations returned to upstream by trimming.
    *
-   * Strategy is to try to grow the pool by half the difference between the configured maximum
-   * pool size and the current pool size, if the maximum pool size is set. If it is not set, try
-   * to double the current pool size.
+   * @return std::size_t Upstream blocks trimmed since construction
+   */
+  [[nodiscard]] std::size_t blocks_trimmed() const noexcept { return blocks_trimmed_; }
+
+ protected:
+  using free_list  = detail::coalescing_free_list;  ///< The free list implementation
+  using block_type = free_list::block_type;         ///< The type of block returned by the free list
+  using typename detail::stream_ordered_memory_resource<pool_memory_resource<Upstream>,
+                                                        detail::coalescing_free_list>::split_block;
+  using lock_guard = std::lock_guard<std::mutex>;  ///< Type of lock used to synchronize access
+  using stream_ordered_base =
+    detail::stream_ordered_memory_resource<pool_memory_resource<Upstream>,
+                                           detail::coalescing_free_list>;  ///< The base class
+
+  /**
+   * @brief Get the maximum size of allocations supported by this memory resource
    *
-   * Returns 0 if the requested size cannot be satisfied.
+   * Note this does not depend on the memory size of the device. It simply returns the maximum
+   * value of `std::size_t`
    *
-   * @param size The size of the minimum allocation immediately needed
-   * @return std::size_t The computed size to grow the pool.
+   * @return std::size_t The maximum size of a single allocation supported by this memory resource
    */
-  [[nodiscard]] std::size_t size_to_grow(std::size_t size) const
+  [[nodiscard]] std::size_t get_maximum_allocation_size() const
   {
-    if (maximum_pool_size_.has_value()) {
-      auto const unaligned_remaining = maximum_pool_size_.value() - pool_size();
-      using rmm::detail::align_up;
-      auto const remaining = align_up(unaligned_remaining, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
-      auto const aligned_size = align_up(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
-      return (aligned_size <= remaining) ? std::max(aligned_size, remaining / 2) : 0;
-    }
-    return std::max(size, pool_size());
-  };
+    return std::numeric_limits<std::size_t>::max();
+  }
 
   /**
-   * @brief Allocate a block from upstream to expand the suballocation pool.
+   * @brief Allocate space from upstream to supply the suballocation pool and return
+   * a sufficiently sized block.
    *
-   * @param size The size in bytes to allocate from the upstream resource
+   * @param size The minimum size to allocate
+   * @param blocks The free list (ignored in this implementation)
    * @param stream The stream on which the memory is to be used.
-   * @return block_type The allocated block
+   * @return block_type a block of at least `size` bytes
    */
-  thrust::optional<block_type> block_from_upstream(std::size_t size, cuda_stream_view stream)
+  block_type expand_pool(std::size_t size, free_list& blocks, cuda_stream_view stream)
   {
-    RMM_LOG_DEBUG("[A][Stream {}][Upstream {}B]", fmt::ptr(stream.value()), size);
-
-    if (size == 0) { return {}; }
-
-    try {
-      void* ptr = get_upstream()->allocate(size, stream);
-      return thrust::optional<block_type>{
-        *upstream_blocks_.emplace(static_cast<char*>(ptr), size, true).first};
-    } catch (std::exception const& e) {
-      return thrust::nullopt;
-    }
+    return upstream_.expand(size, stream);
   }
 
   /**
@@ -338,6 +346,7 @@ class pool_memory_resource final
   split_block allocate_from_block(block_type const& block, std::size_t size)
   {
     block_type const alloc{block.pointer(), size, block.is_head()};
+    upstream_.get_growth_policy().record_allocation(size);
 #ifdef RMM_POOL_TRACK_ALLOCATIONS
     allocated_blocks_.insert(alloc);
 #endif
@@ -370,28 +379,112 @@ class pool_memory_resource final
 
     return block;
 #else
-    auto const iter = upstream_blocks_.find(static_cast<char*>(ptr));
-    return block_type{static_cast<char*>(ptr), size, (iter != upstream_blocks_.end())};
+    return block_type{static_cast<char*>(ptr), size, upstream_.is_head(ptr)};
 #endif
   }
 
+  /**
+   * @brief Deallocate memory pointed to by `ptr`. If a release threshold is set, the pool exceeds
+   * it, and the freed block has coalesced into an entire upstream allocation, that allocation is
+   * returned to upstream as long as the pool stays at or above the threshold.
+   *
+   * Never waits on the device: an upstream allocation is returned only once the work ordered
+   * before its frees has completed. Allocations that are still in use by the device are retried on
+   * later deallocations, and `trim()` returns any that remain.
+   *
+   * @throws nothing
+   *
+   * @param ptr Pointer to be deallocated
+   * @param size The size in bytes of the allocation to deallocate
+   * @param stream The stream in which to order this deallocation
+   */
+  void do_deallocate(void* ptr, std::size_t size, cuda_stream_view stream) override
+  {
+    stream_ordered_base::do_deallocate(ptr, size, stream);
+    if (release_threshold_.has_value() && pool_size() > release_threshold_.value()) {
+      lock_guard lock(this->get_mutex());
+      auto const block = upstream_.containing(ptr);
+      auto const known = std::any_of(
+        pending_releases_.cbegin(), pending_releases_.cend(), [&block](auto const& pending) {
+          return pending.pointer() == block.pointer() && pending.size() == block.size();
+        });
+      if (block.is_valid() && not known) { pending_releases_.push_back(block); }
+      release_completed_blocks(release_threshold_.value());
+    }
+  }
+
+  /**
+   * @brief Returns the upstream allocations queued by `do_deallocate` whose frees have completed,
+   * while the pool stays at least `target` bytes. The caller must hold the mutex.
+   *
+   * Allocations whose frees are still pending stay queued; the rest are dropped from the queue.
+   *
+   * @param target Minimum size in bytes to keep in the pool
+   */
+  void release_completed_blocks(std::size_t target)
+  {
+    using take_result = typename stream_ordered_base::take_result;
+    auto const done   = [this, target](block_type const& block) {
+      if (pool_size() < target + block.size()) { return true; }
+      auto const result = this->try_take_free_block(block);
+      if (result == take_result::taken) { return_to_upstream(block); }
+      return result != take_result::pending;
+    };
+    pending_releases_.erase(
+      std::remove_if(pending_releases_.begin(), pending_releases_.end(), done),
+      pending_releases_.end());
+  }
+
+  /**
+   * @brief Returns entirely free upstream blocks to upstream, largest first, while the pool stays
+   * at least `target` bytes. The caller must hold the mutex.
+   *
+   * @param target Minimum size in bytes to keep in the pool
+   * @return std::size_t The number of bytes returned to upstream
+   */
+  std::size_t trim_unlocked(std::size_t target)
+  {
+    // Trimming visits every upstream allocation, including those queued by do_deallocate
+    pending_releases_.clear();
+    // Largest first, so the pool approaches `target` with as few upstream calls as possible
+    std::size_t trimmed{0};
+    for (auto const& block : upstream_.largest_first()) {
+      if (pool_size() >= target + block.size() && this->take_free_block(block)) {
+        return_to_upstream(block);
+        trimmed += block.size();
+      }
+    }
+    return trimmed;
+  }
+
+  /**
+   * @brief Returns the upstream allocation `block`, already taken from the free lists, to upstream
+   * and counts it as trimmed. The caller must hold the mutex.
+   */
+  void return_to_upstream(block_type const& block)
+  {
+    upstream_.release(block);
+    bytes_trimmed_ += block.size();
+    ++blocks_trimmed_;
+  }
+
   /**
    * @brief Free all memory allocated from the upstream memory_resource.
    *
    */
   void release()
   {
+    this->detach_thread_caches();
+    // Work ordered before frees, including deferred ones, must complete before the memory goes
+    this->synchronize_frees();
+
     lock_guard lock(this->get_mutex());
 
-    for (auto block : upstream_blocks_) {
-      get_upstream()->deallocate(block.pointer(), block.size());
-    }
-    upstream_blocks_.clear();
+    upstream_.release();
+    pending_releases_.clear();
 #ifdef RMM_POOL_TRACK_ALLOCATIONS
     allocated_blocks_.clear();
 #endif
-
-    current_pool_size_ = 0;
   }
 
 #ifdef RMM_DEBUG_PRINT
@@ -405,13 +498,13 @@ class pool_memory_resource final
   {
     lock_guard lock(this->get_mutex());
 
-    auto const [free, total] = upstream_mr_->get_mem_info(rmm::cuda_stream_default);
+    auto const [free, total] = get_upstream()->get_mem_info(rmm::cuda_stream_default);
     std::cout << "GPU free memory: " << free << " total: " << total << "\n";
 
-    std::cout << "upstream_blocks: " << upstream_blocks_.size() << "\n";
+    std::cout << "upstream_blocks: " << upstream_.size() << "\n";
     std::size_t upstream_total{0};
 
-    for (auto blocks : upstream_blocks_) {
+    for (auto blocks : upstream_) {
       blocks.print();
       upstream_total += blocks.size();
     }
@@ -447,31 +540,35 @@ class pool_memory_resource final
   }
 
   /**
-   * @brief Get free and available memory for memory resource
+   * @brief Get free and total memory of the pool
+   *
+   * The free size is the pool size less the bytes currently allocated, where blocks held in
+   * per-thread caches count as allocated. Both values are maintained counters, so this is O(1) and
+   * does not lock the pool. The pool may be able to grow beyond the returned total.
    *
    * @throws nothing
    *
-   * @param stream to execute on
-   * @return std::pair contaiing free_size and total_size of memory
+   * @param stream to execute on (unused)
+   * @return std::pair containing free_size and total_size of memory
    */
   [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
-    cuda_stream_view stream) const override
+    [[maybe_unused]] cuda_stream_view stream) const override
   {
-    // TODO implement this
-    return {0, 0};
+    auto const total = pool_size();
+    auto const used  = this->allocated_bytes();
+    return {(total > used) ? total - used : 0, total};
   }
 
  private:
-  Upstream* upstream_mr_;  // The "heap" to allocate the pool from
-  std::size_t current_pool_size_{};
-  thrust::optional<std::size_t> maximum_pool_size_{};
+  detail::upstream_blocks<Upstream> upstream_;  // The "heap" the pool is allocated from
+  thrust::optional<std::size_t> release_threshold_{};
+  std::atomic<std::size_t> bytes_trimmed_{};   // written under the mutex, read without it
+  std::atomic<std::size_t> blocks_trimmed_{};
+  std::vector<block_type> pending_releases_;  // upstream allocations waiting on their frees
 
 #ifdef RMM_POOL_TRACK_ALLOCATIONS
   std::set<block_type, rmm::mr::detail::compare_blocks<block_type>> allocated_blocks_;
 #endif
-
-  // blocks allocated from upstream
-  std::set<block_type, rmm::mr::detail::compare_blocks<block_type>> upstream_blocks_;
 };  // namespace mr
 
 /** @} */  // end of group
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/detail/aligned.hpp>
+#include <rmm/detail/error.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_memory_resources
+ * @{
+ * @file
+ */
+
+namespace detail {
+
+/**
+ * @brief Index of the most significant set bit of a non-zero `value`.
+ */
+inline std::size_t most_significant_bit(std::size_t value) noexcept
+{
+  return static_cast<std::size_t>(std::numeric_limits<unsigned long long>::digits - 1 -
+                                  __builtin_clzll(static_cast<unsigned long long>(value)));
+}
+
+/**
+ * @brief Aligns `size` up to a multiple of `alignment`.
+ *
+ * @throws rmm::out_of_memory if the aligned size does not fit in a `std::size_t`
+ */
+inline std::size_t align_up_checked(std::size_t size, std::size_t alignment)
+{
+  RMM_EXPECTS(size <= std::numeric_limits<std::size_t>::max() - (alignment - 1),
+              "Allocation size cannot be aligned to its size class",
+              rmm::out_of_memory);
+  return rmm::detail::align_up(size, alignment);
+}
+
+/**
+ * @brief Rounds `size` up to a geometric size class with `2^log2_classes_per_doubling` classes
+ * between consecutive powers of two, and at least 256-byte spacing.
+ *
+ * The spacing of the classes in `(2^m, 2^(m+1)]` is `2^m / classes_per_doubling`, so the class is
+ * found from the position of the most significant bit of `size - 1` in constant time.
+ *
+ * @throws rmm::out_of_memory if the class does not fit in a `std::size_t`
+ */
+inline std::size_t align_to_geometric_class(std::size_t size,
+                                            std::size_t log2_classes_per_doubling)
+{
+  if (size <= rmm::detail::CUDA_ALLOCATION_ALIGNMENT) {
+    return rmm::detail::CUDA_ALLOCATION_ALIGNMENT;
+  }
+  auto const msb     = most_significant_bit(size - 1);
+  auto const shift   = (msb > log2_classes_per_doubling) ? msb - log2_classes_per_doubling : 0;
+  auto const spacing = std::max(std::size_t{1} << shift, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+  return align_up_checked(size, spacing);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Strategy deciding the size class that an allocation is rounded up to.
+ *
+ * Rounding allocations to a small set of sizes makes freed blocks more likely to be reused
+ * exactly, at the cost of internal fragmentation: the bytes between the requested size and its
+ * class are allocated but unused. `align` is called on every allocation and deallocation, so it
+ * must be cheap, must be a pure function of its argument, and must return a multiple of 256 bytes
+ * no smaller than the request, or throw `rmm::out_of_memory` if there is no such size.
+ *
+ * Policies are immutable once constructed and may be shared between resources and threads.
+ */
+class size_class_policy {
+ public:
+  size_class_policy()                                    = default;
+  virtual ~size_class_policy()                           = default;
+  size_class_policy(size_class_policy const&)            = default;
+  size_class_policy& operator=(size_class_policy const&) = default;
+  size_class_policy(size_class_policy&&)                 = default;
+  size_class_policy& operator=(size_class_policy&&)      = default;
+
+  /**
+   * @brief Returns the size class of an allocation of `size` bytes.
+   *
+   * @throws rmm::out_of_memory if the size class of `size` does not fit in a `std::size_t`
+   *
+   * @param size The requested size in bytes
+   * @return std::size_t The number of bytes to allocate
+   */
+  [[nodiscard]] virtual std::size_t align(std::size_t size) const = 0;
+};
+
+/**
+ * @brief No size classes: allocations are only aligned to 256 bytes.
+ */
+class exact_size_classes final : public size_class_policy {
+ public:
+  /**
+   * @copydoc size_class_policy::align
+   */
+  [[nodiscard]] std::size_t align(std::size_t size) const override
+  {
+    return detail::align_up_checked(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+  }
+};
+
+/**
+ * @brief Geometrically spaced size classes, a fixed number per doubling of the size.
+ *
+ * With 4 classes per doubling this is the jemalloc scheme, whose worst-case waste is 25% of the
+ * request; with 8 it is 12.5%. Sizes up to `exact_below` are only aligned to 256 bytes, which
+ * removes the waste for workloads dominated by small allocations whose sizes vary little.
+ *
+ * \see http://jemalloc.net/jemalloc.3.html
+ */
+class geometric_size_classes final : public size_class_policy {
+ public:
+  /**
+   * @brief Construct a geometric size-class policy.
+   *
+   * @throws rmm::logic_error if `classes_per_doubling` is not a power of two
+   *
+   * @param classes_per_doubling The number of classes between consecutive powers of two
+   * @param exact_below Size in bytes up to which allocations are only aligned to 256 bytes
+   */
+  explicit geometric_size_classes(std::size_t classes_per_doubling, std::size_t exact_below = 0)
+    : exact_below_{exact_below}
+  {
+    RMM_EXPECTS(
+      classes_per_doubling > 0 and (classes_per_doubling & (classes_per_doubling - 1)) == 0,
+      "Classes per doubling must be a power of two");
+    log2_classes_per_doubling_ = detail::most_significant_bit(classes_per_doubling);
+  }
+
+  /**
+   * @copydoc size_class_policy::align
+   */
+  [[nodiscard]] std::size_t align(std::size_t size) const override
+  {
+    if (size <= exact_below_) {
+      return detail::align_up_checked(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+    }
+    return detail::align_to_geometric_class(size, log2_classes_per_doubling_);
+  }
+
+ private:
+  std::size_t log2_classes_per_doubling_{};
+  std::size_t exact_below_;
+};
+
+/**
+ * @brief Size classes from a user-supplied table.
+ *
+ * Sizes above the largest class are only aligned to 256 bytes. The lookup starts from the first
+ * class at or above the largest power of two not exceeding the size, found through the position
+ * of its most significant bit, so it only scans the classes within one doubling.
+ */
+class table_size_classes final : public size_class_policy {
+ public:
+  /**
+   * @brief Construct a table size-class policy.
+   *
+   * @throws rmm::logic_error if `classes` is empty, not strictly ascending, or contains a size
+   * that is not a non-zero multiple of 256 bytes
+   *
+   * @param classes The size classes in bytes
+   */
+  explicit table_size_classes(std::vector<std::size_t> classes) : classes_{std::move(classes)}
+  {
+    RMM_EXPECTS(not classes_.empty(), "Size-class table must not be empty");
+    RMM_EXPECTS(std::adjacent_find(classes_.begin(), classes_.end(), std::greater_equal<>{}) ==
+                  classes_.end(),
+                "Size classes must be strictly ascending");
+    RMM_EXPECTS(std::all_of(classes_.begin(),
+                            classes_.end(),
+                            [](auto size) {
+                              return size > 0 and rmm::detail::is_aligned(
+                                                    size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+                            }),
+                "Size classes must be non-zero multiples of 256 bytes");
+    for (std::size_t bit = 0; bit < first_class_.size(); ++bit) {
+      first_class_[bit] = static_cast<std::size_t>(
+        std::lower_bound(classes_.begin(), classes_.end(), std::size_t{1} << bit) -
+        classes_.begin());
+    }
+  }
+
+  /**
+   * @copydoc size_class_policy::align
+   */
+  [[nodiscard]] std::size_t align(std::size_t size) const override
+  {
+    if (size > classes_.back()) {
+      return detail::align_up_checked(size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+    }
+    if (size == 0) { return classes_.front(); }
+    auto index = first_class_[detail::most_significant_bit(size)];
+    while (classes_[index] < size) {
+      ++index;
+    }
+    return classes_[index];
+  }
+
+ private:
+  std::vector<std::size_t> classes_;
+  /// Index of the first class that is at least `2^bit`, for each bit.
+  std::array<std::size_t, std::numeric_limits<std::size_t>::digits> first_class_{};
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rmm/detail/aligned.hpp>
+#include <rmm/detail/error.hpp>
+#include <rmm/mr/device/detail/bin_table.hpp>
+#include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/fixed_size_memory_resource.hpp>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_memory_resources
+ * @{
+ * @file
+ */
+
+/**
+ * @brief Allocates memory from fixed-size bins whose sizes are template parameters, and from an
+ * upstream resource for allocations larger than the largest bin.
+ *
+ * Equivalent to a `binning_memory_resource` with a `fixed_size_memory_resource` bin added for each
+ * of `BinSizes`, but the bins are held by value and the lookup table from sizes to bins is built
+ * at compile time, so choosing a bin is a table load and a comparison, and the call into the bin
+ * is not virtual.
+ *
+ * @tparam Upstream Memory resource to use for the bins' blocks and for allocations larger than
+ * the largest bin
+ * @tparam BinSizes The sizes of the bins, strictly ascending multiples of 256 bytes
+ */
+template <typename Upstream, std::size_t... BinSizes>
+class static_binning_memory_resource final : public device_memory_resource {
+  static_assert(sizeof...(BinSizes) > 0, "At least one bin size is required");
+
+ public:
+  /// The sizes of the bins.
+  static constexpr std::array<std::size_t, sizeof...(BinSizes)> bin_sizes{BinSizes...};
+
+ private:
+  static constexpr bool valid_bin_sizes()
+  {
+    for (std::size_t i = 0; i < bin_sizes.size(); ++i) {
+      if (bin_sizes[i] == 0 or
+          not rmm::detail::is_aligned(bin_sizes[i], rmm::detail::CUDA_ALLOCATION_ALIGNMENT)) {
+        return false;
+      }
+      if (i > 0 and bin_sizes[i - 1] >= bin_sizes[i]) { return false; }
+    }
+    return true;
+  }
+  static_assert(valid_bin_sizes(), "Bin sizes must be strictly ascending multiples of 256 bytes");
+
+  static constexpr detail::bin_table bin_table{detail::make_bin_table(bin_sizes)};
+
+  /// A bin, final so that calls through it are bound statically.
+  class bin_resource final : public fixed_size_memory_resource<Upstream> {
+    using fixed_size_memory_resource<Upstream>::fixed_size_memory_resource;
+  };
+
+ public:
+  /**
+   * @brief Construct a new static binning memory resource, allocating the initial blocks of each
+   * bin from `upstream_resource`.
+   *
+   * @throws rmm::logic_error if `upstream_resource == nullptr`
+   *
+   * @param upstream_resource The upstream memory resource used to allocate bin pools and large
+   * allocations.
+   * @param blocks_to_preallocate The number of blocks each bin allocates from upstream at a time
+   */
+  explicit static_binning_memory_resource(
+    Upstream* upstream_resource,
+    std::size_t blocks_to_preallocate =
+      fixed_size_memory_resource<Upstream>::default_blocks_to_preallocate)
+    : upstream_mr_{[upstream_resource]() {
+        RMM_EXPECTS(nullptr != upstream_resource, "Unexpected null upstream pointer.");
+        return upstream_resource;
+      }()},
+      bins_{{bin_resource{upstream_mr_, BinSizes, blocks_to_preallocate}...}}
+  {
+  }
+
+  /**
+   * @brief Destroy the static_binning_memory_resource and free all memory allocated from the
+   * upstream resource.
+   */
+  ~static_binning_memory_resource() override = default;
+
+  static_binning_memory_resource()                                                 = delete;
+  static_binning_memory_resource(static_binning_memory_resource const&)            = delete;
+  static_binning_memory_resource(static_binning_memory_resource&&)                 = delete;
+  static_binning_memory_resource& operator=(static_binning_memory_resource const&) = delete;
+  static_binning_memory_resource& operator=(static_binning_memory_resource&&)      = delete;
+
+  /**
+   * @brief Query whether the resource supports use of non-null streams for
+   * allocation/deallocation.
+   *
+   * @returns true
+   */
+  [[nodiscard]] bool supports_streams() const noexcept override { return true; }
+
+  /**
+   * @brief Query whether the resource supports the get_mem_info API.
+   *
+   * @return bool true if the upstream resource supports get_mem_info, false otherwise.
+   */
+  [[nodiscard]] bool supports_get_mem_info() const noexcept override
+  {
+    return upstream_mr_->supports_get_mem_info();
+  }
+
+  /**
+   * @brief Get the upstream memory_resource object.
+   *
+   * @return UpstreamResource* the upstream memory resource.
+   */
+  [[nodiscard]] Upstream* get_upstream() const noexcept { return upstream_mr_; }
+
+ private:
+  /// The index of the bin for `bytes`, or the number of bins if no bin is large enough.
+  static constexpr std::size_t bin_index(std::size_t bytes) noexcept
+  {
+    return detail::find_bin(bin_sizes, bin_table, bytes);
+  }
+
+  /**
+   * @brief Allocates memory of size at least \p bytes.
+   *
+   * The returned pointer will have at minimum 256 byte alignment.
+   *
+   * @param bytes The size of the allocation
+   * @param stream Stream on which to perform allocation
+   * @return void* Pointer to the newly allocated memory
+   */
+  void* do_allocate(std::size_t bytes, cuda_stream_view stream) override
+  {
+    if (bytes <= 0) { return nullptr; }
+    auto const index = bin_index(bytes);
+    if (index == bins_.size()) { return upstream_mr_->allocate(bytes, stream); }
+    return bins_[index].allocate(bytes, stream);
+  }
+
+  /**
+   * @brief Deallocate memory pointed to by \p p.
+   *
+   * @throws nothing
+   *
+   * @param ptr Pointer to be deallocated
+   * @param bytes The size in bytes of the allocation. This must be equal to the
+   * value of `bytes` that was passed to the `allocate` call that returned `p`.
+   * @param stream Stream on which to perform deallocation
+   */
+  void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
+  {
+    if (ptr == nullptr) { return; }
+    auto const index = bin_index(bytes);
+    if (index == bins_.size()) {
+      upstream_mr_->deallocate(ptr, bytes, stream);
+    } else {
+      bins_[index].deallocate(ptr, bytes, stream);
+    }
+  }
+
+  /**
+   * @brief Get free and total memory for memory resource
+   *
+   * Reports the upstream's free and total memory, plus the free blocks of the bins.
+   *
+   * @param stream the stream being executed on
+   * @return std::pair with free and total memory for resource
+   */
+  [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
+    cuda_stream_view stream) const override
+  {
+    auto [free, total] = upstream_mr_->get_mem_info(stream);
+    for (auto const& bin : bins_) {
+      free += bin.get_mem_info(stream).first;
+    }
+    return std::make_pair(free, total);
+  }
+
+  Upstream* upstream_mr_;  // The upstream memory_resource from which to allocate blocks.
+  std::array<bin_resource, sizeof...(BinSizes)> bins_;
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
@@ -15,9 +15,18 @@
  */
 #pragma once
 
+#include <rmm/mr/device/detail/atomic_histogram.hpp>
+#include <rmm/mr/device/detail/sharded_pointer_map.hpp>
+#include <rmm/mr/device/detail/sharded_sum.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/histogram.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 
@@ -35,8 +44,17 @@ namespace rmm::mr {
  * resource in order to satisfy allocation requests, but any existing
  * allocations will be untracked. Tracking statistics stores the current, peak
  * and total memory allocations for both the number of bytes and number of calls
- * to the memory resource. `statistics_resource_adaptor` is intended as a debug
- * adaptor and shouldn't be used in performance-sensitive code.
+ * to the memory resource.
+ *
+ * The counters are updated without locks: the current values are atomics, the peaks are raised
+ * with a compare-and-swap only when a current value exceeds them, and the totals are summed from
+ * per-thread shards when read. Each counter read is a consistent snapshot when no other thread is
+ * allocating or deallocating, and otherwise may combine values from slightly different times.
+ *
+ * If constructed with `enable_histograms`, the adaptor also records log-linear histograms (see
+ * `histogram`) of allocation sizes, of allocation lifetimes from allocation to deallocation, and
+ * of the time spent in the upstream resource's allocate and deallocate calls. Recording is lock
+ * free, but remembering when each allocation was made costs a map insertion per allocation.
  *
  * @tparam Upstream Type of the upstream resource used for
  * allocation/deallocation.
@@ -91,8 +109,11 @@ class statistics_resource_adaptor final : public device_memory_resource {
    * @throws rmm::logic_error if `upstream == nullptr`
    *
    * @param upstream The resource used for allocating/deallocating device memory
+   * @param enable_histograms If true, record histograms of allocation sizes, lifetimes and
+   * latencies
    */
-  statistics_resource_adaptor(Upstream* upstream) : upstream_{upstream}
+  statistics_resource_adaptor(Upstream* upstream, bool enable_histograms = false)
+    : histograms_{enable_histograms ? std::make_unique<histograms>() : nullptr}, upstream_{upstream}
   {
     RMM_EXPECTS(nullptr != upstream, "Unexpected null upstream resource pointer.");
   }
@@ -136,12 +157,7 @@ class statistics_resource_adaptor final : public device_memory_resource {
    *
    * @return counter struct containing bytes count
    */
-  counter get_bytes_counter() const noexcept
-  {
-    read_lock_t lock(mtx_);
-
-    return bytes_;
-  }
+  counter get_bytes_counter() const noexcept { return bytes_.load(); }
 
   /**
    * @brief Returns a `counter` struct for this adaptor containing the current,
@@ -150,14 +166,125 @@ class statistics_resource_adaptor final : public device_memory_resource {
    *
    * @return counter struct containing allocations count
    */
-  counter get_allocations_counter() const noexcept
+  counter get_allocations_counter() const noexcept { return allocations_.load(); }
+
+  /**
+   * @briefreturn{true if the adaptor records histograms}
+   */
+  [[nodiscard]] bool histograms_enabled() const noexcept { return histograms_ != nullptr; }
+
+  /**
+   * @brief Returns the histogram of allocation sizes in bytes, which is empty unless histograms
+   * are enabled.
+   *
+   * @return histogram The allocation sizes recorded since construction or the last reset
+   */
+  [[nodiscard]] histogram get_size_histogram() const
+  {
+    return histograms_enabled() ? histograms_->sizes.load() : histogram{};
+  }
+
+  /**
+   * @brief Returns the histogram of the nanoseconds from allocations to their deallocation, which
+   * is empty unless histograms are enabled.
+   *
+   * @return histogram The lifetimes of allocations freed since construction or the last reset
+   */
+  [[nodiscard]] histogram get_lifetime_histogram() const
+  {
+    return histograms_enabled() ? histograms_->lifetimes.load() : histogram{};
+  }
+
+  /**
+   * @brief Returns the histogram of the nanoseconds spent in the upstream resource's allocate
+   * calls, which is empty unless histograms are enabled.
+   *
+   * @return histogram The allocation latencies recorded since construction or the last reset
+   */
+  [[nodiscard]] histogram get_allocate_latency_histogram() const
   {
-    read_lock_t lock(mtx_);
+    return histograms_enabled() ? histograms_->allocate_latencies.load() : histogram{};
+  }
 
-    return allocations_;
+  /**
+   * @brief Returns the histogram of the nanoseconds spent in the upstream resource's deallocate
+   * calls, which is empty unless histograms are enabled.
+   *
+   * @return histogram The deallocation latencies recorded since construction or the last reset
+   */
+  [[nodiscard]] histogram get_deallocate_latency_histogram() const
+  {
+    return histograms_enabled() ? histograms_->deallocate_latencies.load() : histogram{};
+  }
+
+  /**
+   * @brief Empties the histograms. Allocations made before the reset and freed after it still
+   * have their lifetimes recorded.
+   */
+  void reset_histograms() noexcept
+  {
+    if (not histograms_enabled()) { return; }
+    histograms_->sizes.reset();
+    histograms_->lifetimes.reset();
+    histograms_->allocate_latencies.reset();
+    histograms_->deallocate_latencies.reset();
   }
 
  private:
+  /**
+   * @brief A `counter` that threads update concurrently.
+   */
+  class atomic_counter {
+   public:
+    void add(int64_t val) noexcept
+    {
+      auto const value = value_.fetch_add(val, std::memory_order_relaxed) + val;
+      auto peak        = peak_.load(std::memory_order_relaxed);
+      while (value > peak &&
+             not peak_.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {}
+      total_.add(val);
+    }
+
+    void subtract(int64_t val) noexcept { value_.fetch_sub(val, std::memory_order_relaxed); }
+
+    [[nodiscard]] counter load() const noexcept
+    {
+      counter result{};
+      result.value = value_.load(std::memory_order_relaxed);
+      // A racing allocation may have raised the value but not yet the peak
+      result.peak  = std::max(peak_.load(std::memory_order_relaxed), result.value);
+      result.total = total_.load();
+      return result;
+    }
+
+   private:
+    // The current value and peak are shared by all threads, on a cache line of their own
+    alignas(64) std::atomic<int64_t> value_{0};
+    std::atomic<int64_t> peak_{0};
+    alignas(64) detail::sharded_sum total_;
+  };
+
+  using clock_type = std::chrono::steady_clock;
+
+  /// Nanoseconds since the clock's epoch.
+  static std::uint64_t now() noexcept
+  {
+    return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch())
+        .count());
+  }
+
+  /**
+   * @brief The histograms and the times at which outstanding allocations were made.
+   */
+  struct histograms {
+    detail::atomic_histogram sizes;
+    detail::atomic_histogram lifetimes;
+    detail::atomic_histogram allocate_latencies;
+    detail::atomic_histogram deallocate_latencies;
+    detail::sharded_pointer_map<std::uint64_t> allocation_times;
+  };
+
   /**
    * @brief Allocates memory of size at least `bytes` using the upstream
    * resource as long as it fits inside the allocation limit.
@@ -173,16 +300,13 @@ class statistics_resource_adaptor final : public device_memory_resource {
    */
   void* do_allocate(std::size_t bytes, cuda_stream_view stream) override
   {
+    if (histograms_enabled()) { return do_allocate_recorded(bytes, stream); }
+
     void* ptr = upstream_->allocate(bytes, stream);
 
     // increment the stats
-    {
-      write_lock_t lock(mtx_);
-
-      // Increment the allocation_count_ while we have the lock
-      bytes_ += bytes;
-      allocations_ += 1;
-    }
+    bytes_.add(static_cast<int64_t>(bytes));
+    allocations_.add(1);
 
     return ptr;
   }
@@ -196,15 +320,51 @@ class statistics_resource_adaptor final : public device_memory_resource {
    */
   void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
   {
+    if (histograms_enabled()) {
+      do_deallocate_recorded(ptr, bytes, stream);
+      return;
+    }
+
     upstream_->deallocate(ptr, bytes, stream);
 
-    {
-      write_lock_t lock(mtx_);
+    // Decrement the current allocated counts.
+    bytes_.subtract(static_cast<int64_t>(bytes));
+    allocations_.subtract(1);
+  }
 
-      // Decrement the current allocated counts.
-      bytes_ -= bytes;
-      allocations_ -= 1;
-    }
+  /**
+   * @brief `do_allocate`, also recording the allocation in the histograms.
+   */
+  void* do_allocate_recorded(std::size_t bytes, cuda_stream_view stream)
+  {
+    auto const start = now();
+    void* ptr        = upstream_->allocate(bytes, stream);
+    auto const end   = now();
+
+    bytes_.add(static_cast<int64_t>(bytes));
+    allocations_.add(1);
+    histograms_->sizes.record(bytes);
+    histograms_->allocate_latencies.record(end - start);
+    histograms_->allocation_times.insert(ptr, end);
+
+    return ptr;
+  }
+
+  /**
+   * @brief `do_deallocate`, also recording the deallocation in the histograms.
+   */
+  void do_deallocate_recorded(void* ptr, std::size_t bytes, cuda_stream_view stream)
+  {
+    // Forget the allocation before upstream can hand its pointer out again
+    auto const allocated = histograms_->allocation_times.erase(ptr);
+    auto const start     = now();
+    upstream_->deallocate(ptr, bytes, stream);
+    auto const end = now();
+
+    bytes_.subtract(static_cast<int64_t>(bytes));
+    allocations_.subtract(1);
+    histograms_->deallocate_latencies.record(end - start);
+    if (allocated.has_value()) { histograms_->lifetimes.record(start - *allocated); }
   }
 
   /**
@@ -235,9 +395,9 @@ class statistics_resource_adaptor final : public device_memory_resource {
     return upstream_->get_mem_info(stream);
   }
 
-  counter bytes_;                        // peak, current and total allocated bytes
-  counter allocations_;                  // peak, current and total allocation count
-  std::shared_timed_mutex mutable mtx_;  // mutex for thread safe access to allocations_
+  atomic_counter bytes_;                    // peak, current and total allocated bytes
+  atomic_counter allocations_;              // peak, current and total allocation count
+  std::unique_ptr<histograms> histograms_;  // histograms, if enabled
   Upstream* upstream_;  // the upstream resource used for satisfying allocation requests
 };
 
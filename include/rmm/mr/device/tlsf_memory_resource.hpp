@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// MIT License
+//
+// Modifications Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <rmm/cuda_stream_view.hpp>
+#include <rmm/mr/device/detail/stream_ordered_memory_resource.hpp>
+#include <rmm/mr/device/detail/tlsf_free_list.hpp>
+#include <rmm/mr/device/detail/upstream_blocks.hpp>
+#include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/growth_policy.hpp>
+
+#include <rmm/detail/thrust_namespace.h>
+#include <thrust/optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace rmm::mr {
+/**
+ * @addtogroup device_memory_resources
+ * @{
+ * @file
+ */
+
+/**
+ * @brief A coalescing suballocator with constant-time allocation and deallocation, which uses a
+ * pool of memory allocated from an upstream memory_resource.
+ *
+ * Free blocks are kept in a two-level segregated fit (TLSF) free list: finding a free block and
+ * returning a block to the pool (including coalescing it with its neighbors) take a bounded
+ * number of operations independent of how fragmented the pool is. The price is "good fit" rather
+ * than best fit: a request may be served from a block up to one size class (1/16th) larger than
+ * the tightest free block. Prefer this resource over `pool_memory_resource` when worst-case
+ * allocation latency matters more than peak footprint.
+ *
+ * Allocation (do_allocate()) and deallocation (do_deallocate()) are thread-safe. Also,
+ * this class is compatible with CUDA per-thread default stream.
+ *
+ * @tparam Upstream memory_resource to use for allocating the pool. Implements
+ *                  rmm::mr::device_memory_resource interface.
+ */
+template <typename Upstream>
+class tlsf_memory_resource final
+  : public detail::stream_ordered_memory_resource<tlsf_memory_resource<Upstream>,
+                                                  detail::tlsf_free_list> {
+ public:
+  friend class detail::stream_ordered_memory_resource<tlsf_memory_resource<Upstream>,
+                                                      detail::tlsf_free_list>;
+
+  /**
+   * @brief Construct a `tlsf_memory_resource` and allocate the initial device memory pool using
+   * `upstream_mr`.
+   *
+   * @throws rmm::logic_error if `upstream_mr == nullptr`
+   * @throws rmm::logic_error if `initial_pool_size` is neither the default nor aligned to a
+   * multiple of 256 bytes.
+   * @throws rmm::logic_error if `maximum_pool_size` is neither the default nor aligned to a
+   * multiple of 256 bytes.
+   *
+   * @param upstream_mr The memory_resource from which to allocate blocks for the pool.
+   * @param initial_pool_size Minimum size, in bytes, of the initial pool. Defaults to half of the
+   * available memory on the current device.
+   * @param maximum_pool_size Maximum size, in bytes, that the pool can grow to. Defaults to all
+   * of the available memory on the current device.
+   */
+  explicit tlsf_memory_resource(Upstream* upstream_mr,
+                                thrust::optional<std::size_t> initial_pool_size = thrust::nullopt,
+                                thrust::optional<std::size_t> maximum_pool_size = thrust::nullopt)
+    : upstream_{upstream_mr, std::make_shared<default_growth_policy>()}
+  {
+    auto const block = upstream_.initialize(initial_pool_size, maximum_pool_size);
+    if (block.is_valid()) { this->insert_block(block, cuda_stream_legacy); }
+  }
+
+  /**
+   * @brief Destroy the `tlsf_memory_resource` and deallocate all memory it allocated using
+   * the upstream resource.
+   */
+  ~tlsf_memory_resource() override { release(); }
+
+  tlsf_memory_resource()                                       = delete;
+  tlsf_memory_resource(tlsf_memory_resource const&)            = delete;
+  tlsf_memory_resource(tlsf_memory_resource&&)                 = delete;
+  tlsf_memory_resource& operator=(tlsf_memory_resource const&) = delete;
+  tlsf_memory_resource& operator=(tlsf_memory_resource&&)      = delete;
+
+  /**
+   * @brief Queries whether the resource supports use of non-null CUDA streams for
+   * allocation/deallocation.
+   *
+   * @returns bool true.
+   */
+  [[nodiscard]] bool supports_streams() const noexcept override { return true; }
+
+  /**
+   * @brief Query whether the resource supports the get_mem_info API.
+   *
+   * @return bool true
+   */
+  [[nodiscard]] bool supports_get_mem_info() const noexcept override { return true; }
+
+  /**
+   * @brief Get the upstream memory_resource object.
+   *
+   * @return Upstream* the upstream memory resource.
+   */
+  Upstream* get_upstream() const noexcept { return upstream_.get_upstream(); }
+
+  /**
+   * @brief Computes the size of the current pool
+   *
+   * Includes allocated as well as free memory.
+   *
+   * @return std::size_t The total size of the currently allocated pool.
+   */
+  [[nodiscard]] std::size_t pool_size() const noexcept { return upstream_.pool_size(); }
+
+  /**
+   * @brief Returns the size of the largest allocation that a free block in the pool can serve,
+   * across all streams.
+   *
+   * With good-fit search this is the lower bound of the largest free block's size class, which is
+   * at most 1/16th smaller than the block.
+   *
+   * @return std::size_t The size in bytes of the largest allocation served without growing
+   */
+  [[nodiscard]] std::size_t largest_free_block() const noexcept
+  {
+    return this->largest_free_block_size();
+  }
+
+ protected:
+  using free_list  = detail::tlsf_free_list;  ///< The free list implementation
+  using block_type = free_list::block_type;   ///< The type of block returned by the free list
+  using typename detail::stream_ordered_memory_resource<tlsf_memory_resource<Upstream>,
+                                                        detail::tlsf_free_list>::split_block;
+  using lock_guard = std::lock_guard<std::mutex>;  ///< Type of lock used to synchronize access
+
+  /**
+   * @brief Get the maximum size of allocations supported by this memory resource
+   *
+   * @return std::size_t The maximum size of a single allocation supported by this memory resource
+   */
+  [[nodiscard]] std::size_t get_maximum_allocation_size() const
+  {
+    return std::numeric_limits<std::size_t>::max();
+  }
+
+  /**
+   * @brief Allocate space from upstream to supply the suballocation pool and return
+   * a sufficiently sized block.
+   *
+   * Grows by halfway to the maximum pool size if one is set, and by doubling the pool otherwise.
+   *
+   * @param size The minimum size to allocate
+   * @param blocks The free list (ignored in this implementation)
+   * @param stream The stream on which the memory is to be used.
+   * @return block_type a block of at least `size` bytes
+   */
+  block_type expand_pool(std::size_t size, free_list& blocks, cuda_stream_view stream)
+  {
+    return upstream_.expand(size, stream);
+  }
+
+  /**
+   * @brief Splits `block` if necessary to return a pointer to memory of `size` bytes.
+   *
+   * @param block The block to allocate from.
+   * @param size The size in bytes of the requested allocation.
+   * @return A pair comprising the allocated pointer and any unallocated remainder of the input
+   * block.
+   */
+  split_block allocate_from_block(block_type const& block, std::size_t size)
+  {
+    block_type const alloc{block.pointer(), size, block.is_head()};
+    auto rest = (block.size() > size)
+                  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                  ? block_type{block.pointer() + size, block.size() - size, false}
+                  : block_type{};
+    return {alloc, rest};
+  }
+
+  /**
+   * @brief Finds, frees and returns the block associated with pointer `ptr`.
+   *
+   * @param ptr The pointer to the memory to free.
+   * @param size The size of the memory to free. Must be equal to the original allocation size.
+   * @return The (now freed) block associated with `ptr`. The caller is expected to return the
+   * block to the pool.
+   */
+  block_type free_block(void* ptr, std::size_t size) noexcept
+  {
+    return block_type{static_cast<char*>(ptr), size, upstream_.is_head(ptr)};
+  }
+
+  /**
+   * @brief Free all memory allocated from the upstream memory_resource.
+   */
+  void release()
+  {
+    lock_guard lock(this->get_mutex());
+    upstream_.release();
+  }
+
+  /**
+   * @brief Get the largest available block size and total free size in the specified free list
+   *
+   * This is intended only for debugging
+   *
+   * @param blocks The free list from which to return the summary
+   * @return std::pair<std::size_t, std::size_t> Pair of largest available block, total free size
+   */
+  std::pair<std::size_t, std::size_t> free_list_summary(free_list const& blocks)
+  {
+    std::size_t largest{};
+    std::size_t total{};
+    blocks.for_each([&largest, &total](auto const& block) {
+      total += block.size();
+      largest = std::max(largest, block.size());
+    });
+    return {largest, total};
+  }
+
+  /**
+   * @brief Get free and total memory of the pool, from counters maintained on allocation and
+   * deallocation
+   *
+   * @throws nothing
+   *
+   * @param stream to execute on (unused)
+   * @return std::pair containing free_size and total_size of memory
+   */
+  [[nodiscard]] std::pair<std::size_t, std::size_t> do_get_mem_info(
+    [[maybe_unused]] cuda_stream_view stream) const override
+  {
+    auto const total = pool_size();
+    auto const used  = this->allocated_bytes();
+    return {(total > used) ? total - used : 0, total};
+  }
+
+ private:
+  detail::upstream_blocks<Upstream> upstream_;  // The "heap" the pool is allocated from
+};
+
+/** @} */  // end of group
+}  // namespace rmm::mr
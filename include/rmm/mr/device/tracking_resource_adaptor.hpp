@@ -16,17 +16,26 @@
 #pragma once
 
 #include <rmm/detail/error.hpp>
+#include <rmm/detail/stack_table.hpp>
 #include <rmm/detail/stack_trace.hpp>
 #include <rmm/logger.hpp>
+#include <rmm/mr/device/detail/allocation_sampler.hpp>
+#include <rmm/mr/device/detail/sharded_pointer_map.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace rmm::mr {
 /**
@@ -42,9 +51,15 @@ namespace rmm::mr {
  * will be untracked. Tracking stores a size and pointer for every allocation, and a stack
  * frame if `capture_stacks` is true, so it can add significant overhead.
  * `tracking_resource_adaptor` is intended as a debug adaptor and shouldn't be used in
- * performance-sensitive code. Note that callstacks may not contain all symbols unless
- * the project is linked with `-rdynamic`. This can be accomplished with
- * `add_link_options(-rdynamic)` in cmake.
+ * performance-sensitive code. Allocations are recorded in a map split into independently locked
+ * shards by pointer, so concurrent threads rarely wait on each other to record them.
+ *
+ * Stacks can be captured for every allocation, or for a sample of them (see `stack_sampling`),
+ * which is cheap enough to leave enabled. Stacks from the same call site share one interned trace,
+ * symbols are only looked up when a report is printed, and `get_call_sites()` aggregates the
+ * outstanding sampled allocations by call site. Note that
+ * callstacks may not contain all symbols unless the project is linked with `-rdynamic`. This can
+ * be accomplished with `add_link_options(-rdynamic)` in cmake.
  *
  * @tparam Upstream Type of the upstream resource used for
  * allocation/deallocation.
@@ -60,14 +75,24 @@ class tracking_resource_adaptor final : public device_memory_resource {
   /**
    * @brief Information stored about an allocation. Includes the size
    * and a stack trace if the `tracking_resource_adaptor` was initialized
-   * to capture stacks.
+   * to capture stacks and the allocation was sampled.
    *
    */
   struct allocation_info {
-    std::unique_ptr<rmm::detail::stack_trace> strace;  ///< Stack trace of the allocation
-    std::size_t allocation_size;                       ///< Size of the allocation
+    std::shared_ptr<rmm::detail::stack_trace const> strace;  ///< Stack trace of the allocation
+    std::size_t allocation_size{};                           ///< Size of the allocation
 
-    allocation_info() = delete;
+    allocation_info() = default;
+    /**
+     * @brief Construct a new allocation info object
+     *
+     * @param size Size of the allocation
+     * @param trace Stack trace of the allocation, or nullptr
+     */
+    allocation_info(std::size_t size, std::shared_ptr<rmm::detail::stack_trace const> trace)
+      : strace{std::move(trace)}, allocation_size{size}
+    {
+    }
     /**
      * @brief Construct a new allocation info object
      *
@@ -76,11 +101,34 @@ class tracking_resource_adaptor final : public device_memory_resource {
      */
     allocation_info(std::size_t size, bool capture_stack)
       : strace{[&]() {
-          return capture_stack ? std::make_unique<rmm::detail::stack_trace>() : nullptr;
+          return capture_stack ? std::make_shared<rmm::detail::stack_trace>() : nullptr;
         }()},
         allocation_size{size} {};
   };
 
+  /**
+   * @brief Selects the allocations whose stacks are captured.
+   *
+   * If `byte_interval` is nonzero, allocations are sampled on average once per `byte_interval`
+   * bytes allocated, with an allocation of `s` bytes sampled with probability
+   * `1 - exp(-s / byte_interval)`. Otherwise every `allocation_interval`th allocation is sampled,
+   * and none if `allocation_interval` is 0.
+   */
+  struct stack_sampling {
+    std::size_t allocation_interval{1};  ///< Sample every Nth allocation
+    std::size_t byte_interval{0};        ///< Mean number of bytes allocated between samples
+  };
+
+  /**
+   * @brief The outstanding sampled allocations made from one call site.
+   */
+  struct call_site {
+    std::shared_ptr<rmm::detail::stack_trace const> strace;  ///< Stack trace of the call site
+    std::size_t allocation_count{};                          ///< Number of sampled allocations
+    std::size_t allocated_bytes{};                           ///< Bytes of sampled allocations
+    std::size_t estimated_bytes{};  ///< Estimated bytes of all allocations from the call site
+  };
+
   /**
    * @brief Construct a new tracking resource adaptor using `upstream` to satisfy
    * allocation requests.
@@ -89,9 +137,33 @@ class tracking_resource_adaptor final : public device_memory_resource {
    *
    * @param upstream The resource used for allocating/deallocating device memory
    * @param capture_stacks If true, capture stacks for allocation calls
+   * @param num_shards The number of independently locked shards of the allocation map
+   */
+  tracking_resource_adaptor(Upstream* upstream,
+                            bool capture_stacks    = false,
+                            std::size_t num_shards = allocation_map::default_num_shards)
+    : tracking_resource_adaptor{
+        upstream, stack_sampling{capture_stacks ? std::size_t{1} : std::size_t{0}}, num_shards}
+  {
+  }
+
+  /**
+   * @brief Construct a new tracking resource adaptor using `upstream` to satisfy
+   * allocation requests, capturing the stacks of a sample of the allocations.
+   *
+   * @throws rmm::logic_error if `upstream == nullptr`
+   *
+   * @param upstream The resource used for allocating/deallocating device memory
+   * @param sampling The allocations whose stacks are captured
+   * @param num_shards The number of independently locked shards of the allocation map
    */
-  tracking_resource_adaptor(Upstream* upstream, bool capture_stacks = false)
-    : capture_stacks_{capture_stacks}, allocated_bytes_{0}, upstream_{upstream}
+  tracking_resource_adaptor(Upstream* upstream,
+                            stack_sampling sampling,
+                            std::size_t num_shards = allocation_map::default_num_shards)
+    : sampler_{sampling.allocation_interval, sampling.byte_interval},
+      allocations_{num_shards},
+      allocated_bytes_{0},
+      upstream_{upstream}
   {
     RMM_EXPECTS(nullptr != upstream, "Unexpected null upstream resource pointer.");
   }
@@ -129,17 +201,33 @@ class tracking_resource_adaptor final : public device_memory_resource {
   }
 
   /**
-   * @brief Get the outstanding allocations map
+   * @brief Get a snapshot of the outstanding allocations
+   *
+   * Allocations made or freed by other threads while the snapshot is taken may or may not be
+   * included. The snapshot copies every entry; use `get_outstanding_allocations_count()` to only
+   * count them.
    *
-   * @return std::map<void*, allocation_info> const& of a map of allocations. The key
-   * is the allocated memory pointer and the data is the allocation_info structure, which
-   * contains size and, potentially, stack traces.
+   * @return std::map<void*, allocation_info> A map of allocations. The key is the allocated
+   * memory pointer and the data is the allocation_info structure, which contains size and,
+   * potentially, stack traces.
    */
-  std::map<void*, allocation_info> const& get_outstanding_allocations() const noexcept
+  std::map<void*, allocation_info> get_outstanding_allocations() const
   {
-    return allocations_;
+    std::map<void*, allocation_info> allocations;
+    allocations_.for_each(
+      [&allocations](void* ptr, allocation_info const& info) { allocations.emplace(ptr, info); });
+    return allocations;
   }
 
+  /**
+   * @brief Query the number of outstanding allocations, without copying them.
+   *
+   * Allocations made or freed by other threads while counting may or may not be included.
+   *
+   * @return std::size_t The number of outstanding allocations
+   */
+  std::size_t get_outstanding_allocations_count() const { return allocations_.size(); }
+
   /**
    * @brief Query the number of bytes that have been allocated. Note that
    * this can not be used to know how large of an allocation is possible due
@@ -163,18 +251,64 @@ class tracking_resource_adaptor final : public device_memory_resource {
    */
   std::string get_outstanding_allocations_str() const
   {
-    read_lock_t lock(mtx_);
+    if (get_outstanding_allocations_count() == 0) { return {}; }
 
     std::ostringstream oss;
 
-    if (!allocations_.empty()) {
-      for (auto const& alloc : allocations_) {
-        oss << alloc.first << ": " << alloc.second.allocation_size << " B";
-        if (alloc.second.strace != nullptr) {
-          oss << " : callstack:" << std::endl << *alloc.second.strace;
-        }
-        oss << std::endl;
+    for (auto const& alloc : get_outstanding_allocations()) {
+      oss << alloc.first << ": " << alloc.second.allocation_size << " B";
+      if (alloc.second.strace != nullptr) {
+        oss << " : callstack:" << std::endl << *alloc.second.strace;
       }
+      oss << std::endl;
+    }
+
+    return oss.str();
+  }
+
+  /**
+   * @brief Aggregates the outstanding sampled allocations by call site.
+   *
+   * @return std::vector<call_site> The call sites with outstanding sampled allocations, in
+   * descending order of estimated bytes
+   */
+  std::vector<call_site> get_call_sites() const
+  {
+    std::unordered_map<rmm::detail::stack_trace const*, call_site> sites;
+    allocations_.for_each([&](void*, allocation_info const& info) {
+      if (info.strace == nullptr) { return; }
+      auto& site = sites[info.strace.get()];
+      if (site.strace == nullptr) { site.strace = info.strace; }
+      ++site.allocation_count;
+      site.allocated_bytes += info.allocation_size;
+      site.estimated_bytes += sampler_.estimate(info.allocation_size);
+    });
+
+    std::vector<call_site> result;
+    result.reserve(sites.size());
+    for (auto& site : sites) {
+      result.push_back(std::move(site.second));
+    }
+    std::sort(result.begin(), result.end(), [](call_site const& lhs, call_site const& rhs) {
+      return lhs.estimated_bytes > rhs.estimated_bytes;
+    });
+    return result;
+  }
+
+  /**
+   * @brief Gets a string listing the bytes outstanding by call site, largest first, with the
+   * symbolized stack trace of each call site.
+   *
+   * @return std::string The report
+   */
+  std::string get_call_sites_str() const
+  {
+    std::ostringstream oss;
+
+    for (auto const& site : get_call_sites()) {
+      oss << site.estimated_bytes << " B estimated, " << site.allocated_bytes << " B in "
+          << site.allocation_count << " sampled allocations : callstack:" << std::endl
+          << *site.strace << std::endl;
     }
 
     return oss.str();
@@ -210,10 +344,8 @@ class tracking_resource_adaptor final : public device_memory_resource {
     void* ptr = upstream_->allocate(bytes, stream);
 
     // track it.
-    {
-      write_lock_t lock(mtx_);
-      allocations_.emplace(ptr, allocation_info{bytes, capture_stacks_});
-    }
+    allocations_.insert(
+      ptr, allocation_info{bytes, sampler_.sample(bytes) ? stacks_.capture() : nullptr});
     allocated_bytes_ += bytes;
 
     return ptr;
@@ -229,34 +361,29 @@ class tracking_resource_adaptor final : public device_memory_resource {
   void do_deallocate(void* ptr, std::size_t bytes, cuda_stream_view stream) override
   {
     upstream_->deallocate(ptr, bytes, stream);
-    {
-      write_lock_t lock(mtx_);
 
-      const auto found = allocations_.find(ptr);
+    auto const found = allocations_.erase(ptr);
 
-      // Ensure the allocation is found and the number of bytes match
-      if (found == allocations_.end()) {
+    // Ensure the allocation is found and the number of bytes match
+    if (not found.has_value()) {
+      // Don't throw but log an error. Throwing in a descructor (or any noexcept) will call
+      // std::terminate
+      RMM_LOG_ERROR(
+        "Deallocating a pointer that was not tracked. Ptr: {:p} [{}B], Current Num. Allocations: "
+        "{}",
+        fmt::ptr(ptr),
+        bytes,
+        this->allocations_.size());
+    } else {
+      auto allocated_bytes = found->allocation_size;
+
+      if (allocated_bytes != bytes) {
         // Don't throw but log an error. Throwing in a descructor (or any noexcept) will call
         // std::terminate
         RMM_LOG_ERROR(
-          "Deallocating a pointer that was not tracked. Ptr: {:p} [{}B], Current Num. Allocations: "
-          "{}",
-          fmt::ptr(ptr),
-          bytes,
-          this->allocations_.size());
-      } else {
-        allocations_.erase(found);
-
-        auto allocated_bytes = found->second.allocation_size;
-
-        if (allocated_bytes != bytes) {
-          // Don't throw but log an error. Throwing in a descructor (or any noexcept) will call
-          // std::terminate
-          RMM_LOG_ERROR(
-            "Alloc bytes ({}) and Dealloc bytes ({}) do not match", allocated_bytes, bytes);
-
-          bytes = allocated_bytes;
-        }
+          "Alloc bytes ({}) and Dealloc bytes ({}) do not match", allocated_bytes, bytes);
+
+        bytes = allocated_bytes;
       }
     }
     allocated_bytes_ -= bytes;
@@ -290,10 +417,12 @@ class tracking_resource_adaptor final : public device_memory_resource {
     return upstream_->get_mem_info(stream);
   }
 
-  bool capture_stacks_;                           // whether or not to capture call stacks
-  std::map<void*, allocation_info> allocations_;  // map of active allocations
-  std::atomic<std::size_t> allocated_bytes_;      // number of bytes currently allocated
-  std::shared_timed_mutex mutable mtx_;           // mutex for thread safe access to allocations_
+  using allocation_map = detail::sharded_pointer_map<allocation_info>;
+
+  detail::allocation_sampler sampler_;        // selects the allocations whose stacks are captured
+  rmm::detail::stack_table stacks_;           // interned stack traces
+  allocation_map allocations_;                // map of active allocations
+  std::atomic<std::size_t> allocated_bytes_;  // number of bytes currently allocated
   Upstream* upstream_;  // the upstream resource used for satisfying allocation requests
 };
 
@@ -22,11 +22,12 @@ from collections import defaultdict
 cimport cython
 from cython.operator cimport dereference as deref
 from libc.stddef cimport size_t
-from libc.stdint cimport int8_t, int64_t, uintptr_t
+from libc.stdint cimport int8_t, int64_t, uint64_t, uintptr_t
 from libcpp cimport bool
 from libcpp.memory cimport make_unique, unique_ptr
 from libcpp.pair cimport pair
 from libcpp.string cimport string
+from libcpp.vector cimport vector
 
 from cuda.cudart import cudaError_t
 
@@ -183,6 +184,25 @@ cdef extern from "rmm/mr/device/logging_resource_adaptor.hpp" \
 
         void flush() except +
 
+cdef extern from "rmm/mr/device/histogram.hpp" namespace "rmm::mr" nogil:
+    cdef cppclass histogram:
+        histogram()
+
+        vector[uint64_t] counts
+        uint64_t count
+        uint64_t sum
+        uint64_t min
+        uint64_t max
+
+        double mean() const
+        uint64_t percentile(double pct) const
+
+        @staticmethod
+        uint64_t bucket_lower_bound(size_t bucket)
+
+        @staticmethod
+        uint64_t bucket_upper_bound(size_t bucket)
+
 cdef extern from "rmm/mr/device/statistics_resource_adaptor.hpp" \
         namespace "rmm::mr" nogil:
     cdef cppclass statistics_resource_adaptor[Upstream](
@@ -195,10 +215,17 @@ cdef extern from "rmm/mr/device/statistics_resource_adaptor.hpp" \
             int64_t total
 
         statistics_resource_adaptor(
-            Upstream* upstream_mr) except +
+            Upstream* upstream_mr,
+            bool enable_histograms) except +
 
         counter get_bytes_counter() except +
         counter get_allocations_counter() except +
+        bool histograms_enabled()
+        histogram get_size_histogram() except +
+        histogram get_lifetime_histogram() except +
+        histogram get_allocate_latency_histogram() except +
+        histogram get_deallocate_latency_histogram() except +
+        void reset_histograms()
 
 cdef extern from "rmm/mr/device/tracking_resource_adaptor.hpp" \
         namespace "rmm::mr" nogil:
@@ -771,21 +798,48 @@ cdef class LoggingResourceAdaptor(UpstreamResourceAdaptor):
     def __dealloc__(self):
         self.c_obj.reset()
 
+cdef dict _histogram_to_dict(histogram& hist, percentiles):
+    cdef size_t i
+    buckets = []
+    for i in range(hist.counts.size()):
+        if hist.counts[i] != 0:
+            buckets.append((
+                histogram.bucket_lower_bound(i),
+                histogram.bucket_upper_bound(i),
+                hist.counts[i],
+            ))
+    values = {}
+    for pct in percentiles:
+        values[pct] = hist.percentile(pct)
+    return {
+        "count": hist.count,
+        "sum": hist.sum,
+        "min": hist.min,
+        "max": hist.max,
+        "mean": hist.mean(),
+        "percentiles": values,
+        "buckets": buckets,
+    }
+
+
 cdef class StatisticsResourceAdaptor(UpstreamResourceAdaptor):
 
     def __cinit__(
         self,
-        DeviceMemoryResource upstream_mr
+        DeviceMemoryResource upstream_mr,
+        bool enable_histograms=False
     ):
         self.c_obj.reset(
             new statistics_resource_adaptor[device_memory_resource](
-                upstream_mr.get_mr()
+                upstream_mr.get_mr(),
+                enable_histograms
             )
         )
 
     def __init__(
         self,
-        DeviceMemoryResource upstream_mr
+        DeviceMemoryResource upstream_mr,
+        bool enable_histograms=False
     ):
         """
         Memory resource that tracks the current, peak and total
@@ -796,9 +850,59 @@ cdef class StatisticsResourceAdaptor(UpstreamResourceAdaptor):
         ----------
         upstream : DeviceMemoryResource
             The upstream memory resource.
+        enable_histograms : bool, optional
+            If True, also record histograms of allocation sizes,
+            allocation lifetimes and upstream call latencies.
         """
         pass
 
+    def get_histogram(self, kind, percentiles=(50, 90, 99, 99.9)):
+        """
+        Gets a log-linear histogram recorded by this adaptor.
+
+        Histograms are only recorded if the adaptor was created with
+        ``enable_histograms=True``; otherwise they are empty.
+
+        Parameters
+        ----------
+        kind : str
+            ``"size"`` for allocation sizes in bytes, ``"lifetime"`` for
+            the nanoseconds from allocation to deallocation, or
+            ``"allocate_latency"`` / ``"deallocate_latency"`` for the
+            nanoseconds spent in the upstream resource.
+        percentiles : sequence of float, optional
+            The percentiles to report.
+
+        Returns:
+            dict: Dictionary with keys ``count``, ``sum``, ``min``,
+            ``max``, ``mean``, ``percentiles`` (a dict from each requested
+            percentile to its value) and ``buckets`` (a list of
+            ``(lower, upper, count)`` tuples for the non-empty buckets,
+            with inclusive bounds).
+        """
+        cdef statistics_resource_adaptor[device_memory_resource]* mr = (
+            <statistics_resource_adaptor[device_memory_resource]*>(
+                self.c_obj.get()))
+        cdef histogram hist
+        if kind == "size":
+            hist = mr.get_size_histogram()
+        elif kind == "lifetime":
+            hist = mr.get_lifetime_histogram()
+        elif kind == "allocate_latency":
+            hist = mr.get_allocate_latency_histogram()
+        elif kind == "deallocate_latency":
+            hist = mr.get_deallocate_latency_histogram()
+        else:
+            raise ValueError(f"Unknown histogram kind: {kind}")
+        return _histogram_to_dict(hist, percentiles)
+
+    def reset_histograms(self):
+        """
+        Empties the histograms recorded by this adaptor.
+        """
+        (<statistics_resource_adaptor[device_memory_resource]*>(
+            self.c_obj.get()))[0].reset_histograms()
+
     @property
     def allocation_counts(self) -> dict:
         """
@@ -708,6 +708,48 @@ def test_statistics_resource_adaptor(stats_mr):
     gc.collect()
 
 
+def test_statistics_resource_adaptor_histograms():
+    mr = rmm.mr.StatisticsResourceAdaptor(
+        rmm.mr.CudaMemoryResource(), enable_histograms=True
+    )
+    previous_mr = rmm.mr.get_current_device_resource()
+    rmm.mr.set_current_device_resource(mr)
+    try:
+        buffers = [rmm.DeviceBuffer(size=1000) for _ in range(10)]
+        buffers.append(rmm.DeviceBuffer(size=100000))
+        del buffers[:5]
+        gc.collect()
+
+        sizes = mr.get_histogram("size", percentiles=(50, 100))
+        assert sizes["count"] == 11
+        assert sizes["sum"] == 10 * 1000 + 100000
+        assert sizes["min"] == 1000
+        assert sizes["max"] == 100000
+        assert 1000 <= sizes["percentiles"][50] < 1000 * 9 // 8
+        assert sizes["percentiles"][100] == 100000
+        assert sum(count for _, _, count in sizes["buckets"]) == 11
+        for lower, upper, count in sizes["buckets"]:
+            assert lower <= upper
+            assert count > 0
+
+        assert mr.get_histogram("lifetime")["count"] == 5
+        assert mr.get_histogram("allocate_latency")["count"] == 11
+        assert mr.get_histogram("deallocate_latency")["count"] == 5
+        with pytest.raises(ValueError):
+            mr.get_histogram("unknown")
+
+        mr.reset_histograms()
+        assert mr.get_histogram("size")["count"] == 0
+        assert mr.get_histogram("size")["buckets"] == []
+
+        del buffers
+        gc.collect()
+        assert mr.get_histogram("lifetime")["count"] == 6
+        assert mr.allocation_counts["current_bytes"] == 0
+    finally:
+        rmm.mr.set_current_device_resource(previous_mr)
+
+
 def test_tracking_resource_adaptor():
     cuda_mr = rmm.mr.CudaMemoryResource()
 
@@ -17,15 +17,22 @@
 #include "./byte_literals.hpp"
 #include <benchmarks/utilities/log_parser.hpp>
 
+#include <rmm/cuda_stream.hpp>
+#include <rmm/mr/device/binary_logging_resource_adaptor.hpp>
 #include <rmm/mr/device/cuda_memory_resource.hpp>
 #include <rmm/mr/device/logging_resource_adaptor.hpp>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <set>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace rmm::test {
 namespace {
@@ -94,13 +101,14 @@ class raii_temp_directory {
  * allocations to a multiple of 8 bytes by rounding up the expected allocation sizes to a multiple
  * of 8.
  *
- * @param filename Name of CSV log file generated from `logging_resource_adaptor`
+ * @param filename Name of CSV log file generated from `logging_resource_adaptor`, or binary trace
+ * generated from `binary_logging_resource_adaptor`
  * @param expected_events List of expected (de)allocation events
  */
 void expect_log_events(std::string const& filename,
                        std::vector<rmm::detail::event> const& expected_events)
 {
-  auto actual_events = rmm::detail::parse_csv(filename);
+  auto actual_events = rmm::detail::parse_log(filename);
 
   std::equal(expected_events.begin(),
              expected_events.end(),
@@ -311,5 +319,179 @@ TEST(Adaptor, STDERR)
   ASSERT_EQ(header, log_mr.header());
 }
 
+TEST(Adaptor, StreamColumn)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("stream.txt")};
+  rmm::mr::cuda_memory_resource upstream;
+  rmm::cuda_stream stream;
+
+  {
+    rmm::mr::logging_resource_adaptor<rmm::mr::cuda_memory_resource> log_mr{&upstream, filename};
+    log_mr.deallocate(log_mr.allocate(100, stream), 100, stream);
+  }
+
+  // The stream is logged as a hexadecimal pointer
+  auto const events = rmm::detail::parse_csv(filename);
+  ASSERT_EQ(events.size(), 2);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const expected = reinterpret_cast<uintptr_t>(stream.value());
+  EXPECT_EQ(events[0].stream, expected);
+  EXPECT_EQ(events[1].stream, expected);
+}
+
+TEST(BinaryAdaptor, ThrowOnNullUpstream)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("null.bin")};
+  auto construct_nullptr = [&filename]() {
+    rmm::mr::binary_logging_resource_adaptor<rmm::mr::cuda_memory_resource> mr{nullptr, filename};
+  };
+  EXPECT_THROW(construct_nullptr(), rmm::logic_error);
+}
+
+TEST(BinaryAdaptor, RecordsEvents)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("trace.bin")};
+  rmm::mr::cuda_memory_resource upstream;
+
+  auto const size0{100};
+  auto const size1{1_TiB};
+  void* ptr0{};
+  {
+    rmm::mr::binary_logging_resource_adaptor<rmm::mr::cuda_memory_resource> log_mr{&upstream,
+                                                                                   filename};
+    ptr0 = log_mr.allocate(size0);
+    log_mr.deallocate(ptr0, size0);
+    EXPECT_THROW(log_mr.allocate(size1), rmm::bad_alloc);
+  }
+
+  using rmm::detail::action;
+  using rmm::detail::event;
+
+  std::vector<event> expected_events{{action::ALLOCATE, size0, ptr0},
+                                     {action::FREE, size0, ptr0},
+                                     {action::ALLOCATE_FAILURE, size1, nullptr}};
+
+  EXPECT_TRUE(rmm::detail::is_binary_trace(filename));
+  EXPECT_EQ(rmm::detail::parse_log(filename).size(), expected_events.size());
+  expect_log_events(filename, expected_events);
+}
+
+TEST(BinaryAdaptor, FlushWritesCallingThread)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("flush.bin")};
+  rmm::mr::cuda_memory_resource upstream;
+  rmm::mr::binary_logging_resource_adaptor<rmm::mr::cuda_memory_resource> log_mr{&upstream,
+                                                                                 filename};
+
+  log_mr.deallocate(log_mr.allocate(100), 100);
+  log_mr.flush();
+
+  rmm::detail::mapped_trace const trace{filename};
+  ASSERT_EQ(trace.size(), 2);
+  EXPECT_EQ(trace.begin()->action, rmm::mr::trace_action::allocate);
+  EXPECT_EQ(std::next(trace.begin())->action, rmm::mr::trace_action::free);
+  EXPECT_LE(trace.begin()->timestamp_ns, std::next(trace.begin())->timestamp_ns);
+}
+
+TEST(BinaryAdaptor, MultiThreaded)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("threads.bin")};
+  rmm::mr::cuda_memory_resource upstream;
+
+  auto const num_threads{4};
+  auto const num_allocations{100};
+  {
+    // Small buffers so that every thread writes several batches
+    auto const buffer_records{7};
+    rmm::mr::binary_logging_resource_adaptor<rmm::mr::cuda_memory_resource> log_mr{
+      &upstream, filename, buffer_records};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&log_mr] {
+        for (int j = 0; j < num_allocations; ++j) {
+          log_mr.deallocate(log_mr.allocate(256), 256);
+        }
+      });
+    }
+    std::for_each(threads.begin(), threads.end(), [](auto& thread) { thread.join(); });
+  }
+
+  auto const events = rmm::detail::parse_binary(filename);
+  ASSERT_EQ(events.size(), 2 * num_threads * num_allocations);
+  EXPECT_TRUE(std::is_sorted(events.begin(), events.end(), [](auto const& lhs, auto const& rhs) {
+    return lhs.timestamp < rhs.timestamp;
+  }));
+
+  // Events of each thread alternate between allocate and free of the same pointer
+  std::set<std::size_t> thread_ids;
+  for (auto const& evt : events) {
+    thread_ids.insert(evt.thread_id);
+  }
+  EXPECT_EQ(thread_ids.size(), num_threads);
+  for (auto tid : thread_ids) {
+    std::vector<rmm::detail::event> thread_events;
+    std::copy_if(events.begin(),
+                 events.end(),
+                 std::back_inserter(thread_events),
+                 [tid](auto const& evt) { return evt.thread_id == tid; });
+    ASSERT_EQ(thread_events.size(), 2 * num_allocations);
+    for (std::size_t i = 0; i < thread_events.size(); i += 2) {
+      EXPECT_EQ(thread_events[i].act, rmm::detail::action::ALLOCATE);
+      EXPECT_EQ(thread_events[i + 1].act, rmm::detail::action::FREE);
+      EXPECT_EQ(thread_events[i].pointer, thread_events[i + 1].pointer);
+    }
+  }
+}
+
+TEST(BinaryAdaptor, MergesSortedRuns)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("runs.bin")};
+  {
+    // Two batches, each in timestamp order, with a timestamp shared across them
+    std::vector<rmm::mr::trace_record> const records{
+      {1, 0x100, 8, 0, 0, rmm::mr::trace_action::allocate},
+      {3, 0x100, 8, 0, 0, rmm::mr::trace_action::free},
+      {2, 0x200, 16, 0, 1, rmm::mr::trace_action::allocate},
+      {3, 0x200, 16, 0, 1, rmm::mr::trace_action::free}};
+    std::ofstream file{filename, std::ios::binary};
+    rmm::mr::trace_file_header const header{};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<char const*>(records.data()),
+               static_cast<std::streamsize>(records.size() * sizeof(rmm::mr::trace_record)));
+  }
+
+  // Records are merged by timestamp, and equal timestamps keep file order
+  auto const events = rmm::detail::parse_binary(filename);
+  ASSERT_EQ(events.size(), 4);
+  std::vector<std::pair<std::uint64_t, std::size_t>> const expected{
+    {1, 0}, {2, 1}, {3, 0}, {3, 1}};
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].timestamp, expected[i].first);
+    EXPECT_EQ(events[i].thread_id, expected[i].second);
+    EXPECT_EQ(events[i].index, i);
+  }
+}
+
+TEST(BinaryAdaptor, RejectsCsv)
+{
+  raii_temp_directory temp_dir;
+  std::string filename{temp_dir.generate_path("log.csv")};
+  {
+    std::ofstream file{filename};
+    file << "Thread,Time,Action,Pointer,Size,Stream\n";
+  }
+  EXPECT_FALSE(rmm::detail::is_binary_trace(filename));
+  EXPECT_THROW(rmm::detail::mapped_trace{filename}, rmm::logic_error);
+}
+
 }  // namespace
 }  // namespace rmm::test
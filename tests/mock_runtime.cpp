@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mock_runtime.hpp"
+
+#include <dlfcn.h>
+
+// The runtime headers may rename these functions (e.g. for the per-thread default stream), so the
+// definitions below and the names looked up in the runtime library go through the same macros.
+#define RMM_MOCK_STRINGIFY_DETAIL(name) #name
+#define RMM_MOCK_STRINGIFY(name)        RMM_MOCK_STRINGIFY_DETAIL(name)
+#define RMM_MOCK_NEXT(name)             next_definition<decltype(name)>(RMM_MOCK_STRINGIFY(name))
+
+namespace {
+
+/**
+ * @brief Returns the runtime library's definition of the function `name`, which the definition in
+ * this executable hides.
+ */
+template <typename Function>
+Function* next_definition(char const* name)
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<Function*>(dlsym(RTLD_NEXT, name));
+}
+
+}  // namespace
+
+extern "C" {
+
+cudaError_t cudaEventRecord(cudaEvent_t event, cudaStream_t stream)
+{
+  static auto* const next = RMM_MOCK_NEXT(cudaEventRecord);
+  ++rmm::test::mock_runtime::event_records;
+  return next(event, stream);
+}
+
+cudaError_t cudaEventSynchronize(cudaEvent_t event)
+{
+  static auto* const next = RMM_MOCK_NEXT(cudaEventSynchronize);
+  ++rmm::test::mock_runtime::event_synchronizes;
+  return next(event);
+}
+
+cudaError_t cudaEventQuery(cudaEvent_t event)
+{
+  static auto* const next = RMM_MOCK_NEXT(cudaEventQuery);
+  if (rmm::test::mock_runtime::events_not_ready) { return cudaErrorNotReady; }
+  return next(event);
+}
+
+cudaError_t cudaDeviceSynchronize()
+{
+  static auto* const next = RMM_MOCK_NEXT(cudaDeviceSynchronize);
+  ++rmm::test::mock_runtime::device_synchronizes;
+  return next();
+}
+
+}  // extern "C"
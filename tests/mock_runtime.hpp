@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <rmm/cuda_runtime_api.h>
+
+#include <atomic>
+#include <cstddef>
+
+namespace rmm::test {
+
+/**
+ * @brief Counters and switches of the mock runtime.
+ *
+ * A test executable built with mock_runtime.cpp calls the definitions of the runtime functions
+ * there instead of those of the runtime library. Each counts its calls and forwards to the
+ * runtime library, unless a switch below overrides its result.
+ */
+struct mock_runtime {
+  static inline std::atomic<std::size_t> event_records{};        ///< Calls to cudaEventRecord
+  static inline std::atomic<std::size_t> event_synchronizes{};   ///< Calls to cudaEventSynchronize
+  static inline std::atomic<std::size_t> device_synchronizes{};  ///< Calls to cudaDeviceSynchronize
+
+  /// When set, cudaEventQuery reports cudaErrorNotReady without calling the runtime library
+  static inline std::atomic<bool> events_not_ready{};
+};
+
+}  // namespace rmm::test
@@ -29,7 +29,14 @@
 #include <memory>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <random>
+#include <string>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 namespace rmm::test {
@@ -43,7 +50,9 @@ class mock_memory_resource {
 
 using rmm::mr::detail::arena::block;
 using rmm::mr::detail::arena::byte_span;
+using rmm::mr::detail::arena::remote_free_pool;
 using rmm::mr::detail::arena::superblock;
+using rmm::mr::detail::arena::superblock_set;
 using global_arena = rmm::mr::detail::arena::global_arena<mock_memory_resource>;
 using arena        = rmm::mr::detail::arena::arena<mock_memory_resource>;
 using arena_mr     = rmm::mr::arena_memory_resource<rmm::mr::device_memory_resource>;
@@ -88,6 +97,84 @@ TEST_F(ArenaTest, AlignToSizeClass)  // NOLINT
   EXPECT_EQ(align_to_size_class(1_PiB), std::numeric_limits<std::size_t>::max());
 }
 
+TEST_F(ArenaTest, AlignToSizeClassMatchesTable)  // NOLINT
+{
+  using rmm::mr::detail::arena::align_to_size_class;
+  using rmm::mr::detail::arena::size_classes;
+  auto const& classes = size_classes();
+  auto const expected = [&classes](std::size_t value) {
+    return *std::lower_bound(classes.begin(), classes.end(), value);
+  };
+  for (std::size_t i = 0; i + 1 < classes.size(); ++i) {
+    for (auto value : {classes[i] - 1, classes[i], classes[i] + 1}) {
+      EXPECT_EQ(align_to_size_class(value), expected(value));
+    }
+  }
+}
+
+TEST_F(ArenaTest, GeometricSizeClasses)  // NOLINT
+{
+  rmm::mr::geometric_size_classes const four{4};
+  EXPECT_EQ(four.align(1), 256);
+  EXPECT_EQ(four.align(264), 512);
+  EXPECT_EQ(four.align(17_KiB), 20_KiB);
+  EXPECT_EQ(four.align(13_MiB), 14_MiB);
+  EXPECT_EQ(four.align(1_PiB), 1_PiB);
+
+  rmm::mr::geometric_size_classes const eight{8};
+  EXPECT_EQ(eight.align(264), 512);
+  EXPECT_EQ(eight.align(17_KiB), 18_KiB);
+  EXPECT_EQ(eight.align(13_MiB), 13_MiB);
+  EXPECT_EQ(eight.align(1_MiB + 1), 1_MiB + 128_KiB);
+
+  rmm::mr::geometric_size_classes const exact_small{4, 1_MiB};
+  EXPECT_EQ(exact_small.align(17_KiB + 1), 17_KiB + 256);
+  EXPECT_EQ(exact_small.align(1_MiB), 1_MiB);
+  EXPECT_EQ(exact_small.align(1_MiB + 1), 1280_KiB);
+
+  EXPECT_EQ(rmm::mr::exact_size_classes{}.align(17_KiB + 1), 17_KiB + 256);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
+  EXPECT_THROW(rmm::mr::geometric_size_classes{3}, rmm::logic_error);
+}
+
+TEST_F(ArenaTest, TableSizeClasses)  // NOLINT
+{
+  rmm::mr::table_size_classes const table{{256, 1_KiB, 3_KiB, 4_KiB, 1_MiB}};
+  EXPECT_EQ(table.align(0), 256);
+  EXPECT_EQ(table.align(1), 256);
+  EXPECT_EQ(table.align(257), 1_KiB);
+  EXPECT_EQ(table.align(2_KiB), 3_KiB);
+  EXPECT_EQ(table.align(3_KiB + 1), 4_KiB);
+  EXPECT_EQ(table.align(8_KiB), 1_MiB);
+  EXPECT_EQ(table.align(1_MiB), 1_MiB);
+  EXPECT_EQ(table.align(1_MiB + 1), 1_MiB + 256);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-goto)
+  EXPECT_THROW(rmm::mr::table_size_classes{{}}, rmm::logic_error);
+  EXPECT_THROW((rmm::mr::table_size_classes{{1_KiB, 512}}), rmm::logic_error);
+  EXPECT_THROW((rmm::mr::table_size_classes{{512, 512}}), rmm::logic_error);
+  EXPECT_THROW((rmm::mr::table_size_classes{{100, 512}}), rmm::logic_error);
+  // NOLINTEND(cppcoreguidelines-avoid-goto)
+}
+
+TEST_F(ArenaTest, SizeClassesOverflow)  // NOLINT
+{
+  auto constexpr max_size = std::numeric_limits<std::size_t>::max();
+  auto constexpr max_aligned =
+    rmm::detail::align_down(max_size, rmm::detail::CUDA_ALLOCATION_ALIGNMENT);
+  EXPECT_EQ(rmm::mr::exact_size_classes{}.align(max_aligned), max_aligned);
+
+  // NOLINTBEGIN(cppcoreguidelines-avoid-goto)
+  EXPECT_THROW(static_cast<void>(rmm::mr::exact_size_classes{}.align(max_aligned + 1)),
+               rmm::out_of_memory);
+  EXPECT_THROW(static_cast<void>(rmm::mr::geometric_size_classes{4}.align(max_size)),
+               rmm::out_of_memory);
+  EXPECT_THROW(static_cast<void>(rmm::mr::table_size_classes{{1_KiB}}.align(max_size)),
+               rmm::out_of_memory);
+  // NOLINTEND(cppcoreguidelines-avoid-goto)
+}
+
 /**
  * Test byte_span.
  */
@@ -148,7 +235,7 @@ TEST_F(ArenaTest, SuperblockEmpty)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
   EXPECT_TRUE(sblk.empty());
-  sblk.first_fit(256);
+  sblk.best_fit(256);
   EXPECT_FALSE(sblk.empty());
 }
 
@@ -173,8 +260,8 @@ TEST_F(ArenaTest, SuperblockFits)  // NOLINT
   EXPECT_TRUE(sblk.fits(superblock::minimum_size));
   EXPECT_FALSE(sblk.fits(superblock::minimum_size + 1));
 
-  auto const blk = sblk.first_fit(superblock::minimum_size / 4);
-  sblk.first_fit(superblock::minimum_size / 4);
+  auto const blk = sblk.best_fit(superblock::minimum_size / 4);
+  sblk.best_fit(superblock::minimum_size / 4);
   sblk.coalesce(blk);
   EXPECT_TRUE(sblk.fits(superblock::minimum_size / 2));
   EXPECT_FALSE(sblk.fits(superblock::minimum_size / 2 + 1));
@@ -186,12 +273,12 @@ TEST_F(ArenaTest, SuperblockIsContiguousBefore)  // NOLINT
   superblock sb2{fake_address4, superblock::minimum_size};
   EXPECT_TRUE(sblk.is_contiguous_before(sb2));
 
-  auto const blk = sblk.first_fit(256);
+  auto const blk = sblk.best_fit(256);
   EXPECT_FALSE(sblk.is_contiguous_before(sb2));
   sblk.coalesce(blk);
   EXPECT_TRUE(sblk.is_contiguous_before(sb2));
 
-  auto const blk2 = sb2.first_fit(1_KiB);
+  auto const blk2 = sb2.best_fit(1_KiB);
   EXPECT_FALSE(sblk.is_contiguous_before(sb2));
   sb2.coalesce(blk2);
   EXPECT_TRUE(sblk.is_contiguous_before(sb2));
@@ -219,66 +306,112 @@ TEST_F(ArenaTest, SuperblockMerge)  // NOLINT
   EXPECT_TRUE(merged.empty());
 }
 
-TEST_F(ArenaTest, SuperblockFirstFit)  // NOLINT
+TEST_F(ArenaTest, SuperblockBestFit)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  auto const blk = sblk.first_fit(1_KiB);
+  auto const blk = sblk.best_fit(1_KiB);
   EXPECT_EQ(blk.pointer(), fake_address3);
   EXPECT_EQ(blk.size(), 1_KiB);
-  auto const blk2 = sblk.first_fit(2_KiB);
+  auto const blk2 = sblk.best_fit(2_KiB);
   // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
   EXPECT_EQ(blk2.pointer(), static_cast<char*>(fake_address3) + 1_KiB);
   EXPECT_EQ(blk2.size(), 2_KiB);
   sblk.coalesce(blk);
-  auto const blk3 = sblk.first_fit(512);
+  auto const blk3 = sblk.best_fit(512);
   EXPECT_EQ(blk3.pointer(), fake_address3);
   EXPECT_EQ(blk3.size(), 512);
 }
 
+TEST_F(ArenaTest, SuperblockBestFitTakesSmallestClass)  // NOLINT
+{
+  // Leave free holes of 2 KiB and 1 KiB, in that address order, before the remainder
+  superblock sblk{fake_address3, superblock::minimum_size};
+  auto const hole  = sblk.best_fit(2_KiB);
+  auto const used  = sblk.best_fit(1_KiB);
+  auto const hole2 = sblk.best_fit(1_KiB);
+  auto const used2 = sblk.best_fit(1_KiB);
+  sblk.coalesce(hole);
+  sblk.coalesce(hole2);
+
+  EXPECT_EQ(sblk.best_fit(1_KiB).pointer(), hole2.pointer());
+  EXPECT_EQ(sblk.best_fit(1_KiB).pointer(), hole.pointer());
+  EXPECT_EQ(sblk.max_free_size(), superblock::minimum_size - 5_KiB);
+  sblk.coalesce(used);
+  sblk.coalesce(used2);
+}
+
+TEST_F(ArenaTest, SuperblockBestFitBetweenClasses)  // NOLINT
+{
+  // Leave a single free block of 2.75 KiB, which lies between the 2.5 KiB and 3 KiB classes
+  superblock sblk{fake_address3, superblock::minimum_size};
+  auto const blk  = sblk.best_fit(2816);
+  auto const rest = sblk.best_fit(superblock::minimum_size - 2816);
+  sblk.coalesce(blk);
+
+  EXPECT_TRUE(sblk.fits(2816));
+  EXPECT_FALSE(sblk.fits(3072));
+  EXPECT_FALSE(sblk.best_fit(3072).is_valid());
+  EXPECT_EQ(sblk.best_fit(2816).pointer(), blk.pointer());
+  sblk.coalesce(rest);
+}
+
+TEST_F(ArenaTest, SizeClassIndex)  // NOLINT
+{
+  using rmm::mr::detail::arena::num_size_classes;
+  using rmm::mr::detail::arena::size_class_index;
+  using rmm::mr::detail::arena::size_classes;
+  auto const& classes = size_classes();
+  for (std::size_t i = 0; i + 1 < num_size_classes; ++i) {
+    EXPECT_EQ(size_class_index(classes[i]), i);
+    EXPECT_EQ(size_class_index(classes[i] + 1), i + 1);
+  }
+  EXPECT_EQ(size_class_index(1), 0);
+}
+
 TEST_F(ArenaTest, SuperblockCoalesceAfterFull)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  auto const blk = sblk.first_fit(superblock::minimum_size / 2);
-  sblk.first_fit(superblock::minimum_size / 2);
+  auto const blk = sblk.best_fit(superblock::minimum_size / 2);
+  sblk.best_fit(superblock::minimum_size / 2);
   sblk.coalesce(blk);
-  EXPECT_TRUE(sblk.first_fit(superblock::minimum_size / 2).is_valid());
+  EXPECT_TRUE(sblk.best_fit(superblock::minimum_size / 2).is_valid());
 }
 
 TEST_F(ArenaTest, SuperblockCoalesceMergeNext)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  auto const blk = sblk.first_fit(superblock::minimum_size / 2);
+  auto const blk = sblk.best_fit(superblock::minimum_size / 2);
   sblk.coalesce(blk);
-  EXPECT_TRUE(sblk.first_fit(superblock::minimum_size).is_valid());
+  EXPECT_TRUE(sblk.best_fit(superblock::minimum_size).is_valid());
 }
 
 TEST_F(ArenaTest, SuperblockCoalesceMergePrevious)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  auto const blk  = sblk.first_fit(1_KiB);
-  auto const blk2 = sblk.first_fit(1_KiB);
-  sblk.first_fit(1_KiB);
+  auto const blk  = sblk.best_fit(1_KiB);
+  auto const blk2 = sblk.best_fit(1_KiB);
+  sblk.best_fit(1_KiB);
   sblk.coalesce(blk);
   sblk.coalesce(blk2);
-  auto const blk3 = sblk.first_fit(2_KiB);
+  auto const blk3 = sblk.best_fit(2_KiB);
   EXPECT_EQ(blk3.pointer(), fake_address3);
 }
 
 TEST_F(ArenaTest, SuperblockCoalesceMergePreviousAndNext)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  auto const blk  = sblk.first_fit(1_KiB);
-  auto const blk2 = sblk.first_fit(1_KiB);
+  auto const blk  = sblk.best_fit(1_KiB);
+  auto const blk2 = sblk.best_fit(1_KiB);
   sblk.coalesce(blk);
   sblk.coalesce(blk2);
-  EXPECT_TRUE(sblk.first_fit(superblock::minimum_size).is_valid());
+  EXPECT_TRUE(sblk.best_fit(superblock::minimum_size).is_valid());
 }
 
 TEST_F(ArenaTest, SuperblockMaxFreeSize)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  auto const blk = sblk.first_fit(superblock::minimum_size / 4);
-  sblk.first_fit(superblock::minimum_size / 4);
+  auto const blk = sblk.best_fit(superblock::minimum_size / 4);
+  sblk.best_fit(superblock::minimum_size / 4);
   sblk.coalesce(blk);
   EXPECT_EQ(sblk.max_free_size(), superblock::minimum_size / 2);
 }
@@ -286,10 +419,63 @@ TEST_F(ArenaTest, SuperblockMaxFreeSize)  // NOLINT
 TEST_F(ArenaTest, SuperblockMaxFreeSizeWhenFull)  // NOLINT
 {
   superblock sblk{fake_address3, superblock::minimum_size};
-  sblk.first_fit(superblock::minimum_size);
+  sblk.best_fit(superblock::minimum_size);
   EXPECT_EQ(sblk.max_free_size(), 0);
 }
 
+TEST_F(ArenaTest, SuperblockFitsUnalignedSize)  // NOLINT
+{
+  // Leave a 1.5 KiB hole followed by the 1 KiB-smaller remainder of the superblock
+  superblock sblk{fake_address3, superblock::minimum_size};
+  auto const blk = sblk.best_fit(1536);
+  sblk.best_fit(superblock::minimum_size - 2_KiB);
+  sblk.coalesce(blk);
+
+  // 1.5 KiB lies between two size classes
+  EXPECT_TRUE(sblk.fits(1536));
+  EXPECT_FALSE(sblk.fits(1536 + 1));
+  EXPECT_EQ(sblk.max_free_size(), 1536);
+}
+
+TEST_F(ArenaTest, SuperblockCachedFitMatchesFreeBlocks)  // NOLINT
+{
+  superblock sblk{fake_address3, superblock::minimum_size};
+  std::default_random_engine generator;
+  std::uniform_int_distribution<std::size_t> size_distribution(1, 64);
+  std::vector<block> live;
+
+  // Reference largest free block, computed from the allocated blocks
+  auto reference_max_free = [&] {
+    std::vector<block> sorted = live;
+    std::sort(sorted.begin(), sorted.end());
+    std::size_t max_free{};
+    char* next = sblk.pointer();
+    for (auto const& blk : sorted) {
+      max_free = std::max(max_free, static_cast<std::size_t>(blk.pointer() - next));
+      next     = blk.end();
+    }
+    return std::max(max_free, static_cast<std::size_t>(sblk.end() - next));
+  };
+
+  auto const num_operations{2000};
+  for (int i = 0; i < num_operations; ++i) {
+    if (live.empty() || generator() % 3 != 0) {
+      auto const size = size_distribution(generator) * 256;
+      auto const blk  = sblk.best_fit(size);
+      if (blk.is_valid()) { live.push_back(blk); }
+    } else {
+      auto const index = generator() % live.size();
+      sblk.coalesce(live[index]);
+      live.erase(live.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+
+    auto const max_free = reference_max_free();
+    ASSERT_EQ(sblk.max_free_size(), max_free);
+    if (max_free > 0) { EXPECT_TRUE(sblk.fits(max_free)); }
+    EXPECT_FALSE(sblk.fits(max_free + 1));
+  }
+}
+
 /**
  * Test global_arena.
  */
@@ -350,7 +536,7 @@ TEST_F(ArenaTest, GlobalArenaReleaseMergePreviousAndNext)  // NOLINT
 
 TEST_F(ArenaTest, GlobalArenaReleaseMultiple)  // NOLINT
 {
-  std::set<superblock> superblocks{};
+  superblock_set superblocks{};
   auto sblk = global->acquire(256);
   superblocks.insert(std::move(sblk));
   auto sb2 = global->acquire(1_KiB);
@@ -395,14 +581,138 @@ TEST_F(ArenaTest, GlobalArenaDeallocateAlignUp)  // NOLINT
 TEST_F(ArenaTest, GlobalArenaDeallocateFromOtherArena)  // NOLINT
 {
   auto sblk       = global->acquire(512);
-  auto const blk  = sblk.first_fit(512);
-  auto const blk2 = sblk.first_fit(1024);
+  auto const blk  = sblk.best_fit(512);
+  auto const blk2 = sblk.best_fit(1024);
   global->release(std::move(sblk));
   global->deallocate(blk.pointer(), blk.size());
   global->deallocate(blk2.pointer(), blk2.size());
   EXPECT_EQ(global->allocate(arena_size), fake_address3);
 }
 
+TEST_F(ArenaTest, GlobalArenaSplitAtPageBoundary)  // NOLINT
+{
+  auto* ptr = global->allocate(superblock::minimum_size + 256);
+  EXPECT_EQ(ptr, fake_address3);
+  // The first superblock was rounded up to two pages
+  auto* ptr2 = global->allocate(superblock::minimum_size * 2);
+  EXPECT_EQ(ptr2, static_cast<char*>(fake_address3) + superblock::minimum_size * 2);
+}
+
+TEST_F(ArenaTest, GlobalArenaOwnerOf)  // NOLINT
+{
+  auto sblk  = global->acquire(256, per_thread.get());
+  auto* last = sblk.end() - 1;
+  EXPECT_EQ(global->owner_of(sblk.pointer()), per_thread.get());
+  EXPECT_EQ(global->owner_of(last), per_thread.get());
+  EXPECT_EQ(global->owner_of(sblk.end()), nullptr);
+  EXPECT_EQ(global->owner_of(fake_address), nullptr);
+
+  global->release(std::move(sblk));
+  EXPECT_EQ(global->owner_of(fake_address3), nullptr);
+}
+
+TEST_F(ArenaTest, GlobalArenaNoGrowthByDefault)  // NOLINT
+{
+  EXPECT_EQ(global->maximum_size(), arena_size);
+  EXPECT_FALSE(global->grow(superblock::minimum_size));
+  EXPECT_EQ(global->num_regions(), 1);
+}
+
+TEST_F(ArenaTest, GlobalArenaGrow)  // NOLINT
+{
+  mock_memory_resource mock{};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+  auto* const region2 = reinterpret_cast<void*>(superblock::minimum_size * 16);
+  auto const initial  = superblock::minimum_size * 2;
+  EXPECT_CALL(mock, allocate(initial)).WillOnce(Return(fake_address3)).WillOnce(Return(region2));
+  EXPECT_CALL(mock, deallocate(fake_address3, initial));
+  EXPECT_CALL(mock, deallocate(region2, initial));
+  global_arena growable{&mock, initial, initial * 2};
+  arena owner{growable};
+
+  EXPECT_EQ(growable.allocate(initial), fake_address3);
+  EXPECT_FALSE(growable.acquire(256).is_valid());
+  EXPECT_TRUE(growable.grow(256));
+  EXPECT_EQ(growable.size(), initial * 2);
+  EXPECT_EQ(growable.num_regions(), 2);
+
+  auto sblk = growable.acquire(256, &owner);
+  EXPECT_EQ(sblk.pointer(), region2);
+  EXPECT_EQ(growable.owner_of(sblk.pointer()), &owner);
+  growable.release(std::move(sblk));
+
+  // The maximum size is reached
+  EXPECT_FALSE(growable.grow(256));
+}
+
+TEST_F(ArenaTest, GlobalArenaGrowFallsBackToRequiredSize)  // NOLINT
+{
+  mock_memory_resource mock{};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+  auto* const region2 = reinterpret_cast<void*>(superblock::minimum_size * 16);
+  auto const initial  = superblock::minimum_size * 4;
+  EXPECT_CALL(mock, allocate(initial))
+    .WillOnce(Return(fake_address3))
+    .WillOnce([](std::size_t) -> void* { throw rmm::out_of_memory{"out of memory"}; });
+  EXPECT_CALL(mock, allocate(superblock::minimum_size)).WillOnce(Return(region2));
+  EXPECT_CALL(mock, deallocate(fake_address3, initial));
+  EXPECT_CALL(mock, deallocate(region2, superblock::minimum_size));
+  global_arena growable{&mock, initial, initial * 2};
+
+  EXPECT_TRUE(growable.grow(256));
+  EXPECT_EQ(growable.size(), initial + superblock::minimum_size);
+}
+
+TEST_F(ArenaTest, GlobalArenaNoCoalesceAcrossRegions)  // NOLINT
+{
+  mock_memory_resource mock{};
+  auto const initial = superblock::minimum_size * 2;
+  // The second region directly follows the first
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  auto* const region2 = static_cast<char*>(fake_address3) + initial;
+  EXPECT_CALL(mock, allocate(initial)).WillOnce(Return(fake_address3)).WillOnce(Return(region2));
+  EXPECT_CALL(mock, deallocate(fake_address3, initial));
+  EXPECT_CALL(mock, deallocate(region2, initial));
+  global_arena growable{&mock, initial, initial * 2};
+
+  auto* first = growable.allocate(initial);
+  EXPECT_TRUE(growable.grow(initial));
+  auto* second = growable.allocate(initial);
+  EXPECT_EQ(second, region2);
+  growable.deallocate(first, initial);
+  growable.deallocate(second, initial);
+
+  // Both regions are free, but they are not merged into one superblock
+  EXPECT_EQ(growable.allocate(initial * 2), nullptr);
+  EXPECT_EQ(growable.allocate(initial), fake_address3);
+}
+
+TEST_F(ArenaTest, GlobalArenaReleaseFreeRegion)  // NOLINT
+{
+  mock_memory_resource mock{};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+  auto* const region2 = reinterpret_cast<void*>(superblock::minimum_size * 16);
+  auto const initial  = superblock::minimum_size * 2;
+  EXPECT_CALL(mock, allocate(initial)).WillOnce(Return(fake_address3)).WillOnce(Return(region2));
+  EXPECT_CALL(mock, deallocate(fake_address3, initial));
+  EXPECT_CALL(mock, deallocate(region2, initial));
+  global_arena growable{&mock, initial, initial * 2, initial};
+
+  auto* first = growable.allocate(initial);
+  EXPECT_TRUE(growable.grow(initial));
+  auto* second = growable.allocate(initial);
+  EXPECT_EQ(growable.num_regions(), 2);
+
+  // Releasing the second region keeps the arena at the threshold
+  growable.deallocate(second, initial);
+  EXPECT_EQ(growable.num_regions(), 1);
+  EXPECT_EQ(growable.size(), initial);
+
+  // The last region is kept, since the arena would drop below the threshold
+  growable.deallocate(first, initial);
+  EXPECT_EQ(growable.num_regions(), 1);
+}
+
 /**
  * Test arena.
  */
@@ -451,6 +761,64 @@ TEST_F(ArenaTest, ArenaDeallocateMergePreviousAndNext)  // NOLINT
   EXPECT_EQ(per_thread->allocate(2_KiB), fake_address3);
 }
 
+TEST_F(ArenaTest, ArenaFreeRemoteReclaimedOnAllocate)  // NOLINT
+{
+  auto* ptr = per_thread->allocate(256);
+  EXPECT_EQ(ptr, fake_address3);
+  per_thread->free_remote(ptr, 256);
+  // The queued block is returned to its superblock before the next allocation is served
+  EXPECT_EQ(per_thread->allocate(256), fake_address3);
+}
+
+TEST_F(ArenaTest, ArenaFreeRemoteAfterClean)  // NOLINT
+{
+  auto* ptr = per_thread->allocate(256);
+  per_thread->clean();
+  per_thread->free_remote(ptr, 256);
+  per_thread->defragment();
+  // The block went back to the superblock held by the global arena
+  EXPECT_EQ(global->allocate(arena_size), fake_address3);
+}
+
+TEST_F(ArenaTest, ArenaFreeRemoteForwardedToNewOwner)  // NOLINT
+{
+  auto* ptr = per_thread->allocate(256);
+  per_thread->clean();
+
+  // Another arena acquires the superblock that still holds the block
+  arena other{*global};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  EXPECT_EQ(other.allocate(256), static_cast<char*>(fake_address3) + 256);
+
+  per_thread->free_remote(ptr, 256);
+  per_thread->defragment();
+  EXPECT_EQ(other.allocate(256), fake_address3);
+}
+
+TEST_F(ArenaTest, ArenaFreeRemoteReturnedOnExit)  // NOLINT
+{
+  auto* ptr = per_thread->allocate(256);
+  per_thread->free_remote(ptr, 256, rmm::cuda_stream_view{});
+  // The owner waits for the queued free and hands everything back to the global arena
+  per_thread->clean_on_exit();
+  EXPECT_EQ(global->allocate(arena_size), fake_address3);
+}
+
+TEST_F(ArenaTest, RemoteFreePoolReusesNodes)  // NOLINT
+{
+  remote_free_pool pool{2};
+  auto* first  = pool.acquire();
+  auto* second = pool.acquire();
+  EXPECT_NE(first, nullptr);
+  EXPECT_NE(second, nullptr);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(pool.acquire(), nullptr);
+  pool.release(first);
+  EXPECT_EQ(pool.acquire(), first);
+  pool.release(first);
+  pool.release(second);
+}
+
 TEST_F(ArenaTest, ArenaDefragment)  // NOLINT
 {
   std::vector<void*> pointers;
@@ -533,6 +901,269 @@ TEST_F(ArenaTest, Defragment)  // NOLINT
   }());
 }
 
+TEST_F(ArenaTest, FreeOnOtherStreamQueuedWithEvent)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 2_MiB};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+
+  // The block is queued to the arena of stream A, and returned once the free on B has completed
+  void* ptr = mr.allocate(1_KiB, stream_a);
+  EXPECT_NO_THROW(mr.deallocate(ptr, 1_KiB, stream_b));
+  stream_b.synchronize();
+  void* again = mr.allocate(1_KiB, stream_a);
+  EXPECT_EQ(again, ptr);
+  mr.deallocate(again, 1_KiB, stream_a);
+}
+
+TEST_F(ArenaTest, ReclaimIdleStreamArena)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 2_MiB};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+
+  // The arena of stream A keeps an empty superblock that stream B needs
+  void* ptr = mr.allocate(1_KiB, stream_a);
+  mr.deallocate(ptr, 1_KiB, stream_a);
+  stream_a.synchronize();
+
+  void* large{};
+  EXPECT_NO_THROW(large = mr.allocate(2_MiB, stream_b));
+  mr.deallocate(large, 2_MiB, stream_b);
+
+  auto const stats = mr.get_reclaim_statistics();
+  EXPECT_EQ(stats.reclaims, 1);
+  EXPECT_EQ(stats.idle_reclaims, 1);
+  EXPECT_EQ(stats.streams_synchronized, 0);
+  EXPECT_EQ(stats.device_reclaims, 0);
+}
+
+TEST_F(ArenaTest, ReclaimDestroyedStreamArena)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 2_MiB};
+  cudaStream_t stream{};  // we don't use rmm::cuda_stream here to make destruction more explicit
+  EXPECT_EQ(cudaSuccess, cudaStreamCreate(&stream));
+
+  // The arena of the destroyed stream is reclaimed through its event, not through the stream
+  void* ptr = mr.allocate(1_KiB, rmm::cuda_stream_view{stream});
+  mr.deallocate(ptr, 1_KiB, rmm::cuda_stream_view{stream});
+  EXPECT_EQ(cudaSuccess, cudaStreamDestroy(stream));
+
+  rmm::cuda_stream other{};
+  void* large{};
+  EXPECT_NO_THROW(large = mr.allocate(2_MiB, other));
+  mr.deallocate(large, 2_MiB, other);
+
+  auto const stats = mr.get_reclaim_statistics();
+  EXPECT_EQ(stats.reclaims, 1);
+  EXPECT_EQ(stats.device_reclaims, 0);
+}
+
+TEST_F(ArenaTest, ReclaimBySynchronizingStream)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 2_MiB};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+  rmm::cuda_stream stream_c{};
+
+  // The arenas of streams A and B each hold a superblock that is not empty, so neither is released
+  // before its stream has been synchronized, and releasing one is enough for stream C
+  void* ptr_a = mr.allocate(1_KiB, stream_a);
+  void* ptr_b = mr.allocate(1_KiB, stream_b);
+
+  void* ptr_c{};
+  EXPECT_NO_THROW(ptr_c = mr.allocate(512_KiB, stream_c));
+  mr.deallocate(ptr_c, 512_KiB, stream_c);
+  mr.deallocate(ptr_a, 1_KiB, stream_a);
+  mr.deallocate(ptr_b, 1_KiB, stream_b);
+
+  auto const stats = mr.get_reclaim_statistics();
+  EXPECT_EQ(stats.reclaims, 1);
+  EXPECT_EQ(stats.stream_reclaims, 1);
+  EXPECT_EQ(stats.streams_synchronized, 1);
+  EXPECT_EQ(stats.device_reclaims, 0);
+}
+
+TEST_F(ArenaTest, ReclaimOtherThreadArenaBySynchronizingDevice)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 2_MiB};
+  std::promise<void> allocated;
+  std::promise<void> reclaimed;
+  // Another thread's per-thread arena can only be reclaimed after a device synchronization
+  std::thread other([&] {
+    void* ptr = mr.allocate(1_KiB, rmm::cuda_stream_per_thread);
+    mr.deallocate(ptr, 1_KiB, rmm::cuda_stream_per_thread);
+    allocated.set_value();
+    reclaimed.get_future().wait();
+  });
+  allocated.get_future().wait();
+
+  rmm::cuda_stream stream{};
+  void* large{};
+  EXPECT_NO_THROW(large = mr.allocate(2_MiB, stream));
+  mr.deallocate(large, 2_MiB, stream);
+  reclaimed.set_value();
+  other.join();
+
+  auto const stats = mr.get_reclaim_statistics();
+  EXPECT_EQ(stats.reclaims, 1);
+  EXPECT_EQ(stats.idle_reclaims, 0);
+  EXPECT_EQ(stats.stream_reclaims, 0);
+  EXPECT_EQ(stats.device_reclaims, 1);
+}
+
+TEST_F(ArenaTest, GrowBeforeSynchronizingDevice)  // NOLINT
+{
+  arena_mr::options opts;
+  opts.arena_size         = 2_MiB;
+  opts.maximum_arena_size = 4_MiB;
+  arena_mr mr{rmm::mr::get_current_device_resource(), opts};
+  std::promise<void> allocated;
+  std::promise<void> grown;
+  // Another thread's per-thread arena holds a superblock, so only growth avoids a device sync
+  std::thread other([&] {
+    void* ptr = mr.allocate(1_KiB, rmm::cuda_stream_per_thread);
+    mr.deallocate(ptr, 1_KiB, rmm::cuda_stream_per_thread);
+    allocated.set_value();
+    grown.get_future().wait();
+  });
+  allocated.get_future().wait();
+
+  rmm::cuda_stream stream{};
+  void* large{};
+  EXPECT_NO_THROW(large = mr.allocate(2_MiB, stream));
+  mr.deallocate(large, 2_MiB, stream);
+  grown.set_value();
+  other.join();
+
+  auto const stats = mr.get_reclaim_statistics();
+  EXPECT_EQ(stats.reclaims, 1);
+  EXPECT_EQ(stats.growth_reclaims, 1);
+  EXPECT_EQ(stats.device_reclaims, 0);
+}
+
+TEST_F(ArenaTest, DeallocateOnOtherKindOfStream)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 4_MiB};
+  rmm::cuda_stream stream{};
+
+  // Per-thread arena to stream arena and back
+  void* ptr = mr.allocate(1_KiB, rmm::cuda_stream_per_thread);
+  EXPECT_NO_THROW(mr.deallocate(ptr, 1_KiB, stream));
+  ptr = mr.allocate(1_KiB, stream);
+  EXPECT_NO_THROW(mr.deallocate(ptr, 1_KiB, rmm::cuda_stream_per_thread));
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+}
+
+TEST_F(ArenaTest, DeallocateFromOtherThread)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 4_MiB};
+  std::vector<void*> pointers(8);
+  std::promise<void> allocated;
+  std::promise<void> freed;
+  std::thread producer([&] {
+    for (auto& ptr : pointers) {
+      ptr = mr.allocate(1_KiB, rmm::cuda_stream_per_thread);
+    }
+    allocated.set_value();
+    // Keep the producer's arena (and its superblock) alive while the consumer frees
+    freed.get_future().wait();
+  });
+
+  allocated.get_future().wait();
+  for (auto* ptr : pointers) {
+    EXPECT_NO_THROW(mr.deallocate(ptr, 1_KiB, rmm::cuda_stream_per_thread));
+  }
+  freed.set_value();
+  producer.join();
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+}
+
+TEST_F(ArenaTest, ThreadArenaPerResource)  // NOLINT
+{
+  // One thread alternates between two resources; each must serve from its own per-thread arena
+  arena_mr first{rmm::mr::get_current_device_resource(), 4_MiB};
+  arena_mr second{rmm::mr::get_current_device_resource(), 4_MiB};
+  for (int i = 0; i < 4; ++i) {
+    void* ptr_first  = first.allocate(1_KiB, rmm::cuda_stream_per_thread);
+    void* ptr_second = second.allocate(1_KiB, rmm::cuda_stream_per_thread);
+    EXPECT_NO_THROW(first.deallocate(ptr_first, 1_KiB, rmm::cuda_stream_per_thread));
+    EXPECT_NO_THROW(second.deallocate(ptr_second, 1_KiB, rmm::cuda_stream_per_thread));
+  }
+  EXPECT_EQ(first.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+  EXPECT_EQ(second.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+}
+
+TEST_F(ArenaTest, ThreadArenaAfterResourceDestroyed)  // NOLINT
+{
+  // A new resource, possibly at the address of a destroyed one, must not reuse its cached arena
+  for (int i = 0; i < 4; ++i) {
+    auto mr   = std::make_unique<arena_mr>(rmm::mr::get_current_device_resource(), 4_MiB);
+    void* ptr = mr->allocate(1_KiB, rmm::cuda_stream_per_thread);
+    EXPECT_NO_THROW(mr->deallocate(ptr, 1_KiB, rmm::cuda_stream_per_thread));
+    EXPECT_EQ(mr->get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+  }
+}
+
+TEST_F(ArenaTest, SizeClassPolicy)  // NOLINT
+{
+  auto const classes = std::make_shared<rmm::mr::geometric_size_classes>(8);
+  arena_mr::options opts;
+  opts.arena_size   = 4_MiB;
+  opts.size_classes = classes;
+  arena_mr mr{rmm::mr::get_current_device_resource(), opts};
+  void* ptr = mr.allocate(17_KiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB - 18_KiB);
+  mr.deallocate(ptr, 17_KiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
+  opts.size_classes = nullptr;
+  EXPECT_THROW(arena_mr(rmm::mr::get_current_device_resource(), opts), rmm::logic_error);
+}
+
+TEST_F(ArenaTest, GrowOnDemand)  // NOLINT
+{
+  arena_mr::options opts;
+  opts.arena_size         = 2_MiB;
+  opts.maximum_arena_size = 8_MiB;
+  arena_mr mr{rmm::mr::get_current_device_resource(), opts};
+  auto [free, total] = mr.get_mem_info(rmm::cuda_stream_default);
+  EXPECT_EQ(total, 2_MiB);
+
+  std::vector<void*> pointers(3);
+  for (auto& ptr : pointers) {
+    ptr = mr.allocate(2_MiB);
+  }
+  std::tie(free, total) = mr.get_mem_info(rmm::cuda_stream_default);
+  EXPECT_EQ(total, 6_MiB);
+  EXPECT_EQ(free, 0);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
+  EXPECT_THROW(mr.allocate(4_MiB), rmm::out_of_memory);
+
+  for (auto* ptr : pointers) {
+    mr.deallocate(ptr, 2_MiB);
+  }
+}
+
+TEST_F(ArenaTest, ReleaseThreshold)  // NOLINT
+{
+  arena_mr::options opts;
+  opts.arena_size         = 2_MiB;
+  opts.maximum_arena_size = 8_MiB;
+  opts.release_threshold  = 2_MiB;
+  arena_mr mr{rmm::mr::get_current_device_resource(), opts};
+  void* first  = mr.allocate(2_MiB);
+  void* second = mr.allocate(4_MiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).second, 6_MiB);
+
+  mr.deallocate(second, 4_MiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).second, 2_MiB);
+  mr.deallocate(first, 2_MiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).second, 2_MiB);
+}
+
 TEST_F(ArenaTest, DumpLogOnFailure)  // NOLINT
 {
   arena_mr mr{rmm::mr::get_current_device_resource(), 1_MiB, true};
@@ -565,10 +1196,70 @@ TEST_F(ArenaTest, FeatureSupport)  // NOLINT
 {
   arena_mr mr{rmm::mr::get_current_device_resource(), 1_MiB};
   EXPECT_TRUE(mr.supports_streams());
-  EXPECT_FALSE(mr.supports_get_mem_info());
+  EXPECT_TRUE(mr.supports_get_mem_info());
   auto [free, total] = mr.get_mem_info(rmm::cuda_stream_default);
-  EXPECT_EQ(free, 0);
-  EXPECT_EQ(total, 0);
+  EXPECT_EQ(free, 1_MiB);
+  EXPECT_EQ(total, 1_MiB);
+}
+
+TEST_F(ArenaTest, GetMemInfo)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 4_MiB};
+  rmm::cuda_stream stream{};
+  void* small = mr.allocate(1_KiB);
+  void* large = mr.allocate(1_MiB, stream);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB - 1_KiB - 1_MiB);
+
+  mr.deallocate(small, 1_KiB);
+  mr.deallocate(large, 1_MiB, stream);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+}
+
+TEST_F(ArenaTest, Snapshot)  // NOLINT
+{
+  arena_mr mr{rmm::mr::get_current_device_resource(), 4_MiB};
+  void* first  = mr.allocate(1_KiB);
+  void* second = mr.allocate(1_KiB);
+  void* third  = mr.allocate(1_KiB);
+  mr.deallocate(second, 1_KiB);
+
+  auto const snap = mr.snapshot();
+  EXPECT_TRUE(snap.complete);
+  EXPECT_EQ(snap.total_bytes, 4_MiB);
+  ASSERT_EQ(snap.regions.size(), 1);
+  EXPECT_EQ(snap.regions.front().size, 4_MiB);
+  EXPECT_EQ(snap.free_bytes, 4_MiB - 2_KiB);
+  EXPECT_EQ(snap.largest_free, 3_MiB);
+  EXPECT_DOUBLE_EQ(snap.fragmentation(), 1 - 3.0 / (4 - 2.0 / 1024));
+
+  ASSERT_EQ(snap.free_lists.size(), 2);
+  auto const& global = snap.free_lists.front();
+  EXPECT_EQ(global.owner, "global");
+  EXPECT_EQ(global.free_bytes, 3_MiB);
+  auto const& stream = snap.free_lists.back();
+  EXPECT_EQ(stream.free_bytes, 1_MiB - 2_KiB);
+  EXPECT_EQ(stream.largest_free, 1_MiB - 3_KiB);
+  EXPECT_EQ(stream.free_blocks, 2);
+  ASSERT_EQ(stream.superblocks.size(), 1);
+  EXPECT_EQ(stream.superblocks.front().free_bytes, 1_MiB - 2_KiB);
+  ASSERT_EQ(stream.extents.size(), 2);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  EXPECT_EQ(stream.extents.front().address, reinterpret_cast<std::uintptr_t>(second));
+  EXPECT_EQ(stream.extents.front().size, 1_KiB);
+
+  auto const json = snap.to_json();
+  EXPECT_NE(json.find(R"("owner":"global")"), std::string::npos);
+  EXPECT_NE(json.find(R"("complete":true)"), std::string::npos);
+
+  // Limiting the extents leaves the summaries intact
+  auto const partial = mr.snapshot(1);
+  EXPECT_FALSE(partial.complete);
+  EXPECT_EQ(partial.free_bytes, snap.free_bytes);
+  EXPECT_EQ(partial.free_lists.front().extents.size() + partial.free_lists.back().extents.size(),
+            1);
+
+  mr.deallocate(first, 1_KiB);
+  mr.deallocate(third, 1_KiB);
 }
 
 }  // namespace
@@ -14,11 +14,18 @@
  * limitations under the License.
  */
 
+#include "../../byte_literals.hpp"
+
+#include <rmm/cuda_stream_view.hpp>
 #include <rmm/mr/device/binning_memory_resource.hpp>
 #include <rmm/mr/device/cuda_memory_resource.hpp>
+#include <rmm/mr/device/pool_memory_resource.hpp>
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 // explicit instantiation for test coverage purposes
 template class rmm::mr::binning_memory_resource<rmm::mr::cuda_memory_resource>;
 
@@ -43,4 +50,226 @@ TEST(BinningTest, ExplicitBinMR)
   mr.deallocate(ptr, 512);
 }
 
+TEST(BinningTest, GetMemInfo)
+{
+  cuda_mr cuda{};
+  rmm::mr::pool_memory_resource<cuda_mr> pool{&cuda, 4_MiB, 4_MiB};
+  rmm::mr::binning_memory_resource<decltype(pool)> mr{&pool};
+  EXPECT_TRUE(mr.supports_get_mem_info());
+
+  // The owned bin takes a chunk from the pool, but its unallocated blocks still count as free
+  mr.add_bin(1_KiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+
+  auto* small = mr.allocate(512);
+  auto* large = mr.allocate(1_MiB);
+  {
+    auto const [free, total] = mr.get_mem_info(rmm::cuda_stream_default);
+    EXPECT_EQ(free, 4_MiB - 1_KiB - 1_MiB);
+    EXPECT_EQ(total, 4_MiB);
+  }
+
+  mr.deallocate(small, 512);
+  mr.deallocate(large, 1_MiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+}
+
+TEST(BinningTest, BinSelection)
+{
+  cuda_mr cuda{};
+  binning_mr mr{&cuda};
+  // Added out of order and with two bins within one doubling
+  mr.add_bin(3_KiB);
+  mr.add_bin(1_KiB);
+  mr.add_bin(64_KiB);
+  mr.add_bin(1536);
+
+  std::vector<std::size_t> const sizes{
+    1, 1_KiB, 1_KiB + 1, 1536, 1537, 3_KiB, 3_KiB + 1, 64_KiB, 64_KiB + 1};
+  for (auto size : sizes) {
+    mr.deallocate(mr.allocate(size), size);
+  }
+
+  auto const stats = mr.get_bin_statistics();
+  ASSERT_EQ(stats.bins.size(), 4);
+  std::vector<std::size_t> const expected_sizes{1_KiB, 1536, 3_KiB, 64_KiB};
+  for (std::size_t i = 0; i < stats.bins.size(); ++i) {
+    EXPECT_EQ(stats.bins[i].size, expected_sizes[i]);
+    EXPECT_EQ(stats.bins[i].allocations, 2);
+  }
+  EXPECT_EQ(stats.upstream_allocations, 1);
+}
+
+rmm::mr::adaptive_binning_options test_adaptive_options(std::size_t memory_budget)
+{
+  rmm::mr::adaptive_binning_options options{};
+  options.memory_budget    = memory_budget;
+  options.max_bin_size     = 64_KiB;
+  options.blocks_per_chunk = 4;
+  options.sample_period    = 1;
+  options.window           = 16;
+  options.hot_fraction     = 0.5;
+  options.cold_fraction    = 0.1;
+  return options;
+}
+
+TEST(BinningTest, AdaptiveBinForHotSize)
+{
+  cuda_mr cuda{};
+  binning_mr mr{&cuda, test_adaptive_options(1_MiB)};
+  for (int i = 0; i < 16; ++i) {
+    mr.deallocate(mr.allocate(3_KiB), 3_KiB);
+  }
+
+  // The last allocation of the window found the size hot and was served by the new bin
+  auto const stats = mr.get_bin_statistics();
+  EXPECT_EQ(stats.bins_created, 1);
+  EXPECT_EQ(stats.adaptive_bytes, 4 * 3_KiB);
+  ASSERT_EQ(stats.bins.size(), 1);
+  EXPECT_TRUE(stats.bins.front().adaptive);
+  EXPECT_EQ(stats.bins.front().size, 3_KiB);
+  EXPECT_EQ(stats.bins.front().allocations, 1);
+  EXPECT_EQ(stats.allocations, 16);
+  EXPECT_EQ(stats.upstream_allocations, 15);
+  EXPECT_DOUBLE_EQ(stats.bins.front().hit_rate, 1.0 / 16);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 1.0 / 16);
+}
+
+TEST(BinningTest, AdaptiveBinRetiresWhenDrained)
+{
+  cuda_mr cuda{};
+  binning_mr mr{&cuda, test_adaptive_options(1_MiB)};
+  for (int i = 0; i < 16; ++i) {
+    mr.deallocate(mr.allocate(3_KiB), 3_KiB);
+  }
+  void* held = mr.allocate(3_KiB);
+
+  // A window dominated by another size retires the cold bin, which drains before it is destroyed
+  for (int i = 0; i < 15; ++i) {
+    mr.deallocate(mr.allocate(5_KiB), 5_KiB);
+  }
+  auto stats = mr.get_bin_statistics();
+  EXPECT_EQ(stats.bins_created, 2);
+  ASSERT_EQ(stats.bins.size(), 2);
+  EXPECT_TRUE(stats.bins.front().retiring);
+  EXPECT_FALSE(stats.bins.back().retiring);
+
+  mr.deallocate(held, 3_KiB);
+  stats = mr.get_bin_statistics();
+  EXPECT_EQ(stats.bins_retired, 1);
+  ASSERT_EQ(stats.bins.size(), 1);
+  EXPECT_EQ(stats.bins.front().size, 5_KiB);
+  EXPECT_EQ(stats.adaptive_bytes, 4 * 5_KiB);
+  EXPECT_EQ(stats.allocations, 32);
+}
+
+TEST(BinningTest, AdaptiveBinRetiresAfterStreamDestroyed)
+{
+  cuda_mr cuda{};
+  binning_mr mr{&cuda, test_adaptive_options(1_MiB)};
+  cudaStream_t stream{};  // we don't use rmm::cuda_stream here to make destruction more explicit
+  EXPECT_EQ(cudaSuccess, cudaStreamCreate(&stream));
+  auto const view = cuda_stream_view{stream};
+  for (int i = 0; i < 16; ++i) {
+    mr.deallocate(mr.allocate(3_KiB, view), 3_KiB, view);
+  }
+  EXPECT_EQ(cudaSuccess, cudaStreamDestroy(stream));
+
+  // The drained bin is retired at the end of the next window and waits only on recorded events
+  for (int i = 0; i < 16; ++i) {
+    mr.deallocate(mr.allocate(5_KiB), 5_KiB);
+  }
+  auto const stats = mr.get_bin_statistics();
+  EXPECT_EQ(stats.bins_retired, 1);
+  ASSERT_EQ(stats.bins.size(), 1);
+  EXPECT_EQ(stats.bins.front().size, 5_KiB);
+}
+
+TEST(BinningTest, AdaptiveRebinConcurrent)
+{
+  cuda_mr cuda{};
+  binning_mr mr{&cuda, test_adaptive_options(1_MiB)};
+  constexpr int num_threads{4};
+  constexpr int allocations_per_thread{256};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&mr] {
+      for (int j = 0; j < allocations_per_thread; ++j) {
+        mr.deallocate(mr.allocate(3_KiB), 3_KiB);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Rebins racing to create the same class keep one bin and discard the others
+  auto const stats = mr.get_bin_statistics();
+  EXPECT_EQ(stats.bins_created, 1);
+  ASSERT_EQ(stats.bins.size(), 1);
+  EXPECT_EQ(stats.bins.front().size, 3_KiB);
+  EXPECT_EQ(stats.adaptive_bytes, 4 * 3_KiB);
+  EXPECT_EQ(stats.allocations, num_threads * allocations_per_thread);
+}
+
+TEST(BinningTest, AdaptiveSamplingPerResource)
+{
+  cuda_mr cuda{};
+  auto options          = test_adaptive_options(1_MiB);
+  options.sample_period = 2;
+  options.window        = 8;
+  binning_mr first{&cuda, options};
+  binning_mr second{&cuda, options};
+
+  // Interleaved allocations on one thread must not steal each other's samples
+  for (int i = 0; i < 16; ++i) {
+    first.deallocate(first.allocate(3_KiB), 3_KiB);
+    second.deallocate(second.allocate(3_KiB), 3_KiB);
+  }
+  EXPECT_EQ(first.get_bin_statistics().bins_created, 1);
+  EXPECT_EQ(second.get_bin_statistics().bins_created, 1);
+}
+
+TEST(BinningTest, AdaptiveBinsStayWithinBudget)
+{
+  cuda_mr cuda{};
+  binning_mr mr{&cuda, test_adaptive_options(4 * 3_KiB)};
+  mr.add_bin(8_KiB);
+  for (int i = 0; i < 16; ++i) {
+    mr.deallocate(mr.allocate(3_KiB), 3_KiB);
+  }
+
+  // The bin cannot grow beyond its first chunk, so further allocations use the static bin
+  std::vector<void*> pointers(5);
+  for (auto& ptr : pointers) {
+    ptr = mr.allocate(3_KiB);
+  }
+  auto const stats = mr.get_bin_statistics();
+  EXPECT_EQ(stats.adaptive_bytes, 4 * 3_KiB);
+  ASSERT_EQ(stats.bins.size(), 2);
+  EXPECT_FALSE(stats.bins.front().adaptive);
+  EXPECT_EQ(stats.bins.front().allocations, 16);
+  EXPECT_EQ(stats.bins.back().allocations, 5);
+  EXPECT_EQ(stats.upstream_allocations, 0);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 1.0);
+
+  for (auto* ptr : pointers) {
+    mr.deallocate(ptr, 3_KiB);
+  }
+}
+
+TEST(BinningTest, AdaptiveOptionsValidated)
+{
+  cuda_mr cuda{};
+  auto options          = test_adaptive_options(1_MiB);
+  options.hot_fraction  = 0.1;
+  options.cold_fraction = 0.2;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
+  EXPECT_THROW(binning_mr(&cuda, options), rmm::logic_error);
+  options               = test_adaptive_options(1_MiB);
+  options.sample_period = 0;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
+  EXPECT_THROW(binning_mr(&cuda, options), rmm::logic_error);
+}
+
 }  // namespace rmm::test
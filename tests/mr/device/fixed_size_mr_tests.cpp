@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../byte_literals.hpp"
+
+#include <rmm/cuda_stream.hpp>
+#include <rmm/mr/device/cuda_memory_resource.hpp>
+#include <rmm/mr/device/fixed_size_memory_resource.hpp>
+#include <rmm/mr/device/statistics_resource_adaptor.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+// explicit instantiation for test coverage purposes
+template class rmm::mr::fixed_size_memory_resource<rmm::mr::cuda_memory_resource>;
+
+namespace rmm::test {
+
+using cuda_mr       = rmm::mr::cuda_memory_resource;
+using statistics_mr = rmm::mr::statistics_resource_adaptor<cuda_mr>;
+using fixed_size_mr = rmm::mr::fixed_size_memory_resource<statistics_mr>;
+
+constexpr std::size_t blocks_per_chunk{4};
+
+std::vector<void*> allocate_blocks(fixed_size_mr& mr, std::size_t count)
+{
+  std::vector<void*> blocks(count);
+  for (auto& ptr : blocks) {
+    ptr = mr.allocate(1_KiB);
+  }
+  return blocks;
+}
+
+TEST(FixedSizeTest, ReusesLastFreedBlock)
+{
+  cuda_mr cuda{};
+  statistics_mr upstream{&cuda};
+  fixed_size_mr mr{&upstream, 1_KiB, blocks_per_chunk};
+  auto blocks = allocate_blocks(mr, 2);
+  mr.deallocate(blocks[0], 1_KiB);
+  EXPECT_EQ(mr.largest_free_block(), 1_KiB);
+  EXPECT_EQ(mr.allocate(1_KiB), blocks[0]);
+  for (auto* ptr : blocks) {
+    mr.deallocate(ptr, 1_KiB);
+  }
+}
+
+TEST(FixedSizeTest, TrimReturnsFreeChunks)
+{
+  cuda_mr cuda{};
+  statistics_mr upstream{&cuda};
+  fixed_size_mr mr{&upstream, 1_KiB, blocks_per_chunk};
+  auto blocks = allocate_blocks(mr, 2 * blocks_per_chunk);
+  EXPECT_EQ(mr.pool_size(), 8_KiB);
+  EXPECT_EQ(upstream.get_bytes_counter().value, 8_KiB);
+  EXPECT_EQ(mr.trim(0), 0);
+
+  // Free the blocks of the second chunk, one on another stream
+  rmm::cuda_stream stream{};
+  for (std::size_t i = blocks_per_chunk; i < blocks.size() - 1; ++i) {
+    mr.deallocate(blocks[i], 1_KiB);
+  }
+  mr.deallocate(blocks.back(), 1_KiB, stream);
+  EXPECT_EQ(mr.trim(0), 4_KiB);
+  EXPECT_EQ(mr.pool_size(), 4_KiB);
+  EXPECT_EQ(upstream.get_bytes_counter().value, 4_KiB);
+  EXPECT_EQ(mr.get_mem_info(stream).second, 4_KiB);
+
+  for (std::size_t i = 0; i < blocks_per_chunk; ++i) {
+    mr.deallocate(blocks[i], 1_KiB);
+  }
+  EXPECT_EQ(mr.trim(4_KiB), 0);
+  EXPECT_EQ(mr.trim(0), 4_KiB);
+  EXPECT_EQ(mr.pool_size(), 0);
+  EXPECT_EQ(mr.largest_free_block(), 0);
+  EXPECT_EQ(mr.chunks_trimmed(), 2);
+  EXPECT_EQ(mr.bytes_trimmed(), 8_KiB);
+
+  // The resource grows again on demand
+  auto* ptr = mr.allocate(1_KiB, stream);
+  EXPECT_EQ(mr.pool_size(), 4_KiB);
+  mr.deallocate(ptr, 1_KiB, stream);
+}
+
+TEST(FixedSizeTest, ReleaseThreshold)
+{
+  cuda_mr cuda{};
+  statistics_mr upstream{&cuda};
+  fixed_size_mr mr{&upstream, 1_KiB, blocks_per_chunk, 4_KiB};
+  auto blocks = allocate_blocks(mr, 3 * blocks_per_chunk);
+  EXPECT_EQ(mr.pool_size(), 12_KiB);
+
+  for (auto* ptr : blocks) {
+    mr.deallocate(ptr, 1_KiB);
+  }
+  EXPECT_EQ(mr.pool_size(), 4_KiB);
+  EXPECT_EQ(mr.chunks_trimmed(), 2);
+  EXPECT_EQ(upstream.get_bytes_counter().value, 4_KiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_KiB);
+}
+
+}  // namespace rmm::test
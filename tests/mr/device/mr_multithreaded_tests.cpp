@@ -62,8 +62,12 @@ INSTANTIATE_TEST_CASE_P(MultiThreadResourceTests,
 #endif
                                           mr_factory{"Managed", &make_managed},
                                           mr_factory{"Pool", &make_pool},
+                                          mr_factory{"Pool_ThreadCache", &make_pool_thread_cache},
+                                          mr_factory{"Pool_DeferredEvents", &make_pool_deferred},
+                                          mr_factory{"TLSF", &make_tlsf},
                                           mr_factory{"Arena", &make_arena},
-                                          mr_factory{"Binning", &make_binning}),
+                                          mr_factory{"Binning", &make_binning},
+                                          mr_factory{"Binning_Adaptive", &make_binning_adaptive}),
                         [](auto const& info) { return info.param.name; });
 
 template <typename Task, typename... Arguments>
@@ -195,6 +199,28 @@ TEST_P(mr_test_mt, MixedRandomAllocationFreeStream)
   spawn(test_mixed_random_allocation_free, this->mr.get(), default_max_size, this->stream.view());
 }
 
+// Thread caches only exist in the pool, so only pool resources are swept over thread counts. The
+// scaling of other resources is measured by BM_MultithreadedSmallAllocations.
+struct mr_test_mt_cache : public mr_test {};
+
+INSTANTIATE_TEST_CASE_P(ThreadCacheResourceTests,
+                        mr_test_mt_cache,
+                        ::testing::Values(mr_factory{"Pool", &make_pool},
+                                          mr_factory{"Pool_ThreadCache", &make_pool_thread_cache}),
+                        [](auto const& info) { return info.param.name; });
+
+TEST_P(mr_test_mt_cache, MixedRandomAllocationFreeThreadSweep)
+{
+  constexpr size_in_bytes max_size{64_KiB};
+  for (std::size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    spawn_n(num_threads,
+            test_mixed_random_allocation_free,
+            this->mr.get(),
+            max_size,
+            rmm::cuda_stream_per_thread);
+  }
+}
+
 void allocate_loop(rmm::mr::device_memory_resource* mr,
                    std::size_t num_allocations,
                    std::list<allocation>& allocations,
@@ -298,9 +324,59 @@ TEST_P(mr_test_mt, AllocFreeDifferentThreadsSameStream)
 
 TEST_P(mr_test_mt, AllocFreeDifferentThreadsDifferentStream)
 {
-  rmm::cuda_stream streamB;
-  test_allocate_free_different_threads(this->mr.get(), this->stream, streamB);
-  streamB.synchronize();
+  test_allocate_free_different_threads(this->mr.get(), this->stream, this->other_stream);
+  this->other_stream.synchronize();
+}
+
+void test_producers_consumers(rmm::mr::device_memory_resource* mr, std::size_t num_pairs)
+{
+  constexpr std::size_t num_allocations{1000};
+  constexpr std::size_t max_size{64_KiB};
+
+  std::mutex mtx;
+  std::condition_variable allocations_ready;
+  std::list<allocation> allocations;
+
+  // Every block is allocated by a producer and freed by whichever consumer takes it first
+  auto produce = [&](std::size_t seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<std::size_t> size_distribution(1, max_size);
+    for (std::size_t i = 0; i < num_allocations; ++i) {
+      std::size_t size = size_distribution(generator);
+      void* ptr        = mr->allocate(size, rmm::cuda_stream_per_thread);
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        allocations.emplace_back(ptr, size);
+      }
+      allocations_ready.notify_one();
+    }
+  };
+  auto consume = [&]() {
+    for (std::size_t i = 0; i < num_allocations; ++i) {
+      std::unique_lock lock(mtx);
+      allocations_ready.wait(lock, [&allocations] { return !allocations.empty(); });
+      allocation alloc = allocations.front();
+      allocations.pop_front();
+      lock.unlock();
+      mr->deallocate(alloc.ptr, alloc.size, rmm::cuda_stream_per_thread);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < num_pairs; ++i) {
+    threads.emplace_back(produce, i);
+    threads.emplace_back(consume);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_P(mr_test_mt, ProducersConsumers)
+{
+  for (std::size_t num_pairs : {1, 2, 4}) {
+    test_producers_consumers(this->mr.get(), num_pairs);
+  }
 }
 
 }  // namespace
@@ -52,6 +52,7 @@
 #include <rmm/mr/device/owning_wrapper.hpp>
 #include <rmm/mr/device/per_device_resource.hpp>
 #include <rmm/mr/device/pool_memory_resource.hpp>
+#include <rmm/mr/device/tlsf_memory_resource.hpp>
 
 #include <gtest/gtest.h>
 
@@ -267,8 +268,12 @@ struct mr_test : public ::testing::TestWithParam<mr_factory> {
     }
   }
 
-  std::shared_ptr<rmm::mr::device_memory_resource> mr;  ///< Pointer to resource to use in tests
+  // Declared before `mr` so they outlive it: a pool may record deferred events on them when it is
+  // destroyed
   rmm::cuda_stream stream{};
+  rmm::cuda_stream other_stream{};
+
+  std::shared_ptr<rmm::mr::device_memory_resource> mr;  ///< Pointer to resource to use in tests
 };
 
 struct mr_allocation_test : public mr_test {};
@@ -291,6 +296,25 @@ inline auto make_pool()
   return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda());
 }
 
+inline auto make_pool_thread_cache()
+{
+  rmm::mr::pool_memory_resource_options opts;
+  opts.thread_cache = {64_KiB};
+  return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda(), opts);
+}
+
+inline auto make_pool_deferred()
+{
+  rmm::mr::pool_memory_resource_options opts;
+  opts.deferred_events = {64};
+  return rmm::mr::make_owning_wrapper<rmm::mr::pool_memory_resource>(make_cuda(), opts);
+}
+
+inline auto make_tlsf()
+{
+  return rmm::mr::make_owning_wrapper<rmm::mr::tlsf_memory_resource>(make_cuda());
+}
+
 inline auto make_arena()
 {
   return rmm::mr::make_owning_wrapper<rmm::mr::arena_memory_resource>(make_cuda());
@@ -314,4 +338,14 @@ inline auto make_binning()
   return mr;
 }
 
+inline auto make_binning_adaptive()
+{
+  // Adaptive bins for the sizes that recur, within 64 MiB, over a pool for everything else
+  rmm::mr::adaptive_binning_options options{};
+  options.memory_budget = std::size_t{64} << 20U;
+  options.sample_period = 1;
+  options.window        = 64;
+  return rmm::mr::make_owning_wrapper<rmm::mr::binning_memory_resource>(make_pool(), options);
+}
+
 }  // namespace rmm::test
@@ -31,8 +31,12 @@ INSTANTIATE_TEST_SUITE_P(ResourceTests,
 #endif
                                            mr_factory{"Managed", &make_managed},
                                            mr_factory{"Pool", &make_pool},
+                                           mr_factory{"Pool_ThreadCache", &make_pool_thread_cache},
+                                           mr_factory{"Pool_DeferredEvents", &make_pool_deferred},
+                                           mr_factory{"TLSF", &make_tlsf},
                                            mr_factory{"Arena", &make_arena},
                                            mr_factory{"Binning", &make_binning},
+                                           mr_factory{"Binning_Adaptive", &make_binning_adaptive},
                                            mr_factory{"Fixed_Size", &make_fixed_size}),
                          [](auto const& info) { return info.param.name; });
 
@@ -45,8 +49,12 @@ INSTANTIATE_TEST_SUITE_P(ResourceAllocationTests,
 #endif
                                            mr_factory{"Managed", &make_managed},
                                            mr_factory{"Pool", &make_pool},
+                                           mr_factory{"Pool_ThreadCache", &make_pool_thread_cache},
+                                           mr_factory{"Pool_DeferredEvents", &make_pool_deferred},
+                                           mr_factory{"TLSF", &make_tlsf},
                                            mr_factory{"Arena", &make_arena},
-                                           mr_factory{"Binning", &make_binning}),
+                                           mr_factory{"Binning", &make_binning},
+                                           mr_factory{"Binning_Adaptive", &make_binning_adaptive}),
                          [](auto const& info) { return info.param.name; });
 
 TEST(DefaultTest, CurrentDeviceResourceIsCUDA)
@@ -64,6 +72,24 @@ TEST(DefaultTest, GetCurrentDeviceResource)
   EXPECT_TRUE(mr->is_equal(rmm::mr::cuda_memory_resource{}));
 }
 
+TEST(PoolDeferredEventsTest, DeletedStream)
+{
+  auto mr              = make_pool_deferred();
+  auto const pool_size = mr->wrapped().pool_size();
+  cudaStream_t stream{};  // we don't use rmm::cuda_stream here to make destruction more explicit
+  EXPECT_EQ(cudaSuccess, cudaStreamCreate(&stream));
+  // The free on the stream is deferred, so it is flushed before the stream dies
+  auto const view = cuda_stream_view{stream};
+  void* ptr       = mr->allocate(pool_size, view);
+  mr->deallocate(ptr, pool_size, view);
+  mr->wrapped().flush_deferred_frees(view);
+  EXPECT_EQ(cudaSuccess, cudaStreamDestroy(stream));
+
+  // Taking the dead stream's block waits on the event recorded by the flush
+  EXPECT_NO_THROW(ptr = mr->allocate(pool_size));
+  mr->deallocate(ptr, pool_size);
+}
+
 TEST_P(mr_test, SetCurrentDeviceResource)
 {
   rmm::mr::device_memory_resource* old{};
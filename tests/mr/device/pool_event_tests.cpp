@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../byte_literals.hpp"
+#include "../../mock_runtime.hpp"
+
+#include <rmm/cuda_stream.hpp>
+#include <rmm/mr/device/per_device_resource.hpp>
+#include <rmm/mr/device/pool_memory_resource.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Tests of when the pool calls into the runtime, counted by the mock runtime
+
+namespace rmm::test {
+namespace {
+using pool_mr = rmm::mr::pool_memory_resource<rmm::mr::device_memory_resource>;
+
+/// Options for a pool of exactly `pool_size` bytes
+pool_mr::options fixed_pool_options(std::size_t pool_size)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = pool_size;
+  opts.maximum_pool_size = pool_size;
+  return opts;
+}
+
+struct PoolEventTest : public ::testing::Test {
+  void SetUp() override { mock_runtime::events_not_ready = false; }
+  void TearDown() override { mock_runtime::events_not_ready = false; }
+
+  /// Calls to cudaEventRecord since `records` was last reset
+  std::size_t records() const { return mock_runtime::event_records - first_record; }
+  void reset_records() { first_record = mock_runtime::event_records; }
+
+  std::size_t first_record{mock_runtime::event_records};
+};
+
+TEST_F(PoolEventTest, DeferredEventRecord)
+{
+  auto const pool_size{8_KiB};
+  auto const size{1_KiB};
+  auto const num_allocations{pool_size / size};
+  auto opts            = fixed_pool_options(pool_size);
+  opts.deferred_events = {num_allocations, std::chrono::hours{1}};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+
+  std::vector<void*> ptrs(num_allocations);
+  for (auto& ptr : ptrs) {
+    ptr = mr.allocate(size, stream_a);
+  }
+
+  // Frees are batched: the event is recorded once the count threshold is reached
+  reset_records();
+  for (std::size_t i = 0; i < num_allocations - 1; ++i) {
+    mr.deallocate(ptrs[i], size, stream_a);
+  }
+  EXPECT_EQ(records(), 0);
+  mr.deallocate(ptrs.back(), size, stream_a);
+  EXPECT_EQ(records(), 1);
+
+  // Reuse on the same stream needs no record. Stealing from a list with deferred frees records
+  // its event on the stream of the frees, without synchronizing the device.
+  mr.deallocate(mr.allocate(size, stream_a), size, stream_a);
+  EXPECT_EQ(records(), 1);
+  auto const device_synchronizes = mock_runtime::device_synchronizes.load();
+  void* whole                    = mr.allocate(pool_size, stream_b);
+  EXPECT_EQ(records(), 2);
+  EXPECT_EQ(mock_runtime::device_synchronizes, device_synchronizes);
+  mr.deallocate(whole, pool_size, stream_b);
+  EXPECT_EQ(records(), 2);
+  mr.flush_deferred_frees(stream_b);
+  EXPECT_EQ(records(), 3);
+}
+
+TEST_F(PoolEventTest, DeferredEventRecordTimeLimit)
+{
+  auto const pool_size{8_KiB};
+  auto opts            = fixed_pool_options(pool_size);
+  opts.deferred_events = {64, std::chrono::microseconds{0}};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  rmm::cuda_stream stream{};
+
+  // With no deferral time allowed, every free records the event
+  reset_records();
+  mr.deallocate(mr.allocate(1_KiB, stream), 1_KiB, stream);
+  mr.deallocate(mr.allocate(1_KiB, stream), 1_KiB, stream);
+  EXPECT_EQ(records(), 2);
+}
+
+TEST_F(PoolEventTest, DeferredEventRecordOverdueOnIdleStream)
+{
+  auto const pool_size{8_KiB};
+  auto opts            = fixed_pool_options(pool_size);
+  opts.deferred_events = {64, std::chrono::milliseconds{1}};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+
+  void* ptr_a = mr.allocate(1_KiB, stream_a);
+  void* ptr_b = mr.allocate(1_KiB, stream_b);
+  reset_records();
+  mr.deallocate(ptr_a, 1_KiB, stream_a);
+  EXPECT_EQ(records(), 0);
+
+  // Stream A goes idle; its overdue event is recorded by the next operation on any stream
+  std::this_thread::sleep_for(std::chrono::milliseconds{5});
+  mr.deallocate(ptr_b, 1_KiB, stream_b);
+  EXPECT_EQ(records(), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds{5});
+  mr.deallocate(mr.allocate(1_KiB, stream_a), 1_KiB, stream_a);
+  EXPECT_EQ(records(), 2);
+
+  mr.flush_deferred_frees(stream_a);
+  mr.flush_deferred_frees(stream_b);
+}
+
+TEST_F(PoolEventTest, FlushDeferredFreesBeforeDestroyingStream)
+{
+  auto const pool_size{8_KiB};
+  auto opts            = fixed_pool_options(pool_size);
+  opts.deferred_events = {64, std::chrono::hours{1}};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  void* ptr{};
+  {
+    rmm::cuda_stream stream{};
+    ptr = mr.allocate(pool_size, stream);
+    reset_records();
+    mr.deallocate(ptr, pool_size, stream);
+    EXPECT_EQ(records(), 0);
+    mr.flush_deferred_frees(stream);
+    EXPECT_EQ(records(), 1);
+    mr.flush_deferred_frees(stream);
+    EXPECT_EQ(records(), 1);
+  }
+
+  // The destroyed stream's block is taken by waiting on its recorded event
+  auto const device_synchronizes = mock_runtime::device_synchronizes.load();
+  rmm::cuda_stream other{};
+  EXPECT_NO_THROW(ptr = mr.allocate(pool_size, other));
+  EXPECT_EQ(records(), 1);
+  EXPECT_EQ(mock_runtime::device_synchronizes, device_synchronizes);
+  mr.deallocate(ptr, pool_size, other);
+  mr.flush_deferred_frees(other);
+}
+
+TEST_F(PoolEventTest, ReleaseThresholdDoesNotWait)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = 1_MiB;
+  opts.release_threshold = 1_MiB;
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  void* ptr = mr.allocate(2_MiB);
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+
+  // The free is still in progress, so the upstream allocation is kept without waiting on it
+  mock_runtime::events_not_ready = true;
+  auto const event_synchronizes  = mock_runtime::event_synchronizes.load();
+  mr.deallocate(ptr, 2_MiB);
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+  EXPECT_EQ(mock_runtime::event_synchronizes, event_synchronizes);
+
+  // Once it has completed, a later deallocation returns the upstream allocation
+  mock_runtime::events_not_ready = false;
+  mr.deallocate(mr.allocate(256), 256);
+  EXPECT_EQ(mr.pool_size(), 1_MiB);
+  EXPECT_EQ(mr.bytes_trimmed(), 2_MiB);
+}
+
+TEST_F(PoolEventTest, ThreadCacheRecordsOncePerFlush)
+{
+  auto const pool_size{8_KiB};
+  auto const size{256};
+  auto opts         = fixed_pool_options(pool_size);
+  opts.thread_cache = {size, 4};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  rmm::cuda_stream stream{};
+
+  std::vector<void*> ptrs(5);
+  for (auto& ptr : ptrs) {
+    ptr = mr.allocate(size, stream);
+  }
+
+  // Cached frees record no event; flushing the older half of a full magazine records one
+  reset_records();
+  for (std::size_t i = 0; i < ptrs.size() - 1; ++i) {
+    mr.deallocate(ptrs[i], size, stream);
+  }
+  EXPECT_EQ(records(), 0);
+  mr.deallocate(ptrs.back(), size, stream);
+  EXPECT_EQ(records(), 1);
+
+  // Blocks still cached on the stream are returned and recorded before it is destroyed
+  mr.flush_deferred_frees(stream);
+  EXPECT_EQ(records(), 2);
+  rmm::cuda_stream other{};
+  void* whole{};
+  EXPECT_NO_THROW(whole = mr.allocate(pool_size, other));
+  EXPECT_EQ(records(), 2);
+  mr.deallocate(whole, pool_size, other);
+}
+
+}  // namespace
+}  // namespace rmm::test
@@ -14,20 +14,33 @@
  * limitations under the License.
  */
 
+#include "../../byte_literals.hpp"
+
 #include <rmm/cuda_device.hpp>
+#include <rmm/cuda_stream.hpp>
 #include <rmm/detail/aligned.hpp>
 #include <rmm/detail/cuda_util.hpp>
 #include <rmm/detail/error.hpp>
 #include <rmm/device_buffer.hpp>
 #include <rmm/device_uvector.hpp>
+#include <rmm/mr/device/cuda_async_memory_resource.hpp>
 #include <rmm/mr/device/cuda_memory_resource.hpp>
 #include <rmm/mr/device/device_memory_resource.hpp>
+#include <rmm/mr/device/growth_policy.hpp>
 #include <rmm/mr/device/limiting_resource_adaptor.hpp>
 #include <rmm/mr/device/per_device_resource.hpp>
 #include <rmm/mr/device/pool_memory_resource.hpp>
+#include <rmm/mr/device/statistics_resource_adaptor.hpp>
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 // explicit instantiation for test coverage purposes
 template class rmm::mr::pool_memory_resource<rmm::mr::cuda_memory_resource>;
 
@@ -36,6 +49,16 @@ namespace {
 using cuda_mr     = rmm::mr::cuda_memory_resource;
 using pool_mr     = rmm::mr::pool_memory_resource<rmm::mr::device_memory_resource>;
 using limiting_mr = rmm::mr::limiting_resource_adaptor<rmm::mr::cuda_memory_resource>;
+using stats_mr    = rmm::mr::statistics_resource_adaptor<rmm::mr::cuda_memory_resource>;
+
+/// Options for a pool of exactly `pool_size` bytes
+pool_mr::options fixed_pool_options(std::size_t pool_size)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = pool_size;
+  opts.maximum_pool_size = pool_size;
+  return opts;
+}
 
 TEST(PoolTest, ThrowOnNullUpstream)
 {
@@ -106,6 +129,484 @@ TEST(PoolTest, ForceGrowth)
   }
 }
 
+TEST(PoolTest, BestFitAndCoalesce)
+{
+  auto const pool_size{8192};
+  pool_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+
+  auto* ptr1 = mr.allocate(1024);
+  auto* ptr2 = mr.allocate(256);
+  auto* ptr3 = mr.allocate(2048);
+  auto* ptr4 = mr.allocate(256);
+
+  // Free blocks are now 1024B at ptr1, 2048B at ptr3, and the 4608B remainder of the pool
+  mr.deallocate(ptr1, 1024);
+  mr.deallocate(ptr3, 2048);
+
+  // Best fit chooses the tightest free block, not the first or the largest
+  EXPECT_EQ(ptr3, mr.allocate(2000));
+  EXPECT_EQ(ptr1, mr.allocate(1000));
+
+  mr.deallocate(ptr1, 1000);
+  mr.deallocate(ptr3, 2000);
+  mr.deallocate(ptr4, 256);
+  mr.deallocate(ptr2, 256);
+
+  // Everything coalesces back into a single block spanning the whole pool
+  auto* whole = mr.allocate(pool_size);
+  EXPECT_EQ(ptr1, whole);
+  mr.deallocate(whole, pool_size);
+}
+
+TEST(PoolTest, ThreadCacheReuse)
+{
+  auto const pool_size{8192};
+  auto opts         = fixed_pool_options(pool_size);
+  opts.thread_cache = {1024};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  rmm::cuda_stream stream{};
+
+  auto* ptr = mr.allocate(1000, stream);
+  mr.deallocate(ptr, 1000, stream);
+
+  // Same aligned size on the same stream is served from this thread's cache
+  EXPECT_EQ(ptr, mr.allocate(1024, stream));
+  mr.deallocate(ptr, 1024, stream);
+
+  // A different size is not
+  auto* other = mr.allocate(512, stream);
+  EXPECT_NE(ptr, other);
+  mr.deallocate(other, 512, stream);
+  mr.flush_deferred_frees(stream);
+}
+
+TEST(PoolTest, ThreadCacheFlushOnOutOfMemory)
+{
+  auto const pool_size{8192};
+  auto opts         = fixed_pool_options(pool_size);
+  opts.thread_cache = {1024};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  std::vector<void*> ptrs(pool_size / 1024);
+  for (auto& ptr : ptrs) {
+    ptr = mr.allocate(1024);
+  }
+  for (auto* ptr : ptrs) {
+    mr.deallocate(ptr, 1024);
+  }
+
+  // Every block is cached; a larger request must flush the cache so the blocks can coalesce
+  void* whole{nullptr};
+  EXPECT_NO_THROW(whole = mr.allocate(pool_size));
+  mr.deallocate(whole, pool_size);
+}
+
+TEST(PoolTest, ThreadCacheFlushOnThreadExit)
+{
+  auto const pool_size{8192};
+  auto opts         = fixed_pool_options(pool_size);
+  opts.thread_cache = {1024};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  std::thread worker([&mr]() {
+    auto* ptr = mr.allocate(1024, rmm::cuda_stream_per_thread);
+    mr.deallocate(ptr, 1024, rmm::cuda_stream_per_thread);
+  });
+  worker.join();
+
+  // The exited thread's cached block was returned to the pool
+  void* whole{nullptr};
+  EXPECT_NO_THROW(whole = mr.allocate(pool_size));
+  mr.deallocate(whole, pool_size);
+}
+
+TEST(PoolTest, ThreadCacheReclaimFromOtherThread)
+{
+  auto const pool_size{8192};
+  auto opts         = fixed_pool_options(pool_size);
+  opts.thread_cache = {1024};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  // This thread caches every block of the pool and stays alive
+  std::vector<void*> ptrs(pool_size / 1024);
+  for (auto& ptr : ptrs) {
+    ptr = mr.allocate(1024);
+  }
+  for (auto* ptr : ptrs) {
+    mr.deallocate(ptr, 1024);
+  }
+
+  // Another thread needs the whole pool, so the caches of all threads must be reclaimed
+  std::thread worker([&mr]() {
+    void* whole{nullptr};
+    EXPECT_NO_THROW(whole = mr.allocate(pool_size));
+    mr.deallocate(whole, pool_size);
+  });
+  worker.join();
+}
+
+TEST(PoolTest, ThreadCacheBatchFlush)
+{
+  auto const pool_size{8192};
+  auto opts         = fixed_pool_options(pool_size);
+  opts.thread_cache = {256, 2};
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  std::vector<void*> ptrs(4);
+  for (auto& ptr : ptrs) {
+    ptr = mr.allocate(256);
+  }
+  for (auto* ptr : ptrs) {
+    mr.deallocate(ptr, 256);  // the magazine holds 2 blocks; overflow flushes to the pool
+  }
+  for (auto& ptr : ptrs) {
+    EXPECT_NO_THROW(ptr = mr.allocate(256));
+  }
+  for (auto* ptr : ptrs) {
+    mr.deallocate(ptr, 256);
+  }
+}
+
+TEST(PoolTest, CrossStreamTightestFit)
+{
+  auto const small{256};
+  auto const medium{4096};
+  auto const large{65536};
+  auto const pool_size{small + medium + large};
+  pool_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+  rmm::cuda_stream stream_c{};
+  rmm::cuda_stream stream_d{};
+
+  auto* ptr_a = mr.allocate(small, stream_a);
+  auto* ptr_b = mr.allocate(medium, stream_b);
+  auto* ptr_c = mr.allocate(large, stream_c);
+  mr.deallocate(ptr_a, small, stream_a);
+  mr.deallocate(ptr_b, medium, stream_b);
+  mr.deallocate(ptr_c, large, stream_c);
+
+  // Each stream's free list now holds one block. Stealing takes from the stream whose largest
+  // block is the tightest fit, regardless of how many streams have free lists.
+  EXPECT_EQ(ptr_b, mr.allocate(medium - small, stream_d));
+  EXPECT_EQ(ptr_c, mr.allocate(large, stream_d));
+  mr.deallocate(ptr_b, medium - small, stream_d);
+  mr.deallocate(ptr_c, large, stream_d);
+}
+
+TEST(PoolTest, ReleaseCompletesDeferredFrees)
+{
+  if (!rmm::detail::async_alloc::is_supported()) {
+    GTEST_SKIP() << "Skipping since cudaMallocAsync is needed for an upstream that does not "
+                    "synchronize on deallocation";
+  }
+  auto const pool_size{64_MiB};
+  rmm::mr::cuda_async_memory_resource upstream{};
+  rmm::cuda_stream stream{};
+  {
+    auto opts            = fixed_pool_options(pool_size);
+    opts.deferred_events = {64, std::chrono::hours{1}};
+    pool_mr mr{&upstream, opts};
+    void* ptr = mr.allocate(pool_size, stream);
+    RMM_CUDA_TRY(cudaMemsetAsync(ptr, 0, pool_size, stream.value()));
+    // No event covers the memset, yet destroying the pool returns its memory upstream
+    mr.deallocate(ptr, pool_size, stream);
+  }
+  EXPECT_EQ(cudaSuccess, cudaStreamQuery(stream.value()));
+}
+
+TEST(PoolTest, Trim)
+{
+  auto const initial{1_MiB};
+  pool_mr mr{rmm::mr::get_current_device_resource(), initial};
+
+  // Grow the pool by a second upstream block
+  auto* ptr = mr.allocate(2_MiB);
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+
+  // Only entirely free upstream blocks are returned, and at least `target` bytes are kept
+  EXPECT_EQ(mr.trim(3_MiB), 0);
+  EXPECT_EQ(mr.trim(0), 1_MiB);  // the second block is in use
+  EXPECT_EQ(mr.pool_size(), 2_MiB);
+  mr.deallocate(ptr, 2_MiB);
+  EXPECT_EQ(mr.trim(1_MiB), 0);
+  EXPECT_EQ(mr.trim(0), 2_MiB);
+  EXPECT_EQ(mr.pool_size(), 0);
+  EXPECT_EQ(mr.bytes_trimmed(), 3_MiB);
+  EXPECT_EQ(mr.blocks_trimmed(), 2);
+
+  // The pool grows again on demand
+  EXPECT_NO_THROW(ptr = mr.allocate(1_MiB));
+  mr.deallocate(ptr, 1_MiB);
+}
+
+TEST(PoolTest, TrimPartiallyFreeBlock)
+{
+  pool_mr mr{rmm::mr::get_current_device_resource(), 1_MiB};
+  rmm::cuda_stream stream{};
+
+  // The two halves of the upstream block are freed on different streams, so they are not in the
+  // same free list and the block is not entirely free until they are merged
+  auto* ptr_a = mr.allocate(512_KiB);
+  auto* ptr_b = mr.allocate(512_KiB, stream);
+  mr.deallocate(ptr_a, 512_KiB);
+  EXPECT_EQ(mr.trim(0), 0);
+  mr.deallocate(ptr_b, 512_KiB, stream);
+  EXPECT_EQ(mr.trim(0), 0);
+
+  auto* whole = mr.allocate(1_MiB);  // merges the free lists
+  mr.deallocate(whole, 1_MiB);
+  EXPECT_EQ(mr.trim(0), 1_MiB);
+}
+
+TEST(PoolTest, ReleaseThreshold)
+{
+  auto const threshold{1_MiB};
+  pool_mr::options opts;
+  opts.initial_pool_size = threshold;
+  opts.release_threshold = threshold;
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  auto* ptr = mr.allocate(2_MiB);
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+  mr.deallocate(ptr, 2_MiB);
+
+  // The pool trims itself back to the threshold once the free has completed, on this or a later
+  // deallocation
+  rmm::cuda_stream_default.synchronize();
+  mr.deallocate(mr.allocate(256), 256);
+  EXPECT_EQ(mr.pool_size(), threshold);
+  EXPECT_EQ(mr.bytes_trimmed(), 2_MiB);
+}
+
+TEST(PoolTest, ReleaseThresholdTrimsCompletedBlocks)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = 1_MiB;
+  opts.release_threshold = 1_MiB;
+  opts.growth            = std::make_shared<rmm::mr::fixed_chunk_growth_policy>(2_MiB);
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  auto* ptr_a     = mr.allocate(1_MiB - 256);
+  auto* ptr_small = mr.allocate(256);
+  auto* ptr_b     = mr.allocate(1_MiB);  // grows the pool by a 2 MiB upstream block
+  auto* ptr_c     = mr.allocate(1_MiB);
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+
+  // Freeing half of the upstream block leaves nothing to trim
+  mr.deallocate(ptr_b, 1_MiB);
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+  EXPECT_EQ(mr.blocks_trimmed(), 0);
+
+  // The free that completes the upstream block returns it once the free has completed, on this
+  // or a later deallocation
+  mr.deallocate(ptr_c, 1_MiB);
+  rmm::cuda_stream_default.synchronize();
+  mr.deallocate(ptr_small, 256);
+  EXPECT_EQ(mr.pool_size(), 1_MiB);
+  EXPECT_EQ(mr.blocks_trimmed(), 1);
+
+  // At the threshold, nothing more is trimmed
+  mr.deallocate(ptr_a, 1_MiB - 256);
+  EXPECT_EQ(mr.pool_size(), 1_MiB);
+  EXPECT_EQ(mr.bytes_trimmed(), 2_MiB);
+}
+
+TEST(PoolTest, ThrowOnNullGrowthPolicy)
+{
+  auto construct_nullptr = []() {
+    pool_mr::options opts;
+    opts.initial_pool_size = 0;
+    opts.growth            = nullptr;
+    pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  };
+  EXPECT_THROW(construct_nullptr(), rmm::logic_error);
+}
+
+TEST(PoolTest, FixedChunkGrowth)
+{
+  cuda_mr cuda;
+  stats_mr upstream{&cuda};
+  rmm::mr::pool_memory_resource_options opts;
+  opts.initial_pool_size = 0;
+  opts.growth            = std::make_shared<rmm::mr::fixed_chunk_growth_policy>(1_MiB);
+  rmm::mr::pool_memory_resource<stats_mr> mr{&upstream, opts};
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(mr.allocate(256_KiB));
+  }
+  EXPECT_EQ(mr.pool_size(), 1_MiB);
+  EXPECT_EQ(upstream.get_allocations_counter().total, 1);
+
+  // An allocation larger than a chunk grows by the smallest multiple of the chunk that fits
+  ptrs.push_back(mr.allocate(1_MiB + 512_KiB));
+  EXPECT_EQ(mr.pool_size(), 3_MiB);
+  EXPECT_EQ(upstream.get_allocations_counter().total, 2);
+
+  mr.deallocate(ptrs.back(), 1_MiB + 512_KiB);
+  ptrs.pop_back();
+  for (auto* ptr : ptrs) {
+    mr.deallocate(ptr, 256_KiB);
+  }
+}
+
+TEST(PoolTest, GrowthClampedToMaximum)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = 0;
+  opts.maximum_pool_size = 2_MiB;
+  opts.growth            = std::make_shared<rmm::mr::fixed_chunk_growth_policy>(4_MiB);
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+  auto* ptr = mr.allocate(1_MiB);
+  EXPECT_EQ(mr.pool_size(), 2_MiB);
+  mr.deallocate(ptr, 1_MiB);
+}
+
+TEST(PoolTest, GeometricGrowthWithCap)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = 1_MiB;
+  opts.growth            = std::make_shared<rmm::mr::geometric_growth_policy>(2.0, 2_MiB);
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  std::vector<std::pair<void*, std::size_t>> allocations;
+  auto allocate = [&](std::size_t size) { allocations.emplace_back(mr.allocate(size), size); };
+
+  allocate(1_MiB);
+  allocate(1_MiB);  // doubles the pool
+  EXPECT_EQ(mr.pool_size(), 2_MiB);
+  allocate(1_MiB);  // doubling would add 2 MiB, which is the cap
+  EXPECT_EQ(mr.pool_size(), 4_MiB);
+  allocate(1_MiB);
+  allocate(1_MiB);  // capped at 2 MiB instead of doubling to 8 MiB
+  EXPECT_EQ(mr.pool_size(), 6_MiB);
+  allocate(3_MiB);  // the cap never prevents an allocation
+  EXPECT_EQ(mr.pool_size(), 9_MiB);
+
+  for (auto const& [ptr, size] : allocations) {
+    mr.deallocate(ptr, size);
+  }
+}
+
+TEST(PoolTest, AdaptiveGrowth)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = 4_MiB;
+  opts.growth            = std::make_shared<rmm::mr::adaptive_growth_policy>(4, 256_KiB, 64_MiB);
+  pool_mr mr{rmm::mr::get_current_device_resource(), opts};
+
+  std::vector<std::pair<void*, std::size_t>> allocations;
+  auto allocate = [&](std::size_t size) { allocations.emplace_back(mr.allocate(size), size); };
+
+  for (int i = 0; i < 4; ++i) {
+    allocate(1_MiB);
+  }
+  // The last four allocations requested 4 MiB, so the pool grows by 4 MiB
+  allocate(256_KiB);
+  EXPECT_EQ(mr.pool_size(), 8_MiB);
+
+  for (int i = 0; i < 15; ++i) {
+    allocate(256_KiB);
+  }
+  // Now the recent demand is 1 MiB
+  allocate(256_KiB);
+  EXPECT_EQ(mr.pool_size(), 9_MiB);
+
+  for (auto const& [ptr, size] : allocations) {
+    mr.deallocate(ptr, size);
+  }
+}
+
+TEST(PoolTest, GrowthPolicyCopiedPerPool)
+{
+  pool_mr::options opts;
+  opts.initial_pool_size = 4_MiB;
+  opts.growth            = std::make_shared<rmm::mr::adaptive_growth_policy>(4, 256_KiB, 64_MiB);
+  pool_mr first{rmm::mr::get_current_device_resource(), opts};
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(first.allocate(1_MiB));
+  }
+
+  // The allocations recorded by the first pool do not size the second pool's growth
+  opts.initial_pool_size = 1_MiB;
+  pool_mr second{rmm::mr::get_current_device_resource(), opts};
+  auto* ptr_a = second.allocate(1_MiB);
+  auto* ptr_b = second.allocate(256_KiB);
+  EXPECT_EQ(second.pool_size(), 2_MiB);
+
+  second.deallocate(ptr_b, 256_KiB);
+  second.deallocate(ptr_a, 1_MiB);
+  for (auto* ptr : ptrs) {
+    first.deallocate(ptr, 1_MiB);
+  }
+}
+
+TEST(PoolTest, GetMemInfo)
+{
+  pool_mr mr{rmm::mr::get_current_device_resource(), 1_MiB};
+  EXPECT_TRUE(mr.supports_get_mem_info());
+  rmm::cuda_stream stream{};
+
+  auto* ptr_a = mr.allocate(256_KiB);
+  auto* ptr_b = mr.allocate(256_KiB, stream);
+  {
+    auto const [free, total] = mr.get_mem_info(rmm::cuda_stream_default);
+    EXPECT_EQ(free, 512_KiB);
+    EXPECT_EQ(total, 1_MiB);
+    EXPECT_EQ(mr.largest_free_block(), 512_KiB);
+  }
+
+  // Blocks freed on different streams all count as free
+  mr.deallocate(ptr_a, 256_KiB);
+  mr.deallocate(ptr_b, 256_KiB, stream);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 1_MiB);
+
+  // Growing the pool increases the total
+  auto* ptr_c = mr.allocate(2_MiB);
+  {
+    auto const [free, total] = mr.get_mem_info(rmm::cuda_stream_default);
+    EXPECT_EQ(total, mr.pool_size());
+    EXPECT_EQ(free, total - 2_MiB);
+  }
+  mr.deallocate(ptr_c, 2_MiB);
+}
+
+TEST(PoolTest, Snapshot)
+{
+  pool_mr mr{rmm::mr::get_current_device_resource(), 1_MiB};
+  auto* ptr_a = mr.allocate(256_KiB);
+  auto* ptr_b = mr.allocate(256_KiB);
+  auto* ptr_c = mr.allocate(256_KiB);
+  mr.deallocate(ptr_b, 256_KiB);
+
+  auto const snap = mr.snapshot();
+  EXPECT_TRUE(snap.complete);
+  EXPECT_EQ(snap.total_bytes, 1_MiB);
+  ASSERT_EQ(snap.regions.size(), 1);
+  EXPECT_EQ(snap.regions.front().size, 1_MiB);
+  EXPECT_EQ(snap.free_bytes, 512_KiB);
+  EXPECT_EQ(snap.largest_free, 256_KiB);
+  EXPECT_DOUBLE_EQ(snap.fragmentation(), 0.5);
+
+  ASSERT_EQ(snap.free_lists.size(), 1);
+  auto const& list = snap.free_lists.front();
+  EXPECT_EQ(list.free_blocks, 2);
+  ASSERT_EQ(list.extents.size(), 2);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  EXPECT_EQ(list.extents.front().address, reinterpret_cast<std::uintptr_t>(ptr_b));
+  EXPECT_NE(snap.to_json().find(R"("fragmentation":0.5)"), std::string::npos);
+
+  auto const partial = mr.snapshot(0);
+  EXPECT_FALSE(partial.complete);
+  EXPECT_EQ(partial.free_bytes, 512_KiB);
+  EXPECT_TRUE(partial.free_lists.front().extents.empty());
+
+  mr.deallocate(ptr_a, 256_KiB);
+  mr.deallocate(ptr_c, 256_KiB);
+}
+
 TEST(PoolTest, DeletedStream)
 {
   pool_mr mr{rmm::mr::get_current_device_resource(), 0};
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../byte_literals.hpp"
+
+#include <rmm/mr/device/cuda_memory_resource.hpp>
+#include <rmm/mr/device/detail/bin_table.hpp>
+#include <rmm/mr/device/pool_memory_resource.hpp>
+#include <rmm/mr/device/statistics_resource_adaptor.hpp>
+#include <rmm/mr/device/static_binning_memory_resource.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+
+// explicit instantiation for test coverage purposes
+template class rmm::mr::static_binning_memory_resource<rmm::mr::cuda_memory_resource, 256, 1024>;
+
+namespace rmm::test {
+
+using cuda_mr       = rmm::mr::cuda_memory_resource;
+using statistics_mr = rmm::mr::statistics_resource_adaptor<cuda_mr>;
+
+TEST(StaticBinningTest, ThrowOnNullUpstream)
+{
+  using binning_mr       = rmm::mr::static_binning_memory_resource<cuda_mr, 1_KiB>;
+  auto construct_nullptr = []() { binning_mr mr{nullptr}; };
+  EXPECT_THROW(construct_nullptr(), rmm::logic_error);
+}
+
+TEST(StaticBinningTest, BinTable)
+{
+  constexpr std::array<std::size_t, 4> sizes{1_KiB, 1536, 3_KiB, 64_KiB};
+  constexpr auto table = rmm::mr::detail::make_bin_table(sizes);
+  using rmm::mr::detail::find_bin;
+  static_assert(find_bin(sizes, table, 1) == 0);
+  static_assert(find_bin(sizes, table, 1_KiB) == 0);
+  static_assert(find_bin(sizes, table, 1_KiB + 1) == 1);
+  static_assert(find_bin(sizes, table, 1537) == 2);
+  static_assert(find_bin(sizes, table, 3_KiB + 1) == 3);
+  static_assert(find_bin(sizes, table, 64_KiB) == 3);
+  EXPECT_EQ(find_bin(sizes, table, 64_KiB + 1), sizes.size());
+  EXPECT_EQ(find_bin(sizes, table, ~std::size_t{0}), sizes.size());
+}
+
+TEST(StaticBinningTest, BinsServeSmallAllocations)
+{
+  cuda_mr cuda{};
+  statistics_mr upstream{&cuda};
+  rmm::mr::static_binning_memory_resource<statistics_mr, 1_KiB, 1536, 64_KiB> mr{&upstream, 4};
+  // Each bin takes one chunk of four blocks from upstream
+  auto const chunks = upstream.get_allocations_counter().value;
+  EXPECT_EQ(chunks, 3);
+
+  for (auto size : {std::size_t{1}, std::size_t{1_KiB}, std::size_t{1537}, std::size_t{64_KiB}}) {
+    mr.deallocate(mr.allocate(size), size);
+  }
+  EXPECT_EQ(upstream.get_allocations_counter().value, chunks);
+
+  auto* large = mr.allocate(64_KiB + 1);
+  EXPECT_EQ(upstream.get_allocations_counter().value, chunks + 1);
+  mr.deallocate(large, 64_KiB + 1);
+  EXPECT_EQ(upstream.get_allocations_counter().value, chunks);
+}
+
+TEST(StaticBinningTest, GetMemInfo)
+{
+  cuda_mr cuda{};
+  rmm::mr::pool_memory_resource<cuda_mr> pool{&cuda, 4_MiB, 4_MiB};
+  rmm::mr::static_binning_memory_resource<decltype(pool), 1_KiB> mr{&pool};
+  EXPECT_TRUE(mr.supports_get_mem_info());
+
+  // The bin takes a chunk from the pool, but its unallocated blocks still count as free
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+
+  auto* small = mr.allocate(512);
+  auto* large = mr.allocate(1_MiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB - 1_KiB - 1_MiB);
+
+  mr.deallocate(small, 512);
+  mr.deallocate(large, 1_MiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, 4_MiB);
+}
+
+}  // namespace rmm::test
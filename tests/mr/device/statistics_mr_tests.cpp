@@ -23,6 +23,9 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 namespace rmm::test {
 namespace {
 
@@ -233,5 +236,169 @@ TEST(StatisticsTest, NegativeInnerTracking)
   EXPECT_EQ(inner_mr.get_allocations_counter().total, 5);
 }
 
+TEST(StatisticsTest, MultiThreaded)
+{
+  constexpr std::size_t num_threads{8};
+  constexpr std::size_t count{100};
+  statistics_adaptor mr{rmm::mr::get_current_device_resource()};
+
+  // Each thread frees every other allocation and keeps the rest, freed afterwards on this thread
+  std::vector<std::vector<void*>> kept(num_threads);
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < num_threads; ++thread) {
+    threads.emplace_back([&mr, &kept = kept[thread]]() {
+      for (std::size_t i = 0; i < count; ++i) {
+        void* ptr = mr.allocate(1_KiB);
+        if (i % 2 == 0) {
+          mr.deallocate(ptr, 1_KiB);
+        } else {
+          kept.push_back(ptr);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Each thread may hold one transient allocation while the others hold all their kept ones
+  auto const kept_count = static_cast<int64_t>(num_threads * count / 2);
+  auto const max_peak   = kept_count + static_cast<int64_t>(num_threads);
+  EXPECT_EQ(mr.get_allocations_counter().value, kept_count);
+  EXPECT_GE(mr.get_allocations_counter().peak, kept_count);
+  EXPECT_LE(mr.get_allocations_counter().peak, max_peak);
+  EXPECT_EQ(mr.get_allocations_counter().total, num_threads * count);
+  EXPECT_EQ(mr.get_bytes_counter().value, kept_count * 1_KiB);
+  EXPECT_GE(mr.get_bytes_counter().peak, kept_count * 1_KiB);
+  EXPECT_LE(mr.get_bytes_counter().peak, max_peak * 1_KiB);
+  EXPECT_EQ(mr.get_bytes_counter().total, num_threads * count * 1_KiB);
+
+  for (auto const& ptrs : kept) {
+    for (auto* ptr : ptrs) {
+      mr.deallocate(ptr, 1_KiB);
+    }
+  }
+  EXPECT_EQ(mr.get_allocations_counter().value, 0);
+  EXPECT_EQ(mr.get_bytes_counter().value, 0);
+  EXPECT_GE(mr.get_bytes_counter().peak, kept_count * 1_KiB);
+  EXPECT_LE(mr.get_bytes_counter().peak, max_peak * 1_KiB);
+}
+
+TEST(StatisticsTest, HistogramBuckets)
+{
+  using rmm::mr::histogram;
+  // Small values have a bucket each; larger ones share a bucket within 1/8 of their size
+  for (std::uint64_t value : {0UL, 1UL, 15UL, 16UL, 17UL, 1000UL, 1UL << 40U, ~0UL}) {
+    auto const bucket = histogram::bucket_of(value);
+    ASSERT_LT(bucket, histogram::num_buckets);
+    EXPECT_LE(histogram::bucket_lower_bound(bucket), value);
+    EXPECT_GE(histogram::bucket_upper_bound(bucket), value);
+    EXPECT_LE(histogram::bucket_upper_bound(bucket) - histogram::bucket_lower_bound(bucket),
+              value / histogram::sub_buckets);
+  }
+  EXPECT_EQ(histogram::bucket_of(~0UL), histogram::num_buckets - 1);
+  for (std::size_t bucket = 1; bucket < histogram::num_buckets; ++bucket) {
+    EXPECT_EQ(histogram::bucket_lower_bound(bucket),
+              histogram::bucket_upper_bound(bucket - 1) + 1);
+  }
+}
+
+TEST(StatisticsTest, HistogramPercentiles)
+{
+  rmm::mr::histogram hist{};
+  EXPECT_EQ(hist.percentile(50), 0);
+  for (std::uint64_t value = 1; value <= 100; ++value) {
+    hist.record(value);
+  }
+  EXPECT_EQ(hist.count, 100);
+  EXPECT_EQ(hist.min, 1);
+  EXPECT_EQ(hist.max, 100);
+  EXPECT_DOUBLE_EQ(hist.mean(), 50.5);
+  EXPECT_EQ(hist.percentile(0), 1);
+  EXPECT_EQ(hist.percentile(10), 10);
+  EXPECT_GE(hist.percentile(50), 50);
+  EXPECT_LE(hist.percentile(50), 50 + 50 / rmm::mr::histogram::sub_buckets);
+  EXPECT_EQ(hist.percentile(100), 100);
+
+  rmm::mr::histogram other{};
+  other.record(1000);
+  hist += other;
+  EXPECT_EQ(hist.count, 101);
+  EXPECT_EQ(hist.max, 1000);
+  EXPECT_EQ(hist.percentile(100), 1000);
+}
+
+TEST(StatisticsTest, Histograms)
+{
+  statistics_adaptor mr{rmm::mr::get_current_device_resource(), true};
+  EXPECT_TRUE(mr.histograms_enabled());
+
+  std::vector<void*> allocations;
+  for (std::size_t i = 0; i < num_allocations; ++i) {
+    allocations.push_back(mr.allocate(1_KiB));
+  }
+  allocations.push_back(mr.allocate(ten_MiB));
+  for (std::size_t i = 0; i < num_allocations; ++i) {
+    mr.deallocate(allocations[i], 1_KiB);
+  }
+
+  auto const sizes = mr.get_size_histogram();
+  EXPECT_EQ(sizes.count, num_allocations + 1);
+  EXPECT_EQ(sizes.min, 1_KiB);
+  EXPECT_EQ(sizes.max, ten_MiB);
+  auto const small_bucket = rmm::mr::histogram::bucket_of(1_KiB);
+  EXPECT_EQ(sizes.counts[small_bucket], num_allocations);
+  EXPECT_EQ(sizes.percentile(50), rmm::mr::histogram::bucket_upper_bound(small_bucket));
+  EXPECT_EQ(sizes.percentile(100), ten_MiB);
+
+  // Only freed allocations have a lifetime
+  EXPECT_EQ(mr.get_lifetime_histogram().count, num_allocations);
+  EXPECT_EQ(mr.get_allocate_latency_histogram().count, num_allocations + 1);
+  EXPECT_EQ(mr.get_deallocate_latency_histogram().count, num_allocations);
+
+  mr.reset_histograms();
+  EXPECT_EQ(mr.get_size_histogram().count, 0);
+  EXPECT_EQ(mr.get_lifetime_histogram().count, 0);
+
+  // The lifetime of an allocation made before the reset is still recorded
+  mr.deallocate(allocations.back(), ten_MiB);
+  EXPECT_EQ(mr.get_lifetime_histogram().count, 1);
+  EXPECT_EQ(mr.get_bytes_counter().value, 0);
+}
+
+TEST(StatisticsTest, HistogramsDisabled)
+{
+  statistics_adaptor mr{rmm::mr::get_current_device_resource()};
+  EXPECT_FALSE(mr.histograms_enabled());
+  void* ptr = mr.allocate(1_KiB);
+  mr.deallocate(ptr, 1_KiB);
+  EXPECT_EQ(mr.get_size_histogram().count, 0);
+  EXPECT_EQ(mr.get_lifetime_histogram().count, 0);
+  EXPECT_EQ(mr.get_allocations_counter().total, 1);
+}
+
+TEST(StatisticsTest, HistogramsMultiThreaded)
+{
+  constexpr std::size_t num_threads{8};
+  constexpr std::size_t count{100};
+  statistics_adaptor mr{rmm::mr::get_current_device_resource(), true};
+
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < num_threads; ++thread) {
+    threads.emplace_back([&mr]() {
+      for (std::size_t i = 0; i < count; ++i) {
+        mr.deallocate(mr.allocate(1_KiB), 1_KiB);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(mr.get_size_histogram().count, num_threads * count);
+  EXPECT_EQ(mr.get_size_histogram().sum, num_threads * count * 1_KiB);
+  EXPECT_EQ(mr.get_lifetime_histogram().count, num_threads * count);
+}
+
 }  // namespace
 }  // namespace rmm::test
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2023, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../byte_literals.hpp"
+
+#include <benchmarks/utilities/simulated_memory_resource.hpp>
+
+#include <rmm/cuda_stream.hpp>
+#include <rmm/detail/error.hpp>
+#include <rmm/mr/device/cuda_memory_resource.hpp>
+#include <rmm/mr/device/limiting_resource_adaptor.hpp>
+#include <rmm/mr/device/per_device_resource.hpp>
+#include <rmm/mr/device/tlsf_memory_resource.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <vector>
+
+// explicit instantiation for test coverage purposes
+template class rmm::mr::tlsf_memory_resource<rmm::mr::cuda_memory_resource>;
+
+namespace rmm::test {
+namespace {
+using cuda_mr      = rmm::mr::cuda_memory_resource;
+using tlsf_mr      = rmm::mr::tlsf_memory_resource<rmm::mr::device_memory_resource>;
+using limiting_mr  = rmm::mr::limiting_resource_adaptor<rmm::mr::cuda_memory_resource>;
+using simulated_mr = rmm::mr::simulated_memory_resource;
+
+TEST(TLSFTest, ThrowOnNullUpstream)
+{
+  auto construct_nullptr = []() { tlsf_mr mr{nullptr}; };
+  EXPECT_THROW(construct_nullptr(), rmm::logic_error);
+}
+
+TEST(TLSFTest, ThrowMaxLessThanInitial)
+{
+  auto max_less_than_initial = []() {
+    const auto initial{1024};
+    const auto maximum{256};
+    tlsf_mr mr{rmm::mr::get_current_device_resource(), initial, maximum};
+  };
+  EXPECT_THROW(max_less_than_initial(), rmm::logic_error);
+}
+
+TEST(TLSFTest, ForceGrowth)
+{
+  cuda_mr cuda;
+  auto const max_size{6000};
+  limiting_mr limiter{&cuda, max_size};
+  tlsf_mr mr{&limiter, 0};
+  EXPECT_NO_THROW(mr.allocate(1000));
+  EXPECT_NO_THROW(mr.allocate(4000));
+  EXPECT_NO_THROW(mr.allocate(500));
+  EXPECT_THROW(mr.allocate(2000), rmm::out_of_memory);  // too much
+}
+
+TEST(TLSFTest, ExactFitInSizeClass)
+{
+  // The bitmap search rounds requests up to the next size class; a request for exactly the
+  // whole pool must still be served from the pool's own size class.
+  auto const pool_size{1_MiB + 256_KiB};
+  tlsf_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+  void* ptr{nullptr};
+  EXPECT_NO_THROW(ptr = mr.allocate(pool_size));
+  EXPECT_NO_THROW(mr.deallocate(ptr, pool_size));
+}
+
+TEST(TLSFTest, GoodFitGrowsInsteadOfSearching)
+{
+  // A block that is not on a size class boundary only serves requests up to its class's lower
+  // bound; a larger request grows the pool rather than searching the class
+  auto const pool_size{1_MiB + 256};
+  tlsf_mr mr{rmm::mr::get_current_device_resource(), pool_size};
+  void* ptr = mr.allocate(pool_size);
+  EXPECT_GT(mr.pool_size(), pool_size);
+  mr.deallocate(ptr, pool_size);
+}
+
+TEST(TLSFTest, CoalesceOutOfOrder)
+{
+  auto const pool_size{1_MiB};
+  auto const num_allocations{256};
+  auto const size{pool_size / num_allocations};
+  tlsf_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+
+  std::vector<void*> ptrs(num_allocations);
+  for (auto& ptr : ptrs) {
+    ptr = mr.allocate(size);
+  }
+  EXPECT_THROW(mr.allocate(size), rmm::out_of_memory);
+
+  std::default_random_engine generator;
+  std::shuffle(ptrs.begin(), ptrs.end(), generator);
+  for (auto* ptr : ptrs) {
+    mr.deallocate(ptr, size);
+  }
+
+  // Freed blocks coalesce with both neighbors regardless of the order they are freed in
+  void* whole{nullptr};
+  EXPECT_NO_THROW(whole = mr.allocate(pool_size));
+  mr.deallocate(whole, pool_size);
+}
+
+TEST(TLSFTest, SimulatedRandomAllocations)
+{
+  // Simulated upstream pointers are never dereferenced, so this can model a large device
+  auto const pool_size{64_GiB};
+  simulated_mr simulated{pool_size};
+  tlsf_mr mr{&simulated, pool_size, pool_size};
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<std::size_t> size_distribution(1, 16_MiB);
+  std::uniform_int_distribution<int> op_distribution(0, 99);
+
+  // Live allocations by address, used to check that no two allocations overlap
+  std::map<char*, std::size_t> live;
+  auto const num_operations{10000};
+  for (int i = 0; i < num_operations; ++i) {
+    if (live.empty() || op_distribution(generator) < 55) {
+      auto const size = size_distribution(generator);
+      auto* ptr       = static_cast<char*>(mr.allocate(size));
+      auto const next = live.upper_bound(ptr);
+      if (next != live.end()) { EXPECT_LE(ptr + size, next->first); }
+      if (next != live.begin()) {
+        auto const prev = std::prev(next);
+        EXPECT_LE(prev->first + prev->second, ptr);
+      }
+      live.emplace(ptr, size);
+    } else {
+      auto iter = std::next(live.begin(), static_cast<long>(generator() % live.size()));
+      mr.deallocate(iter->first, iter->second);
+      live.erase(iter);
+    }
+  }
+
+  for (auto const& [ptr, size] : live) {
+    mr.deallocate(ptr, size);
+  }
+
+  EXPECT_EQ(mr.pool_size(), pool_size);
+  void* whole{nullptr};
+  EXPECT_NO_THROW(whole = mr.allocate(pool_size));
+  mr.deallocate(whole, pool_size);
+}
+
+TEST(TLSFTest, GetMemInfo)
+{
+  auto const pool_size{1_MiB};
+  tlsf_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+  EXPECT_TRUE(mr.supports_get_mem_info());
+
+  void* ptr = mr.allocate(256_KiB);
+  auto const [free, total] = mr.get_mem_info(rmm::cuda_stream_default);
+  EXPECT_EQ(free, pool_size - 256_KiB);
+  EXPECT_EQ(total, pool_size);
+  EXPECT_EQ(mr.largest_free_block(), pool_size - 256_KiB);
+
+  mr.deallocate(ptr, 256_KiB);
+  EXPECT_EQ(mr.get_mem_info(rmm::cuda_stream_default).first, pool_size);
+  EXPECT_EQ(mr.largest_free_block(), pool_size);
+}
+
+TEST(TLSFTest, LargestFreeBlockIsServable)
+{
+  // The largest free block is reported as the largest request good-fit search can serve from it
+  auto const pool_size{1_MiB + 256};
+  tlsf_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+  EXPECT_EQ(mr.largest_free_block(), 1_MiB);
+  void* ptr{nullptr};
+  EXPECT_NO_THROW(ptr = mr.allocate(mr.largest_free_block()));
+  mr.deallocate(ptr, 1_MiB);
+}
+
+TEST(TLSFTest, MultiStreamMerge)
+{
+  auto const pool_size{1_MiB};
+  tlsf_mr mr{rmm::mr::get_current_device_resource(), pool_size, pool_size};
+  rmm::cuda_stream stream_a{};
+  rmm::cuda_stream stream_b{};
+
+  auto const half{pool_size / 2};
+  void* ptr_a = mr.allocate(half, stream_a);
+  void* ptr_b = mr.allocate(half, stream_b);
+  mr.deallocate(ptr_a, half, stream_a);
+  mr.deallocate(ptr_b, half, stream_b);
+
+  // The two halves live in different per-stream free lists; a full-size request must merge them
+  void* whole{nullptr};
+  EXPECT_NO_THROW(whole = mr.allocate(pool_size, stream_a));
+  mr.deallocate(whole, pool_size, stream_a);
+}
+
+}  // namespace
+}  // namespace rmm::test
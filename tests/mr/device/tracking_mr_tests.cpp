@@ -26,6 +26,9 @@
 
 #include <spdlog/sinks/ostream_sink.h>
 
+#include <thread>
+#include <vector>
+
 namespace rmm::test {
 namespace {
 
@@ -44,7 +47,7 @@ TEST(TrackingTest, ThrowOnNullUpstream)
 TEST(TrackingTest, Empty)
 {
   tracking_adaptor mr{rmm::mr::get_current_device_resource()};
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), 0);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
   EXPECT_EQ(mr.get_allocated_bytes(), 0);
 }
 
@@ -59,7 +62,7 @@ TEST(TrackingTest, AllFreed)
   for (auto* alloc : allocations) {
     mr.deallocate(alloc, ten_MiB);
   }
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), 0);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
   EXPECT_EQ(mr.get_allocated_bytes(), 0);
 }
 
@@ -74,7 +77,7 @@ TEST(TrackingTest, AllocationsLeftWithStacks)
   for (int i = 0; i < num_allocations; i += 2) {
     mr.deallocate(allocations[i], ten_MiB);
   }
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), num_allocations / 2);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), num_allocations / 2);
   EXPECT_EQ(mr.get_allocated_bytes(), ten_MiB * (num_allocations / 2));
   auto const& outstanding_allocations = mr.get_outstanding_allocations();
   EXPECT_EQ(outstanding_allocations.size(), num_allocations / 2);
@@ -93,7 +96,7 @@ TEST(TrackingTest, AllocationsLeftWithoutStacks)
   for (int i = 0; i < num_allocations; i += 2) {
     mr.deallocate(allocations[i], ten_MiB);
   }
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), num_allocations / 2);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), num_allocations / 2);
   EXPECT_EQ(mr.get_allocated_bytes(), ten_MiB * (num_allocations / 2));
   auto const& outstanding_allocations = mr.get_outstanding_allocations();
   EXPECT_EQ(outstanding_allocations.size(), num_allocations / 2);
@@ -111,7 +114,7 @@ TEST(TrackingTest, MultiTracking)
       std::make_shared<rmm::device_buffer>(ten_MiB, rmm::cuda_stream_default));
   }
 
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), num_allocations);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), num_allocations);
 
   tracking_adaptor inner_mr{rmm::mr::get_current_device_resource()};
   rmm::mr::set_current_device_resource(&inner_mr);
@@ -122,8 +125,8 @@ TEST(TrackingTest, MultiTracking)
   }
 
   // Check the allocated bytes for both MRs
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), num_allocations + num_more_allocations);
-  EXPECT_EQ(inner_mr.get_outstanding_allocations().size(), num_more_allocations);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), num_allocations + num_more_allocations);
+  EXPECT_EQ(inner_mr.get_outstanding_allocations_count(), num_more_allocations);
 
   EXPECT_EQ(mr.get_allocated_bytes(), ten_MiB * (num_allocations + num_more_allocations));
   EXPECT_EQ(inner_mr.get_allocated_bytes(), ten_MiB * num_more_allocations);
@@ -134,8 +137,8 @@ TEST(TrackingTest, MultiTracking)
   allocations.clear();
 
   // The current allocations for both MRs should be 0
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), 0);
-  EXPECT_EQ(inner_mr.get_outstanding_allocations().size(), 0);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
+  EXPECT_EQ(inner_mr.get_outstanding_allocations_count(), 0);
 
   EXPECT_EQ(mr.get_allocated_bytes(), 0);
   EXPECT_EQ(inner_mr.get_allocated_bytes(), 0);
@@ -155,7 +158,7 @@ TEST(TrackingTest, NegativeInnerTracking)
     allocations.push_back(mr.allocate(ten_MiB));
   }
 
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), num_allocations);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), num_allocations);
 
   tracking_adaptor inner_mr{&mr};
 
@@ -165,8 +168,8 @@ TEST(TrackingTest, NegativeInnerTracking)
   }
 
   // Check the outstanding allocations
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), num_allocations + num_more_allocations);
-  EXPECT_EQ(inner_mr.get_outstanding_allocations().size(), num_more_allocations);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), num_allocations + num_more_allocations);
+  EXPECT_EQ(inner_mr.get_outstanding_allocations_count(), num_more_allocations);
 
   // Deallocate all allocations using the inner_mr
   for (auto& allocation : allocations) {
@@ -175,8 +178,8 @@ TEST(TrackingTest, NegativeInnerTracking)
   allocations.clear();
 
   // Check the outstanding allocations are all 0
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), 0);
-  EXPECT_EQ(inner_mr.get_outstanding_allocations().size(), 0);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
+  EXPECT_EQ(inner_mr.get_outstanding_allocations_count(), 0);
 }
 
 TEST(TrackingTest, DeallocWrongBytes)
@@ -193,13 +196,170 @@ TEST(TrackingTest, DeallocWrongBytes)
   }
   allocations.clear();
 
-  EXPECT_EQ(mr.get_outstanding_allocations().size(), 0);
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
   EXPECT_EQ(mr.get_allocated_bytes(), 0);
 
   // Verify current allocations are correct despite the error
   EXPECT_EQ(mr.get_allocated_bytes(), 0);
 }
 
+TEST(TrackingTest, ManyAllocations)
+{
+  // Enough allocations, over few enough shards, that the shards' tables must grow
+  constexpr std::size_t num_shards{2};
+  constexpr std::size_t count{1000};
+  tracking_adaptor mr{rmm::mr::get_current_device_resource(), false, num_shards};
+  std::vector<void*> allocations;
+  for (std::size_t i = 0; i < count; ++i) {
+    allocations.push_back(mr.allocate(1_KiB));
+  }
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), count);
+  EXPECT_EQ(mr.get_allocated_bytes(), count * 1_KiB);
+
+  // Free every other allocation, so that entries move back within the tables
+  for (std::size_t i = 0; i < count; i += 2) {
+    mr.deallocate(allocations[i], 1_KiB);
+  }
+  auto const outstanding = mr.get_outstanding_allocations();
+  EXPECT_EQ(outstanding.size(), count / 2);
+  for (std::size_t i = 1; i < count; i += 2) {
+    EXPECT_EQ(outstanding.count(allocations[i]), 1);
+  }
+
+  // The string lists the outstanding allocations in address order
+  std::ostringstream expected;
+  for (auto const& alloc : outstanding) {
+    expected << alloc.first << ": " << 1_KiB << " B" << std::endl;
+  }
+  EXPECT_EQ(mr.get_outstanding_allocations_str(), expected.str());
+
+  for (std::size_t i = 1; i < count; i += 2) {
+    mr.deallocate(allocations[i], 1_KiB);
+  }
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
+  EXPECT_EQ(mr.get_allocated_bytes(), 0);
+}
+
+TEST(TrackingTest, MultiThreaded)
+{
+  constexpr std::size_t num_threads{8};
+  constexpr std::size_t count{200};
+  tracking_adaptor mr{rmm::mr::get_current_device_resource()};
+
+  // Each thread frees half of its allocations and keeps the rest
+  std::vector<std::vector<void*>> kept(num_threads);
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < num_threads; ++thread) {
+    threads.emplace_back([&mr, &kept = kept[thread]]() {
+      for (std::size_t i = 0; i < count; ++i) {
+        void* ptr = mr.allocate(1_KiB);
+        if (i % 2 == 0) {
+          mr.deallocate(ptr, 1_KiB);
+        } else {
+          kept.push_back(ptr);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto const outstanding = mr.get_outstanding_allocations();
+  EXPECT_EQ(outstanding.size(), num_threads * count / 2);
+  EXPECT_EQ(mr.get_allocated_bytes(), num_threads * count / 2 * 1_KiB);
+  for (auto const& ptrs : kept) {
+    for (auto* ptr : ptrs) {
+      EXPECT_EQ(outstanding.count(ptr), 1);
+      mr.deallocate(ptr, 1_KiB);
+    }
+  }
+  EXPECT_EQ(mr.get_outstanding_allocations_count(), 0);
+  EXPECT_EQ(mr.get_allocated_bytes(), 0);
+}
+
+TEST(TrackingTest, SampledStacksAreShared)
+{
+  constexpr std::size_t interval{4};
+  tracking_adaptor mr{rmm::mr::get_current_device_resource(),
+                      tracking_adaptor::stack_sampling{interval}};
+  std::vector<void*> allocations;
+  for (std::size_t i = 0; i < num_allocations * interval; ++i) {
+    allocations.push_back(mr.allocate(1_KiB));
+  }
+
+  // Every `interval`th allocation has a stack, and they all share the one trace of the call site
+  std::size_t sampled{0};
+  rmm::detail::stack_trace const* trace{nullptr};
+  for (auto const& alloc : mr.get_outstanding_allocations()) {
+    if (alloc.second.strace == nullptr) { continue; }
+    ++sampled;
+    if (trace == nullptr) { trace = alloc.second.strace.get(); }
+    EXPECT_EQ(alloc.second.strace.get(), trace);
+  }
+  EXPECT_EQ(sampled, num_allocations);
+
+  auto const sites = mr.get_call_sites();
+  ASSERT_EQ(sites.size(), 1);
+  EXPECT_EQ(sites[0].strace.get(), trace);
+  EXPECT_EQ(sites[0].allocation_count, num_allocations);
+  EXPECT_EQ(sites[0].allocated_bytes, num_allocations * 1_KiB);
+  EXPECT_EQ(sites[0].estimated_bytes, num_allocations * interval * 1_KiB);
+  EXPECT_NE(mr.get_call_sites_str().find("callstack"), std::string::npos);
+
+  for (auto* ptr : allocations) {
+    mr.deallocate(ptr, 1_KiB);
+  }
+  EXPECT_TRUE(mr.get_call_sites().empty());
+}
+
+TEST(TrackingTest, CallSitesBySize)
+{
+  tracking_adaptor mr{rmm::mr::get_current_device_resource(), true};
+  void* small = mr.allocate(1_KiB);
+  void* large = mr.allocate(ten_MiB);
+
+  auto const sites = mr.get_call_sites();
+  ASSERT_EQ(sites.size(), 2);
+  EXPECT_EQ(sites[0].allocated_bytes, ten_MiB);
+  EXPECT_EQ(sites[1].allocated_bytes, 1_KiB);
+  EXPECT_EQ(sites[0].estimated_bytes, ten_MiB);
+
+  mr.deallocate(small, 1_KiB);
+  mr.deallocate(large, ten_MiB);
+}
+
+TEST(TrackingTest, ByteSampling)
+{
+  constexpr std::size_t byte_interval{64_KiB};
+  constexpr std::size_t count{4000};
+  tracking_adaptor mr{rmm::mr::get_current_device_resource(),
+                      tracking_adaptor::stack_sampling{0, byte_interval}};
+  std::vector<void*> allocations;
+  for (std::size_t i = 0; i < count; ++i) {
+    allocations.push_back(mr.allocate(1_KiB));
+  }
+
+  // Allocations much larger than the interval are practically always sampled
+  void* large = mr.allocate(ten_MiB);
+  auto const outstanding = mr.get_outstanding_allocations();
+  EXPECT_NE(outstanding.at(large).strace, nullptr);
+  mr.deallocate(large, ten_MiB);
+
+  // About one small allocation is sampled per interval, and the estimate is close to the total
+  auto const sites = mr.get_call_sites();
+  ASSERT_EQ(sites.size(), 1);
+  auto const expected_samples = count * 1_KiB / byte_interval;
+  EXPECT_GT(sites[0].allocation_count, expected_samples / 2);
+  EXPECT_LT(sites[0].allocation_count, expected_samples * 2);
+  EXPECT_GT(sites[0].estimated_bytes, count * 1_KiB / 2);
+  EXPECT_LT(sites[0].estimated_bytes, count * 1_KiB * 2);
+
+  for (auto* ptr : allocations) {
+    mr.deallocate(ptr, 1_KiB);
+  }
+}
+
 TEST(TrackingTest, LogOutstandingAllocations)
 {
   std::ostringstream oss;